@@ -0,0 +1,130 @@
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "slp/pipeline/aggregate.h"
+#include "slp/pipeline/model_store.h"
+#include "slp/seaweed/filer.h"
+
+// Metrics across every run on the filer, grouped by model, prompt set and
+// day. Runs already aggregated are served from a local cache as long as
+// their results object is unchanged.
+
+namespace {
+
+void usage() {
+    std::cerr << "usage: slp_aggregate <filer_url> [options]\n";
+    std::cerr << "  --prefix=<run_id prefix>  only runs whose id starts with this\n";
+    std::cerr << "  --fetch=<n>               result objects fetched at once (default 16)\n";
+    std::cerr << "  --threads=<n>             parser threads (default: one per core)\n";
+    std::cerr << "  --cache=<file>            aggregate cache (default <cache_dir>/aggregate/<filer>.jsonl)\n";
+    std::cerr << "  --no-cache                read and parse every run\n";
+    std::cerr << "  --out=<file>              summary JSON (default aggregate.json)\n";
+    std::cerr << "  --put=<filer path>        also store the summary on the filer, e.g. /runs-summary.json\n";
+}
+
+// Filer URL as a file name
+std::string cache_name(const std::string& filer) {
+    std::string name = filer.substr(filer.find("://") == std::string::npos ? 0 : filer.find("://") + 3);
+    for (char& c : name) {
+        if (!std::isalnum(static_cast<unsigned char>(c)) && c != '.' && c != '-') c = '_';
+    }
+    return name;
+}
+
+std::string short_hash(const std::string& h) {
+    return h.size() > 12 ? h.substr(0, 12) : h;
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2 || std::string(argv[1]).rfind("--", 0) == 0) {
+        usage();
+        return 1;
+    }
+
+    slp::pipeline::AggregateOptions opts;
+    opts.filer_base = argv[1];
+    std::string cache_path;
+    bool use_cache = true;
+    std::string out_path = "aggregate.json";
+    std::string put_path;
+
+    try {
+        for (int i = 2; i < argc; ++i) {
+            std::string arg = argv[i];
+            auto value = [&](const std::string& prefix) { return arg.substr(prefix.size()); };
+            if (arg.rfind("--prefix=", 0) == 0) {
+                opts.run_prefix = value("--prefix=");
+            } else if (arg.rfind("--fetch=", 0) == 0) {
+                opts.fetch_concurrency = std::max<size_t>(1, std::stoul(value("--fetch=")));
+            } else if (arg.rfind("--threads=", 0) == 0) {
+                opts.parse_threads = std::stoul(value("--threads="));
+            } else if (arg.rfind("--cache=", 0) == 0) {
+                cache_path = value("--cache=");
+            } else if (arg == "--no-cache") {
+                use_cache = false;
+            } else if (arg.rfind("--out=", 0) == 0) {
+                out_path = value("--out=");
+            } else if (arg.rfind("--put=", 0) == 0) {
+                put_path = value("--put=");
+            } else {
+                usage();
+                return 1;
+            }
+        }
+        if (use_cache) {
+            opts.cache_path = cache_path.empty() ? slp::pipeline::default_cache_dir() + "/aggregate/" +
+                                                       cache_name(opts.filer_base) + ".jsonl"
+                                                 : cache_path;
+        }
+
+        auto report = slp::pipeline::aggregate_runs(opts);
+
+        std::cout << "Runs: " << report.runs << " (" << report.runs_cached << " cached, "
+                  << report.runs - report.runs_cached << " read, " << report.runs_pending << " without results, "
+                  << report.runs_failed << " failed)\n";
+        std::cout << "Read " << std::fixed << std::setprecision(2)
+                  << static_cast<double>(report.bytes_fetched) / (1024.0 * 1024.0) << " MiB in " << report.seconds
+                  << " s\n";
+        if (report.bad_lines > 0) std::cout << "Skipped " << report.bad_lines << " lines that are not results\n";
+        for (const auto& e : report.errors) std::cerr << "failed: " << e << "\n";
+
+        std::cout << "\n" << std::left << std::setw(14) << "model" << std::setw(14) << "prompts" << std::setw(12)
+                  << "date" << std::right << std::setw(6) << "runs" << std::setw(10) << "requests" << std::setw(9)
+                  << "ok%" << std::setw(10) << "p50 ms" << std::setw(10) << "p99 ms" << std::setw(11) << "decode t/s"
+                  << "\n";
+        for (const auto& [key, g] : report.groups) {
+            double ok = g.requests ? 100.0 * static_cast<double>(g.successes) / static_cast<double>(g.requests) : 0.0;
+            double decode = g.predicted_ms > 0 ? static_cast<double>(g.predicted_tokens) * 1000.0 / g.predicted_ms : 0.0;
+            std::cout << std::left << std::setw(14) << short_hash(key.model_hash) << std::setw(14)
+                      << short_hash(key.prompts_hash) << std::setw(12) << key.date << std::right << std::setw(6)
+                      << g.runs << std::setw(10) << g.requests << std::setw(9) << std::setprecision(2) << ok
+                      << std::setw(10) << g.latency.percentile_ms(0.50) << std::setw(10) << g.latency.percentile_ms(0.99)
+                      << std::setw(11) << std::setprecision(1) << decode << "\n";
+        }
+
+        std::string summary = report.to_json();
+        std::ofstream out(out_path);
+        if (!out) throw std::runtime_error("cannot write " + out_path);
+        out << summary << "\n";
+        std::cout << "\nSummary: " << out_path << "\n";
+
+        if (!put_path.empty()) {
+            if (!slp::seaweed::put_file(opts.filer_base, put_path, std::vector<uint8_t>(summary.begin(), summary.end()))) {
+                throw std::runtime_error("failed to store summary at " + put_path);
+            }
+            std::cout << "Stored:  " << put_path << "\n";
+        }
+        return report.runs_failed > 0 ? 2 : 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
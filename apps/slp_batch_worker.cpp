@@ -0,0 +1,325 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <ctime>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+#include "slp/artifact/paths.h"
+#include "slp/async_http.h"
+#include "slp/json.h"
+#include "slp/llama/batch_result.h"
+#include "slp/llama/completion.h"
+#include "slp/llama/endpoint_pool.h"
+#include "slp/llama/loadgen.h"
+#include "slp/pipeline/shards.h"
+#include "slp/seaweed/filer.h"
+
+// One worker of a sharded batch run. Start as many as you like, on any
+// nodes, with the same arguments: they split the prompt set between them
+// through lease objects on the filer, with no coordinator. A worker that
+// dies leaves its lease to expire, and the shard is taken over.
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using slp::llama::InferenceResult;
+using slp::pipeline::Lease;
+using slp::pipeline::ShardLeases;
+
+void usage() {
+    std::cerr << "usage: slp_batch_worker <filer_url> <llama_url[,llama_url...]> <prompts_hash> <run_id> [options]\n";
+    std::cerr << "  --shard-prompts=<n>  prompts per shard when this worker plans the run (default 500)\n";
+    std::cerr << "  --concurrency=<n>    prompts in flight per worker (default 4)\n";
+    std::cerr << "  --lease-ms=<ms>      lease length; renewed every third of it (default 30000)\n";
+    std::cerr << "  --settle-ms=<ms>     wait before confirming a claim (default 200)\n";
+    std::cerr << "  --owner=<name>       name written into leases (default <hostname>-<pid>)\n";
+    std::cerr << "  --max-shards=<n>     stop after finishing n shards\n";
+    std::cerr << "  --no-merge           leave results per shard; do not write results.jsonl\n";
+    std::cerr << "  --model=<hash>       model the servers run, recorded in the run's metrics.json\n";
+    std::cerr << "\n";
+    std::cerr << "The prompt set is read from /prompts/<prompts_hash>.jsonl. Leases go to\n";
+    std::cerr << "/runs/<run_id>/leases/, per-shard results to /runs/<run_id>/shards/, and the\n";
+    std::cerr << "worker that sees the last shard finish writes /runs/<run_id>/results.jsonl\n";
+    std::cerr << "and metrics.json.\n";
+    std::cerr << "\n";
+    std::cerr << "Example (run the same command on every node):\n";
+    std::cerr << "  slp_batch_worker http://127.0.0.1:8888 http://127.0.0.1:8090 4f2a... run-42\n";
+}
+
+std::string default_owner() {
+    char host[256] = {};
+    if (gethostname(host, sizeof(host) - 1) != 0) host[0] = '\0';
+    return std::string(host[0] ? host : "worker") + "-" + std::to_string(getpid());
+}
+
+std::string iso_timestamp() {
+    auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+    std::tm tm_now;
+    localtime_r(&now, &tm_now);
+    char buf[32];
+    return std::string(buf, std::strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%S", &tm_now));
+}
+
+// Keeps a lease alive from a side thread while the shard runs; if the
+// lease is lost, `lost()` turns true and the shard should be abandoned
+class LeaseKeeper {
+public:
+    LeaseKeeper(ShardLeases& leases, Lease lease, std::chrono::milliseconds ttl)
+        : leases_(leases),
+          lease_(std::move(lease)),
+          interval_(std::max<std::chrono::milliseconds>(ttl / 3, std::chrono::milliseconds(1))),
+          thread_([this] { run(); }) {}
+
+    ~LeaseKeeper() {
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            stop_ = true;
+        }
+        cv_.notify_one();
+        thread_.join();
+    }
+
+    LeaseKeeper(const LeaseKeeper&) = delete;
+    LeaseKeeper& operator=(const LeaseKeeper&) = delete;
+
+    bool lost() const { return lost_; }
+
+private:
+    void run() {
+        std::unique_lock<std::mutex> lock(mu_);
+        while (!cv_.wait_for(lock, interval_, [this] { return stop_; })) {
+            lock.unlock();
+            try {
+                if (!leases_.renew(lease_)) lost_ = true;
+            } catch (const std::exception& e) {
+                // Keep trying; the lease only lapses if the filer stays away
+                std::cerr << "lease renewal for shard " << lease_.shard << " failed: " << e.what() << "\n";
+            }
+            lock.lock();
+            if (lost_) return;
+        }
+    }
+
+    ShardLeases& leases_;
+    Lease lease_;
+    std::chrono::milliseconds interval_;
+    std::mutex mu_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+    std::atomic<bool> lost_{false};
+    std::thread thread_;
+};
+
+struct ShardRun {
+    std::vector<slp::llama::LoadPrompt> prompts;
+    std::vector<InferenceResult> results;
+    std::vector<std::string> urls;
+    size_t next = 0;
+};
+
+slp::Task<void> prompt_worker(slp::AsyncHttpClient& http, ShardRun& run, const LeaseKeeper& keeper) {
+    while (run.next < run.prompts.size() && !keeper.lost()) {
+        size_t i = run.next++;
+        const auto& p = run.prompts[i];
+        const std::string& url = run.urls[i % run.urls.size()];
+        InferenceResult& r = run.results[i];
+        r.prompt = p.prompt;
+        r.max_tokens = p.max_tokens;
+        r.timestamp = iso_timestamp();
+        auto c = co_await slp::llama::complete_async(http, url, p.prompt, p.max_tokens);
+        r.success = c.success;
+        r.content = std::move(c.content);
+        r.error = std::move(c.error);
+        r.elapsed_us = c.elapsed_us;
+        r.timings = c.timings;
+    }
+}
+
+struct WorkerStats {
+    uint64_t shards = 0;
+    uint64_t stolen = 0;
+    uint64_t lost = 0;
+    uint64_t prompts = 0;
+    uint64_t failures = 0;
+};
+
+} // anonymous namespace
+
+int main(int argc, char** argv) {
+    if (argc < 5) {
+        usage();
+        return 1;
+    }
+
+    std::string filer = argv[1];
+    std::string llama_urls = argv[2];
+    std::string prompts_hash = argv[3];
+    std::string run_id = argv[4];
+    uint32_t shard_prompts = 500;
+    size_t concurrency = 4;
+    slp::pipeline::LeaseOptions lease_opts;
+    std::string owner = default_owner();
+    uint64_t max_shards = 0;
+    bool merge = true;
+    std::string model_hash;
+
+    try {
+        for (int i = 5; i < argc; ++i) {
+            std::string arg = argv[i];
+            auto value = [&](const std::string& prefix) { return arg.substr(prefix.size()); };
+            if (arg.rfind("--shard-prompts=", 0) == 0) {
+                shard_prompts = static_cast<uint32_t>(std::stoul(value("--shard-prompts=")));
+            } else if (arg.rfind("--concurrency=", 0) == 0) {
+                concurrency = std::max<size_t>(1, std::stoul(value("--concurrency=")));
+            } else if (arg.rfind("--lease-ms=", 0) == 0) {
+                lease_opts.ttl = std::chrono::milliseconds(std::stol(value("--lease-ms=")));
+            } else if (arg.rfind("--settle-ms=", 0) == 0) {
+                lease_opts.settle = std::chrono::milliseconds(std::stol(value("--settle-ms=")));
+            } else if (arg.rfind("--owner=", 0) == 0) {
+                owner = value("--owner=");
+            } else if (arg.rfind("--max-shards=", 0) == 0) {
+                max_shards = std::stoull(value("--max-shards="));
+            } else if (arg == "--no-merge") {
+                merge = false;
+            } else if (arg.rfind("--model=", 0) == 0) {
+                model_hash = value("--model=");
+            } else {
+                usage();
+                return 1;
+            }
+        }
+
+        auto urls = slp::llama::parse_endpoint_list(llama_urls);
+        auto plan = slp::pipeline::load_or_create_plan(filer, run_id, prompts_hash, shard_prompts);
+        std::cout << "[" << owner << "] run " << run_id << ": " << plan.total_prompts << " prompts in "
+                  << plan.shards.size() << " shards\n";
+
+        if (plan.shards.empty()) {
+            std::cout << "[" << owner << "] nothing to do\n";
+            return 0;
+        }
+
+        ShardLeases leases(filer, run_id, owner, lease_opts);
+        slp::EventLoop loop;
+        slp::AsyncHttpClient http(loop);
+        std::vector<uint8_t> whole_prompts;  // only for compressed prompt sets
+        auto poll = std::min<std::chrono::milliseconds>(lease_opts.ttl / 4, std::chrono::milliseconds(2000));
+        // Workers start at different shards so that they rarely race for one
+        auto start_shard = static_cast<uint32_t>(std::hash<std::string>{}(owner) % plan.shards.size());
+        WorkerStats stats;
+        auto t0 = Clock::now();
+        bool finished = false;
+
+        while (max_shards == 0 || stats.shards < max_shards) {
+            auto next = leases.next(plan, start_shard);
+            if (next.outcome == ShardLeases::Outcome::finished) {
+                finished = true;
+                break;
+            }
+            if (next.outcome == ShardLeases::Outcome::wait) {
+                std::this_thread::sleep_for(poll);
+                continue;
+            }
+
+            const auto& shard = plan.shards[next.lease.shard];
+            auto shard_t0 = Clock::now();
+            // Compressed prompt sets cannot be read by range (the read
+            // throws, or comes back short); fetch those whole, once
+            std::vector<uint8_t> body;
+            if (whole_prompts.empty()) {
+                try {
+                    body = slp::seaweed::get_file_range(filer, slp::artifact::prompts_path(prompts_hash),
+                                                        shard.offset, shard.length);
+                } catch (const std::exception&) {
+                    body.clear();
+                }
+            }
+            if (body.size() != shard.length) {
+                if (whole_prompts.empty()) {
+                    whole_prompts = slp::seaweed::get_file(filer, slp::artifact::prompts_path(prompts_hash));
+                }
+                if (shard.offset + shard.length > whole_prompts.size()) {
+                    throw std::runtime_error("prompt set is shorter than shard " + std::to_string(shard.id));
+                }
+                auto first = whole_prompts.begin() + static_cast<std::ptrdiff_t>(shard.offset);
+                body.assign(first, first + static_cast<std::ptrdiff_t>(shard.length));
+            }
+
+            ShardRun run;
+            run.urls = urls;
+            run.prompts = slp::llama::parse_prompts(std::string(body.begin(), body.end()),
+                                                    slp::artifact::prompts_path(prompts_hash));
+            run.results.resize(run.prompts.size());
+            bool lost = false;
+            {
+                LeaseKeeper keeper(leases, next.lease, lease_opts.ttl);
+                std::vector<slp::Task<void>> workers;
+                for (size_t w = 0; w < std::min(concurrency, run.prompts.size()); ++w) {
+                    workers.push_back(prompt_worker(http, run, keeper));
+                }
+                loop.run(slp::when_all(std::move(workers)));
+                lost = keeper.lost();
+            }
+            if (lost) {
+                stats.lost++;
+                std::cout << "[" << owner << "] shard " << shard.id << ": lease lost to another worker, abandoned\n";
+                continue;
+            }
+
+            std::string out;
+            uint64_t failures = 0;
+            for (const auto& r : run.results) {
+                slp::llama::append_result_json(out, r);
+                out += '\n';
+                if (!r.success) failures++;
+            }
+            leases.complete(shard.id, out);
+
+            double secs = std::chrono::duration<double>(Clock::now() - shard_t0).count();
+            stats.shards++;
+            stats.prompts += run.results.size();
+            stats.failures += failures;
+            if (next.stolen) stats.stolen++;
+            std::cout << "[" << owner << "] shard " << shard.id << ": " << run.results.size() << " prompts in "
+                      << std::fixed << std::setprecision(2) << secs << " s" << (next.stolen ? " (taken over)" : "")
+                      << (failures ? ", " + std::to_string(failures) + " failed" : "") << "\n";
+        }
+
+        double secs = std::chrono::duration<double>(Clock::now() - t0).count();
+        std::cout << "[" << owner << "] done: " << stats.shards << " shards (" << stats.stolen << " taken over, "
+                  << stats.lost << " lost), " << stats.prompts << " prompts, " << stats.failures << " failed, "
+                  << std::fixed << std::setprecision(2) << secs << " s, "
+                  << (secs > 0 ? static_cast<double>(stats.prompts) / secs : 0.0) << " prompts/s\n";
+
+        if (finished && merge && !slp::seaweed::file_exists(filer, slp::artifact::run_results_path(run_id))) {
+            // Metrics first: results.jsonl marks the run finished, and readers
+            // that see it may cache the run without looking again
+            std::string metrics = "{\"run_id\":\"" + slp::json::escape(run_id) + "\",\"prompts_hash\":\"" +
+                                  slp::json::escape(prompts_hash) + "\"" +
+                                  (model_hash.empty() ? "" : ",\"model_hash\":\"" + slp::json::escape(model_hash) + "\"") +
+                                  ",\"prompts\":" + std::to_string(plan.total_prompts) +
+                                  ",\"shards\":" + std::to_string(plan.shards.size()) + "}";
+            slp::seaweed::CodecOptions codec;
+            codec.codec = slp::seaweed::default_text_codec();
+            if (!slp::seaweed::put_file(filer, slp::artifact::run_metrics_path(run_id),
+                                        std::vector<uint8_t>(metrics.begin(), metrics.end()), codec)) {
+                throw std::runtime_error("failed to write " + slp::artifact::run_metrics_path(run_id));
+            }
+            slp::pipeline::merge_shard_results(filer, run_id, plan);
+            std::cout << "[" << owner << "] all shards finished; wrote " << slp::artifact::run_results_path(run_id)
+                      << "\n";
+        }
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -1,12 +1,18 @@
 #include <iostream>
+#include <memory>
 #include <vector>
 #include <chrono>
 #include <random>
 #include <algorithm>
 #include <iomanip>
+#include <stdexcept>
 
+#include "slp/async_http.h"
 #include "slp/seaweed/filer.h"
+#include "slp/seaweed/filer_async.h"
+#include "slp/seaweed/retry.h"
 #include "slp/sha256.h"
+#include "slp/testing/mock_filer.h"
 
 static std::vector<uint8_t> generate_random_data(size_t size) {
     std::vector<uint8_t> data(size);
@@ -27,10 +33,29 @@ static double percentile(std::vector<double> v, double p) {
     return v[idx];
 }
 
+// `workers` coroutines share the iterations, so at most that many GETs are
+// in flight on the one loop thread
+static slp::Task<void> async_download_worker(slp::AsyncHttpClient& http, const std::string& filer,
+                                             const std::string& path, size_t expected, size_t& next,
+                                             size_t iters, std::vector<double>& latencies_ms) {
+    while (next < iters) {
+        next++;
+        auto t0 = std::chrono::steady_clock::now();
+        auto bytes = co_await slp::seaweed::get_file_async(http, filer, path);
+        auto t1 = std::chrono::steady_clock::now();
+        if (bytes.size() != expected) throw std::runtime_error("short download");
+        latencies_ms.push_back(std::chrono::duration<double, std::milli>(t1 - t0).count());
+    }
+}
+
 int main(int argc, char** argv) {
-    if (argc != 5) {
-        std::cerr << "usage: slp_bench_storage <filer_url> <size_mb> <iters> <operation>\n";
-        std::cerr << "  operation: upload | download | roundtrip\n";
+    if (argc != 5 && argc != 6) {
+        std::cerr << "usage: slp_bench_storage <filer_url> <size_mb> <iters> <operation> [concurrency]\n";
+        std::cerr << "  operation: upload | download | download-async | roundtrip\n";
+        std::cerr << "  download-async keeps up to [concurrency] GETs (default: iters) in flight\n";
+        std::cerr << "  from a single thread; size_mb may be fractional (0.004 = 4 KiB)\n";
+        std::cerr << "  filer_url 'mock' or 'mock:<latency spec>' (e.g. mock:exp:2) benchmarks an\n";
+        std::cerr << "  in-process stand-in filer instead of SeaweedFS\n";
         std::cerr << "\n";
         std::cerr << "  Example:\n";
         std::cerr << "    slp_bench_storage http://127.0.0.1:8888 128 10 roundtrip\n";
@@ -38,11 +63,19 @@ int main(int argc, char** argv) {
     }
 
     std::string filer = argv[1];
-    size_t size_mb = std::stoul(argv[2]);
+    std::unique_ptr<slp::testing::MockFiler> mock;
+    if (filer == "mock" || filer.rfind("mock:", 0) == 0) {
+        slp::testing::FaultOptions faults;
+        if (filer.size() > 5) faults.latency = slp::testing::Latency::parse(filer.substr(5));
+        mock = std::make_unique<slp::testing::MockFiler>(faults);
+        filer = mock->url();
+    }
+    double size_mb = std::stod(argv[2]);
     size_t iters = std::stoul(argv[3]);
     std::string operation = argv[4];
+    size_t concurrency = argc == 6 ? std::stoul(argv[5]) : iters;
 
-    size_t size_bytes = size_mb * 1024 * 1024;
+    auto size_bytes = static_cast<size_t>(size_mb * 1024 * 1024);
 
     std::cout << "Storage Benchmark\n";
     std::cout << "=================\n";
@@ -92,10 +125,78 @@ int main(int argc, char** argv) {
     }
 
     if (operation == "download") {
-        std::cout << "Download benchmark not yet implemented.\n";
-        std::cout << "Would test retrieval of existing blobs from SeaweedFS.\n";
+        std::cout << "Running download benchmark...\n";
+
+        auto data = generate_random_data(size_bytes);
+        auto hash = slp::sha256_hex(data);
+        std::string path = "/bench/" + hash + ".bin";
+        if (!slp::seaweed::put_file(filer, path, data)) {
+            std::cerr << "Upload of benchmark object failed\n";
+            return 1;
+        }
+
+        for (size_t i = 0; i < iters; ++i) {
+            auto t0 = std::chrono::steady_clock::now();
+            auto bytes = slp::seaweed::get_file(filer, path);
+            auto t1 = std::chrono::steady_clock::now();
+
+            if (bytes.size() != size_bytes) {
+                std::cerr << "Short download at iteration " << i << "\n";
+                return 1;
+            }
+            double ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+            latencies_ms.push_back(ms);
+        }
+
+        std::cout << "\nDownload Statistics:\n";
+        std::cout << "  P50:   " << std::fixed << std::setprecision(2) << percentile(latencies_ms, 0.5) << " ms\n";
+        std::cout << "  P95:   " << percentile(latencies_ms, 0.95) << " ms\n";
+        std::cout << "  P99:   " << percentile(latencies_ms, 0.99) << " ms\n";
+        std::cout << "  Max:   " << percentile(latencies_ms, 1.0) << " ms\n";
+    }
+
+    if (operation == "download-async") {
+        std::cout << "Running async download benchmark (" << concurrency << " in flight)...\n";
+
+        auto data = generate_random_data(size_bytes);
+        auto hash = slp::sha256_hex(data);
+        std::string path = "/bench/" + hash + ".bin";
+        if (!slp::seaweed::put_file(filer, path, data)) {
+            std::cerr << "Upload of benchmark object failed\n";
+            return 1;
+        }
+
+        slp::EventLoop loop;
+        slp::AsyncHttpClient http(loop);
+        size_t next = 0;
+        std::vector<slp::Task<void>> workers;
+        for (size_t w = 0; w < std::max<size_t>(1, std::min(concurrency, iters)); ++w) {
+            workers.push_back(async_download_worker(http, filer, path, size_bytes, next, iters, latencies_ms));
+        }
+
+        auto t0 = std::chrono::steady_clock::now();
+        try {
+            loop.run(slp::when_all(std::move(workers)));
+        } catch (const std::exception& e) {
+            std::cerr << "Download failed: " << e.what() << "\n";
+            return 1;
+        }
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+        std::cout << "\nDownload Statistics:\n";
+        std::cout << "  P50:   " << std::fixed << std::setprecision(2) << percentile(latencies_ms, 0.5) << " ms\n";
+        std::cout << "  P95:   " << percentile(latencies_ms, 0.95) << " ms\n";
+        std::cout << "  P99:   " << percentile(latencies_ms, 0.99) << " ms\n";
+        std::cout << "  Max:   " << percentile(latencies_ms, 1.0) << " ms\n";
+        std::cout << "  Rate:  " << static_cast<double>(iters) / secs << " req/s, "
+                  << static_cast<double>(iters * size_bytes) / (1024.0 * 1024.0) / secs << " MB/s (1 thread)\n";
     }
 
+    auto rs = slp::seaweed::request_stats();
+    std::cout << "\nRequests: " << rs.requests << " (" << rs.attempts << " sent, "
+              << rs.retries << " retries, " << rs.hedges_sent << " hedged, "
+              << rs.hedges_won << " won by hedge, " << rs.failures << " failed)\n";
+
     if (operation == "roundtrip") {
         std::cout << "\nRoundtrip (upload + verify) complete.\n";
     }
@@ -0,0 +1,97 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "slp/file_writer.h"
+
+// Compare the model cache write paths: time to write, time until durable,
+// and how much of the file is left in the page cache afterwards.
+
+static size_t resident_bytes(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return 0;
+    off_t size = ::lseek(fd, 0, SEEK_END);
+    size_t resident = 0;
+    if (size > 0) {
+        void* p = ::mmap(nullptr, static_cast<size_t>(size), PROT_READ, MAP_SHARED, fd, 0);
+        if (p != MAP_FAILED) {
+            long page = ::sysconf(_SC_PAGESIZE);
+            size_t pages = (static_cast<size_t>(size) + static_cast<size_t>(page) - 1) / static_cast<size_t>(page);
+            std::vector<unsigned char> vec(pages);
+            if (::mincore(p, static_cast<size_t>(size), vec.data()) == 0) {
+                for (unsigned char v : vec) resident += (v & 1) ? static_cast<size_t>(page) : 0;
+            }
+            ::munmap(p, static_cast<size_t>(size));
+        }
+    }
+    ::close(fd);
+    return resident;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::cerr << "usage: slp_bench_write <path> <size_mb> [mode ...]\n";
+        std::cerr << "  mode: buffered | direct | uring | uring+direct, optionally :qd=<n>:buf=<KiB>\n";
+        std::cerr << "  Default modes: buffered direct uring:qd=4 uring+direct:qd=4 uring+direct:qd=16\n";
+        std::cerr << "  Point <path> at the cache filesystem (e.g. NVMe); the file is removed after each run.\n";
+        return 1;
+    }
+
+    std::string path = argv[1];
+    size_t size_bytes = std::stoul(argv[2]) * 1024 * 1024;
+    std::vector<std::string> modes;
+    for (int i = 3; i < argc; ++i) modes.push_back(argv[i]);
+    if (modes.empty()) {
+        modes = {"buffered", "direct", "uring:qd=4", "uring+direct:qd=4", "uring+direct:qd=16"};
+    }
+
+    // libcurl hands the body over in pieces of at most 16 KiB
+    constexpr size_t kPiece = 16 * 1024;
+    std::vector<uint8_t> piece(kPiece);
+    std::mt19937 gen(42);
+    for (auto& b : piece) b = static_cast<uint8_t>(gen());
+
+    std::cout << "Write path benchmark: " << size_bytes / (1024 * 1024) << " MB to " << path << "\n";
+    std::cout << std::left << std::setw(40) << "mode" << std::right << std::setw(12) << "write MB/s"
+              << std::setw(14) << "durable MB/s" << std::setw(14) << "cached MB" << "\n";
+
+    for (const auto& mode : modes) {
+        try {
+            auto opts = slp::parse_write_spec(mode);
+            ::unlink(path.c_str());
+
+            auto t0 = std::chrono::steady_clock::now();
+            auto writer = slp::open_file_writer(path, 0, opts);
+            std::string desc = writer->describe();
+            for (size_t done = 0; done < size_bytes; done += kPiece) {
+                writer->write(piece.data(), std::min(kPiece, size_bytes - done));
+            }
+            writer->finish();
+            auto t1 = std::chrono::steady_clock::now();
+
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd >= 0) {
+                ::fdatasync(fd);
+                ::close(fd);
+            }
+            auto t2 = std::chrono::steady_clock::now();
+            size_t cached = resident_bytes(path);
+
+            double mb = static_cast<double>(size_bytes) / (1024.0 * 1024.0);
+            std::cout << std::left << std::setw(40) << desc << std::right << std::fixed << std::setprecision(1)
+                      << std::setw(12) << mb / std::chrono::duration<double>(t1 - t0).count()
+                      << std::setw(14) << mb / std::chrono::duration<double>(t2 - t0).count()
+                      << std::setw(14) << static_cast<double>(cached) / (1024.0 * 1024.0) << "\n";
+        } catch (const std::exception& e) {
+            std::cerr << mode << ": " << e.what() << "\n";
+        }
+        ::unlink(path.c_str());
+    }
+    return 0;
+}
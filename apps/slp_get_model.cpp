@@ -1,47 +1,194 @@
-#include <fstream>
+#include <algorithm>
+#include <charconv>
+#include <csignal>
+#include <chrono>
+#include <iomanip>
 #include <iostream>
+#include <limits>
+#include <stdexcept>
 #include <vector>
 #include <filesystem>
 
-#include "slp/seaweed/filer.h"
-#include "slp/artifact/manifest.h"
-#include "slp/sha256.h"
+#include "slp/file_writer.h"
+#include "slp/seaweed/retry.h"
+#include "slp/artifact/registry.h"
+#include "slp/pipeline/model_store.h"
+#include "slp/pipeline/warmup.h"
 
-static void write_file(const std::string& path, const std::vector<uint8_t>& data) {
-    std::ofstream f(path, std::ios::binary);
-    if (!f) throw std::runtime_error("cannot create file");
-    f.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+static void print_request_stats() {
+    auto rs = slp::seaweed::request_stats();
+    if (rs.retries == 0 && rs.hedges_sent == 0) return;
+    std::cout << "Requests: " << rs.requests << " (" << rs.retries << " retries, "
+              << rs.hedges_sent << " hedged, " << rs.hedges_won << " won by hedge)\n";
+}
+
+// Unsigned decimal only: stoull would take "-1" and "4k"
+static uint64_t parse_count(const std::string& s) {
+    uint64_t v = 0;
+    auto [end, ec] = std::from_chars(s.data(), s.data() + s.size(), v);
+    if (ec == std::errc::result_out_of_range) throw std::out_of_range(s + " is out of range");
+    if (ec != std::errc() || end != s.data() + s.size()) throw std::invalid_argument("not a number: '" + s + "'");
+    return v;
 }
 
 int main(int argc, char** argv) {
-    if (argc != 4) {
-        std::cerr << "usage: slp_get_model <filer_url> <model_hash> <output_path>\n";
+    if (argc < 4) {
+        std::cerr << "usage: slp_get_model <filer_url> <model_hash|name[:tag]> <output_path> [--cache-dir=<dir>] [--write=<mode>]\n";
+        std::cerr << "                     [--warm[=readahead|fadvise|touch]] [--warm-threads=<n>] [--warm-limit-mb=<n>] [--lock]\n";
+        std::cerr << "  Names and hash prefixes are resolved through <dir>/registry\n";
+        std::cerr << "  Models are cached in <dir>/models and chunks in <dir>/chunks (default: "
+                  << slp::pipeline::default_cache_dir() << ");\n";
+        std::cerr << "  concurrent fetches of one model on a node share a single download\n";
+        std::cerr << "  --write=<mode>  buffered (default) | direct | uring | uring+direct,\n";
+        std::cerr << "                  optionally :qd=<n>:buf=<KiB>; direct keeps the download\n";
+        std::cerr << "                  out of the page cache\n";
+        std::cerr << "  --warm          load the model into the page cache before returning\n";
+        std::cerr << "                  (default method readahead) and report time-to-warm\n";
+        std::cerr << "  --warm-limit-mb bytes read in at most (default 80% of MemAvailable)\n";
+        std::cerr << "  --lock          also mlock the model and hold it until interrupted\n";
         return 1;
     }
 
     std::string filer = argv[1];
     std::string hash = argv[2];
     std::string output_path = argv[3];
+    std::string cache_dir = slp::pipeline::default_cache_dir();
+    slp::FileWriterOptions writer;
+    bool warm = false;
+    slp::pipeline::WarmupOptions warm_opts;
+    for (int i = 4; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--cache-dir=", 0) == 0) {
+            cache_dir = arg.substr(12);
+        } else if (arg.rfind("--write=", 0) == 0) {
+            try {
+                writer = slp::parse_write_spec(arg.substr(8));
+            } catch (const std::exception& e) {
+                std::cerr << e.what() << "\n";
+                return 1;
+            }
+        } else if (arg == "--warm" || arg.rfind("--warm=", 0) == 0) {
+            warm = true;
+            if (arg.size() > 7) {
+                try {
+                    warm_opts.method = slp::pipeline::parse_warm_method(arg.substr(7));
+                } catch (const std::exception& e) {
+                    std::cerr << e.what() << "\n";
+                    return 1;
+                }
+            }
+        } else if (arg.rfind("--warm-threads=", 0) == 0) {
+            try {
+                warm_opts.threads = std::max<size_t>(1, parse_count(arg.substr(15)));
+            } catch (const std::exception& e) {
+                std::cerr << "bad --warm-threads: " << e.what() << "\n";
+                return 1;
+            }
+        } else if (arg.rfind("--warm-limit-mb=", 0) == 0) {
+            try {
+                uint64_t mb = parse_count(arg.substr(16));
+                if (mb > (std::numeric_limits<uint64_t>::max() >> 20)) {
+                    throw std::out_of_range(arg.substr(16) + " MiB is out of range");
+                }
+                warm_opts.memory_limit = mb << 20;
+            } catch (const std::exception& e) {
+                std::cerr << "bad --warm-limit-mb: " << e.what() << "\n";
+                return 1;
+            }
+        } else if (arg == "--lock") {
+            warm = true;
+            warm_opts.lock = true;
+        } else {
+            std::cerr << "unknown option: " << arg << "\n";
+            return 1;
+        }
+    }
 
     try {
-        // Download model from SeaweedFS
-        std::string obj_path = "/models/" + hash + ".gguf";
-        std::cout << "Downloading model from " << obj_path << "...\n";
+        // Anything but a full hash is a registry reference
+        if (hash.size() != 64) {
+            slp::artifact::Registry reg(cache_dir + "/registry");
+            auto entry = reg.resolve(hash);
+            if (!entry) {
+                std::cerr << "Unknown model: " << hash << " (not in " << cache_dir << "/registry)\n";
+                return 1;
+            }
+            std::cout << "Resolved " << hash << " -> " << entry->sha256 << "\n";
+            hash = entry->sha256;
+        }
 
-        auto bytes = slp::seaweed::get_file(filer, obj_path);
+        // Fetches of the same model on this node share one download
+        std::cout << "Fetching model " << hash << " into " << cache_dir << "/models...\n";
+        auto t0 = std::chrono::steady_clock::now();
+        auto last_report = t0;
+        auto show_progress = [&](const slp::pipeline::FetchProgress& p) {
+            auto now = std::chrono::steady_clock::now();
+            if (now - last_report < std::chrono::seconds(1)) return;
+            last_report = now;
+            std::cerr << "  " << (p.waiting ? "waiting on pid " + std::to_string(p.owner_pid) + ": " : "")
+                      << p.done << "/" << p.total << " bytes";
+            if (p.total > 0) std::cerr << " (" << (100 * p.done / p.total) << "%)";
+            std::cerr << "\n";
+        };
+        auto cached = slp::pipeline::fetch_model_cached(filer, hash, cache_dir, writer, show_progress);
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
 
-        // Verify hash
-        auto computed_hash = slp::sha256_hex(bytes);
-        if (computed_hash != hash) {
-            std::cerr << "Hash mismatch! Expected: " << hash << ", Got: " << computed_hash << "\n";
-            return 1;
+        if (cached.chunked) {
+            std::cout << "Distinct chunks: " << cached.chunks.chunks_from_cache << " from cache, "
+                      << cached.chunks.chunks_downloaded << " downloaded (" << cached.chunks.bytes_downloaded
+                      << " bytes)\n";
+        } else if (cached.fetched) {
+            std::cout << "Fetched " << cached.download.bytes_fetched << " bytes in " << std::fixed
+                      << std::setprecision(2) << secs << " s via " << cached.download.writer << "\n";
+            if (cached.download.bytes_resumed > 0) {
+                std::cout << "Resumed at byte " << cached.download.bytes_resumed << " of "
+                          << cached.download.bytes_total << "\n";
+            }
+        }
+        if (!cached.fetched) {
+            std::cout << (cached.waited ? "Fetched by another process" : "Cache hit") << ": " << cached.path << "\n";
         }
 
-        // Write to local file
-        write_file(output_path, bytes);
+        // Never a hard link: writing to the output would change the cache
+        // entry that later hits trust without rehashing
+        bool reflinked = slp::pipeline::copy_from_cache(cached.path, output_path);
 
-        std::cout << "Downloaded model " << hash << " (" << bytes.size() << " bytes) to " << output_path << "\n";
+        std::cout << "Downloaded model " << hash << " (" << std::filesystem::file_size(output_path)
+                  << " bytes) to " << output_path << (reflinked ? " (reflink)" : "") << "\n";
         std::cout << "Hash verified: OK\n";
+        print_request_stats();
+
+        if (warm) {
+            // Warm the path the server will open; a copy is a different file
+            auto w = slp::pipeline::warm_page_cache(output_path, warm_opts);
+            constexpr double kMiB = 1024.0 * 1024.0;
+            std::cout << "Warmed " << std::fixed << std::setprecision(1)
+                      << static_cast<double>(w.target_bytes) / kMiB << " MiB via "
+                      << slp::pipeline::warm_method_name(warm_opts.method) << " in " << std::setprecision(2)
+                      << w.seconds << " s (" << std::setprecision(1)
+                      << static_cast<double>(w.bytes_read) / kMiB << " MiB read, "
+                      << static_cast<double>(w.resident_before) / kMiB << " MiB already cached)\n";
+            std::cout << "Resident: " << static_cast<double>(w.resident_after) / kMiB << " of "
+                      << static_cast<double>(w.file_bytes) / kMiB << " MiB\n";
+            if (w.limited_by_memory) {
+                std::cout << "Stopped at the memory bound; raise --warm-limit-mb to warm the rest\n";
+            }
+            if (!w.lock_error.empty()) std::cerr << "warning: not locked: " << w.lock_error << "\n";
+            if (w.pinned) {
+                // The lock lasts as long as this process keeps the mapping
+                sigset_t signals;
+                sigemptyset(&signals);
+                sigaddset(&signals, SIGINT);
+                sigaddset(&signals, SIGTERM);
+                sigprocmask(SIG_BLOCK, &signals, nullptr);
+                std::cout << "Locked " << static_cast<double>(w.locked_bytes) / kMiB
+                          << " MiB in memory; holding until SIGINT/SIGTERM\n"
+                          << std::flush;
+                int sig = 0;
+                sigwait(&signals, &sig);
+                std::cout << "Released\n";
+            }
+        }
 
         return 0;
     } catch (const std::exception& e) {
@@ -0,0 +1,127 @@
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <vector>
+
+#include "slp/artifact/gguf.h"
+#include "slp/pipeline/model_store.h"
+
+// Inspect a GGUF model without downloading its weights:
+// header and tensor table come from the manifest index or ranged reads.
+
+static slp::artifact::GgufHeader read_local_header(const std::string& path) {
+    std::ifstream f(path, std::ios::binary);
+    if (!f) throw std::runtime_error("cannot open file: " + path);
+
+    std::vector<uint8_t> prefix;
+    size_t probe = 1 << 20;
+    for (;;) {
+        prefix.resize(probe);
+        f.clear();
+        f.seekg(0);
+        f.read(reinterpret_cast<char*>(prefix.data()), static_cast<std::streamsize>(probe));
+        prefix.resize(static_cast<size_t>(f.gcount()));
+        try {
+            return slp::artifact::parse_gguf_header(prefix.data(), prefix.size());
+        } catch (const slp::artifact::GgufTruncated& e) {
+            if (prefix.size() < probe) throw std::runtime_error("file ends inside its GGUF header");
+            probe = std::max(static_cast<size_t>(e.needed), probe * 4);
+        }
+    }
+}
+
+static void print_summary(const slp::artifact::Manifest& m, bool list_tensors) {
+    std::cout << "GGUF version:   " << m.gguf_version << "\n";
+    std::cout << "Architecture:   " << m.gguf_architecture << "\n";
+    std::cout << "Header bytes:   " << m.gguf_header_bytes << "\n";
+    std::cout << "Tensors:        " << m.tensors.size() << "\n";
+
+    // Quantization mix: how many tensors and bytes per ggml type
+    std::map<std::string, std::pair<size_t, uint64_t>> by_type;
+    uint64_t total = 0;
+    for (const auto& t : m.tensors) {
+        by_type[t.type].first++;
+        by_type[t.type].second += t.size;
+        total += t.size;
+    }
+    std::cout << "\nQuant types:\n";
+    for (const auto& [type, entry] : by_type) {
+        double pct = total ? 100.0 * static_cast<double>(entry.second) / static_cast<double>(total) : 0.0;
+        std::cout << "  " << std::left << std::setw(8) << type << std::right
+                  << std::setw(6) << entry.first << " tensors "
+                  << std::setw(14) << entry.second << " bytes ("
+                  << std::fixed << std::setprecision(1) << pct << "%)\n";
+    }
+
+    if (list_tensors) {
+        std::cout << "\nTensor table:\n";
+        for (const auto& t : m.tensors) {
+            std::cout << "  " << std::left << std::setw(40) << t.name << std::right
+                      << std::setw(8) << t.type << "  [";
+            for (size_t d = 0; d < t.shape.size(); ++d) {
+                std::cout << (d ? ", " : "") << t.shape[d];
+            }
+            std::cout << "]  offset=" << t.offset << " size=" << t.size << "\n";
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "usage: slp_gguf_inspect <model.gguf> [--tensors]\n";
+        std::cerr << "       slp_gguf_inspect <filer_url> <model_hash> [--tensors] [--tensor=<name> --out=<path>]\n";
+        std::cerr << "  Reads only the GGUF header (or one tensor), never the whole model.\n";
+        return 1;
+    }
+
+    bool list_tensors = false;
+    std::string tensor_name;
+    std::string out_path;
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--tensors") list_tensors = true;
+        else if (arg.rfind("--tensor=", 0) == 0) tensor_name = arg.substr(9);
+        else if (arg.rfind("--out=", 0) == 0) out_path = arg.substr(6);
+        else positional.push_back(arg);
+    }
+
+    try {
+        auto t0 = std::chrono::steady_clock::now();
+        slp::artifact::Manifest m;
+
+        if (positional.size() == 1) {
+            slp::artifact::add_gguf_index(m, read_local_header(positional[0]));
+        } else if (positional.size() == 2) {
+            const std::string& filer = positional[0];
+            m = slp::pipeline::fetch_manifest(filer, positional[1]);
+            // Models uploaded before indexing: parse the header by range now
+            if (m.gguf_version == 0) {
+                slp::artifact::add_gguf_index(m, slp::pipeline::fetch_gguf_header(filer, m));
+            }
+
+            if (!tensor_name.empty()) {
+                if (out_path.empty()) throw std::runtime_error("--tensor needs --out=<path>");
+                auto bytes = slp::pipeline::fetch_tensor(filer, m, tensor_name);
+                std::ofstream f(out_path, std::ios::binary);
+                if (!f) throw std::runtime_error("cannot create file: " + out_path);
+                f.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+                std::cout << "Wrote tensor " << tensor_name << " (" << bytes.size() << " bytes) to " << out_path << "\n";
+            }
+        } else {
+            std::cerr << "expected <model.gguf> or <filer_url> <model_hash>\n";
+            return 1;
+        }
+
+        auto t1 = std::chrono::steady_clock::now();
+        print_summary(m, list_tensors);
+        std::cout << "\nElapsed:        " << std::fixed << std::setprecision(2)
+                  << std::chrono::duration<double, std::milli>(t1 - t0).count() << " ms\n";
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -6,15 +6,34 @@
 #include <algorithm>
 #include <chrono>
 #include <ctime>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <exception>
+#include <charconv>
+#include <stdexcept>
+#include <string_view>
 #include <curl/curl.h>
 
+#include "slp/alloc_count.h"
+#include "slp/llama/batch_journal.h"
+#include "slp/llama/batch_result.h"
+#include "slp/llama/endpoint_pool.h"
+#include "slp/llama/job_cost.h"
+#include "slp/pipeline/model_store.h"
+
 // Batch inference tool that:
 // 1. Processes prompts from JSONL file
-// 2. Calls llama-server for each prompt
+// 2. Calls llama-server for each prompt, spread over one or more replicas
 // 3. Saves results to output JSONL file (ready for SeaweedFS upload)
 
 namespace {
 
+using slp::llama::InferenceResult;
+using slp::llama::extract_json_field;
+
 size_t write_callback(void* contents, size_t size, size_t nmemb, void* userp) {
     size_t total_size = size * nmemb;
     auto* response = static_cast<std::string*>(userp);
@@ -22,190 +41,409 @@ size_t write_callback(void* contents, size_t size, size_t nmemb, void* userp) {
     return total_size;
 }
 
-std::string escape_json_string(const std::string& s) {
-    std::ostringstream oss;
-    for (char c : s) {
-        switch (c) {
-            case '"': oss << "\\\""; break;
-            case '\\': oss << "\\\\"; break;
-            case '\b': oss << "\\b"; break;
-            case '\f': oss << "\\f"; break;
-            case '\n': oss << "\\n"; break;
-            case '\r': oss << "\\r"; break;
-            case '\t': oss << "\\t"; break;
-            default:
-                if (c < 32) {
-                    oss << "\\u" << std::hex << std::setfill('0') << std::setw(4) << static_cast<int>(c);
-                } else {
-                    oss << c;
-                }
-        }
-    }
-    return oss.str();
+// Local time as YYYY-MM-DDTHH:MM:SS, formatted into `buf`
+std::string_view format_iso_timestamp(char (&buf)[32]) {
+    auto time_t_now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+    std::tm tm_now;
+    localtime_r(&time_t_now, &tm_now);
+    return {buf, std::strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%S", &tm_now)};
 }
 
-std::string extract_json_field(const std::string& json, const std::string& field) {
-    std::string search = "\"" + field + "\":";
-    size_t pos = json.find(search);
-    if (pos == std::string::npos) return "";
+std::string get_iso_timestamp() {
+    char buf[32];
+    return std::string(format_iso_timestamp(buf));
+}
 
-    pos += search.length();
-    while (pos < json.length() && std::isspace(static_cast<unsigned char>(json[pos]))) pos++;
+// One worker's connection to llama-server. The CURL handle (and with it the
+// keep-alive connection), the header list, the request and response bodies
+// and the result are reused for every prompt; the strings only ever grow,
+// so once they have held the largest prompt and reply, call() stops
+// allocating.
+class LlamaCaller {
+public:
+    LlamaCaller() : curl_(curl_easy_init()) {
+        if (!curl_) throw std::runtime_error("Failed to initialize CURL");
+        headers_ = curl_slist_append(nullptr, "Content-Type: application/json");
+        curl_easy_setopt(curl_, CURLOPT_HTTPHEADER, headers_);
+        curl_easy_setopt(curl_, CURLOPT_WRITEFUNCTION, write_callback);
+        curl_easy_setopt(curl_, CURLOPT_WRITEDATA, &response_);
+        curl_easy_setopt(curl_, CURLOPT_TIMEOUT, 120L);
+        body_.reserve(4096);
+        response_.reserve(16384);
+        result_.prompt.reserve(2048);
+        result_.content.reserve(4096);
+        result_.id.reserve(32);
+    }
 
-    if (pos >= json.length()) return "";
+    ~LlamaCaller() {
+        curl_slist_free_all(headers_);
+        curl_easy_cleanup(curl_);
+    }
 
-    if (json[pos] == '"') {
-        size_t start = pos + 1;
-        size_t end = start;
-        while (end < json.length() && json[end] != '"') {
-            if (json[end] == '\\' && end + 1 < json.length()) end += 2;
-            else end++;
+    LlamaCaller(const LlamaCaller&) = delete;
+    LlamaCaller& operator=(const LlamaCaller&) = delete;
+
+    // POST to `endpoint` (a .../completion URL). The result stays valid
+    // until the next call.
+    InferenceResult& call(const std::string& endpoint, const std::string& prompt, int max_tokens) {
+        reset(prompt, max_tokens);
+
+        char num[16];
+        body_.assign("{\n  \"prompt\": \"");
+        slp::llama::append_json_escaped(body_, prompt);
+        body_ += "\",\n  \"n_predict\": ";
+        body_.append(num, static_cast<size_t>(std::to_chars(num, num + sizeof(num), max_tokens).ptr - num));
+        body_ += ",\n  \"stream\": false\n}";
+
+        // libcurl copies the URL, so only hand it over when the backend changes
+        if (endpoint_ != &endpoint) {
+            curl_easy_setopt(curl_, CURLOPT_URL, endpoint.c_str());
+            endpoint_ = &endpoint;
         }
-        return json.substr(start, end - start);
-    }
+        curl_easy_setopt(curl_, CURLOPT_POSTFIELDS, body_.data());
+        curl_easy_setopt(curl_, CURLOPT_POSTFIELDSIZE, static_cast<long>(body_.size()));
+        response_.clear();
 
-    size_t start = pos;
-    while (pos < json.length() && (std::isalnum(static_cast<unsigned char>(json[pos])) || json[pos] == '.' || json[pos] == '-')) {
-        pos++;
+        auto t0 = std::chrono::steady_clock::now();
+        CURLcode res = curl_easy_perform(curl_);
+        auto t1 = std::chrono::steady_clock::now();
+
+        result_.elapsed_us = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count();
+
+        if (res != CURLE_OK) {
+            result_.error.assign("CURL error: ").append(curl_easy_strerror(res));
+            return result_;
+        }
+
+        curl_off_t ttfb = 0;
+        if (curl_easy_getinfo(curl_, CURLINFO_STARTTRANSFER_TIME_T, &ttfb) == CURLE_OK) {
+            result_.ttfb_us = static_cast<int64_t>(ttfb);
+        }
+        result_.timings = slp::llama::parse_server_timings(response_);
+
+        std::string_view content = slp::llama::find_json_field(response_, "content");
+        if (content.empty()) content = slp::llama::find_json_field(response_, "response");
+        if (content.empty()) content = slp::llama::find_json_field(response_, "completion");
+        if (content.empty()) content = slp::llama::find_json_field(response_, "text");
+
+        if (!content.empty()) {
+            result_.content.assign(content);
+            result_.success = true;
+        } else {
+            result_.error.assign("Could not parse response");
+            result_.content.assign(response_, 0, 500);
+        }
+
+        return result_;
     }
-    return json.substr(start, pos - start);
-}
 
-std::string get_iso_timestamp() {
-    auto now = std::chrono::system_clock::now();
-    auto time_t_now = std::chrono::system_clock::to_time_t(now);
-    std::tm tm_now;
-    localtime_r(&time_t_now, &tm_now);
+    // A failed result for a prompt that is not sent, with `error` as the reason
+    InferenceResult& skip(const std::string& prompt, int max_tokens, const char* error) {
+        reset(prompt, max_tokens);
+        result_.elapsed_us = 0;
+        result_.error.assign(error);
+        return result_;
+    }
 
-    std::ostringstream oss;
-    oss << std::put_time(&tm_now, "%Y-%m-%dT%H:%M:%S");
-    return oss.str();
-}
+private:
+    void reset(const std::string& prompt, int max_tokens) {
+        result_.id.clear();
+        result_.prompt.assign(prompt);
+        result_.max_tokens = max_tokens;
+        result_.success = false;
+        result_.content.clear();
+        result_.error.clear();
+        result_.ttfb_us = 0;
+        result_.timings = {};
+        result_.priority = 0;
+        result_.deadline_ms = -1;
+        result_.deadline_missed = false;
+        char ts[32];
+        result_.timestamp.assign(format_iso_timestamp(ts));
+    }
 
-struct InferenceResult {
-    std::string prompt;
-    std::string content;
-    int max_tokens;
-    int64_t elapsed_us;
-    bool success;
-    std::string error;
-    std::string timestamp;
+    CURL* curl_;
+    curl_slist* headers_ = nullptr;
+    const std::string* endpoint_ = nullptr;
+    std::string body_;
+    std::string response_;
+    InferenceResult result_;
 };
 
-InferenceResult call_llama_server(const std::string& url,
-                                   const std::string& prompt,
-                                   int max_tokens) {
-    InferenceResult result;
-    result.prompt = prompt;
-    result.max_tokens = max_tokens;
-    result.success = false;
-    result.timestamp = get_iso_timestamp();
-
-    CURL* curl = curl_easy_init();
-    if (!curl) {
-        result.error = "Failed to initialize CURL";
-        return result;
+void print_backend_stats(const slp::llama::EndpointPool& pool) {
+    std::cout << "\nPer-Backend Statistics:\n";
+    for (const auto& st : pool.stats()) {
+        std::cout << "  " << st.url << (st.healthy ? "" : " [ejected]") << "\n";
+        std::cout << "    Requests: " << st.requests << "  Failures: " << st.failures
+                  << "  Ejections: " << st.ejections << "\n";
+        std::cout << "    Mean: " << std::fixed << std::setprecision(2) << st.mean_ms << " ms"
+                  << "  P50: " << st.p50_ms << " ms"
+                  << "  P95: " << st.p95_ms << " ms"
+                  << "  P99: " << st.p99_ms << " ms\n";
     }
+}
 
-    std::ostringstream json_body;
-    json_body << "{\n";
-    json_body << "  \"prompt\": \"" << escape_json_string(prompt) << "\",\n";
-    json_body << "  \"n_predict\": " << max_tokens << ",\n";
-    json_body << "  \"stream\": false\n";
-    json_body << "}";
-
-    std::string request_body = json_body.str();
-    std::string response_body;
-    std::string endpoint = url + "/completion";
+// Where the time went, from the timings llama-server reports per request
+void print_throughput(const slp::llama::ThroughputStats& t, double batch_secs) {
+    if (t.requests() == 0) return;
+    std::cout << "\nToken Throughput:\n";
+    if (batch_secs > 0) {
+        std::cout << "  Requests/s:      " << std::fixed << std::setprecision(2)
+                  << static_cast<double>(t.requests()) / batch_secs << "\n";
+    }
+    if (t.requests_with_timings() == 0) {
+        std::cout << "  (the server reported no timings)\n";
+        return;
+    }
+    double wall = t.mean_wall_ms();
+    auto share = [&](double ms) { return wall > 0 ? 100.0 * ms / wall : 0.0; };
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "  Prompt tokens:   " << t.prompt_tokens() << " (" << t.prefill_tokens_per_sec()
+              << " tok/s prefill per request)\n";
+    std::cout << "  Output tokens:   " << t.predicted_tokens() << " (" << t.decode_tokens_per_sec()
+              << " tok/s decode per request)\n";
+    if (batch_secs > 0) {
+        std::cout << "  Batch output:    " << static_cast<double>(t.predicted_tokens()) / batch_secs
+                  << " tok/s over " << batch_secs << " s\n";
+    }
+    std::cout << "  Mean wall:       " << wall << " ms\n";
+    std::cout << "    Server:        " << t.mean_server_ms() << " ms (" << std::setprecision(1)
+              << share(t.mean_server_ms()) << "%)\n";
+    std::cout << std::setprecision(2) << "    Queueing:      " << t.mean_queue_ms() << " ms ("
+              << std::setprecision(1) << share(t.mean_queue_ms()) << "%)\n";
+    std::cout << std::setprecision(2) << "    Client:        " << t.mean_client_ms() << " ms ("
+              << std::setprecision(1) << share(t.mean_client_ms()) << "%)\n";
+    std::cout << std::setprecision(2) << "  Overhead:        " << t.mean_overhead_ms()
+              << " ms per request (wall minus server)\n";
+    std::cout << "  Bound:           " << t.bound() << "\n";
+    if (t.requests_with_timings() < t.requests()) {
+        std::cout << "  (" << t.requests() - t.requests_with_timings() << " requests without timings)\n";
+    }
+}
 
-    curl_easy_setopt(curl, CURLOPT_URL, endpoint.c_str());
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, request_body.c_str());
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response_body);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 120L);
+struct PromptSpec {
+    int prompt_num;
+    std::string prompt;
+    int max_tokens;
+    int priority = 0;          // higher is dispatched first
+    int64_t deadline_ms = -1;  // after the batch starts; -1 for none
+    double cost = 0.0;         // estimated, for shortest-job-first
+    slp::llama::PromptId id;
+    std::string id_text;
+};
 
-    struct curl_slist* headers = nullptr;
-    headers = curl_slist_append(headers, "Content-Type: application/json");
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+// What to do with a prompt whose deadline passed before a worker got to it
+enum class LatePolicy {
+    drop,  // write a failed result without sending it
+    run,   // send it anyway; the result is flagged as missed
+};
 
-    auto t0 = std::chrono::steady_clock::now();
-    CURLcode res = curl_easy_perform(curl);
-    auto t1 = std::chrono::steady_clock::now();
+struct BatchOptions {
+    size_t concurrency = 0;  // 0: one per replica
+    LatePolicy late = LatePolicy::drop;
+    // Within a priority and deadline, send the cheapest prompts first:
+    // short ones stop waiting behind long ones, which lowers mean latency
+    bool shortest_first = false;
+    bool server_tokens = true;  // count prompt tokens with /tokenize
+    // Continue the run recorded in the output's journal, skipping prompts
+    // it finished
+    bool resume = false;
+};
 
-    result.elapsed_us = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count();
+// Higher priority first, then earliest deadline (prompts without one last),
+// then lowest cost if `shortest_first`, then input order. Deadlines are
+// fixed offsets from the batch start, so sorting once gives the order an
+// earliest-deadline-first queue would.
+std::vector<size_t> dispatch_order(const std::vector<PromptSpec>& prompts, bool shortest_first) {
+    std::vector<size_t> order(prompts.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    auto deadline = [](const PromptSpec& p) { return p.deadline_ms < 0 ? INT64_MAX : p.deadline_ms; };
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        const PromptSpec& pa = prompts[a];
+        const PromptSpec& pb = prompts[b];
+        if (pa.priority != pb.priority) return pa.priority > pb.priority;
+        if (deadline(pa) != deadline(pb)) return deadline(pa) < deadline(pb);
+        return shortest_first && pa.cost < pb.cost;
+    });
+    return order;
+}
 
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
+// Outcomes for one priority level
+struct LevelStats {
+    uint64_t prompts = 0;
+    uint64_t with_deadline = 0;
+    uint64_t missed = 0;   // finished late, failed, or dropped
+    uint64_t dropped = 0;  // deadline passed before dispatch
+    std::vector<int64_t> finished_us;  // since the batch started
+};
 
-    if (res != CURLE_OK) {
-        result.error = std::string("CURL error: ") + curl_easy_strerror(res);
-        return result;
+// Time from the batch start until each prompt's result was in: what a
+// prompt waited for its turn plus its own request
+void print_completion(std::map<int, LevelStats, std::greater<>>& levels) {
+    std::vector<int64_t> all;
+    for (const auto& [priority, l] : levels) all.insert(all.end(), l.finished_us.begin(), l.finished_us.end());
+    if (all.empty()) return;
+    std::sort(all.begin(), all.end());
+    int64_t total = 0;
+    for (auto t : all) total += t;
+    auto pct = [&](double q) { return static_cast<double>(all[static_cast<size_t>(static_cast<double>(all.size() - 1) * q)]) / 1000.0; };
+    std::cout << "\nCompletion Time (from batch start):\n";
+    std::cout << "  Mean:            " << std::fixed << std::setprecision(2)
+              << static_cast<double>(total) / static_cast<double>(all.size()) / 1000.0 << " ms\n";
+    std::cout << "  P50:             " << pct(0.5) << " ms\n";
+    std::cout << "  P99:             " << pct(0.99) << " ms\n";
+
+    bool any_deadline = false;
+    for (const auto& [priority, l] : levels) any_deadline |= l.with_deadline > 0;
+    if (levels.size() < 2 && !any_deadline) return;
+
+    std::cout << "\nPriorities and Deadlines:\n";
+    for (auto& [priority, l] : levels) {
+        auto& t = l.finished_us;
+        std::sort(t.begin(), t.end());
+        auto at = [&](double q) { return static_cast<double>(t[static_cast<size_t>(static_cast<double>(t.size() - 1) * q)]) / 1000.0; };
+        std::cout << "  Priority " << priority << ": " << l.prompts << " prompts, finished by P50 "
+                  << std::fixed << std::setprecision(2) << at(0.5) << " ms, P95 " << at(0.95) << " ms\n";
+        if (l.with_deadline > 0) {
+            std::cout << "    Deadlines: " << l.with_deadline << "  Missed: " << l.missed << " ("
+                      << std::setprecision(1)
+                      << 100.0 * static_cast<double>(l.missed) / static_cast<double>(l.with_deadline)
+                      << "%)  Dropped: " << l.dropped << "\n";
+        }
     }
+}
 
-    result.content = extract_json_field(response_body, "content");
-    if (result.content.empty()) result.content = extract_json_field(response_body, "response");
-    if (result.content.empty()) result.content = extract_json_field(response_body, "completion");
-    if (result.content.empty()) result.content = extract_json_field(response_body, "text");
+// Writes results in dispatch order (input order unless prompts are
+// reordered) even though workers finish out of order, and journals each
+// line once it is flushed. Lines that arrive early wait in slots whose
+// buffers are reused, so once there are as many slots as results ever wait
+// at once, submit() does not allocate. Dispatch order keeps that wait
+// short, so a crash loses little more than the prompts in flight.
+class OrderedWriter {
+public:
+    // `slots` is how many early results to make room for up front; `out`
+    // already holds `offset` bytes the journal covers
+    OrderedWriter(std::ofstream& out, slp::llama::BatchJournal& journal, uint64_t offset, size_t slots)
+        : out_(out), journal_(journal), offset_(offset), slots_(slots) {
+        for (auto& slot : slots_) slot.line.reserve(8192);
+        flushed_.reserve(slots + 1);
+    }
 
-    if (!result.content.empty()) {
-        result.success = true;
-    } else {
-        result.error = "Could not parse response";
-        result.content = response_body.substr(0, 500);
+    void submit(size_t seq, std::string_view line, const slp::llama::PromptId& id, bool success) {
+        std::lock_guard<std::mutex> lock(mu_);
+        if (seq != next_) {
+            park(seq, line, id, success);
+            return;
+        }
+        write(line, id, success);
+        for (bool found = true; found;) {
+            found = false;
+            for (auto& slot : slots_) {
+                if (slot.used && slot.seq == next_) {
+                    write(slot.line, slot.id, slot.success);
+                    slot.used = false;
+                    found = true;
+                }
+            }
+        }
+        out_.flush();
+        if (!out_) throw std::runtime_error("failed to write results");
+        for (const auto& f : flushed_) journal_.record(f.id, f.success, f.end);
+        flushed_.clear();
     }
 
-    return result;
-}
+private:
+    struct Slot {
+        size_t seq = 0;
+        bool used = false;
+        slp::llama::PromptId id;
+        bool success = false;
+        std::string line;
+    };
+
+    struct Flushed {
+        slp::llama::PromptId id;
+        bool success;
+        uint64_t end;  // results file length after the line
+    };
+
+    void write(std::string_view line, const slp::llama::PromptId& id, bool success) {
+        out_.write(line.data(), static_cast<std::streamsize>(line.size()));
+        out_.put('\n');
+        offset_ += line.size() + 1;
+        flushed_.push_back({id, success, offset_});
+        next_++;
+    }
 
-std::string result_to_json(const InferenceResult& r) {
-    std::ostringstream oss;
-    oss << "{";
-    oss << "\"timestamp\":\"" << r.timestamp << "\",";
-    oss << "\"prompt\":\"" << escape_json_string(r.prompt) << "\",";
-    oss << "\"max_tokens\":" << r.max_tokens << ",";
-    oss << "\"success\":" << (r.success ? "true" : "false") << ",";
-    oss << "\"elapsed_ms\":" << std::fixed << std::setprecision(2) << (r.elapsed_us / 1000.0) << ",";
-
-    if (r.success) {
-        oss << "\"response\":\"" << escape_json_string(r.content) << "\"";
-    } else {
-        oss << "\"error\":\"" << escape_json_string(r.error) << "\"";
+    void park(size_t seq, std::string_view line, const slp::llama::PromptId& id, bool success) {
+        for (auto& slot : slots_) {
+            if (!slot.used) {
+                slot.seq = seq;
+                slot.used = true;
+                slot.id = id;
+                slot.success = success;
+                slot.line.assign(line);
+                return;
+            }
+        }
+        slots_.push_back({seq, true, id, success, std::string(line)});
     }
 
-    oss << "}";
-    return oss.str();
-}
+    std::ofstream& out_;
+    slp::llama::BatchJournal& journal_;
+    uint64_t offset_;
+    std::mutex mu_;
+    std::vector<Slot> slots_;
+    std::vector<Flushed> flushed_;
+    size_t next_ = 0;
+};
+
+// Prompts each worker runs before its allocations are counted: long
+// enough for the reusable buffers and the connection to be set up
+constexpr uint64_t kWarmupPrompts = 3;
 
-void process_batch(const std::string& llama_url,
+void process_batch(const std::string& llama_urls,
                    const std::string& prompts_file,
-                   const std::string& output_file) {
+                   const std::string& output_file,
+                   BatchOptions opts) {
     std::ifstream file(prompts_file);
     if (!file) {
         std::cerr << "Error: Cannot open prompts file: " << prompts_file << "\n";
         return;
     }
 
-    std::ofstream outfile(output_file);
+    // Empties the output, or with --resume trims it back to what the
+    // journal covers, before it is appended to
+    slp::llama::BatchJournal journal(output_file, opts.resume);
+    std::ofstream outfile(output_file, std::ios::app);
     if (!outfile) {
         std::cerr << "Error: Cannot create output file: " << output_file << "\n";
         return;
     }
 
+    slp::llama::EndpointPool pool(slp::llama::parse_endpoint_list(llama_urls));
+    size_t concurrency = opts.concurrency ? opts.concurrency : pool.size();
+
     std::cout << "\n╔════════════════════════════════════════════════════════════════╗\n";
     std::cout << "║         Batch Inference - cuda-llm-storage-pipeline          ║\n";
     std::cout << "╚════════════════════════════════════════════════════════════════╝\n\n";
-    std::cout << "LLaMA Server:  " << llama_url << "\n";
+    for (size_t i = 0; i < pool.size(); ++i) {
+        std::cout << (i == 0 ? "LLaMA Server:  " : "               ") << pool.url(i) << "\n";
+    }
     std::cout << "Input:         " << prompts_file << "\n";
     std::cout << "Output:        " << output_file << "\n";
+    std::cout << "Concurrency:   " << concurrency << "\n";
+    std::cout << "Order:         " << (opts.shortest_first ? "shortest first" : "input") << "\n";
     std::cout << "Started:       " << get_iso_timestamp() << "\n\n";
 
     int prompt_num = 0;
-    int success_count = 0;
-    int failure_count = 0;
+    uint32_t line_no = 0;
+    size_t already_done = 0;
     std::string line;
-    std::vector<int64_t> latencies;
+    std::vector<PromptSpec> prompts;
 
     while (std::getline(file, line)) {
+        line_no++;
         if (line.empty() || line[0] == '#') continue;
 
         prompt_num++;
@@ -229,39 +467,193 @@ void process_batch(const std::string& llama_url,
             max_tokens = std::stoi(extract_json_field(line, "max_tokens"));
         }
 
+        int priority = 0;
+        if (line.find("\"priority\":") != std::string::npos) {
+            priority = std::stoi(extract_json_field(line, "priority"));
+        }
+        int64_t deadline_ms = -1;
+        if (line.find("\"deadline_ms\":") != std::string::npos) {
+            deadline_ms = std::stoll(extract_json_field(line, "deadline_ms"));
+            if (deadline_ms < 0) throw std::invalid_argument("negative deadline_ms on line " + std::to_string(prompt_num));
+        }
+
         if (prompt_text.empty()) {
             std::cerr << "Warning: Could not parse prompt from line: " << line << "\n";
             continue;
         }
 
-        std::cout << "[" << prompt_num << "] Processing: \"" << prompt_text.substr(0, 50)
-                  << (prompt_text.length() > 50 ? "..." : "") << "\" ... " << std::flush;
+        auto id = slp::llama::make_prompt_id(line, line_no);
+        if (journal.succeeded(id)) {
+            already_done++;
+            continue;
+        }
+        prompts.push_back({prompt_num, prompt_text, max_tokens, priority, deadline_ms, 0.0, id, id.str()});
+    }
+    file.close();
 
-        auto result = call_llama_server(llama_url, prompt_text, max_tokens);
+    if (opts.resume) {
+        std::cout << "Resumed:       " << already_done << " prompts already done, " << prompts.size()
+                  << " to run" << (journal.rebuilt() ? " (journal rebuilt from the output)" : "") << "\n\n";
+    }
 
-        // Write result to output file
-        outfile << result_to_json(result) << "\n";
-        outfile.flush();
+    if (opts.shortest_first) {
+        std::vector<std::string> texts;
+        texts.reserve(prompts.size());
+        for (const auto& p : prompts) texts.push_back(p.prompt);
+        slp::llama::TokenCountCache cache(slp::pipeline::default_cache_dir() + "/token_counts.tsv");
+        slp::llama::TokenCountReport report;
+        auto tokens = slp::llama::count_prompt_tokens(texts, opts.server_tokens ? pool.url(0) : std::string(),
+                                                      cache, concurrency, &report);
+        for (size_t i = 0; i < prompts.size(); ++i) {
+            prompts[i].cost = slp::llama::job_cost(tokens[i], prompts[i].max_tokens);
+        }
+        std::cout << "Prompt tokens: " << report.cached << " cached, " << report.tokenized << " from /tokenize, "
+                  << report.estimated << " estimated (" << std::fixed << std::setprecision(1)
+                  << report.seconds * 1000.0 << " ms)\n\n";
+    }
 
-        if (result.success) {
-            success_count++;
-            latencies.push_back(result.elapsed_us);
-            std::cout << "✓ (" << (result.elapsed_us / 1000.0) << " ms)\n";
-        } else {
-            failure_count++;
-            std::cout << "✗ (" << result.error << ")\n";
+    OrderedWriter writer(outfile, journal, journal.results_bytes(), 2 * concurrency);
+    std::mutex stats_mu;
+    int success_count = 0;
+    int failure_count = 0;
+    int dropped_count = 0;
+    std::vector<int64_t> latencies;
+    std::vector<size_t> order = dispatch_order(prompts, opts.shortest_first);
+    std::atomic<size_t> next{0};
+    // The first exception in any worker stops the others; it is rethrown
+    // once they have all finished their current prompt
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;
+
+    // One entry per priority level up front, so workers only look them up
+    std::map<int, LevelStats, std::greater<>> levels;
+    for (const auto& p : prompts) levels[p.priority].prompts++;
+    for (auto& [priority, l] : levels) {
+        l.finished_us.reserve(l.prompts);
+        l.prompts = 0;
+    }
+
+    uint64_t steady_prompts = 0;
+    uint64_t steady_allocations = 0;
+    uint64_t steady_curl_allocations = 0;
+    slp::llama::ThroughputStats throughput;
+    latencies.reserve(prompts.size());
+    pool.reserve(prompts.size());
+
+    std::vector<std::string> endpoints;
+    for (size_t i = 0; i < pool.size(); ++i) endpoints.push_back(pool.url(i) + "/completion");
+
+    auto batch_start = std::chrono::steady_clock::now();
+    auto worker = [&]() {
+        LlamaCaller caller;
+        std::string out_line;
+        out_line.reserve(8192);
+        uint64_t done = 0;
+        uint64_t counted = 0;
+        uint64_t allocations = 0;
+        uint64_t curl_allocations = 0;
+
+        for (size_t k = next++; k < order.size() && !failed; k = next++, done++) {
+            size_t i = order[k];
+            const PromptSpec& p = prompts[i];
+            uint64_t allocs_before = slp::thread_allocations();
+            uint64_t curl_before = slp::thread_curl_allocations();
+            auto picked = std::chrono::steady_clock::now();
+            auto deadline = batch_start + std::chrono::milliseconds(p.deadline_ms);
+            bool drop = opts.late == LatePolicy::drop && p.deadline_ms >= 0 && picked > deadline;
+
+            size_t backend = drop ? 0 : pool.acquire();
+            InferenceResult& result = drop ? caller.skip(p.prompt, p.max_tokens, "deadline passed before dispatch")
+                                           : caller.call(endpoints[backend], p.prompt, p.max_tokens);
+            if (!drop) pool.release(backend, result.success, result.elapsed_us);
+            auto finished = std::chrono::steady_clock::now();
+            result.priority = p.priority;
+            result.deadline_ms = p.deadline_ms;
+            result.deadline_missed = p.deadline_ms >= 0 && (!result.success || finished > deadline);
+
+            // Write result to output file
+            result.id.assign(p.id_text);
+            out_line.clear();
+            slp::llama::append_result_json(out_line, result);
+            writer.submit(k, out_line, p.id, result.success);
+            auto written = std::chrono::steady_clock::now();
+
+            {
+                std::lock_guard<std::mutex> lock(stats_mu);
+                if (result.success) {
+                    // Wall time runs from picking the prompt to its result being
+                    // written, so waiting for a backend counts as client time
+                    throughput.add(result.timings,
+                                   std::chrono::duration_cast<std::chrono::microseconds>(written - picked).count(),
+                                   result.ttfb_us);
+                }
+                LevelStats& level = levels.find(p.priority)->second;
+                level.prompts++;
+                level.finished_us.push_back(
+                    std::chrono::duration_cast<std::chrono::microseconds>(finished - batch_start).count());
+                if (p.deadline_ms >= 0) {
+                    level.with_deadline++;
+                    if (result.deadline_missed) level.missed++;
+                    if (drop) level.dropped++;
+                }
+
+                std::cout << "[" << p.prompt_num << "] ";
+                if (!drop) std::cout << pool.url(backend) << " ";
+                std::cout << "\"" << std::string_view(p.prompt).substr(0, 50) << (p.prompt.length() > 50 ? "..." : "")
+                          << "\" ... ";
+                if (result.success) {
+                    success_count++;
+                    latencies.push_back(result.elapsed_us);
+                    std::cout << "✓ (" << (static_cast<double>(result.elapsed_us) / 1000.0) << " ms)\n";
+                } else {
+                    (drop ? dropped_count : failure_count)++;
+                    std::cout << "✗ (" << result.error << ")\n";
+                }
+            }
+
+            if (done >= kWarmupPrompts) {
+                counted++;
+                allocations += slp::thread_allocations() - allocs_before;
+                curl_allocations += slp::thread_curl_allocations() - curl_before;
+            }
         }
+
+        std::lock_guard<std::mutex> lock(stats_mu);
+        steady_prompts += counted;
+        steady_allocations += allocations;
+        steady_curl_allocations += curl_allocations;
+    };
+
+    auto guarded = [&]() {
+        try {
+            worker();
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(stats_mu);
+            if (!error) error = std::current_exception();
+            failed = true;
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < std::min(concurrency, prompts.size()); ++t) {
+        workers.emplace_back(guarded);
     }
+    for (auto& t : workers) t.join();
+    // Results written before the failure are journaled, so --resume
+    // picks up from there
+    if (error) std::rethrow_exception(error);
+    double batch_secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - batch_start).count();
 
-    file.close();
     outfile.close();
 
     std::cout << "\n╔════════════════════════════════════════════════════════════════╗\n";
     std::cout << "║                      Batch Complete                           ║\n";
     std::cout << "╚════════════════════════════════════════════════════════════════╝\n\n";
-    std::cout << "Total prompts:     " << prompt_num << "\n";
+    if (already_done > 0) std::cout << "Already done:      " << already_done << "\n";
+    std::cout << "Total prompts:     " << prompts.size() << "\n";
     std::cout << "Successful:        " << success_count << "\n";
     std::cout << "Failed:            " << failure_count << "\n";
+    if (dropped_count > 0) std::cout << "Dropped (late):    " << dropped_count << "\n";
 
     if (!latencies.empty()) {
         std::sort(latencies.begin(), latencies.end());
@@ -280,6 +672,21 @@ void process_batch(const std::string& llama_url,
         std::cout << "  P99:             " << p99_ms << " ms\n";
     }
 
+    print_throughput(throughput, batch_secs);
+    print_completion(levels);
+
+    if (steady_prompts > 0) {
+        auto per_prompt = [&](uint64_t n) { return static_cast<double>(n) / static_cast<double>(steady_prompts); };
+        std::cout << "\nHeap Allocations (after " << kWarmupPrompts << " warm-up prompts per worker):\n";
+        std::cout << "  Prompts:         " << steady_prompts << "\n";
+        std::cout << "  Client:          " << steady_allocations << " (" << per_prompt(steady_allocations)
+                  << " per prompt)\n";
+        std::cout << "  libcurl:         " << steady_curl_allocations << " ("
+                  << per_prompt(steady_curl_allocations) << " per prompt)\n";
+    }
+
+    print_backend_stats(pool);
+
     std::cout << "\nResults saved to:  " << output_file << "\n";
     std::cout << "Next step:         Upload to SeaweedFS with slp_put_prompts\n\n";
 }
@@ -287,14 +694,48 @@ void process_batch(const std::string& llama_url,
 } // anonymous namespace
 
 int main(int argc, char** argv) {
-    if (argc != 4) {
-        std::cerr << "usage: slp_llama_batch <llama_url> <prompts.jsonl> <output.jsonl>\n";
+    std::vector<std::string> positional;
+    BatchOptions opts;
+    bool bad_option = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--late=drop") opts.late = LatePolicy::drop;
+        else if (arg == "--late=run") opts.late = LatePolicy::run;
+        else if (arg == "--order=input") opts.shortest_first = false;
+        else if (arg == "--order=sjf") opts.shortest_first = true;
+        else if (arg == "--tokens=server") opts.server_tokens = true;
+        else if (arg == "--tokens=local") opts.server_tokens = false;
+        else if (arg == "--resume") opts.resume = true;
+        else if (arg.rfind("--", 0) == 0) bad_option = true;
+        else positional.push_back(arg);
+    }
+
+    if (bad_option || (positional.size() != 3 && positional.size() != 4)) {
+        std::cerr << "usage: slp_llama_batch <llama_url[,llama_url...]> <prompts.jsonl> <output.jsonl> [concurrency]\n";
+        std::cerr << "                       [--late=drop|run] [--order=input|sjf] [--tokens=server|local]\n";
+        std::cerr << "                       [--resume]\n";
         std::cerr << "\n";
         std::cerr << "Example:\n";
         std::cerr << "  slp_llama_batch http://127.0.0.1:9080 prompts.jsonl results.jsonl\n";
+        std::cerr << "  slp_llama_batch http://127.0.0.1:9080,http://127.0.0.1:9081 prompts.jsonl results.jsonl 8\n";
+        std::cerr << "\n";
+        std::cerr << "  Requests go to the healthy replica with the fewest requests in flight.\n";
+        std::cerr << "  concurrency defaults to the number of replicas.\n";
         std::cerr << "\n";
         std::cerr << "Input format (JSONL):\n";
         std::cerr << "  {\"prompt\": \"What is AI?\", \"max_tokens\": 50}\n";
+        std::cerr << "  {\"prompt\": \"Urgent\", \"max_tokens\": 50, \"priority\": 10, \"deadline_ms\": 2000}\n";
+        std::cerr << "\n";
+        std::cerr << "  Higher priority runs first, then the earliest deadline (ms after the batch\n";
+        std::cerr << "  starts). A prompt still waiting at its deadline is dropped (--late=drop) or\n";
+        std::cerr << "  sent anyway and flagged (--late=run).\n";
+        std::cerr << "\n";
+        std::cerr << "  --order=sjf sends the cheapest prompts first (prompt tokens plus 20 per\n";
+        std::cerr << "  max_token). Prompt tokens come from the first replica's /tokenize, or an\n";
+        std::cerr << "  estimate with --tokens=local; server counts are cached for later runs.\n";
+        std::cerr << "\n";
+        std::cerr << "  Each result line is recorded in <output.jsonl>.journal. After a crash,\n";
+        std::cerr << "  --resume appends to the output and skips prompts that already succeeded.\n";
         std::cerr << "\n";
         std::cerr << "Output format (JSONL - ready for SeaweedFS upload):\n";
         std::cerr << "  {\"timestamp\":\"...\",\"prompt\":\"...\",\"success\":true,\"response\":\"...\"}\n";
@@ -302,11 +743,15 @@ int main(int argc, char** argv) {
     }
 
     try {
-        process_batch(argv[1], argv[2], argv[3]);
+        slp::init_curl_counting_allocations();
+        if (positional.size() == 4) opts.concurrency = std::stoul(positional[3]);
+        process_batch(positional[0], positional[1], positional[2], opts);
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << "\n";
+        curl_global_cleanup();
         return 1;
     }
 
+    curl_global_cleanup();
     return 0;
 }
@@ -7,11 +7,18 @@
 #include <chrono>
 #include <curl/curl.h>
 
+#include "slp/llama/batch_result.h"
+#include "slp/llama/endpoint_pool.h"
+
 // Simple llama-server client without SeaweedFS dependency
 // This demonstrates integration with your running llama-server on port 9080
 
 namespace {
 
+using slp::llama::InferenceResult;
+using slp::llama::extract_json_field;
+using slp::llama::escape_json_string;
+
 size_t write_callback(void* contents, size_t size, size_t nmemb, void* userp) {
     size_t total_size = size * nmemb;
     auto* response = static_cast<std::string*>(userp);
@@ -19,62 +26,6 @@ size_t write_callback(void* contents, size_t size, size_t nmemb, void* userp) {
     return total_size;
 }
 
-std::string escape_json_string(const std::string& s) {
-    std::ostringstream oss;
-    for (char c : s) {
-        switch (c) {
-            case '"': oss << "\\\""; break;
-            case '\\': oss << "\\\\"; break;
-            case '\b': oss << "\\b"; break;
-            case '\f': oss << "\\f"; break;
-            case '\n': oss << "\\n"; break;
-            case '\r': oss << "\\r"; break;
-            case '\t': oss << "\\t"; break;
-            default:
-                if (c < 32) {
-                    oss << "\\u" << std::hex << std::setfill('0') << std::setw(4) << static_cast<int>(c);
-                } else {
-                    oss << c;
-                }
-        }
-    }
-    return oss.str();
-}
-
-std::string extract_json_field(const std::string& json, const std::string& field) {
-    std::string search = "\"" + field + "\":";
-    size_t pos = json.find(search);
-    if (pos == std::string::npos) return "";
-
-    pos += search.length();
-    while (pos < json.length() && std::isspace(json[pos])) pos++;
-
-    if (pos >= json.length()) return "";
-
-    if (json[pos] == '"') {
-        size_t start = pos + 1;
-        size_t end = start;
-        while (end < json.length() && json[end] != '"') {
-            if (json[end] == '\\' && end + 1 < json.length()) end += 2;
-            else end++;
-        }
-        return json.substr(start, end - start);
-    }
-
-    size_t start = pos;
-    while (pos < json.length() && (std::isalnum(json[pos]) || json[pos] == '.' || json[pos] == '-')) {
-        pos++;
-    }
-    return json.substr(start, pos - start);
-}
-
-struct InferenceResult {
-    std::string content;
-    int64_t elapsed_us;
-    bool success;
-    std::string error;
-};
-
 InferenceResult call_llama_server(const std::string& url,
                                    const std::string& prompt,
                                    int max_tokens) {
@@ -146,17 +97,21 @@ InferenceResult call_llama_server(const std::string& url,
     return result;
 }
 
-void process_prompts_file(const std::string& llama_url, const std::string& prompts_file) {
+void process_prompts_file(const std::string& llama_urls, const std::string& prompts_file) {
     std::ifstream file(prompts_file);
     if (!file) {
         std::cerr << "Error: Cannot open prompts file: " << prompts_file << "\n";
         return;
     }
 
+    slp::llama::EndpointPool pool(slp::llama::parse_endpoint_list(llama_urls));
+
     std::cout << "\n╔════════════════════════════════════════════════════════════════╗\n";
     std::cout << "║  LLaMA Server Integration Test - cuda-llm-storage-pipeline   ║\n";
     std::cout << "╚════════════════════════════════════════════════════════════════╝\n\n";
-    std::cout << "LLaMA Server: " << llama_url << "\n";
+    for (size_t i = 0; i < pool.size(); ++i) {
+        std::cout << (i == 0 ? "LLaMA Server: " : "              ") << pool.url(i) << "\n";
+    }
     std::cout << "Prompts File: " << prompts_file << "\n\n";
 
     int prompt_num = 0;
@@ -198,7 +153,9 @@ void process_prompts_file(const std::string& llama_url, const std::string& promp
         std::cout << "Max Tokens: " << max_tokens << "\n";
         std::cout << "─────────────────────────────────────────────────────────────────\n";
 
-        auto result = call_llama_server(llama_url, prompt_text, max_tokens);
+        size_t backend = pool.acquire();
+        auto result = call_llama_server(pool.url(backend), prompt_text, max_tokens);
+        pool.release(backend, result.success, result.elapsed_us);
 
         if (result.success) {
             latencies.push_back(result.elapsed_us);
@@ -208,7 +165,8 @@ void process_prompts_file(const std::string& llama_url, const std::string& promp
             std::cout << "┌─────────────────────────────────────────────────────────────┐\n";
             std::cout << "│ " << result.content << "\n";
             std::cout << "└─────────────────────────────────────────────────────────────┘\n";
-            std::cout << "\nLatency: " << (result.elapsed_us / 1000.0) << " ms\n\n";
+            std::cout << "\nBackend: " << pool.url(backend) << "\n";
+            std::cout << "Latency: " << (result.elapsed_us / 1000.0) << " ms\n\n";
         } else {
             std::cout << "\n✗ Failed: " << result.error << "\n";
             std::cout << "Raw response: " << result.content.substr(0, 200) << "...\n\n";
@@ -234,6 +192,16 @@ void process_prompts_file(const std::string& llama_url, const std::string& promp
         std::cout << "P50 latency:       " << p50_ms << " ms\n";
         std::cout << "P95 latency:       " << p95_ms << " ms\n";
         std::cout << "P99 latency:       " << p99_ms << " ms\n\n";
+
+        if (pool.size() > 1) {
+            std::cout << "Per-backend latency:\n";
+            for (const auto& st : pool.stats()) {
+                std::cout << "  " << st.url << (st.healthy ? "" : " [ejected]")
+                          << "  requests=" << st.requests << " failures=" << st.failures
+                          << " mean=" << st.mean_ms << " ms p95=" << st.p95_ms << " ms\n";
+            }
+            std::cout << "\n";
+        }
     }
 }
 
@@ -241,7 +209,7 @@ void process_prompts_file(const std::string& llama_url, const std::string& promp
 
 int main(int argc, char** argv) {
     if (argc != 3) {
-        std::cerr << "usage: slp_llama_client <llama_url> <prompts_file.jsonl>\n";
+        std::cerr << "usage: slp_llama_client <llama_url[,llama_url...]> <prompts_file.jsonl>\n";
         std::cerr << "\n";
         std::cerr << "Example:\n";
         std::cerr << "  slp_llama_client http://127.0.0.1:9080 /tmp/test_prompts.jsonl\n";
@@ -252,11 +220,11 @@ int main(int argc, char** argv) {
         return 1;
     }
 
-    std::string llama_url = argv[1];
+    std::string llama_urls = argv[1];
     std::string prompts_file = argv[2];
 
     try {
-        process_prompts_file(llama_url, prompts_file);
+        process_prompts_file(llama_urls, prompts_file);
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << "\n";
         return 1;
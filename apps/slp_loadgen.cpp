@@ -0,0 +1,261 @@
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "slp/async_http.h"
+#include "slp/llama/endpoint_pool.h"
+#include "slp/llama/loadgen.h"
+
+// Open-loop load against llama-server: requests go out on a Poisson (or
+// recorded) schedule regardless of how fast earlier ones come back, at a
+// series of rates, to find the highest rate whose p99 latency still meets
+// the SLO. slp_llama_batch, being closed-loop, cannot show that.
+
+namespace {
+
+using slp::llama::OpenLoopResult;
+
+void usage() {
+    std::cerr << "usage: slp_loadgen <llama_url[,llama_url...]> <prompts.jsonl> [options]\n";
+    std::cerr << "  --rates=<r1,r2,...>    request rates to step through, requests/s\n";
+    std::cerr << "  --trace=<file>         send times (seconds, one per line) instead of Poisson\n";
+    std::cerr << "                         arrivals; replayed as recorded unless --rates rescales it\n";
+    std::cerr << "  --duration=<s>         length of each Poisson step (default 30)\n";
+    std::cerr << "  --slo-p99-ms=<ms>      p99 latency a rate must meet to count (default 1000)\n";
+    std::cerr << "  --max-error-rate=<f>   failed fraction a rate may have (default 0.01)\n";
+    std::cerr << "  --search=<n>           extra steps bisecting between the best passing and the\n";
+    std::cerr << "                         first failing rate (default 0)\n";
+    std::cerr << "  --timeout-ms=<ms>      per-request timeout (default 60000)\n";
+    std::cerr << "  --max-connections=<n>  connection cap for the client (default unlimited)\n";
+    std::cerr << "  --seed=<n>             arrival schedule seed (default 1)\n";
+    std::cerr << "  --report=<file>        JSONL report, one line per step (default loadgen_report.jsonl)\n";
+    std::cerr << "\n";
+    std::cerr << "Latency is measured from when a request was scheduled to be sent, so time\n";
+    std::cerr << "spent queued behind a slow server or a busy client is never left out.\n";
+    std::cerr << "\n";
+    std::cerr << "Example:\n";
+    std::cerr << "  slp_loadgen http://127.0.0.1:8090 prompts.jsonl --rates=1,2,4,8 --slo-p99-ms=2000 --search=3\n";
+}
+
+std::vector<double> parse_rates(const std::string& list) {
+    std::vector<double> rates;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (item.empty()) continue;
+        double r = std::stod(item);
+        if (r <= 0) throw std::runtime_error("rates must be positive: " + item);
+        rates.push_back(r);
+    }
+    return rates;
+}
+
+struct Step {
+    double rate = 0.0;  // target; 0 for a trace replayed as recorded
+    OpenLoopResult result;
+    bool meets_slo = false;
+};
+
+std::string latency_json(const slp::llama::LatencySummary& s) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2) << "{\"mean\":" << s.mean_ms << ",\"p50\":" << s.p50_ms
+        << ",\"p90\":" << s.p90_ms << ",\"p99\":" << s.p99_ms << ",\"p999\":" << s.p999_ms
+        << ",\"max\":" << s.max_ms << "}";
+    return out.str();
+}
+
+std::string step_json(const Step& s) {
+    const OpenLoopResult& r = s.result;
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3) << "{\"kind\":\"step\",\"target_rate\":" << s.rate
+        << ",\"offered_rate\":" << r.offered_rate << ",\"achieved_rate\":" << r.achieved_rate
+        << ",\"duration_s\":" << r.duration_s << ",\"requests\":" << r.requests << ",\"failures\":" << r.failures
+        << ",\"latency_ms\":" << latency_json(r.latency) << ",\"service_ms\":" << latency_json(r.service)
+        << ",\"send_lag_ms\":{\"mean\":" << r.mean_send_lag_ms << ",\"max\":" << r.max_send_lag_ms << "}"
+        << ",\"predicted_tokens\":" << r.predicted_tokens << ",\"mean_server_ms\":" << r.mean_server_ms
+        << ",\"meets_slo\":" << (s.meets_slo ? "true" : "false") << "}";
+    return out.str();
+}
+
+void print_header() {
+    std::cout << std::right << std::setw(9) << "rate" << std::setw(8) << "sent" << std::setw(8) << "err%"
+              << std::setw(10) << "done/s" << std::setw(10) << "p50 ms" << std::setw(10) << "p99 ms"
+              << std::setw(10) << "p99.9 ms" << std::setw(10) << "max ms" << std::setw(11) << "svc p99"
+              << std::setw(10) << "lag max" << "  SLO\n";
+}
+
+void print_step(const Step& s) {
+    const OpenLoopResult& r = s.result;
+    std::cout << std::fixed << std::setprecision(2) << std::right << std::setw(9)
+              << (s.rate > 0 ? s.rate : r.offered_rate) << std::setw(8) << r.requests << std::setw(8)
+              << 100.0 * r.error_rate() << std::setw(10) << r.achieved_rate << std::setw(10) << r.latency.p50_ms
+              << std::setw(10) << r.latency.p99_ms << std::setw(10) << r.latency.p999_ms << std::setw(10)
+              << r.latency.max_ms << std::setw(11) << r.service.p99_ms << std::setw(10) << r.max_send_lag_ms
+              << "  " << (s.meets_slo ? "ok" : "MISS") << "\n";
+    if (!r.first_error.empty()) std::cout << "           first error: " << r.first_error << "\n";
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv) {
+    if (argc < 3 || std::string(argv[1]).rfind("--", 0) == 0) {
+        usage();
+        return 1;
+    }
+
+    std::string urls = argv[1];
+    std::string prompts_file = argv[2];
+    std::vector<double> rates;
+    std::string trace_file;
+    double duration_s = 30;
+    double slo_p99_ms = 1000;
+    double max_error_rate = 0.01;
+    int search_steps = 0;
+    uint64_t seed = 1;
+    std::string report_path = "loadgen_report.jsonl";
+    slp::LoopOptions loop_opts;
+    slp::llama::OpenLoopOptions opts;
+
+    try {
+        for (int i = 3; i < argc; ++i) {
+            std::string arg = argv[i];
+            auto value = [&](const std::string& prefix) { return arg.substr(prefix.size()); };
+            if (arg.rfind("--rates=", 0) == 0) {
+                rates = parse_rates(value("--rates="));
+            } else if (arg.rfind("--trace=", 0) == 0) {
+                trace_file = value("--trace=");
+            } else if (arg.rfind("--duration=", 0) == 0) {
+                duration_s = std::stod(value("--duration="));
+            } else if (arg.rfind("--slo-p99-ms=", 0) == 0) {
+                slo_p99_ms = std::stod(value("--slo-p99-ms="));
+            } else if (arg.rfind("--max-error-rate=", 0) == 0) {
+                max_error_rate = std::stod(value("--max-error-rate="));
+            } else if (arg.rfind("--search=", 0) == 0) {
+                search_steps = std::stoi(value("--search="));
+            } else if (arg.rfind("--timeout-ms=", 0) == 0) {
+                opts.timeout_ms = std::stol(value("--timeout-ms="));
+            } else if (arg.rfind("--max-connections=", 0) == 0) {
+                loop_opts.max_connections = std::stol(value("--max-connections="));
+            } else if (arg.rfind("--seed=", 0) == 0) {
+                seed = std::stoull(value("--seed="));
+            } else if (arg.rfind("--report=", 0) == 0) {
+                report_path = value("--report=");
+            } else {
+                usage();
+                return 1;
+            }
+        }
+        if (rates.empty() && trace_file.empty()) {
+            std::cerr << "Error: give --rates, --trace or both\n";
+            return 1;
+        }
+
+        opts.urls = slp::llama::parse_endpoint_list(urls);
+        auto prompts = slp::llama::load_prompts(prompts_file);
+        std::vector<double> trace;
+        if (!trace_file.empty()) {
+            trace = slp::llama::read_trace(trace_file);
+            if (trace.empty()) throw std::runtime_error("no send times in " + trace_file);
+        }
+
+        std::ofstream report(report_path);
+        if (!report) throw std::runtime_error("cannot write report " + report_path);
+
+        std::cout << "Servers:      " << urls << "\n";
+        std::cout << "Prompts:      " << prompts.size() << " from " << prompts_file << "\n";
+        if (trace.empty()) {
+            std::cout << "Arrivals:     Poisson, " << duration_s << " s per step\n";
+        } else {
+            std::cout << "Arrivals:     trace " << trace_file << " (" << trace.size() << " requests)\n";
+        }
+        std::cout << "SLO:          p99 <= " << slo_p99_ms << " ms, errors <= " << 100.0 * max_error_rate << "%\n\n";
+
+        slp::EventLoop loop(loop_opts);
+        slp::AsyncHttpClient http(loop);
+        std::mt19937_64 rng(seed);
+        std::vector<Step> steps;
+
+        auto run_step = [&](double rate) {
+            std::vector<double> arrivals;
+            if (trace.empty()) {
+                arrivals = slp::llama::poisson_arrivals(rate, duration_s, rng);
+            } else {
+                arrivals = rate > 0 ? slp::llama::scale_to_rate(trace, rate) : trace;
+            }
+            Step s;
+            s.rate = rate;
+            s.result = loop.run(slp::llama::run_open_loop(http, arrivals, prompts, opts));
+            s.meets_slo = s.result.requests > 0 && s.result.latency.p99_ms <= slo_p99_ms &&
+                          s.result.error_rate() <= max_error_rate;
+            print_step(s);
+            report << step_json(s) << "\n";
+            report.flush();
+            if (s.result.max_send_lag_ms > 0.1 * slo_p99_ms) {
+                std::cout << "           warning: sends left up to " << s.result.max_send_lag_ms
+                          << " ms late; the client is near its limit\n";
+            }
+            steps.push_back(std::move(s));
+        };
+
+        print_header();
+        if (rates.empty()) {
+            run_step(0);
+        } else {
+            std::sort(rates.begin(), rates.end());
+            for (double rate : rates) run_step(rate);
+        }
+
+        // Best passing rate, and the lowest failing rate above it
+        auto bracket = [&]() {
+            std::optional<double> pass;
+            std::optional<double> fail;
+            for (const auto& s : steps) {
+                double rate = s.rate > 0 ? s.rate : s.result.offered_rate;
+                if (s.meets_slo && (!pass || rate > *pass)) pass = rate;
+            }
+            for (const auto& s : steps) {
+                double rate = s.rate > 0 ? s.rate : s.result.offered_rate;
+                if (!s.meets_slo && (!pass || rate > *pass) && (!fail || rate < *fail)) fail = rate;
+            }
+            return std::make_pair(pass, fail);
+        };
+
+        if (!rates.empty()) {
+            for (int i = 0; i < search_steps; ++i) {
+                auto [pass, fail] = bracket();
+                if (!pass || !fail) break;
+                run_step((*pass + *fail) / 2);
+            }
+        }
+
+        auto [best, first_miss] = bracket();
+        std::cout << "\n";
+        if (best) {
+            std::cout << "Max sustainable rate: " << std::fixed << std::setprecision(2) << *best
+                      << " req/s with p99 <= " << slo_p99_ms << " ms";
+            if (!first_miss) std::cout << " (every rate tried met the SLO)";
+            std::cout << "\n";
+        } else {
+            std::cout << "No rate tried met the SLO\n";
+        }
+
+        std::ostringstream summary;
+        summary << std::fixed << std::setprecision(3) << "{\"kind\":\"summary\",\"slo_p99_ms\":" << slo_p99_ms
+                << ",\"max_error_rate\":" << max_error_rate << ",\"max_sustainable_rate\":";
+        if (best) summary << *best;
+        else summary << "null";
+        summary << ",\"steps\":" << steps.size() << "}";
+        report << summary.str() << "\n";
+        std::cout << "Report: " << report_path << "\n";
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,398 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "curl_common.h"
+#include "slp/artifact/manifest.h"
+#include "slp/json.h"
+#include "slp/llama/batch_result.h"
+#include "slp/sha256.h"
+
+// Microbenchmarks for the CPU-side hot paths: hashing, the batch tools' JSON
+// encode/scan helpers, manifest serialization and response-body buffering.
+// Prints one JSON report; with --baseline it compares against an earlier
+// report and exits non-zero when anything got slower than --threshold.
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+#ifdef __OPTIMIZE__
+constexpr bool kOptimized = true;
+#else
+constexpr bool kOptimized = false;
+#endif
+
+// Keep the compiler from discarding a result it can see is unused
+template <typename T>
+void keep(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct Case {
+    std::string name;
+    size_t bytes;                             // input bytes per op; 0 if not meaningful
+    std::function<void(size_t iters)> run;
+};
+
+struct Measurement {
+    std::string name;
+    size_t bytes = 0;
+    uint64_t iterations = 0;                  // per repetition
+    double ns_per_op = 0.0;                   // median over repetitions
+    double min_ns_per_op = 0.0;
+};
+
+double elapsed_ns(const std::function<void(size_t)>& run, size_t iters) {
+    auto start = Clock::now();
+    run(iters);
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+}
+
+Measurement measure(const Case& c, double min_time_s, int repetitions) {
+    // Grow the batch until one takes ~10ms, then size each repetition so
+    // all of them together fill min_time_s
+    size_t iters = 1;
+    double ns = elapsed_ns(c.run, iters);
+    while (ns < 1e7 && iters < (size_t(1) << 40)) {
+        iters *= ns < 1e5 ? 10 : 2;
+        ns = elapsed_ns(c.run, iters);
+    }
+    double per_op = ns / static_cast<double>(iters);
+    double per_rep_ns = min_time_s * 1e9 / repetitions;
+    iters = std::max<size_t>(1, static_cast<size_t>(per_rep_ns / per_op));
+
+    std::vector<double> samples;
+    for (int r = 0; r < repetitions; ++r) {
+        samples.push_back(elapsed_ns(c.run, iters) / static_cast<double>(iters));
+    }
+    std::sort(samples.begin(), samples.end());
+
+    Measurement m;
+    m.name = c.name;
+    m.bytes = c.bytes;
+    m.iterations = iters;
+    m.ns_per_op = samples[samples.size() / 2];
+    m.min_ns_per_op = samples.front();
+    return m;
+}
+
+// Prompt-like text with the occasional quote, newline, tab and control byte
+std::string sample_text(size_t len, uint32_t seed) {
+    static const char* words[] = {"the", "model", "returns", "a", "token", "stream", "for", "each",
+                                  "prompt", "in", "batch", "order", "with", "timings"};
+    std::mt19937 rng(seed);
+    std::string s;
+    while (s.size() < len) {
+        uint32_t r = static_cast<uint32_t>(rng() % 100);
+        if (r < 2) s += '"';
+        else if (r < 4) s += '\n';
+        else if (r < 5) s += '\t';
+        else if (r < 6) s += '\x01';
+        s += words[rng() % (sizeof(words) / sizeof(words[0]))];
+        s += ' ';
+    }
+    s.resize(len);
+    return s;
+}
+
+// Body shaped like a llama-server /completion reply
+std::string llama_reply(size_t content_len) {
+    return "{\"content\":\"" + slp::llama::escape_json_string(sample_text(content_len, 7)) +
+           "\",\"id_slot\":0,\"stop\":true,\"model\":\"gemma-3-1b-it-Q4_K_M.gguf\",\"tokens_predicted\":" +
+           std::to_string(content_len / 4) + ",\"tokens_evaluated\":24,"
+           "\"generation_settings\":{\"n_ctx\":4096,\"temperature\":0.8,\"top_k\":40,\"top_p\":0.95},"
+           "\"timings\":{\"prompt_n\":24,\"prompt_ms\":12.5,\"predicted_n\":64,\"predicted_ms\":640.1}}";
+}
+
+slp::artifact::Manifest sample_manifest(size_t chunks, size_t tensors) {
+    slp::artifact::Manifest m;
+    m.sha256 = std::string(64, 'a');
+    m.created_at = "2026-01-01T00:00:00Z";
+    m.original_name = "gemma-3-1b-it-Q4_K_M.gguf";
+    uint64_t offset = 0;
+    for (size_t i = 0; i < chunks; ++i) {
+        uint64_t size = 1024 * 1024 + i * 37;
+        m.chunks.push_back({slp::sha256_hex(reinterpret_cast<const uint8_t*>(&i), sizeof(i)), offset, size});
+        offset += size;
+    }
+    if (tensors > 0) {
+        m.gguf_version = 3;
+        m.gguf_architecture = "gemma3";
+        m.gguf_header_bytes = 6 * 1024 * 1024;
+        for (size_t i = 0; i < tensors; ++i) {
+            m.tensors.push_back({"blk." + std::to_string(i / 11) + ".attn_q.weight", "Q4_K", {1152, 1024},
+                                 offset, 663552});
+            offset += 663552;
+        }
+    }
+    m.size_bytes = offset;
+    return m;
+}
+
+std::vector<Case> build_cases() {
+    std::vector<Case> cases;
+
+    for (size_t size : {size_t(64), size_t(4096), size_t(65536), size_t(1) << 20}) {
+        auto data = std::make_shared<std::vector<uint8_t>>(size);
+        for (size_t i = 0; i < size; ++i) (*data)[i] = static_cast<uint8_t>(i * 131);
+        cases.push_back({"sha256_hex/" + std::to_string(size), size, [data](size_t iters) {
+                             for (size_t i = 0; i < iters; ++i) keep(slp::sha256_hex(*data));
+                         }});
+    }
+
+    for (size_t size : {size_t(64), size_t(1024), size_t(16384)}) {
+        auto text = std::make_shared<std::string>(sample_text(size, 1));
+        cases.push_back({"escape_json_string/" + std::to_string(size), size, [text](size_t iters) {
+                             for (size_t i = 0; i < iters; ++i) keep(slp::llama::escape_json_string(*text));
+                         }});
+        cases.push_back({"json_escape/" + std::to_string(size), size, [text](size_t iters) {
+                             for (size_t i = 0; i < iters; ++i) keep(slp::json::escape(*text));
+                         }});
+    }
+
+    for (size_t size : {size_t(256), size_t(4096), size_t(65536)}) {
+        auto reply = std::make_shared<std::string>(llama_reply(size));
+        size_t bytes = reply->size();
+        // "content" comes first; "tokens_predicted" sits behind the whole text
+        for (const char* field : {"content", "tokens_predicted"}) {
+            std::string f = field;
+            cases.push_back({"extract_json_field/" + f + "/" + std::to_string(size), bytes, [reply, f](size_t iters) {
+                                 for (size_t i = 0; i < iters; ++i) keep(slp::llama::extract_json_field(*reply, f));
+                             }});
+        }
+    }
+
+    for (size_t size : {size_t(256), size_t(4096)}) {
+        auto r = std::make_shared<slp::llama::InferenceResult>();
+        r->prompt = sample_text(128, 2);
+        r->content = sample_text(size, 3);
+        r->max_tokens = 128;
+        r->elapsed_us = 812345;
+        r->success = true;
+        r->timestamp = "2026-01-01T00:00:00Z";
+        cases.push_back({"result_to_json/" + std::to_string(size), size, [r](size_t iters) {
+                             for (size_t i = 0; i < iters; ++i) keep(slp::llama::result_to_json(*r));
+                         }});
+    }
+
+    struct ManifestShape {
+        const char* name;
+        size_t chunks;
+        size_t tensors;
+    };
+    for (ManifestShape shape : {ManifestShape{"whole", 0, 0}, ManifestShape{"chunks:1024", 1024, 0},
+                                ManifestShape{"tensors:340", 0, 340}}) {
+        auto m = std::make_shared<slp::artifact::Manifest>(sample_manifest(shape.chunks, shape.tensors));
+        auto json = std::make_shared<std::string>(m->to_json());
+        cases.push_back({std::string("manifest_to_json/") + shape.name, json->size(), [m](size_t iters) {
+                             for (size_t i = 0; i < iters; ++i) keep(m->to_json());
+                         }});
+        cases.push_back({std::string("manifest_from_json/") + shape.name, json->size(), [json](size_t iters) {
+                             for (size_t i = 0; i < iters; ++i) keep(slp::artifact::Manifest::from_json(*json));
+                         }});
+    }
+
+    // The HttpClient body sink, fed the way libcurl delivers a response:
+    // CURL_MAX_WRITE_SIZE pieces into a vector that starts empty
+    for (size_t size : {size_t(65536), size_t(1) << 20, size_t(16) << 20}) {
+        auto src = std::make_shared<std::vector<char>>(size, 'x');
+        cases.push_back({"http_write_callback/" + std::to_string(size), size, [src](size_t iters) {
+                             for (size_t i = 0; i < iters; ++i) {
+                                 std::vector<uint8_t> body;
+                                 for (size_t off = 0; off < src->size(); off += CURL_MAX_WRITE_SIZE) {
+                                     size_t n = std::min<size_t>(CURL_MAX_WRITE_SIZE, src->size() - off);
+                                     slp::detail::write_callback(src->data() + off, 1, n, &body);
+                                 }
+                                 keep(body.data());
+                             }
+                         }});
+    }
+
+    return cases;
+}
+
+std::string report_json(const std::vector<Measurement>& results) {
+    char host[256] = {};
+    gethostname(host, sizeof(host) - 1);
+    std::time_t now = std::time(nullptr);
+    char date[32];
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2);
+    out << "{\n  \"date\": \"" << date << "\",\n  \"host\": \"" << slp::json::escape(host) << "\",\n"
+        << "  \"optimized\": " << (kOptimized ? "true" : "false") << ",\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto& m = results[i];
+        out << "    {\"name\": \"" << slp::json::escape(m.name) << "\", \"bytes\": " << m.bytes
+            << ", \"iterations\": " << m.iterations << ", \"ns_per_op\": " << m.ns_per_op
+            << ", \"min_ns_per_op\": " << m.min_ns_per_op;
+        if (m.bytes > 0) {
+            out << ", \"mb_per_s\": " << static_cast<double>(m.bytes) / m.ns_per_op * 1e9 / (1024.0 * 1024.0);
+        }
+        out << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+    return out.str();
+}
+
+std::map<std::string, double> load_baseline(const std::string& path, bool& optimized) {
+    std::ifstream in(path);
+    if (!in) throw std::runtime_error("cannot read baseline " + path);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    slp::json::Value doc = slp::json::parse(ss.str());
+    const slp::json::Value* list = doc.find("benchmarks");
+    if (!list || !list->is_array()) throw std::runtime_error("baseline has no benchmarks array: " + path);
+
+    optimized = doc.get_bool("optimized", true);
+    std::map<std::string, double> baseline;
+    for (const auto& b : list->as_array()) {
+        baseline[b.get_string("name")] = b.get_number("ns_per_op");
+    }
+    return baseline;
+}
+
+// Prints a comparison table; returns the number of regressions
+int compare(const std::vector<Measurement>& results, const std::map<std::string, double>& baseline,
+            double threshold_pct) {
+    int regressions = 0;
+    std::cerr << std::left << std::setw(44) << "benchmark" << std::right << std::setw(14) << "base ns/op"
+              << std::setw(14) << "ns/op" << std::setw(10) << "delta" << "\n";
+    for (const auto& m : results) {
+        auto it = baseline.find(m.name);
+        std::cerr << std::left << std::setw(44) << m.name << std::right << std::fixed << std::setprecision(1);
+        if (it == baseline.end() || it->second <= 0) {
+            std::cerr << std::setw(14) << "-" << std::setw(14) << m.ns_per_op << std::setw(10) << "new" << "\n";
+            continue;
+        }
+        double delta = (m.ns_per_op / it->second - 1.0) * 100.0;
+        std::cerr << std::setw(14) << it->second << std::setw(14) << m.ns_per_op << std::setw(9) << std::showpos
+                  << delta << "%" << std::noshowpos;
+        if (delta > threshold_pct) {
+            std::cerr << "  REGRESSION";
+            ++regressions;
+        } else if (delta < -threshold_pct) {
+            std::cerr << "  faster";
+        }
+        std::cerr << "\n";
+    }
+    return regressions;
+}
+
+void usage() {
+    std::cerr << "usage: slp_microbench [options]\n";
+    std::cerr << "  --filter=<text>      only run benchmarks whose name contains <text>\n";
+    std::cerr << "  --list               print benchmark names and exit\n";
+    std::cerr << "  --min-time=<s>       measured time per benchmark (default 0.5)\n";
+    std::cerr << "  --repetitions=<n>    timed repetitions; the median is reported (default 5)\n";
+    std::cerr << "  --out=<file>         write the JSON report here instead of stdout\n";
+    std::cerr << "  --baseline=<file>    compare against an earlier report\n";
+    std::cerr << "  --threshold=<pct>    slowdown that counts as a regression (default 10)\n";
+}
+
+} // anonymous namespace
+
+int main(int argc, char** argv) {
+    std::string filter;
+    std::string out_path;
+    std::string baseline_path;
+    double min_time_s = 0.5;
+    int repetitions = 5;
+    double threshold_pct = 10.0;
+    bool list = false;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            auto value = [&](const std::string& prefix) { return arg.substr(prefix.size()); };
+            if (arg.rfind("--filter=", 0) == 0) {
+                filter = value("--filter=");
+            } else if (arg == "--list") {
+                list = true;
+            } else if (arg.rfind("--min-time=", 0) == 0) {
+                min_time_s = std::stod(value("--min-time="));
+            } else if (arg.rfind("--repetitions=", 0) == 0) {
+                repetitions = std::max(1, std::stoi(value("--repetitions=")));
+            } else if (arg.rfind("--out=", 0) == 0) {
+                out_path = value("--out=");
+            } else if (arg.rfind("--baseline=", 0) == 0) {
+                baseline_path = value("--baseline=");
+            } else if (arg.rfind("--threshold=", 0) == 0) {
+                threshold_pct = std::stod(value("--threshold="));
+            } else {
+                usage();
+                return 1;
+            }
+        }
+
+        // Read the baseline first so a bad path fails before minutes of work
+        std::map<std::string, double> baseline;
+        if (!baseline_path.empty()) {
+            bool baseline_optimized = true;
+            baseline = load_baseline(baseline_path, baseline_optimized);
+            if (baseline_optimized != kOptimized) {
+                std::cerr << "warning: baseline and this binary differ in optimization; deltas are meaningless\n";
+            }
+        }
+        if (!kOptimized && !list) {
+            std::cerr << "warning: built without optimization; configure with -DCMAKE_BUILD_TYPE=Release\n";
+        }
+
+        std::vector<Measurement> results;
+        for (const auto& c : build_cases()) {
+            if (!filter.empty() && c.name.find(filter) == std::string::npos) continue;
+            if (list) {
+                std::cout << c.name << "\n";
+                continue;
+            }
+            results.push_back(measure(c, min_time_s, repetitions));
+            const auto& m = results.back();
+            std::cerr << std::left << std::setw(44) << m.name << std::right << std::fixed << std::setprecision(1)
+                      << std::setw(12) << m.ns_per_op << " ns/op";
+            if (m.bytes > 0) {
+                std::cerr << std::setw(10) << static_cast<double>(m.bytes) / m.ns_per_op * 1e9 / (1024.0 * 1024.0)
+                          << " MB/s";
+            }
+            std::cerr << "\n";
+        }
+        if (list) return 0;
+
+        std::string report = report_json(results);
+        if (out_path.empty()) {
+            std::cout << report;
+        } else {
+            std::ofstream out(out_path);
+            if (!out || !(out << report)) throw std::runtime_error("cannot write " + out_path);
+        }
+
+        if (!baseline_path.empty()) {
+            std::cerr << "\n";
+            int regressions = compare(results, baseline, threshold_pct);
+            if (regressions > 0) {
+                std::cerr << regressions << " benchmark(s) slower than baseline by more than " << threshold_pct
+                          << "%\n";
+                return 2;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "error: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,113 @@
+#include <csignal>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "slp/testing/mock_filer.h"
+#include "slp/testing/mock_llama.h"
+
+// Loopback stand-ins for the SeaweedFS filer and llama-server, so the
+// benchmarks and tools can run without either. Runs until interrupted.
+
+static void usage() {
+    std::cerr << "usage: slp_mock_servers [options]\n";
+    std::cerr << "  --filer-port=<n>          filer port (default 8888; 0 = any, -1 = disabled)\n";
+    std::cerr << "  --llama-port=<n>          llama-server port (default 8090; 0 = any, -1 = disabled)\n";
+    std::cerr << "  --latency=<spec>          per-request latency: none | fixed:<ms> | uniform:<lo>:<hi> |\n";
+    std::cerr << "                            exp:<mean_ms> | lognormal:<median_ms>:<sigma>\n";
+    std::cerr << "  --bandwidth-mbps=<MB/s>   cap each response body (default unlimited)\n";
+    std::cerr << "  --error-rate=<p>          answer this fraction of requests with --error-status\n";
+    std::cerr << "  --error-status=<code>     (default 503)\n";
+    std::cerr << "  --drop-rate=<p>           cut this fraction of filer GET bodies off halfway\n";
+    std::cerr << "  --seed=<n>                random seed for latencies and faults (default 1)\n";
+    std::cerr << "  --prefill=<spec>          llama time to first token (default none)\n";
+    std::cerr << "  --prefill-ms-per-token=<ms>  plus this per prompt token\n";
+    std::cerr << "  --token-ms=<spec>         llama gap between tokens (default fixed:10)\n";
+    std::cerr << "  --slots=<n>               llama requests decoded at once (default 1)\n";
+}
+
+int main(int argc, char** argv) {
+    int filer_port = 8888;
+    int llama_port = 8090;
+    slp::testing::FaultOptions faults;
+    slp::testing::MockLlamaOptions llama;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            auto value = [&](const std::string& prefix) { return arg.substr(prefix.size()); };
+            if (arg.rfind("--filer-port=", 0) == 0) {
+                filer_port = std::stoi(value("--filer-port="));
+            } else if (arg.rfind("--llama-port=", 0) == 0) {
+                llama_port = std::stoi(value("--llama-port="));
+            } else if (arg.rfind("--latency=", 0) == 0) {
+                faults.latency = slp::testing::Latency::parse(value("--latency="));
+            } else if (arg.rfind("--bandwidth-mbps=", 0) == 0) {
+                faults.bandwidth_bytes_per_sec = std::stod(value("--bandwidth-mbps=")) * 1024 * 1024;
+            } else if (arg.rfind("--error-rate=", 0) == 0) {
+                faults.error_rate = std::stod(value("--error-rate="));
+            } else if (arg.rfind("--error-status=", 0) == 0) {
+                faults.error_status = std::stoi(value("--error-status="));
+            } else if (arg.rfind("--drop-rate=", 0) == 0) {
+                faults.drop_rate = std::stod(value("--drop-rate="));
+            } else if (arg.rfind("--seed=", 0) == 0) {
+                faults.seed = std::stoull(value("--seed="));
+            } else if (arg.rfind("--prefill=", 0) == 0) {
+                llama.prefill = slp::testing::Latency::parse(value("--prefill="));
+            } else if (arg.rfind("--prefill-ms-per-token=", 0) == 0) {
+                llama.prefill_ms_per_token = std::stod(value("--prefill-ms-per-token="));
+            } else if (arg.rfind("--token-ms=", 0) == 0) {
+                llama.token_interval = slp::testing::Latency::parse(value("--token-ms="));
+            } else if (arg.rfind("--slots=", 0) == 0) {
+                llama.slots = std::stoi(value("--slots="));
+            } else {
+                usage();
+                return 1;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "bad option: " << e.what() << "\n";
+        return 1;
+    }
+    llama.faults = faults;
+
+    // Block the signals before any server thread starts so only sigwait sees them
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    std::unique_ptr<slp::testing::MockFiler> filer;
+    std::unique_ptr<slp::testing::MockLlama> server;
+    try {
+        if (filer_port >= 0) {
+            filer = std::make_unique<slp::testing::MockFiler>(faults, static_cast<uint16_t>(filer_port));
+            std::cout << "filer:        " << filer->url() << "\n";
+        }
+        if (llama_port >= 0) {
+            server = std::make_unique<slp::testing::MockLlama>(llama, static_cast<uint16_t>(llama_port));
+            std::cout << "llama-server: " << server->url() << " (" << llama.slots << " slots, tokens every "
+                      << llama.token_interval.describe() << ")\n";
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+    std::cout << "latency:      " << faults.latency.describe() << "\n";
+    std::cout << "Ctrl-C to stop" << std::endl;
+
+    int sig = 0;
+    sigwait(&signals, &sig);
+
+    if (filer) {
+        filer->stop();
+        std::cout << "\nfiler served " << filer->requests_served() << " requests, holds "
+                  << filer->object_count() << " objects\n";
+    }
+    if (server) {
+        server->stop();
+        std::cout << "llama-server served " << server->requests_served() << " requests\n";
+    }
+    return 0;
+}
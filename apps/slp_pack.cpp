@@ -0,0 +1,67 @@
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "slp/artifact/pack.h"
+#include "slp/artifact/paths.h"
+
+// Store many small files as one pack object and read members back by hash
+
+static void usage() {
+    std::cerr << "usage: slp_pack <command> <filer_url> [args]\n";
+    std::cerr << "  put <filer_url> <file>...                 pack the files into /packs/<pack_id>.pack\n";
+    std::cerr << "  ls <filer_url> <pack_id>                  list members from the pack index\n";
+    std::cerr << "  cat <filer_url> <pack_id> <sha256>...     write members to stdout\n";
+}
+
+static std::vector<uint8_t> read_local(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) throw std::runtime_error("cannot read " + path);
+    return std::vector<uint8_t>((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+}
+
+int main(int argc, char** argv) {
+    if (argc < 4) {
+        usage();
+        return 1;
+    }
+    std::string cmd = argv[1];
+    std::string filer = argv[2];
+
+    try {
+        if (cmd == "put") {
+            slp::artifact::PackWriter writer;
+            std::vector<std::pair<std::string, std::string>> added;  // hash, file
+            for (int i = 3; i < argc; ++i) added.emplace_back(writer.add(read_local(argv[i])), argv[i]);
+
+            auto pack = writer.finish();
+            slp::artifact::put_pack(filer, pack);
+            for (const auto& [hash, file] : added) std::cout << hash << "  " << file << "\n";
+            std::cout << "packed " << pack.entries.size() << " objects (" << pack.bytes.size() << " bytes) into "
+                      << slp::artifact::pack_path(pack.pack_id) << "\n";
+            std::cout << "pack_id=" << pack.pack_id << "\n";
+        } else if (cmd == "ls" && argc == 4) {
+            auto index = slp::artifact::fetch_pack_index(filer, argv[3]);
+            for (const auto& e : index.entries()) {
+                std::cout << e.sha256 << " " << std::setw(12) << e.offset << " " << std::setw(10) << e.size << "\n";
+            }
+            std::cout << index.entries().size() << " members\n";
+        } else if (cmd == "cat" && argc >= 5) {
+            slp::artifact::PackIndexCache cache;
+            for (int i = 4; i < argc; ++i) {
+                auto data = cache.read(filer, argv[3], argv[i]);
+                std::cout.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+            }
+        } else {
+            usage();
+            return 1;
+        }
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
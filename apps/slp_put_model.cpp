@@ -1,20 +1,41 @@
-#include <fstream>
+#include <ctime>
+#include <filesystem>
 #include <iostream>
+#include <iomanip>
+#include <memory>
+#include <tuple>
 #include <vector>
 
 #include "slp/seaweed/filer.h"
+#include "slp/seaweed/transfer.h"
+#include "slp/artifact/gguf.h"
 #include "slp/artifact/manifest.h"
+#include "slp/artifact/paths.h"
+#include "slp/artifact/registry.h"
+#include "slp/pipeline/chunk_store.h"
+#include "slp/pipeline/model_store.h"
+#include "slp/file_hash.h"
+#include "slp/mapped_file.h"
 #include "slp/sha256.h"
 
-static std::vector<uint8_t> read_file(const std::string& path) {
-  std::ifstream f(path, std::ios::binary);
-  if (!f) throw std::runtime_error("cannot open file");
-  return {std::istreambuf_iterator<char>(f), {}};
+// Larger models are uploaded as chunks so an interrupted upload can resume
+static constexpr uint64_t kResumableThreshold = 1ULL << 30;
+
+static void usage() {
+  std::cerr << "usage: slp_put_model <filer_url> <model.gguf> <model_name[:tag]> [--codec=<spec>] [--chunked|--single] [--rehash]\n";
+  std::cerr << "  --codec=<spec>  none (default) | gzip[:level] | zstd[:level[:dict_path]]\n";
+  std::cerr << "  --chunked       store as content-defined chunks under /chunks/,\n";
+  std::cerr << "                  uploading only chunks the store does not have yet\n";
+  std::cerr << "                  (default above 1 GiB; rerun to resume an interrupted upload;\n";
+  std::cerr << "                  chunks are stored raw, so not with --codec)\n";
+  std::cerr << "  --single        store as one object even when large\n";
+  std::cerr << "  --rehash        hash the file even if its hash is recorded as unchanged\n";
+  std::cerr << "  The name is recorded in the local registry (see slp_registry).\n";
 }
 
 int main(int argc, char** argv) {
-  if (argc != 4) {
-    std::cerr << "usage: slp_put_model <filer_url> <model.gguf> <model_name>\n";
+  if (argc < 4) {
+    usage();
     return 1;
   }
 
@@ -22,27 +43,146 @@ int main(int argc, char** argv) {
   std::string model_path = argv[2];
   std::string model_name = argv[3];
 
-  auto bytes = read_file(model_path);
-  auto hash = slp::sha256_hex(bytes);
+  // Quantized weights barely compress, so models are stored raw unless asked
+  slp::seaweed::CodecOptions codec;
+  bool chunked = false;
+  bool single = false;
+  bool rehash = false;
+  for (int i = 4; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg.rfind("--codec=", 0) == 0) {
+      try {
+        codec = slp::seaweed::parse_codec_spec(arg.substr(8));
+      } catch (const std::exception& e) {
+        std::cerr << e.what() << "\n";
+        usage();
+        return 1;
+      }
+    } else if (arg == "--chunked") {
+      chunked = true;
+    } else if (arg == "--single") {
+      single = true;
+    } else if (arg == "--rehash") {
+      rehash = true;
+    } else {
+      usage();
+      return 1;
+    }
+  }
+  // Chunks are stored raw so identical chunks dedup across models
+  if (chunked && codec.codec != slp::seaweed::Codec::none) {
+    std::cerr << "--chunked cannot be combined with --codec; chunks are stored uncompressed\n";
+    return 1;
+  }
 
-  std::string obj_path = "/models/" + hash + ".gguf";
+  std::unique_ptr<slp::MappedFile> file;
+  try {
+    file = std::make_unique<slp::MappedFile>(model_path);
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << "\n";
+    return 1;
+  }
+  const uint8_t* data = file->data();
+  size_t size = file->size();
 
-  if (!slp::seaweed::put_file(filer, obj_path, bytes)) {
-    std::cerr << "upload failed\n";
+  // The hash of an unchanged file is reused from the last run instead of
+  // reading the whole model again
+  std::string hash;
+  try {
+    slp::HashCache hashes(slp::pipeline::default_cache_dir() + "/hashes");
+    if (rehash) hashes.forget(model_path);
+    auto h = hashes.sha256(model_path, [&] { return slp::sha256_hex(data, size); });
+    hash = h.sha256;
+    if (h.reused) std::cout << "hash unchanged since last run (--rehash to verify)\n";
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << "\n";
     return 1;
   }
 
+  if (!chunked && !single && codec.codec == slp::seaweed::Codec::none && size >= kResumableThreshold) {
+    chunked = true;
+  }
+
   slp::artifact::Manifest m;
   m.sha256 = hash;
-  m.size_bytes = bytes.size();
+  m.size_bytes = size;
   m.original_name = model_name;
 
-  std::string manifest_path = "/models/" + hash + ".manifest.json";
+  // Index the GGUF header so tools can inspect the model or fetch single
+  // tensors with range reads instead of downloading it
+  if (slp::artifact::is_gguf(data, size)) {
+    try {
+      slp::artifact::add_gguf_index(m, slp::artifact::parse_gguf_header(data, size));
+      std::cout << "indexed GGUF v" << m.gguf_version << " header: " << m.tensors.size()
+                << " tensors, " << m.gguf_header_bytes << " header bytes\n";
+    } catch (const std::exception& e) {
+      std::cerr << "warning: GGUF header not indexed: " << e.what() << "\n";
+    }
+  }
+
+  if (chunked) {
+    std::string ckpt_dir = slp::pipeline::default_cache_dir() + "/uploads";
+    std::filesystem::create_directories(ckpt_dir);
+    slp::pipeline::ChunkUploadStats stats;
+    try {
+      stats = slp::pipeline::put_chunked(filer, data, size, m, ckpt_dir + "/" + hash + ".ckpt");
+    } catch (const std::exception& e) {
+      std::cerr << "upload failed: " << e.what() << "\n";
+      std::cerr << "rerun the same command to resume\n";
+      return 1;
+    }
+
+    std::cout << "chunks: " << stats.chunks_total << " total, " << stats.chunks_unique
+              << " unique, " << stats.chunks_uploaded << " uploaded";
+    if (stats.chunks_resumed > 0) {
+      std::cout << ", " << stats.chunks_resumed << " done by an earlier run";
+    }
+    std::cout << "\n";
+    std::cout << "bytes:  " << stats.bytes_total << " logical, " << stats.bytes_uploaded << " uploaded\n";
+    if (stats.bytes_uploaded == 0) {
+      std::cout << "dedup:  all chunks already stored\n";
+    } else {
+      std::cout << "dedup:  " << std::fixed << std::setprecision(2) << stats.dedup_ratio() << "x\n";
+    }
+  } else {
+    m.codec = slp::seaweed::codec_name(codec.codec);
+    bool ok;
+    if (codec.codec == slp::seaweed::Codec::none) {
+      // Streamed from disk; never buffered in memory
+      ok = slp::seaweed::upload_file(filer, slp::artifact::model_path(hash), model_path);
+    } else {
+      ok = slp::seaweed::put_file(filer, slp::artifact::model_path(hash),
+                                  std::vector<uint8_t>(data, data + size), codec);
+    }
+    if (!ok) {
+      std::cerr << "upload failed\n";
+      return 1;
+    }
+  }
+
+  std::string manifest_json = m.to_json();
   auto manifest_bytes =
-      std::vector<uint8_t>(m.to_json().begin(), m.to_json().end());
+      std::vector<uint8_t>(manifest_json.begin(), manifest_json.end());
 
-  slp::seaweed::put_file(filer, manifest_path, manifest_bytes);
+  if (!slp::seaweed::put_file(filer, slp::artifact::model_manifest_path(hash), manifest_bytes)) {
+    std::cerr << "manifest upload failed\n";
+    return 1;
+  }
 
   std::cout << "uploaded model " << model_name
             << " hash=" << hash << "\n";
+
+  // The upload already succeeded; a registry problem is only a warning
+  try {
+    slp::artifact::Registry reg(slp::pipeline::default_cache_dir() + "/registry");
+    slp::artifact::RegistryEntry e;
+    std::tie(e.name, e.tag) = slp::artifact::split_ref(model_name);
+    e.sha256 = hash;
+    e.size_bytes = size;
+    e.created_unix = static_cast<int64_t>(std::time(nullptr));
+    reg.put(e);
+    std::cout << "registered " << e.name << ":" << e.tag << "\n";
+  } catch (const std::exception& e) {
+    std::cerr << "warning: not registered: " << e.what() << "\n";
+  }
 }
@@ -12,9 +12,11 @@ static std::vector<uint8_t> read_file(const std::string& path) {
 }
 
 int main(int argc, char** argv) {
-    if (argc != 3) {
-        std::cerr << "usage: slp_put_prompts <filer_url> <prompts_file>\n";
+    if (argc != 3 && argc != 4) {
+        std::cerr << "usage: slp_put_prompts <filer_url> <prompts_file> [codec]\n";
         std::cerr << "  prompts_file should be JSONL or CSV format\n";
+        std::cerr << "  codec: none | gzip[:level] | zstd[:level[:dict_path]]  (default: "
+                  << slp::seaweed::codec_name(slp::seaweed::default_text_codec()) << ")\n";
         return 1;
     }
 
@@ -22,17 +24,23 @@ int main(int argc, char** argv) {
     std::string prompts_path = argv[2];
 
     try {
+        slp::seaweed::CodecOptions codec;
+        codec.codec = slp::seaweed::default_text_codec();
+        if (argc == 4) codec = slp::seaweed::parse_codec_spec(argv[3]);
+
         auto bytes = read_file(prompts_path);
+        // The object name is the hash of the uncompressed content
         auto hash = slp::sha256_hex(bytes);
 
         std::string obj_path = "/prompts/" + hash + ".jsonl";
 
-        if (!slp::seaweed::put_file(filer, obj_path, bytes)) {
+        if (!slp::seaweed::put_file(filer, obj_path, bytes, codec)) {
             std::cerr << "upload failed\n";
             return 1;
         }
 
-        std::cout << "uploaded prompts hash=" << hash << " (" << bytes.size() << " bytes)\n";
+        std::cout << "uploaded prompts hash=" << hash << " (" << bytes.size() << " bytes, codec="
+                  << slp::seaweed::codec_name(codec.codec) << ")\n";
         return 0;
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << "\n";
@@ -0,0 +1,90 @@
+#include <ctime>
+#include <iomanip>
+#include <tuple>
+#include <iostream>
+#include <vector>
+
+#include "slp/artifact/registry.h"
+#include "slp/pipeline/model_store.h"
+
+// Maintain the local name:tag -> model hash registry and sync it with the filer
+
+static void usage() {
+    std::cerr << "usage: slp_registry [--dir=<dir>] <command> [args]\n";
+    std::cerr << "  add <name[:tag]> <sha256> [size_bytes]   point a tag at a model hash\n";
+    std::cerr << "  rm <name[:tag]>                          remove a tag\n";
+    std::cerr << "  resolve <name[:tag]|hash_prefix>         print the model hash\n";
+    std::cerr << "  ls [name]                                list entries\n";
+    std::cerr << "  compact                                  merge the journal into the index\n";
+    std::cerr << "  push <filer_url> | pull <filer_url>      sync the index with the filer\n";
+    std::cerr << "  Default dir: " << slp::pipeline::default_cache_dir() << "/registry\n";
+}
+
+static void print_entry(const slp::artifact::RegistryEntry& e) {
+    std::cout << std::left << std::setw(32) << (e.name + ":" + e.tag) << std::right << " "
+              << e.sha256 << " " << std::setw(14) << e.size_bytes << "\n";
+}
+
+int main(int argc, char** argv) {
+    std::string dir = slp::pipeline::default_cache_dir() + "/registry";
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--dir=", 0) == 0) dir = arg.substr(6);
+        else args.push_back(arg);
+    }
+    if (args.empty()) {
+        usage();
+        return 1;
+    }
+
+    try {
+        slp::artifact::Registry reg(dir);
+        const std::string& cmd = args[0];
+
+        if (cmd == "add" && (args.size() == 3 || args.size() == 4)) {
+            slp::artifact::RegistryEntry e;
+            std::tie(e.name, e.tag) = slp::artifact::split_ref(args[1]);
+            e.sha256 = args[2];
+            e.size_bytes = args.size() == 4 ? std::stoull(args[3]) : 0;
+            e.created_unix = static_cast<int64_t>(std::time(nullptr));
+            reg.put(e);
+            std::cout << "tagged " << e.name << ":" << e.tag << " -> " << e.sha256 << "\n";
+        } else if (cmd == "rm" && args.size() == 2) {
+            auto [name, tag] = slp::artifact::split_ref(args[1]);
+            if (!reg.remove(name, tag)) {
+                std::cerr << "not found: " << name << ":" << tag << "\n";
+                return 1;
+            }
+        } else if (cmd == "resolve" && args.size() == 2) {
+            auto e = reg.resolve(args[1]);
+            if (!e) {
+                std::cerr << "cannot resolve: " << args[1] << "\n";
+                return 1;
+            }
+            std::cout << e->sha256 << "\n";
+        } else if (cmd == "ls" && args.size() <= 2) {
+            for (const auto& e : args.size() == 2 ? reg.list(args[1]) : reg.all()) print_entry(e);
+        } else if (cmd == "compact" && args.size() == 1) {
+            size_t delta = reg.delta_size();
+            reg.compact();
+            std::cout << "compacted " << delta << " journal entries; index holds " << reg.all().size() << "\n";
+        } else if (cmd == "push" && args.size() == 2) {
+            reg.push(args[1]);
+            std::cout << "pushed " << reg.all().size() << " entries\n";
+        } else if (cmd == "pull" && args.size() == 2) {
+            if (!reg.pull(args[1])) {
+                std::cerr << "no registry index on the filer\n";
+                return 1;
+            }
+            std::cout << "pulled; index holds " << reg.all().size() << " entries\n";
+        } else {
+            usage();
+            return 1;
+        }
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
@@ -0,0 +1,260 @@
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "slp/artifact/paths.h"
+#include "slp/parallel.h"
+#include "slp/pipeline/scrub.h"
+#include "slp/seaweed/filer.h"
+
+// Walk the filer namespace and verify every stored object: content hashes
+// against paths, manifests against the objects they describe. Each result
+// is appended to a JSONL report as soon as it is known, so the report is
+// also the checkpoint that --resume continues from.
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using slp::pipeline::ScrubResult;
+using slp::pipeline::ScrubStatus;
+
+void usage() {
+    std::cerr << "usage: slp_scrub <filer_url> [options]\n";
+    std::cerr << "  --prefix=<dir,...>   directories to scrub (default /models/,/prompts/,/runs/,/chunks/)\n";
+    std::cerr << "  --threads=<n>        objects verified at once (default 4)\n";
+    std::cerr << "  --max-mbps=<MB/s>    cap the combined read rate (default unlimited)\n";
+    std::cerr << "  --report=<file>      JSONL report, one line per object (default scrub_report.jsonl)\n";
+    std::cerr << "  --resume             skip objects the report already has a verdict for;\n";
+    std::cerr << "                       objects that failed to read are tried again\n";
+    std::cerr << "  --dict=<file>        zstd dictionary for objects compressed with one\n";
+    std::cerr << "\n";
+    std::cerr << "Exit status: 0 if everything verified, 2 if anything is corrupt, missing or\n";
+    std::cerr << "unreadable, 1 if the scrub itself failed.\n";
+}
+
+std::vector<std::string> split_prefixes(const std::string& list) {
+    std::vector<std::string> out;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (item.empty()) continue;
+        if (item.front() != '/') item.insert(item.begin(), '/');
+        if (item.back() != '/') item += '/';
+        out.push_back(item);
+    }
+    return out;
+}
+
+// Every object under `root`, recursively
+void walk(const std::string& filer, const std::string& root, std::map<std::string, uint64_t>& objects) {
+    std::deque<std::string> dirs{root};
+    while (!dirs.empty()) {
+        std::string dir = dirs.front();
+        dirs.pop_front();
+        for (const auto& e : slp::seaweed::list_directory(filer, dir)) {
+            if (e.is_dir) {
+                dirs.push_back(e.path + "/");
+            } else {
+                objects[e.path] = e.size;
+            }
+        }
+    }
+}
+
+std::string format_bytes(uint64_t bytes) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2);
+    if (bytes >= (1ULL << 30)) out << static_cast<double>(bytes) / (1ULL << 30) << " GiB";
+    else out << static_cast<double>(bytes) / (1ULL << 20) << " MiB";
+    return out.str();
+}
+
+// Appends results to the report and keeps the running tallies
+class ScrubLog {
+public:
+    ScrubLog(const std::string& path, bool resume) : start_(Clock::now()), last_progress_(start_) {
+        if (resume) load(path);
+        out_.open(path, resume ? std::ios::app : std::ios::trunc);
+        if (!out_) throw std::runtime_error("cannot write report " + path);
+    }
+
+    bool done(const std::string& path) const { return done_.count(path) != 0; }
+    size_t resumed() const { return resumed_; }
+
+    void record(const ScrubResult& r, size_t total) {
+        std::lock_guard<std::mutex> lock(mu_);
+        if (!done_.insert(r.path).second) return;
+        out_ << r.to_json() << "\n";
+        out_.flush();
+        counts_[r.status]++;
+        bytes_ += r.bytes;
+        checked_++;
+
+        if (r.status != ScrubStatus::ok && r.status != ScrubStatus::readable) {
+            std::cerr << slp::pipeline::scrub_status_name(r.status) << ": " << r.path << ": " << r.detail << "\n";
+        }
+        auto now = Clock::now();
+        if (now - last_progress_ >= std::chrono::seconds(1)) {
+            last_progress_ = now;
+            std::cerr << "scrub: " << checked_ << "/" << total << " objects, " << format_bytes(bytes_) << ", "
+                      << std::fixed << std::setprecision(1) << mb_per_sec() << " MB/s\n";
+        }
+    }
+
+    int print_summary(const std::string& report_path) const {
+        std::lock_guard<std::mutex> lock(mu_);
+        double secs = std::chrono::duration<double>(Clock::now() - start_).count();
+        std::cout << "\nScrub complete: " << checked_ << " objects, " << format_bytes(bytes_) << " in "
+                  << std::fixed << std::setprecision(1) << secs << " s (" << mb_per_sec() << " MB/s)\n";
+        if (resumed_ > 0) std::cout << "  (" << resumed_ << " more verified by an earlier run)\n";
+        uint64_t problems = 0;
+        for (ScrubStatus s : {ScrubStatus::ok, ScrubStatus::readable, ScrubStatus::corrupt, ScrubStatus::missing,
+                              ScrubStatus::error}) {
+            auto it = counts_.find(s);
+            uint64_t n = it == counts_.end() ? 0 : it->second;
+            std::cout << "  " << std::left << std::setw(10) << slp::pipeline::scrub_status_name(s) + ":"
+                      << std::right << n << "\n";
+            if (s != ScrubStatus::ok && s != ScrubStatus::readable) problems += n;
+        }
+        std::cout << "Report: " << report_path << "\n";
+        return problems > 0 ? 2 : 0;
+    }
+
+private:
+    // Earlier verdicts count towards the summary; read errors do not, so
+    // those objects are tried again. A torn last line is ignored.
+    void load(const std::string& path) {
+        std::ifstream in(path);
+        std::string line;
+        std::map<std::string, ScrubResult> last;
+        while (std::getline(in, line)) {
+            try {
+                ScrubResult r = ScrubResult::from_json(line);
+                last[r.path] = std::move(r);
+            } catch (const std::exception&) {
+            }
+        }
+        for (const auto& [p, r] : last) {
+            if (r.status == ScrubStatus::error) continue;
+            done_.insert(p);
+            counts_[r.status]++;
+            resumed_++;
+        }
+    }
+
+    double mb_per_sec() const {
+        double secs = std::chrono::duration<double>(Clock::now() - start_).count();
+        return secs > 0 ? static_cast<double>(bytes_) / secs / (1024.0 * 1024.0) : 0.0;
+    }
+
+    mutable std::mutex mu_;
+    std::ofstream out_;
+    std::set<std::string> done_;
+    std::map<ScrubStatus, uint64_t> counts_;
+    uint64_t bytes_ = 0;
+    uint64_t checked_ = 0;
+    size_t resumed_ = 0;
+    Clock::time_point start_;
+    Clock::time_point last_progress_;
+};
+
+} // anonymous namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2 || std::string(argv[1]).rfind("--", 0) == 0) {
+        usage();
+        return 1;
+    }
+
+    std::string filer = argv[1];
+    std::vector<std::string> prefixes = split_prefixes("/models/,/prompts/,/runs/,/chunks/");
+    size_t threads = 4;
+    double max_mbps = 0;
+    std::string report_path = "scrub_report.jsonl";
+    bool resume = false;
+    slp::pipeline::ScrubOptions opts;
+
+    try {
+        for (int i = 2; i < argc; ++i) {
+            std::string arg = argv[i];
+            auto value = [&](const std::string& prefix) { return arg.substr(prefix.size()); };
+            if (arg.rfind("--prefix=", 0) == 0) {
+                prefixes = split_prefixes(value("--prefix="));
+            } else if (arg.rfind("--threads=", 0) == 0) {
+                threads = std::stoul(value("--threads="));
+            } else if (arg.rfind("--max-mbps=", 0) == 0) {
+                max_mbps = std::stod(value("--max-mbps="));
+            } else if (arg.rfind("--report=", 0) == 0) {
+                report_path = value("--report=");
+            } else if (arg == "--resume") {
+                resume = true;
+            } else if (arg.rfind("--dict=", 0) == 0) {
+                std::ifstream in(value("--dict="), std::ios::binary);
+                if (!in) throw std::runtime_error("cannot read dictionary " + value("--dict="));
+                opts.dictionary.assign(std::istreambuf_iterator<char>(in), {});
+            } else {
+                usage();
+                return 1;
+            }
+        }
+
+        slp::pipeline::ByteThrottle throttle(max_mbps * 1024 * 1024);
+        opts.throttle = &throttle;
+        ScrubLog log(report_path, resume);
+
+        slp::pipeline::StoreListing listing;
+        listing.roots = prefixes;
+        for (const auto& root : prefixes) walk(filer, root, listing.objects);
+
+        std::vector<std::string> manifests;
+        std::vector<std::string> objects;
+        size_t total = 0;
+        for (const auto& [path, size] : listing.objects) {
+            if (!slp::pipeline::manifest_model_hash(path).empty()) {
+                manifests.push_back(path);
+            } else if (!log.done(path)) {
+                objects.push_back(path);
+            }
+            if (!log.done(path)) total++;
+        }
+        std::cerr << "scrub: " << listing.objects.size() << " objects under " << prefixes.size()
+                  << " prefixes; " << log.resumed() << " already verified\n";
+
+        // Manifests first: they are small, and whole models are checked
+        // against the size they record. They are re-read on resume for the
+        // sizes even when their own verdict is already in the report.
+        std::map<std::string, uint64_t> model_sizes;
+        std::mutex sizes_mu;
+        slp::parallel_for(manifests.size(), threads, [&](size_t i) {
+            std::optional<slp::artifact::Manifest> manifest;
+            auto results = slp::pipeline::scrub_manifest(filer, manifests[i], listing, opts, manifest);
+            if (manifest && manifest->chunks.empty()) {
+                std::lock_guard<std::mutex> lock(sizes_mu);
+                model_sizes[slp::artifact::model_path(manifest->sha256)] = manifest->size_bytes;
+            }
+            for (const auto& r : results) {
+                if (!log.done(r.path)) log.record(r, total);
+            }
+        });
+
+        slp::parallel_for(objects.size(), threads, [&](size_t i) {
+            std::optional<uint64_t> expected_size;
+            auto it = model_sizes.find(objects[i]);
+            if (it != model_sizes.end()) expected_size = it->second;
+            log.record(slp::pipeline::scrub_object(filer, objects[i], opts, expected_size), total);
+        });
+
+        return log.print_summary(report_path);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
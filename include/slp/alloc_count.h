@@ -0,0 +1,22 @@
+#pragma once
+#include <cstdint>
+
+// Heap allocation counters for checking that a hot loop has stopped
+// allocating. A program that calls any of these gets a counting global
+// operator new (it lives in the same object file); the cost is one
+// thread-local increment per allocation. Counts are per thread.
+
+namespace slp {
+
+// operator new calls made by this thread so far
+uint64_t thread_allocations();
+
+// malloc/calloc/realloc/strdup calls libcurl made on this thread; only
+// counted after init_curl_counting_allocations()
+uint64_t thread_curl_allocations();
+
+// curl_global_init(CURL_GLOBAL_DEFAULT) with libcurl's allocator routed
+// through the counter; call it instead of curl_global_init
+void init_curl_counting_allocations();
+
+} // namespace slp
@@ -0,0 +1,27 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace slp::artifact {
+
+// FastCDC parameters. Boundaries depend only on content, so an edit to one
+// region of a file leaves the chunks of the other regions unchanged.
+struct ChunkerParams {
+  size_t min_size = 256 * 1024;
+  size_t avg_size = 1024 * 1024;  // must be a power of two
+  size_t max_size = 4 * 1024 * 1024;
+};
+
+struct ChunkSpan {
+  uint64_t offset = 0;
+  uint64_t size = 0;
+};
+
+// Length of the chunk starting at `data` (at most `len`)
+size_t next_chunk_length(const uint8_t* data, size_t len, const ChunkerParams& params = {});
+
+// Split a buffer into content-defined chunks covering it end to end
+std::vector<ChunkSpan> chunk_buffer(const uint8_t* data, size_t len, const ChunkerParams& params = {});
+
+} // namespace slp::artifact
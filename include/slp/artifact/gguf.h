@@ -0,0 +1,73 @@
+#pragma once
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "slp/artifact/manifest.h"
+
+// GGUF header reader: parses the header, KV metadata and tensor info table
+// from a prefix of the file, without touching tensor data.
+
+namespace slp::artifact {
+
+enum class GgufValueType : uint32_t {
+  uint8 = 0, int8 = 1, uint16 = 2, int16 = 3, uint32 = 4, int32 = 5,
+  float32 = 6, boolean = 7, string = 8, array = 9, uint64 = 10, int64 = 11,
+  float64 = 12,
+};
+
+struct GgufKeyValue {
+  std::string key;
+  GgufValueType type = GgufValueType::uint8;
+  // Scalars and strings rendered as text. Arrays keep only their element
+  // type and length (tokenizer vocabularies alone can be megabytes).
+  std::string value;
+  GgufValueType array_type = GgufValueType::uint8;
+  uint64_t array_len = 0;
+};
+
+struct GgufTensorInfo {
+  std::string name;
+  std::vector<uint64_t> shape;  // ne[0] first, as stored
+  uint32_t type = 0;            // ggml_type
+  uint64_t offset = 0;          // relative to the start of the data section
+  uint64_t size_bytes = 0;      // 0 if the ggml type is unknown
+};
+
+struct GgufHeader {
+  uint32_t version = 0;
+  uint64_t alignment = 32;
+  uint64_t data_offset = 0;  // absolute file offset of the tensor data section
+  std::vector<GgufKeyValue> metadata;
+  std::vector<GgufTensorInfo> tensors;
+
+  const GgufKeyValue* find(const std::string& key) const;
+  std::string get_string(const std::string& key, const std::string& def = "") const;
+};
+
+// Thrown when the buffer ends before the header does. `needed` is a lower
+// bound on the prefix length required to make progress.
+class GgufTruncated : public std::runtime_error {
+public:
+  explicit GgufTruncated(uint64_t needed_bytes)
+      : std::runtime_error("GGUF header truncated"), needed(needed_bytes) {}
+  uint64_t needed;
+};
+
+bool is_gguf(const uint8_t* data, size_t len);
+
+// Parse a file prefix; throws GgufTruncated if it is too short and
+// std::runtime_error if it is not a valid GGUF v2/v3 header.
+GgufHeader parse_gguf_header(const uint8_t* data, size_t len);
+
+// ggml type name ("F16", "Q4_K", ...) or "type<N>" when unknown
+std::string ggml_type_name(uint32_t type);
+
+// Size in bytes of a tensor of the given type and shape; 0 if unknown
+uint64_t ggml_tensor_bytes(uint32_t type, const std::vector<uint64_t>& shape);
+
+// Record the tensor index of `header` in `manifest`
+void add_gguf_index(Manifest& manifest, const GgufHeader& header);
+
+} // namespace slp::artifact
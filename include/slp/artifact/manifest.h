@@ -1,15 +1,42 @@
 #pragma once
+#include <cstdint>
 #include <string>
+#include <vector>
 
 namespace slp::artifact {
 
+// One content-defined chunk of an artifact, stored at /chunks/<sha256>
+struct ChunkRef {
+  std::string sha256;
+  uint64_t offset = 0;
+  uint64_t size = 0;
+};
+
+// One tensor of a GGUF artifact, so single tensors can be fetched by range
+struct TensorRef {
+  std::string name;
+  std::string type;             // ggml type name, e.g. "Q4_K"
+  std::vector<uint64_t> shape;
+  uint64_t offset = 0;          // absolute file offset
+  uint64_t size = 0;
+};
+
 struct Manifest {
   std::string sha256;
   uint64_t size_bytes = 0;
   std::string created_at;
   std::string original_name;
+  std::string codec = "none";  // encoding of the stored object body
+  std::vector<ChunkRef> chunks;  // empty when stored as one whole object
+
+  // GGUF index; gguf_version stays 0 for other artifacts
+  uint32_t gguf_version = 0;
+  std::string gguf_architecture;
+  uint64_t gguf_header_bytes = 0;  // prefix holding header, KV and tensor table
+  std::vector<TensorRef> tensors;
 
   std::string to_json() const;
+  static Manifest from_json(const std::string& json);
 };
 
 } // namespace slp::artifact
@@ -0,0 +1,115 @@
+#pragma once
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Packs: many small content-addressed objects appended into one filer
+// object, so storing a thousand prompt sets or result files costs one
+// object's metadata and one PUT. A trailing index lists each member's
+// sha256, offset and size; a reader fetches the index once, from the tail
+// of the pack, and then reads single members with Range requests.
+//
+// Layout (little-endian):
+//   member bytes sorted by hash | IndexEntry[count] | Footer (32 bytes)
+// The pack id is the sha256 of the index bytes. Members are laid out in
+// hash order whatever order they were added in, so identical member sets
+// produce the same pack.
+
+namespace slp::artifact {
+
+struct PackEntry {
+  std::string sha256;  // 64 lowercase hex chars
+  uint64_t offset = 0;
+  uint64_t size = 0;
+};
+
+// Collects members in memory and serialises them as one pack. Adding the
+// same content twice stores it once.
+class PackWriter {
+public:
+  // Returns the member's sha256
+  std::string add(const std::vector<uint8_t>& data);
+  std::string add(const uint8_t* data, size_t len);
+
+  size_t members() const { return entries_.size(); }
+  // Bytes of member data so far; the index adds 48 bytes per member
+  uint64_t data_bytes() const { return data_.size(); }
+
+  // Pack bytes and id; the writer is left empty for the next pack
+  struct Finished {
+    std::string pack_id;
+    std::vector<uint8_t> bytes;
+    std::vector<PackEntry> entries;  // sorted by hash
+  };
+  Finished finish();
+
+private:
+  std::vector<uint8_t> data_;
+  std::vector<PackEntry> entries_;
+  std::unordered_set<std::string> hashes_;
+};
+
+class PackIndex {
+public:
+  // Parse from the last `tail.size()` bytes of a pack of `pack_size` bytes.
+  // Throws if the tail is not a pack footer or does not hold the whole index.
+  static PackIndex parse(const std::string& pack_id, const std::vector<uint8_t>& tail, uint64_t pack_size);
+  // Bytes needed from the end of the pack to parse the index, as recorded
+  // in the footer at the end of `tail`
+  static uint64_t tail_bytes_needed(const std::vector<uint8_t>& tail);
+
+  const std::string& pack_id() const { return pack_id_; }
+  const std::vector<PackEntry>& entries() const { return entries_; }
+  std::optional<PackEntry> find(const std::string& sha256) const;
+
+private:
+  std::string pack_id_;
+  std::vector<PackEntry> entries_;  // sorted by hash
+};
+
+// Upload a finished pack to /packs/<pack_id>.pack; throws on failure
+void put_pack(const std::string& filer_base, const PackWriter::Finished& pack);
+
+// Fetch a pack's index: its size with HEAD, then one Range read of the tail
+// (two if the index is larger than the first guess)
+PackIndex fetch_pack_index(const std::string& filer_base, const std::string& pack_id);
+
+// Read one member with a Range request and verify it against its hash
+std::vector<uint8_t> read_pack_member(const std::string& filer_base, const std::string& pack_id,
+                                      const PackEntry& entry);
+
+// Recently used pack indexes, so repeated member reads cost one Range
+// request each. Thread-safe.
+class PackIndexCache {
+public:
+  explicit PackIndexCache(size_t capacity = 64) : capacity_(capacity) {}
+
+  // Cached index, fetching it on a miss
+  std::shared_ptr<const PackIndex> get(const std::string& filer_base, const std::string& pack_id);
+
+  // Member `sha256` of pack `pack_id`; throws if the pack does not hold it
+  std::vector<uint8_t> read(const std::string& filer_base, const std::string& pack_id, const std::string& sha256);
+
+  size_t size() const;
+  uint64_t hits() const;
+  uint64_t misses() const;
+
+private:
+  using Key = std::string;  // filer_base + " " + pack_id
+  using Lru = std::list<std::pair<Key, std::shared_ptr<const PackIndex>>>;
+
+  size_t capacity_;
+  mutable std::mutex mu_;
+  Lru lru_;  // most recently used first
+  std::unordered_map<Key, Lru::iterator> map_;
+  uint64_t hits_ = 0;
+  uint64_t misses_ = 0;
+};
+
+} // namespace slp::artifact
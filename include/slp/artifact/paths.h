@@ -0,0 +1,25 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+// Canonical filer layout for content-addressed artifacts
+
+namespace slp::artifact {
+
+std::string model_path(const std::string& hash);           // /models/<hash>.gguf
+std::string model_manifest_path(const std::string& hash);  // /models/<hash>.manifest.json
+std::string prompts_path(const std::string& hash);         // /prompts/<hash>.jsonl
+std::string chunk_path(const std::string& hash);           // /chunks/<hash>
+std::string pack_path(const std::string& pack_id);         // /packs/<pack_id>.pack
+std::string run_results_path(const std::string& run_id);   // /runs/<run_id>/results.jsonl
+std::string run_metrics_path(const std::string& run_id);   // /runs/<run_id>/metrics.json
+
+// Sharded runs (pipeline/shards.h). Shard ids are zero-padded so that
+// listings come back in shard order.
+std::string run_shard_plan_path(const std::string& run_id);                  // /runs/<run_id>/shards.json
+std::string run_leases_dir(const std::string& run_id);                       // /runs/<run_id>/leases/
+std::string run_lease_path(const std::string& run_id, uint32_t shard);       // .../leases/<shard>
+std::string run_shard_results_dir(const std::string& run_id);                // /runs/<run_id>/shards/
+std::string run_shard_results_path(const std::string& run_id, uint32_t shard);  // .../shards/<shard>.jsonl
+
+} // namespace slp::artifact
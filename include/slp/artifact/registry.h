@@ -0,0 +1,108 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Artifact registry: name/tag -> content hash, backed by an immutable sorted
+// table that is mmap'd and binary-searched, plus an in-memory delta (mirrored
+// to an append-only journal) that is periodically compacted into a new table.
+// Removals are kept as timestamped tombstones in both, so a sync between
+// nodes can tell a deleted entry from one the other side never had.
+
+namespace slp::artifact {
+
+struct RegistryEntry {
+  std::string name;
+  std::string tag = "latest";
+  std::string sha256;  // 64 lowercase hex chars
+  uint64_t size_bytes = 0;
+  int64_t created_unix = 0;
+  // Tombstone: removed at created_unix. Only tables and the journal hold
+  // these; lookups never return one.
+  bool deleted = false;
+};
+
+// Split "name[:tag]" into name and tag ("latest" when omitted)
+std::pair<std::string, std::string> split_ref(const std::string& ref);
+
+class Registry {
+public:
+  // Opens <dir>/registry.idx if present and replays <dir>/registry.log
+  explicit Registry(std::string dir);
+  ~Registry();
+
+  Registry(const Registry&) = delete;
+  Registry& operator=(const Registry&) = delete;
+
+  void put(const RegistryEntry& entry);
+  bool remove(const std::string& name, const std::string& tag);
+
+  std::optional<RegistryEntry> find(const std::string& name, const std::string& tag) const;
+
+  // "name[:tag]", or a hash prefix of at least 4 hex chars. Throws if the
+  // prefix matches more than one distinct hash.
+  std::optional<RegistryEntry> resolve(const std::string& ref) const;
+
+  // Every tag of one name, sorted by tag
+  std::vector<RegistryEntry> list(const std::string& name) const;
+
+  // Entries whose hash starts with `hex_prefix`, at most `limit`
+  std::vector<RegistryEntry> find_by_hash_prefix(const std::string& hex_prefix, size_t limit = 16) const;
+
+  // All live entries sorted by name and tag
+  std::vector<RegistryEntry> all() const;
+
+  // Records in the table file, tombstones included
+  size_t table_size() const;
+  size_t delta_size() const { return delta_.size(); }
+
+  // Merge the journal into a new table file, swap it in and clear the journal
+  void compact();
+
+  // Sync the whole index as one filer object (/registry/index.slpreg).
+  // pull folds the journal into the table and merges the remote table into
+  // it: for a name:tag both have, the newer of the two entries or
+  // tombstones wins. Returns false if there is no remote copy. push pulls
+  // and uploads with If-Match on the ETag it merged, starting over if
+  // another publisher got there first.
+  bool pull(const std::string& filer_base);
+  void push(const std::string& filer_base);
+
+  // Deltas beyond this many entries trigger compaction on put()
+  static constexpr size_t kAutoCompactThreshold = 4096;
+
+  // Write a table file from entries (tombstones included) in any order
+  static void write_table(const std::string& path, std::vector<RegistryEntry> entries);
+
+private:
+  class Table;
+
+  using Key = std::pair<std::string, std::string>;
+  // A deleted value is a tombstone hiding a table entry
+  using Delta = std::map<Key, RegistryEntry>;
+
+  // The callers below hold the directory lock
+  void append_journal(const std::string& line);
+  void replay_journal();
+  void reopen_table();
+  void reload();  // table and journal as they are on disk now
+  void compact_locked();
+  void merge_table(const std::vector<uint8_t>& bytes);
+  // Live entries and tombstones sorted by name and tag; the delta wins
+  std::vector<RegistryEntry> records() const;
+
+  // Live entries whose hash starts with `hex_prefix`, until `visit` returns false
+  void visit_hash_prefix(const std::string& hex_prefix,
+                         const std::function<bool(const RegistryEntry&)>& visit) const;
+
+  std::string dir_;
+  std::unique_ptr<Table> table_;
+  Delta delta_;
+};
+
+} // namespace slp::artifact
@@ -0,0 +1,128 @@
+#pragma once
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "slp/http_client.h"
+#include "slp/task.h"
+
+// Coroutine HTTP on a curl_multi + epoll event loop. An operation in flight
+// costs its coroutine frame and a curl easy handle, not a thread, so one
+// thread can keep thousands of requests outstanding. A loop and the clients
+// on it belong to the thread that runs it; use one loop per thread to
+// spread work over several cores.
+
+namespace slp {
+
+struct LoopOptions {
+  long max_connections = 0;           // across all hosts; 0 = unlimited
+  long max_host_connections = 0;      // per host; 0 = unlimited
+};
+
+class EventLoop {
+public:
+  explicit EventLoop(LoopOptions opts = {});
+  ~EventLoop();
+
+  EventLoop(const EventLoop&) = delete;
+  EventLoop& operator=(const EventLoop&) = delete;
+
+  // Start `task` and drive I/O and timers on this thread until it finishes
+  template <typename T>
+  T run(Task<T> task) {
+    auto h = task.handle_;
+    h.resume();
+    while (!h.done()) poll();
+    return h.promise().result();
+  }
+
+  struct SleepAwaiter {
+    EventLoop& loop;
+    std::chrono::steady_clock::time_point until;
+    bool await_ready() const noexcept { return until <= std::chrono::steady_clock::now(); }
+    void await_suspend(std::coroutine_handle<> h) { loop.timers_.emplace(until, h); }
+    void await_resume() const noexcept {}
+  };
+
+  // Suspend the calling coroutine without blocking the loop
+  SleepAwaiter sleep_for(std::chrono::milliseconds delay) {
+    return {*this, std::chrono::steady_clock::now() + delay};
+  }
+  SleepAwaiter sleep_until(std::chrono::steady_clock::time_point until) { return {*this, until}; }
+
+  size_t transfers_in_flight() const { return in_flight_; }
+
+private:
+  friend class AsyncHttpClient;
+  struct Transfer;
+
+  struct TransferAwaiter {
+    EventLoop& loop;
+    Transfer& transfer;
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> h);
+    void await_resume() const noexcept {}
+  };
+
+  // One epoll round: wait for socket activity or the next deadline, hand it
+  // to libcurl, then resume finished transfers and expired sleeps
+  void poll();
+  void finish_transfers();
+  void fire_timers();
+
+  void* acquire_handle();
+  void release_handle(void* easy);
+
+  static int socket_callback(void* easy, int fd, int what, void* userp, void* socketp);
+  static int timer_callback(void* multi, long timeout_ms, void* userp);
+
+  void* multi_;
+  int epoll_fd_;
+  bool curl_timer_armed_ = false;
+  std::chrono::steady_clock::time_point curl_deadline_{};
+  std::multimap<std::chrono::steady_clock::time_point, std::coroutine_handle<>> timers_;
+  std::vector<void*> idle_handles_;
+  size_t in_flight_ = 0;
+};
+
+struct HttpRequest {
+  std::string method = "GET";  // GET, HEAD, PUT or POST
+  std::string url;
+  std::vector<uint8_t> body;   // PUT/POST payload
+  std::vector<std::string> headers;
+  std::string range;           // "first-last" or "first-"; empty for none
+  long timeout_ms = 0;         // 0: no wall-clock cap, only stall limits
+  // Bandwidth class; unset, it follows the size rules of HttpClient
+  std::optional<TrafficClass> traffic_class;
+};
+
+// Non-blocking counterpart of HttpClient. Transport failures throw from the
+// awaiting coroutine; HTTP error statuses are returned in the response.
+// Under bandwidth limits a request waits on the loop until its buckets are
+// out of debt, then is charged for what it moved once it completes.
+class AsyncHttpClient {
+public:
+  explicit AsyncHttpClient(EventLoop& loop) : loop_(loop) {}
+
+  EventLoop& loop() { return loop_; }
+
+  Task<HttpResponse> send(HttpRequest request);
+
+  Task<HttpResponse> get(std::string url, long timeout_ms = 30000);
+  Task<HttpResponse> get_range(std::string url, uint64_t offset, uint64_t length,
+                               long timeout_ms = 30000);
+  Task<HttpResponse> head(std::string url, long timeout_ms = 30000);
+  Task<HttpResponse> put(std::string url, std::vector<uint8_t> data, std::string content_type,
+                         std::vector<std::string> extra_headers = {});
+  Task<HttpResponse> post(std::string url, std::vector<uint8_t> data, std::string content_type,
+                          std::vector<std::string> extra_headers = {}, long timeout_ms = 0);
+
+private:
+  EventLoop& loop_;
+};
+
+} // namespace slp
@@ -0,0 +1,62 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+
+// Trusted SHA256 of local files. A computed hash is stored with the file's
+// stat fingerprint and reused while the fingerprint is unchanged, so a large
+// model that has not been touched is not read again.
+
+namespace slp {
+
+// Identity and change markers of a file; any write, truncate, replace,
+// chmod or rename changes at least one field
+struct FileFingerprint {
+  uint64_t dev = 0;
+  uint64_t ino = 0;
+  uint64_t size = 0;
+  int64_t mtime_ns = 0;
+  int64_t ctime_ns = 0;
+
+  bool operator==(const FileFingerprint& o) const {
+    return dev == o.dev && ino == o.ino && size == o.size && mtime_ns == o.mtime_ns && ctime_ns == o.ctime_ns;
+  }
+  bool operator!=(const FileFingerprint& o) const { return !(*this == o); }
+};
+
+// Throws if `path` cannot be stat'ed
+FileFingerprint fingerprint_file(const std::string& path);
+
+struct FileHash {
+  std::string sha256;
+  bool reused = false;   // taken from the store without reading the file
+  bool stored = false;   // computed and recorded for next time
+};
+
+// Hashes recorded as one sidecar per file, <dir>/<dev>-<ino>.json, rather
+// than in an xattr: setting an xattr changes the file's ctime, and the
+// sidecar also works for read-only files and filesystems without xattrs.
+class HashCache {
+public:
+  explicit HashCache(std::string dir);
+
+  // Stored hash of `path` if its fingerprint still matches
+  std::optional<std::string> lookup(const std::string& path) const;
+
+  // Stored hash if still valid, else compute it (with `compute` if given,
+  // else by streaming the file) and record it. The result is not recorded
+  // if the file changed while it was read, or was modified so recently
+  // that a further write could leave the timestamps unchanged.
+  FileHash sha256(const std::string& path, const std::function<std::string()>& compute = {});
+
+  // Drop the stored hash of `path`, if any
+  void forget(const std::string& path);
+
+private:
+  std::string entry_path(const FileFingerprint& fp) const;
+
+  std::string dir_;
+};
+
+} // namespace slp
@@ -0,0 +1,55 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// Sequential file writer for large downloads. The default is plain pwrite
+// through the page cache. O_DIRECT keeps a freshly written multi-GB model
+// from evicting the page cache (including the llama-server mmap of the model
+// in use), and io_uring keeps several aligned writes in flight at once.
+
+namespace slp {
+
+struct FileWriterOptions {
+  bool direct = false;             // O_DIRECT: bypass the page cache
+  bool io_uring = false;           // submit writes through io_uring
+  size_t buffer_size = 1 << 20;    // bytes per write; rounded up to kDirectAlignment
+  unsigned queue_depth = 4;        // writes in flight (io_uring only)
+};
+
+// Offset/length alignment O_DIRECT needs on the filesystems we target
+inline constexpr size_t kDirectAlignment = 4096;
+
+// True if this build has io_uring support and the kernel allows it
+bool io_uring_available();
+
+class FileWriter {
+public:
+  virtual ~FileWriter() = default;
+
+  // Append bytes at the current offset
+  virtual void write(const uint8_t* data, size_t len) = 0;
+
+  // Flush outstanding writes, cut the file to its exact size and close it
+  virtual void finish() = 0;
+
+  virtual uint64_t offset() const = 0;
+
+  // What is actually in effect, e.g. "io_uring+O_DIRECT qd=4 buf=1024K";
+  // differs from the options when O_DIRECT or io_uring was unavailable
+  virtual std::string describe() const = 0;
+};
+
+// Open `path` for writing from `start_offset` on; bytes past it are dropped.
+// Direct writers need an aligned start offset (callers resuming a partial
+// file round down to kDirectAlignment and re-fetch the tail).
+std::unique_ptr<FileWriter> open_file_writer(const std::string& path,
+                                             uint64_t start_offset,
+                                             const FileWriterOptions& options = {});
+
+// Parse "--write=" style specs: "buffered", "direct", "uring" or
+// "uring+direct", optionally followed by ":qd=<n>" and ":buf=<KiB>"
+FileWriterOptions parse_write_spec(const std::string& spec);
+
+} // namespace slp
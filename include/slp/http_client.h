@@ -1,12 +1,36 @@
 #pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "slp/transfer_scheduler.h"
+
 namespace slp {
 
+// Bulk transfers have no wall-clock cap; they fail only when they stall,
+// i.e. move fewer than kLowSpeedBytesPerSec for kLowSpeedSeconds.
+inline constexpr long kConnectTimeoutMs = 10000;
+inline constexpr long kLowSpeedBytesPerSec = 1024;
+inline constexpr long kLowSpeedSeconds = 60;
+
 struct HttpResponse {
   long status = 0;
   std::vector<uint8_t> body;
+  std::vector<std::pair<std::string, std::string>> headers;
+  int64_t first_byte_us = 0;  // request start to first response byte
+
+  // Case-insensitive header lookup; empty string when absent
+  std::string header(const std::string& name) const;
+};
+
+// Lets another thread watch and abort an in-flight request (hedging)
+struct TransferControl {
+  std::atomic<bool> cancel{false};     // set to abort the transfer
+  std::atomic<bool> responded{false};  // set once body bytes arrive
 };
 
 class HttpClient {
@@ -14,13 +38,50 @@ public:
   HttpClient();
   ~HttpClient();
 
-  HttpResponse get(const std::string& url) const;
+  // Attach to every following request; nullptr detaches
+  void set_control(TransferControl* control) { control_ = control; }
+  // Bandwidth class of following requests (see transfer_scheduler.h).
+  // Unset, HEADs and small ranges or PUTs are interactive, streamed bodies
+  // and large ranges or PUTs bulk, and plain GETs normal.
+  void set_traffic_class(std::optional<TrafficClass> cls) { class_ = cls; }
+
+  HttpResponse get(const std::string& url, long timeout_ms = 30000,
+                   const std::vector<std::string>& extra_headers = {}) const;
+  // GET bytes [offset, offset + length); servers answer 206, or 200 with the
+  // whole body if they ignore ranges
+  HttpResponse get_range(const std::string& url, uint64_t offset, uint64_t length,
+                         long timeout_ms = 30000) const;
+  // Status and headers only; the body is not transferred
+  HttpResponse head(const std::string& url, long timeout_ms = 30000) const;
+  // Receives a 200/206 body piece by piece with its status; return false
+  // to abort the transfer
+  using BodySink = std::function<bool(long status, const uint8_t* data, size_t len)>;
+
+  // Stream the body from `offset` on (Range: bytes=<offset>-, plus If-Range
+  // when given) into `sink`. Error bodies are returned in the response.
+  HttpResponse get_stream(const std::string& url, uint64_t offset,
+                          const std::string& if_range, const BodySink& sink) const;
+  // Stream the body into `fd` from `offset` on (Range: bytes=<offset>-).
+  // With `if_range` (an ETag or Last-Modified value) a changed object comes
+  // back as 200; the file is then truncated and rewritten from zero. Error
+  // bodies are returned in the response instead of being written.
+  HttpResponse get_to_file(const std::string& url, int fd, uint64_t offset,
+                           const std::string& if_range = "") const;
   HttpResponse put(const std::string& url,
                    const std::vector<uint8_t>& data,
-                   const std::string& content_type);
+                   const std::string& content_type,
+                   const std::vector<std::string>& extra_headers = {});
+  // PUT `length` bytes of `fd` starting at `offset`, without buffering them
+  HttpResponse put_from_file(const std::string& url, int fd, uint64_t offset, uint64_t length,
+                             const std::string& content_type,
+                             const std::vector<std::string>& extra_headers = {});
 
 private:
+  TrafficClass traffic_class(TrafficClass fallback) const { return class_.value_or(fallback); }
+
   void* curl_;
+  TransferControl* control_ = nullptr;
+  std::optional<TrafficClass> class_;
 };
 
 } // namespace slp
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace slp::json {
+
+// Minimal JSON document model for reading manifests and server responses
+class Value {
+public:
+  enum class Type { null, boolean, number, string, array, object };
+
+  Value() = default;
+
+  Type type() const { return type_; }
+  bool is_null() const { return type_ == Type::null; }
+  bool is_object() const { return type_ == Type::object; }
+  bool is_array() const { return type_ == Type::array; }
+
+  bool as_bool() const { return bool_; }
+  double as_number() const { return number_; }
+  int64_t as_int() const { return integer_; }
+  uint64_t as_uint() const { return static_cast<uint64_t>(integer_); }
+  const std::string& as_string() const { return string_; }
+  const std::vector<Value>& as_array() const { return array_; }
+  const std::vector<std::pair<std::string, Value>>& as_object() const { return object_; }
+
+  // Object member lookup; nullptr when absent or this is not an object
+  const Value* find(const std::string& key) const;
+
+  // Typed member lookup with a fallback for missing or mistyped members
+  std::string get_string(const std::string& key, const std::string& def = "") const;
+  double get_number(const std::string& key, double def = 0.0) const;
+  int64_t get_int(const std::string& key, int64_t def = 0) const;
+  bool get_bool(const std::string& key, bool def = false) const;
+
+private:
+  friend class Parser;
+
+  Type type_ = Type::null;
+  bool bool_ = false;
+  double number_ = 0.0;
+  int64_t integer_ = 0;
+  std::string string_;
+  std::vector<Value> array_;
+  std::vector<std::pair<std::string, Value>> object_;
+};
+
+// Parse a complete JSON document; throws std::runtime_error on bad input
+Value parse(const std::string& text);
+
+// Escape a string for embedding between JSON double quotes
+std::string escape(const std::string& s);
+
+} // namespace slp::json
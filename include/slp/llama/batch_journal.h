@@ -0,0 +1,76 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+
+// Crash-safe progress for batch runs. Every prompt gets a stable id from
+// its line number and a hash of the line, and every result line written is
+// followed by a fixed-size journal record. A rerun reads the journal once
+// to learn which prompts are finished and how much of the results file is
+// intact, so it neither recomputes them nor re-reads the results.
+
+namespace slp::llama {
+
+struct PromptId {
+  uint64_t hash = 0;  // of the prompt's line in the prompts file
+  uint32_t line = 0;  // 1-based line number
+
+  bool operator==(const PromptId& o) const { return hash == o.hash && line == o.line; }
+  // "<16 hex digits>-<line>", as written in each result's "id" field
+  std::string str() const;
+};
+
+PromptId make_prompt_id(std::string_view line_text, uint32_t line);
+// Inverse of PromptId::str(); nullopt if `text` is not an id
+std::optional<PromptId> parse_prompt_id(std::string_view text);
+
+struct PromptIdHash {
+  size_t operator()(const PromptId& id) const { return static_cast<size_t>(id.hash ^ (uint64_t{id.line} << 32)); }
+};
+
+// Journal of a results file, kept beside it as <results>.journal: a magic
+// header, then one 24-byte record per result line (prompt id, whether it
+// succeeded, and the results file's length after that line). Records are
+// written only after their line is flushed, so the last record bounds the
+// part of the results file that is whole.
+class BatchJournal {
+public:
+  // Without `resume`, empties the results file and starts a new journal.
+  // With it, loads the journal and cuts the results file back to the last
+  // recorded line, dropping anything a crashed run wrote after it. If there
+  // is no journal, it is rebuilt from the "id" fields of the results file.
+  // Throws if the files cannot be opened or the journal is not one.
+  BatchJournal(const std::string& results_path, bool resume);
+  ~BatchJournal();
+
+  BatchJournal(const BatchJournal&) = delete;
+  BatchJournal& operator=(const BatchJournal&) = delete;
+
+  // Whether an earlier run finished `id` successfully; records added by
+  // this run are not looked up. Failed prompts are not done: a rerun tries
+  // them again and its line for them comes later.
+  bool succeeded(const PromptId& id) const { return succeeded_.count(id) > 0; }
+  size_t succeeded_count() const { return succeeded_.size(); }
+  bool rebuilt() const { return rebuilt_; }
+
+  // Length of the results file covered by the journal
+  uint64_t results_bytes() const { return results_bytes_; }
+
+  // Record a result line already flushed to the results file, which now
+  // ends at `results_end`. Throws if the record cannot be written.
+  void record(const PromptId& id, bool success, uint64_t results_end);
+
+private:
+  void load(uint64_t results_size);
+  void rebuild(const std::string& results_path);
+
+  std::string path_;
+  int fd_ = -1;
+  std::unordered_set<PromptId, PromptIdHash> succeeded_;
+  uint64_t results_bytes_ = 0;
+  bool rebuilt_ = false;
+};
+
+} // namespace slp::llama
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "slp/llama/timings.h"
+
+namespace slp::llama {
+
+// Outcome of one prompt in the batch tools
+struct InferenceResult {
+  std::string id;             // stable prompt id; written first when set
+  std::string prompt;
+  std::string content;
+  int max_tokens = 0;
+  int priority = 0;           // higher is dispatched first; written when nonzero
+  int64_t deadline_ms = -1;   // after the batch started; -1 for none
+  bool deadline_missed = false;
+  int64_t elapsed_us = 0;
+  int64_t ttfb_us = 0;      // request start to first response byte
+  ServerTimings timings;
+  bool success = false;
+  std::string error;
+  std::string timestamp;
+};
+
+// Escape for embedding between JSON double quotes
+std::string escape_json_string(const std::string& s);
+// Same, appended to `out`; allocates only if `out` has to grow
+void append_json_escaped(std::string& out, std::string_view s);
+
+// Raw (still escaped) value of the first "field": in a flat JSON response;
+// empty if absent. A quick scan, not a parser: it is what the batch loop
+// uses to pick the generated text out of a llama-server reply.
+std::string extract_json_field(const std::string& json, const std::string& field);
+// Same, as a view into `json`
+std::string_view find_json_field(std::string_view json, std::string_view field);
+
+// One line of results.jsonl
+std::string result_to_json(const InferenceResult& r);
+// Same, appended to `out`
+void append_result_json(std::string& out, const InferenceResult& r);
+
+} // namespace slp::llama
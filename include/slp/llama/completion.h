@@ -0,0 +1,34 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+#include "slp/async_http.h"
+#include "slp/llama/timings.h"
+
+namespace slp::llama {
+
+struct CompletionResult {
+  bool success = false;
+  long status = 0;         // HTTP status; 0 on transport failure
+  std::string content;
+  std::string error;
+  int64_t elapsed_us = 0;
+  ServerTimings timings;
+};
+
+// Request body for POST <url>/completion (non-streaming)
+std::string completion_request_body(const std::string& prompt, int n_predict);
+
+// Generated text from a /completion response; llama-server answers with
+// "content", other servers use "response", "completion" or "text"
+CompletionResult parse_completion_response(long status, const std::string& body);
+
+// POST <base_url>/completion on `http`'s event loop. Never throws for
+// transport or server errors; they are reported in the result.
+Task<CompletionResult> complete_async(AsyncHttpClient& http,
+                                      std::string base_url,
+                                      std::string prompt,
+                                      int n_predict,
+                                      long timeout_ms = 120000);
+
+} // namespace slp::llama
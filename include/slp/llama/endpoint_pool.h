@@ -0,0 +1,92 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace slp::llama {
+
+struct PoolOptions {
+  // Consecutive request failures before a backend is ejected
+  uint32_t max_consecutive_failures = 3;
+  // How long an ejected backend stays out before it may be health-checked back in
+  std::chrono::milliseconds eject_duration{10000};
+  // Background /health polling interval (0 disables the checker thread)
+  std::chrono::milliseconds health_interval{5000};
+  // Timeout of a single /health probe
+  long health_timeout_ms = 2000;
+};
+
+struct EndpointStats {
+  std::string url;
+  bool healthy = true;
+  uint32_t in_flight = 0;
+  uint64_t requests = 0;
+  uint64_t failures = 0;
+  uint64_t ejections = 0;
+  double mean_ms = 0.0;
+  double p50_ms = 0.0;
+  double p95_ms = 0.0;
+  double p99_ms = 0.0;
+};
+
+// Routes requests over several llama-server replicas using
+// least-outstanding-requests, ejecting backends that keep failing.
+class EndpointPool {
+public:
+  explicit EndpointPool(std::vector<std::string> urls, PoolOptions opts = {});
+  ~EndpointPool();
+
+  EndpointPool(const EndpointPool&) = delete;
+  EndpointPool& operator=(const EndpointPool&) = delete;
+
+  // Pick the healthy backend with the fewest requests in flight and mark one
+  // more request outstanding on it. Blocks while every backend is ejected.
+  size_t acquire();
+
+  // Complete a request started with acquire()
+  void release(size_t idx, bool success, int64_t elapsed_us);
+
+  // Make room to record this many latencies per backend, so release()
+  // does not allocate in a loop of known length
+  void reserve(size_t requests_per_backend);
+
+  const std::string& url(size_t idx) const { return backends_[idx].url; }
+  size_t size() const { return backends_.size(); }
+
+  // Probe GET <url>/health on every backend and update ejection state
+  void check_health();
+
+  std::vector<EndpointStats> stats() const;
+
+private:
+  struct Backend {
+    std::string url;
+    bool healthy = true;
+    std::chrono::steady_clock::time_point ejected_until{};
+    uint32_t in_flight = 0;
+    uint32_t consecutive_failures = 0;
+    uint64_t requests = 0;
+    uint64_t failures = 0;
+    uint64_t ejections = 0;
+    std::vector<int64_t> latencies_us;
+  };
+
+  void eject_locked(Backend& b);
+  void health_loop();
+
+  PoolOptions opts_;
+  std::vector<Backend> backends_;
+  mutable std::mutex mu_;
+  std::condition_variable cv_;
+  bool stop_ = false;
+  std::thread health_thread_;
+};
+
+// Split a comma-separated endpoint list ("http://a:9080,http://b:9081")
+std::vector<std::string> parse_endpoint_list(const std::string& list);
+
+} // namespace slp::llama
@@ -0,0 +1,80 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "slp/async_http.h"
+#include "slp/task.h"
+
+// Request cost estimates for running short prompts first. The cost of a
+// completion is its prompt tokens (prefill) plus its n_predict (decode);
+// prompt token counts come from llama-server's /tokenize, a cache of earlier
+// counts, or a local estimate. Counts only decide the order prompts are
+// sent in, so a stale or estimated count costs latency, never correctness.
+
+namespace slp::llama {
+
+// Local stand-in for a BPE tokenizer: about one token per four bytes of
+// each whitespace-separated word
+int estimate_prompt_tokens(std::string_view text);
+
+// Relative cost of one request. Prefill runs the whole prompt in one
+// batched pass while decode needs a forward pass per generated token, so a
+// generated token costs many prompt tokens.
+struct CostModel {
+  double prompt_token = 1.0;
+  double output_token = 20.0;
+};
+
+double job_cost(int prompt_tokens, int n_predict, const CostModel& model = {});
+
+// Prompt token counts kept across runs in an append-only file of
+// "<key> <tokens>" lines, keyed by the tokenizer (the server URL) and the
+// prompt text. Thread-safe.
+class TokenCountCache {
+public:
+  // Loads `path` if it exists; an empty path keeps counts in memory only
+  explicit TokenCountCache(std::string path = "");
+
+  static std::string key(std::string_view tokenizer, std::string_view text);
+
+  std::optional<int> get(const std::string& key) const;
+  // Remembered, and appended to the file; write errors are ignored
+  void put(const std::string& key, int tokens);
+
+  size_t size() const;
+
+private:
+  std::string path_;
+  mutable std::mutex mu_;
+  std::unordered_map<std::string, int> counts_;
+  std::ofstream out_;  // opened on the first put
+};
+
+// POST <base_url>/tokenize and count the tokens; -1 if the request fails
+// or the server has no such endpoint
+Task<int> count_tokens_async(AsyncHttpClient& http, std::string base_url, std::string text,
+                             long timeout_ms = 10000);
+
+struct TokenCountReport {
+  size_t cached = 0;     // found in the cache
+  size_t tokenized = 0;  // counted by the server
+  size_t estimated = 0;  // local estimate
+  double seconds = 0.0;
+};
+
+// Prompt token counts for `texts`: from the cache, else from /tokenize on
+// `base_url` with up to `concurrency` requests in flight, else the local
+// estimate. An empty `base_url`, or a first /tokenize that fails, means
+// estimates for every prompt not cached. Server counts are added to the
+// cache.
+std::vector<int> count_prompt_tokens(const std::vector<std::string>& texts, const std::string& base_url,
+                                     TokenCountCache& cache, size_t concurrency,
+                                     TokenCountReport* report = nullptr);
+
+} // namespace slp::llama
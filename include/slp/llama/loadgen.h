@@ -0,0 +1,88 @@
+#pragma once
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "slp/async_http.h"
+#include "slp/task.h"
+
+// Open-loop load generation against llama-server. Requests are sent on a
+// schedule fixed before the run starts, whether or not earlier requests
+// have finished, so a slow server builds a queue instead of slowing the
+// client down. Latency is measured from the scheduled send time, which
+// keeps queueing in the numbers even when the client itself falls behind
+// (coordinated omission).
+
+namespace slp::llama {
+
+struct LoadPrompt {
+  std::string prompt;
+  int max_tokens = 50;
+};
+
+// Prompts from a JSONL file of {"prompt": ..., "max_tokens": ...} lines;
+// blank lines and lines starting with '#' are skipped. Throws if the file
+// cannot be read or holds no prompts.
+std::vector<LoadPrompt> load_prompts(const std::string& path);
+
+// As above for a JSONL body already in memory, which may hold no prompts;
+// `source` names it in errors
+std::vector<LoadPrompt> parse_prompts(const std::string& jsonl, const std::string& source);
+
+// Send times, in seconds from the start of a run
+
+// Poisson arrivals at `rate` requests/s over `duration_s`
+std::vector<double> poisson_arrivals(double rate, double duration_s, std::mt19937_64& rng);
+
+// One send time per line, in seconds from the start; '#' comments and blank
+// lines are skipped. Throws unless the times are non-negative and sorted.
+std::vector<double> read_trace(const std::string& path);
+
+// `arrivals` stretched or compressed in time to average `rate` requests/s
+std::vector<double> scale_to_rate(const std::vector<double>& arrivals, double rate);
+
+struct LatencySummary {
+  double mean_ms = 0.0;
+  double p50_ms = 0.0;
+  double p90_ms = 0.0;
+  double p99_ms = 0.0;
+  double p999_ms = 0.0;
+  double max_ms = 0.0;
+};
+
+// Sorts `us` in place
+LatencySummary summarize_latencies(std::vector<int64_t>& us);
+
+struct OpenLoopOptions {
+  std::vector<std::string> urls;  // llama-server base URLs, used round-robin
+  long timeout_ms = 60000;
+};
+
+struct OpenLoopResult {
+  double offered_rate = 0.0;      // scheduled requests per second
+  double achieved_rate = 0.0;     // successful completions per second of run time
+  double duration_s = 0.0;        // first scheduled send to last completion
+  uint64_t requests = 0;
+  uint64_t failures = 0;
+  std::string first_error;
+  LatencySummary latency;         // scheduled send -> response (successes)
+  LatencySummary service;         // actual send -> response (successes)
+  double mean_send_lag_ms = 0.0;  // how late sends left the client
+  double max_send_lag_ms = 0.0;
+  int64_t predicted_tokens = 0;   // from the server's timings
+  double mean_server_ms = 0.0;
+
+  double error_rate() const {
+    return requests > 0 ? static_cast<double>(failures) / static_cast<double>(requests) : 0.0;
+  }
+};
+
+// Send prompts[i % prompts.size()] at arrivals[i] seconds after the run
+// starts and wait for every response. Runs on `http`'s event loop.
+Task<OpenLoopResult> run_open_loop(AsyncHttpClient& http,
+                                   const std::vector<double>& arrivals,
+                                   const std::vector<LoadPrompt>& prompts,
+                                   const OpenLoopOptions& opts);
+
+} // namespace slp::llama
@@ -0,0 +1,71 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace slp::llama {
+
+// What llama-server reports about one completion ("timings" plus the
+// token counts next to it). Servers that send none leave `present` false.
+struct ServerTimings {
+  bool present = false;
+  int64_t tokens_predicted = 0;
+  int64_t tokens_evaluated = 0;   // prompt tokens, cached ones included
+  int64_t prompt_n = 0;           // prompt tokens actually processed
+  double prompt_ms = 0.0;
+  int64_t predicted_n = 0;
+  double predicted_ms = 0.0;
+
+  double server_ms() const { return prompt_ms + predicted_ms; }
+};
+
+// Pull the timings out of a /completion response body (or the final event
+// of a stream) without allocating
+ServerTimings parse_server_timings(std::string_view response);
+
+// Append `"tokens_predicted":..,"tokens_evaluated":..,"timings":{...}` to
+// `out`; nothing if the timings are absent
+void append_timings_json(std::string& out, const ServerTimings& t);
+
+// Where the time of a batch of requests went. A request's wall time splits
+// into server compute (prefill + decode), queueing (time to first byte not
+// spent computing: waiting for a slot, plus the network), and client time
+// (everything else: waiting for a backend, sending, receiving, parsing,
+// writing results). Sums only, so add() never allocates.
+class ThroughputStats {
+public:
+  void add(const ServerTimings& t, int64_t wall_us, int64_t ttfb_us);
+
+  uint64_t requests() const { return requests_; }
+  uint64_t requests_with_timings() const { return timed_; }
+  int64_t prompt_tokens() const { return prompt_tokens_; }
+  int64_t predicted_tokens() const { return predicted_tokens_; }
+
+  // Per-request server speeds: tokens over the server's own compute time
+  double prefill_tokens_per_sec() const;
+  double decode_tokens_per_sec() const;
+
+  // Means over requests with timings, in milliseconds
+  double mean_wall_ms() const;
+  double mean_server_ms() const;
+  double mean_queue_ms() const;
+  double mean_client_ms() const;
+  // Wall time minus server compute
+  double mean_overhead_ms() const { return mean_wall_ms() - mean_server_ms(); }
+
+  // "compute", "queue" or "client": whichever share of wall time is largest
+  const char* bound() const;
+
+private:
+  uint64_t requests_ = 0;
+  uint64_t timed_ = 0;
+  int64_t prompt_tokens_ = 0;
+  int64_t predicted_tokens_ = 0;
+  double prompt_ms_ = 0.0;
+  double predicted_ms_ = 0.0;
+  double wall_ms_ = 0.0;        // over timed requests
+  double queue_ms_ = 0.0;
+  double client_ms_ = 0.0;
+};
+
+} // namespace slp::llama
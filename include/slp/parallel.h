@@ -0,0 +1,48 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace slp {
+
+// Run fn(i) for i in [0, n) on up to `workers` threads. The first exception
+// thrown by any call stops further work and is rethrown to the caller.
+template <typename Fn>
+void parallel_for(size_t n, size_t workers, Fn&& fn) {
+  workers = std::max<size_t>(1, std::min(workers, n));
+  if (workers == 1) {
+    for (size_t i = 0; i < n; ++i) fn(i);
+    return;
+  }
+
+  std::atomic<size_t> next{0};
+  std::atomic<bool> failed{false};
+  std::exception_ptr error;
+  std::mutex error_mu;
+
+  auto run = [&]() {
+    for (size_t i = next++; i < n && !failed; i = next++) {
+      try {
+        fn(i);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(error_mu);
+        if (!error) error = std::current_exception();
+        failed = true;
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(workers - 1);
+  for (size_t t = 1; t < workers; ++t) threads.emplace_back(run);
+  run();
+  for (auto& t : threads) t.join();
+
+  if (error) std::rethrow_exception(error);
+}
+
+} // namespace slp
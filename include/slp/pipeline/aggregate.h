@@ -0,0 +1,120 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "slp/json.h"
+
+// Metrics across many runs' results.jsonl. Result objects are fetched
+// concurrently on an event loop and parsed on a thread pool; each run is
+// reduced to mergeable per-date partials, which are cached locally against
+// the object's ETag so that aggregating again only reads new or changed runs.
+
+namespace slp::pipeline {
+
+// Latency histogram with four buckets per doubling (about 19% wide),
+// from 1 us up; fixed buckets keep histograms of different runs mergeable
+class LatencyHistogram {
+public:
+  static constexpr size_t kBuckets = 160;
+
+  void add(double ms);
+  void merge(const LatencyHistogram& other);
+
+  uint64_t count() const { return count_; }
+  // Upper bound of the bucket holding the p-th quantile, in ms
+  double percentile_ms(double p) const;
+  static double bucket_upper_ms(size_t bucket);
+
+  // Sparse [[bucket, count], ...]
+  std::string to_json() const;
+  static LatencyHistogram from_json(const json::Value& v);
+  // Sparse [[upper_ms, count], ...], for reports
+  std::string to_report_json() const;
+
+private:
+  std::array<uint64_t, kBuckets> buckets_{};
+  uint64_t count_ = 0;
+};
+
+struct GroupStats {
+  uint64_t runs = 0;
+  uint64_t requests = 0;
+  uint64_t successes = 0;
+  double latency_sum_ms = 0.0;   // successful requests
+  double latency_max_ms = 0.0;
+  LatencyHistogram latency;
+  uint64_t timed = 0;            // successes that carried server timings
+  int64_t prompt_tokens = 0;
+  double prompt_ms = 0.0;
+  int64_t predicted_tokens = 0;
+  double predicted_ms = 0.0;
+
+  // One results.jsonl line; false if it is not a result line
+  bool add_line(std::string_view line);
+  void merge(const GroupStats& other);
+
+  std::string to_json() const;
+  static GroupStats from_json(const json::Value& v);
+};
+
+// What one run contributes: its identity and per-date partials
+struct RunAggregate {
+  std::string run_id;
+  std::string validator;      // ETag and size of the results object
+  std::string model_hash;     // from the run's metrics.json, else "unknown"
+  std::string prompts_hash;   // from metrics.json or shards.json, else "unknown"
+  std::map<std::string, GroupStats> by_date;  // YYYY-MM-DD of each result's timestamp
+  uint64_t bad_lines = 0;
+
+  std::string to_json() const;
+  static RunAggregate from_json(const std::string& line);
+};
+
+// Reduce a results.jsonl body
+void aggregate_results(std::string_view jsonl, RunAggregate& run);
+
+struct AggregateKey {
+  std::string model_hash;
+  std::string prompts_hash;
+  std::string date;
+
+  bool operator<(const AggregateKey& o) const {
+    if (model_hash != o.model_hash) return model_hash < o.model_hash;
+    if (prompts_hash != o.prompts_hash) return prompts_hash < o.prompts_hash;
+    return date < o.date;
+  }
+};
+
+struct AggregateOptions {
+  std::string filer_base;
+  std::string run_prefix;           // only runs whose id starts with this
+  size_t fetch_concurrency = 16;    // requests in flight
+  size_t parse_threads = 0;         // 0: hardware concurrency
+  std::string cache_path;           // "" disables the cache
+};
+
+struct AggregateReport {
+  std::map<AggregateKey, GroupStats> groups;
+  uint64_t runs = 0;          // runs with results
+  uint64_t runs_cached = 0;   // taken from the cache unchanged
+  uint64_t runs_pending = 0;  // no results.jsonl yet
+  uint64_t runs_failed = 0;   // could not be read; see `errors`
+  uint64_t bytes_fetched = 0;
+  uint64_t bad_lines = 0;
+  double seconds = 0.0;
+  std::vector<std::string> errors;
+
+  // The compact summary: one entry per group with success rate, latency
+  // percentiles and histogram, and token throughput
+  std::string to_json() const;
+};
+
+// Aggregate every run under /runs/. Runs that fail to read are reported in
+// the result rather than thrown; listing and cache I/O failures throw.
+AggregateReport aggregate_runs(const AggregateOptions& opts);
+
+} // namespace slp::pipeline
@@ -0,0 +1,61 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "slp/artifact/chunker.h"
+#include "slp/artifact/manifest.h"
+
+namespace slp::pipeline {
+
+struct ChunkUploadStats {
+  size_t chunks_total = 0;
+  size_t chunks_unique = 0;    // distinct chunk hashes in this artifact
+  size_t chunks_uploaded = 0;  // unique chunks the store did not have
+  size_t chunks_resumed = 0;   // skipped because a checkpoint recorded them
+  uint64_t bytes_total = 0;
+  uint64_t bytes_uploaded = 0;
+
+  // Logical bytes per byte actually sent (>= 1.0; higher is better)
+  double dedup_ratio() const;
+};
+
+struct ChunkFetchStats {
+  size_t chunks_total = 0;
+  size_t chunks_from_cache = 0;
+  size_t chunks_downloaded = 0;
+  uint64_t bytes_downloaded = 0;
+};
+
+// Split `data` into content-defined chunks, upload only the chunks missing
+// under /chunks/, and record the chunk list in `manifest`.
+ChunkUploadStats put_chunked(const std::string& filer_base,
+                             const std::vector<uint8_t>& data,
+                             artifact::Manifest& manifest,
+                             size_t parallelism = 8,
+                             const artifact::ChunkerParams& params = {});
+
+// Restartable upload of a large artifact (typically an mmap'd model). Each
+// chunk confirmed by the filer is appended to `checkpoint_path`; a rerun
+// after a failure skips those chunks without contacting the filer. The
+// checkpoint is removed on success.
+ChunkUploadStats put_chunked(const std::string& filer_base,
+                             const uint8_t* data,
+                             size_t len,
+                             artifact::Manifest& manifest,
+                             const std::string& checkpoint_path,
+                             size_t parallelism = 8,
+                             const artifact::ChunkerParams& params = {});
+
+// Assemble an artifact from its chunk list into `output_path`, fetching
+// chunks in parallel and reusing verified chunks from `cache_dir`.
+// `progress` gets (bytes written, artifact size) from the worker threads.
+ChunkFetchStats get_chunked(const std::string& filer_base,
+                            const artifact::Manifest& manifest,
+                            const std::string& output_path,
+                            const std::string& cache_dir,
+                            size_t parallelism = 8,
+                            const std::function<void(uint64_t done, uint64_t total)>& progress = {});
+
+} // namespace slp::pipeline
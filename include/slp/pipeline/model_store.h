@@ -0,0 +1,75 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "slp/artifact/gguf.h"
+#include "slp/artifact/manifest.h"
+#include "slp/file_writer.h"
+#include "slp/pipeline/chunk_store.h"
+#include "slp/seaweed/transfer.h"
+
+namespace slp::pipeline {
+
+// Root of the node-local cache: $SLP_CACHE_DIR, else $XDG_CACHE_HOME/slp,
+// else $HOME/.cache/slp
+std::string default_cache_dir();
+
+struct FetchProgress {
+  uint64_t done = 0;
+  uint64_t total = 0;     // 0 until known
+  bool waiting = false;   // another process is doing the download
+  int owner_pid = 0;      // process doing the download
+};
+
+struct CachedModel {
+  std::string path;       // <cache_dir>/models/<hash>.gguf
+  bool fetched = false;   // this call downloaded it
+  bool waited = false;    // another process was downloading it first
+  bool chunked = false;
+  seaweed::DownloadStats download;  // single-object fetch
+  ChunkFetchStats chunks;           // chunked fetch
+};
+
+// Path of model `hash` in the node-local cache, downloading and verifying it
+// first if needed. Concurrent callers on the node, in any process, share one
+// download: whoever holds <hash>.lock fetches, the others poll the lock and
+// follow progress through the mmap'd <hash>.progress file. If the downloader
+// dies its lock is released and a waiter takes over, resuming the partial
+// file.
+CachedModel fetch_model_cached(const std::string& filer_base,
+                               const std::string& hash,
+                               const std::string& cache_dir,
+                               const FileWriterOptions& writer = {},
+                               const std::function<void(const FetchProgress&)>& progress = {});
+
+// Give `dest` its own copy of a cached model, replacing any file there. The
+// copy shares extents with the cache entry where the filesystem can reflink
+// (btrfs, XFS), so it costs no space until one side is written; elsewhere
+// the bytes are copied in the kernel. Returns true if it was a reflink.
+// Cache entries are published read-only, so writes to `dest` never reach
+// the cache.
+bool copy_from_cache(const std::string& cached_path, const std::string& dest);
+
+// Download and parse /models/<hash>.manifest.json
+artifact::Manifest fetch_manifest(const std::string& filer_base, const std::string& hash);
+
+// Bytes [offset, offset + length) of a model, whether it is stored as one
+// object or as chunks
+std::vector<uint8_t> read_model_range(const std::string& filer_base,
+                                      const artifact::Manifest& manifest,
+                                      uint64_t offset,
+                                      uint64_t length);
+
+// Parse the GGUF header with ranged reads only. Uses the header size from
+// the manifest when indexed, else grows a prefix read until it parses.
+artifact::GgufHeader fetch_gguf_header(const std::string& filer_base,
+                                       const artifact::Manifest& manifest);
+
+// Raw bytes of one tensor, located through the manifest's tensor index
+std::vector<uint8_t> fetch_tensor(const std::string& filer_base,
+                                  const artifact::Manifest& manifest,
+                                  const std::string& tensor_name);
+
+} // namespace slp::pipeline
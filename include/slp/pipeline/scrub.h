@@ -0,0 +1,99 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "slp/artifact/manifest.h"
+
+// Store scrubbing: re-verify what sits on the filer. Objects whose path
+// names their content hash (/models/<h>.gguf, /chunks/<h>, /prompts/<h>.jsonl)
+// are streamed, decoded and hashed; manifests are checked against their
+// path and against the objects they reference.
+
+namespace slp::pipeline {
+
+enum class ScrubStatus {
+  ok,        // content hash verified
+  readable,  // the path names no hash; the body read and decoded cleanly
+  corrupt,   // hash, size or manifest mismatch
+  missing,   // referenced or listed but not retrievable (404)
+  error,     // could not be read
+};
+
+std::string scrub_status_name(ScrubStatus status);
+ScrubStatus parse_scrub_status(const std::string& name);  // throws on unknown names
+
+// One line of a scrub report
+struct ScrubResult {
+  std::string path;
+  ScrubStatus status = ScrubStatus::error;
+  uint64_t bytes = 0;      // bytes read from the filer
+  std::string expected;    // content hash the path promises, if any
+  std::string actual;
+  std::string detail;      // what is wrong, for anything but ok/readable
+  int64_t elapsed_us = 0;
+
+  std::string to_json() const;
+  static ScrubResult from_json(const std::string& line);
+};
+
+// Content hash `path` promises by the canonical layout (artifact/paths.h),
+// or "" when it names none
+std::string expected_content_hash(const std::string& path);
+
+// Model hash of a /models/<h>.manifest.json path, or ""
+std::string manifest_model_hash(const std::string& path);
+
+// Caps the combined read rate of every thread that shares it, so a scrub
+// leaves bandwidth for production traffic
+class ByteThrottle {
+public:
+  explicit ByteThrottle(double bytes_per_sec);  // <= 0: unlimited
+
+  // Block until `bytes` more may be read
+  void acquire(size_t bytes);
+
+private:
+  double bytes_per_sec_;
+  std::mutex mu_;
+  std::chrono::steady_clock::time_point next_{};
+};
+
+// What a listing found, for checking references between objects
+struct StoreListing {
+  std::vector<std::string> roots;            // directories that were listed
+  std::map<std::string, uint64_t> objects;   // path -> stored size
+
+  // True if `path` lies under a listed root, i.e. its absence means something
+  bool covers(const std::string& path) const;
+};
+
+struct ScrubOptions {
+  std::vector<uint8_t> dictionary;  // zstd dictionary for objects written with one
+  ByteThrottle* throttle = nullptr;
+};
+
+// Stream `path` and verify its content hash, and its decoded size when
+// `expected_size` is given (a whole model against its manifest). Never
+// throws; failures are reported in the result.
+ScrubResult scrub_object(const std::string& filer_base,
+                         const std::string& path,
+                         const ScrubOptions& opts,
+                         std::optional<uint64_t> expected_size = std::nullopt);
+
+// Check the manifest at `path`: its sha256 against the path, its chunk
+// list for gaps, and that every object it references is in `listing`.
+// The first result is the manifest's own; references missing from the
+// listing follow as `missing` results. The parsed manifest is stored in
+// `manifest` when it could be read.
+std::vector<ScrubResult> scrub_manifest(const std::string& filer_base,
+                                        const std::string& path,
+                                        const StoreListing& listing,
+                                        const ScrubOptions& opts,
+                                        std::optional<artifact::Manifest>& manifest);
+
+} // namespace slp::pipeline
@@ -0,0 +1,122 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+
+// Coordinator-free sharded batch runs. A prompt set (/prompts/<hash>.jsonl)
+// is cut into shards of whole lines; workers on any node claim a shard by
+// writing a lease under /runs/<run_id>/leases/, renew it while they work,
+// and store the shard's results under /runs/<run_id>/shards/. A worker
+// that stops renewing loses the shard to whoever finds its lease expired.
+//
+// The filer has no compare-and-swap, so a claim is a write followed by a
+// read-back after a short settle delay. Two workers can still end up on
+// one shard in a narrow race; shard results are written whole under a
+// fixed path, so the duplicate costs time, not correctness. Lease expiry
+// compares wall clocks, which must agree to well within the lease length.
+
+namespace slp::pipeline {
+
+struct Shard {
+  uint32_t id = 0;
+  uint64_t offset = 0;   // byte range of the shard's lines in the prompt file
+  uint64_t length = 0;
+  uint32_t prompts = 0;
+};
+
+struct ShardPlan {
+  std::string prompts_hash;
+  uint32_t prompts_per_shard = 0;
+  uint64_t total_prompts = 0;
+  std::vector<Shard> shards;
+
+  std::string to_json() const;
+  static ShardPlan from_json(const std::string& text);
+};
+
+// Split a prompts JSONL body into shards of `prompts_per_shard` prompt
+// lines. Blank and '#' lines belong to the shard they fall in but are not
+// counted, matching how the batch tools read prompt files.
+ShardPlan plan_shards(const std::vector<uint8_t>& prompts,
+                      const std::string& prompts_hash,
+                      uint32_t prompts_per_shard);
+
+// The plan stored for `run_id`, written from the prompt set on first use.
+// Workers starting together compute the same plan; whichever write lands
+// last is read back and used by all. Throws if the stored plan is for a
+// different prompt set.
+ShardPlan load_or_create_plan(const std::string& filer_base,
+                              const std::string& run_id,
+                              const std::string& prompts_hash,
+                              uint32_t prompts_per_shard);
+
+struct Lease {
+  uint32_t shard = 0;
+  std::string owner;
+  uint64_t generation = 0;     // bumped by every claim, so a steal is visible
+  int64_t expires_unix_ms = 0;
+
+  bool expired(int64_t now_unix_ms) const { return now_unix_ms >= expires_unix_ms; }
+
+  std::string to_json() const;
+  static Lease from_json(const std::string& text);
+};
+
+struct LeaseOptions {
+  std::chrono::milliseconds ttl{30000};   // how long a claim or renewal holds
+  std::chrono::milliseconds settle{200};  // wait before reading a claim back
+};
+
+int64_t unix_now_ms();
+
+// One worker's view of a run's leases and finished shards
+class ShardLeases {
+public:
+  ShardLeases(std::string filer_base, std::string run_id, std::string owner, LeaseOptions opts = {});
+
+  const std::string& owner() const { return owner_; }
+
+  std::set<uint32_t> finished() const;   // shards whose results are stored
+  std::set<uint32_t> leased() const;     // shards with a lease object, live or not
+  std::optional<Lease> read(uint32_t shard) const;
+
+  // Write a lease on `shard` and confirm it after the settle delay.
+  // `seen` is the lease found on the shard, if any, when stealing it.
+  std::optional<Lease> claim(uint32_t shard, const std::optional<Lease>& seen);
+
+  // Extend `lease`; false if another worker has claimed the shard since
+  bool renew(Lease& lease);
+
+  enum class Outcome { claimed, wait, finished };
+  struct Next {
+    Outcome outcome = Outcome::wait;
+    Lease lease;
+    bool stolen = false;    // taken over from an expired lease
+  };
+
+  // Claim the next shard: never-leased shards first, in order from
+  // `start`, then shards whose leases have expired. `wait` means every
+  // unfinished shard is leased to a live worker; `finished` that none is left.
+  Next next(const ShardPlan& plan, uint32_t start);
+
+  // Store a shard's result lines
+  void complete(uint32_t shard, const std::string& results);
+
+private:
+  std::set<uint32_t> list_ids(const std::string& dir, const std::string& suffix) const;
+  void write(const Lease& lease);
+
+  std::string filer_;
+  std::string run_id_;
+  std::string owner_;
+  LeaseOptions opts_;
+};
+
+// Concatenate every shard's results, in shard order, into the run's
+// results.jsonl. Throws if a shard has no results yet.
+void merge_shard_results(const std::string& filer_base, const std::string& run_id, const ShardPlan& plan);
+
+} // namespace slp::pipeline
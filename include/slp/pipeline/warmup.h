@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "slp/mapped_file.h"
+
+// Page-cache warm-up for a cached model before a server loads it, so the
+// first load does not pay a cold miss per page (the download may have gone
+// around the cache with O_DIRECT, or the cache may have been evicted since).
+
+namespace slp::pipeline {
+
+enum class WarmMethod {
+  readahead,  // readahead(2) per range, then read whatever is still missing
+  fadvise,    // posix_fadvise(WILLNEED) per range, then the same
+  touch,      // plain reads only
+};
+
+// "readahead", "fadvise" or "touch"; throws std::invalid_argument otherwise
+WarmMethod parse_warm_method(const std::string& name);
+const char* warm_method_name(WarmMethod m);
+
+struct WarmupOptions {
+  WarmMethod method = WarmMethod::readahead;
+  size_t threads = 4;                  // ranges warmed in parallel
+  uint64_t range_bytes = 16ULL << 20;  // unit of work
+  // Upper bound on bytes brought into memory; 0 means 80% of MemAvailable.
+  // A file larger than the bound is warmed from the start up to it.
+  uint64_t memory_limit = 0;
+  // mlock the warmed part; held until the report's `pinned` is released.
+  // The warmed part is then bounded as a whole, cached pages included, by
+  // memory_limit and RLIMIT_MEMLOCK.
+  // Failure to lock (RLIMIT_MEMLOCK, no CAP_IPC_LOCK) is reported, not thrown.
+  bool lock = false;
+};
+
+struct WarmupReport {
+  uint64_t file_bytes = 0;
+  uint64_t target_bytes = 0;      // prefix warmed after the memory bound
+  uint64_t resident_before = 0;   // bytes of the file in page cache beforehand
+  uint64_t resident_after = 0;
+  uint64_t bytes_read = 0;        // brought in by this call
+  uint64_t locked_bytes = 0;
+  std::string lock_error;
+  bool limited_by_memory = false;
+  double seconds = 0.0;           // time to warm
+  std::shared_ptr<const MappedFile> pinned;  // keeps the lock while held
+};
+
+// MemAvailable from /proc/meminfo; 0 if it cannot be read
+uint64_t available_memory_bytes();
+
+// Bytes of `file` resident in the page cache (mincore)
+uint64_t resident_bytes(const MappedFile& file);
+
+// Bring `path` into the page cache and report how long it took
+WarmupReport warm_page_cache(const std::string& path, const WarmupOptions& opts = {});
+
+} // namespace slp::pipeline
@@ -0,0 +1,55 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace slp::seaweed {
+
+// Compression applied to an object body before it is sent to the filer.
+// Content hashes are always computed over the uncompressed bytes.
+enum class Codec { none, gzip, zstd };
+
+struct CodecOptions {
+  Codec codec = Codec::none;
+  int level = 0;                    // 0 = codec default
+  std::vector<uint8_t> dictionary;  // zstd only
+};
+
+std::string codec_name(Codec codec);
+Codec parse_codec(const std::string& name);  // throws on unknown names
+
+// Parse a command-line codec spec: "none", "gzip", "gzip:9", "zstd",
+// "zstd:19" or "zstd:19:/path/to/dict" (level 0 keeps the codec default)
+CodecOptions parse_codec_spec(const std::string& spec);
+
+// False when the codec was not compiled in (zlib/zstd not found at build time)
+bool codec_available(Codec codec);
+
+// Best codec compiled into this build for text artifacts
+Codec default_text_codec();
+
+// Streaming encoder: feed input with update(), then call finish() once.
+// Output is appended to `out`.
+class Compressor {
+public:
+  virtual ~Compressor() = default;
+  virtual void update(const uint8_t* data, size_t len, std::vector<uint8_t>& out) = 0;
+  virtual void finish(std::vector<uint8_t>& out) = 0;
+};
+
+class Decompressor {
+public:
+  virtual ~Decompressor() = default;
+  virtual void update(const uint8_t* data, size_t len, std::vector<uint8_t>& out) = 0;
+  // Throws if the stream was truncated
+  virtual void finish(std::vector<uint8_t>& out) = 0;
+};
+
+std::unique_ptr<Compressor> make_compressor(const CodecOptions& opts);
+std::unique_ptr<Decompressor> make_decompressor(const CodecOptions& opts);
+
+std::vector<uint8_t> compress(const std::vector<uint8_t>& data, const CodecOptions& opts);
+std::vector<uint8_t> decompress(const std::vector<uint8_t>& data, const CodecOptions& opts);
+
+} // namespace slp::seaweed
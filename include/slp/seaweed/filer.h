@@ -1,14 +1,69 @@
 #pragma once
+#include <cstdint>
 #include <string>
 #include <vector>
 
+#include "slp/seaweed/codec.h"
+
 namespace slp::seaweed {
 
+// Filer metadata header recording how an object body is encoded.
+// SeaweedFS stores "Seaweed-*" request headers as extended attributes and
+// returns them on GET.
+inline constexpr const char* kCodecHeader = "Seaweed-Slp-Codec";
+inline constexpr const char* kRawSizeHeader = "Seaweed-Slp-Raw-Size";
+
+// All calls below retry transient failures per retry_policy(); the GETs are
+// also hedged per hedge_policy() (see seaweed/retry.h).
+
 bool put_file(const std::string& filer_base,
               const std::string& path,
               const std::vector<uint8_t>& data);
 
+// Compress `data` with `codec` and record the codec in object metadata.
+// `data` is the uncompressed content; its hash is what names the object.
+bool put_file(const std::string& filer_base,
+              const std::string& path,
+              const std::vector<uint8_t>& data,
+              const CodecOptions& codec);
+
+// Returns the uncompressed content, decoding per the object's codec metadata
 std::vector<uint8_t> get_file(const std::string& filer_base,
                               const std::string& path);
 
+// As above, with a zstd dictionary for objects written with one
+std::vector<uint8_t> get_file(const std::string& filer_base,
+                              const std::string& path,
+                              const std::vector<uint8_t>& dictionary);
+
+// Bytes [offset, offset + length) of an uncompressed object; fewer bytes
+// are returned if the object ends first. Throws for compressed objects,
+// whose stored bytes do not map onto content offsets.
+std::vector<uint8_t> get_file_range(const std::string& filer_base,
+                                    const std::string& path,
+                                    uint64_t offset,
+                                    uint64_t length);
+
+// True if the object exists (HEAD 200), false on 404; throws otherwise
+bool file_exists(const std::string& filer_base,
+                 const std::string& path);
+
+// Stored size of the object in bytes (HEAD Content-Length); throws if it
+// does not exist
+uint64_t file_size(const std::string& filer_base,
+                   const std::string& path);
+
+struct FilerEntry {
+  std::string path;   // full path
+  uint64_t size = 0;  // bytes as stored; 0 for directories
+  bool is_dir = false;
+};
+
+// Entries directly under `dir` in name order, fetched `page_size` at a
+// time through the filer's JSON listing. A missing directory lists as
+// empty; other failures throw.
+std::vector<FilerEntry> list_directory(const std::string& filer_base,
+                                       const std::string& dir,
+                                       size_t page_size = 1000);
+
 } // namespace slp::seaweed
@@ -0,0 +1,37 @@
+#pragma once
+#include <string>
+#include <vector>
+
+#include "slp/async_http.h"
+#include "slp/seaweed/codec.h"
+
+// Coroutine versions of the filer calls in filer.h, for keeping many
+// operations in flight from one thread. Results and errors match the
+// blocking calls. Retries follow retry_policy() and are counted in
+// request_stats(); the wait between attempts suspends instead of blocking.
+// GETs are not hedged.
+
+namespace slp::seaweed {
+
+Task<bool> put_file_async(AsyncHttpClient& http,
+                          std::string filer_base,
+                          std::string path,
+                          std::vector<uint8_t> data,
+                          CodecOptions codec = {});
+
+Task<std::vector<uint8_t>> get_file_async(AsyncHttpClient& http,
+                                          std::string filer_base,
+                                          std::string path,
+                                          std::vector<uint8_t> dictionary = {});
+
+Task<std::vector<uint8_t>> get_file_range_async(AsyncHttpClient& http,
+                                                std::string filer_base,
+                                                std::string path,
+                                                uint64_t offset,
+                                                uint64_t length);
+
+Task<bool> file_exists_async(AsyncHttpClient& http,
+                             std::string filer_base,
+                             std::string path);
+
+} // namespace slp::seaweed
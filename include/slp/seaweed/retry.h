@@ -0,0 +1,64 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+#include "slp/http_client.h"
+
+// Retry and hedging layer used by the filer calls. Policies are process-wide
+// so every put_file/get_file shares them without extra parameters.
+
+namespace slp::seaweed {
+
+struct RetryPolicy {
+  int max_attempts = 4;  // including the first try; 1 disables retries
+  std::chrono::milliseconds base_delay{100};
+  std::chrono::milliseconds max_delay{5000};
+};
+
+// Hedged GETs: if no response byte has arrived after the observed p95
+// time-to-first-byte, a duplicate request is sent and whichever answers
+// first wins; the other is cancelled.
+struct HedgePolicy {
+  bool enabled = true;
+  double quantile = 0.95;
+  std::chrono::milliseconds min_delay{5};
+  std::chrono::milliseconds initial_delay{200};  // until enough samples exist
+  size_t min_samples = 20;
+};
+
+struct RequestStats {
+  uint64_t requests = 0;     // logical operations
+  uint64_t attempts = 0;     // HTTP requests sent, hedges included
+  uint64_t retries = 0;
+  uint64_t hedges_sent = 0;
+  uint64_t hedges_won = 0;   // the hedge answered before the original
+  uint64_t failures = 0;     // operations that gave up
+};
+
+void set_retry_policy(const RetryPolicy& policy);
+RetryPolicy retry_policy();
+void set_hedge_policy(const HedgePolicy& policy);
+HedgePolicy hedge_policy();
+
+RequestStats request_stats();
+void reset_request_stats();
+// Count an operation whose retries ran outside send_with_retries (async calls)
+void add_request_stats(const RequestStats& delta);
+
+// Transport failures (status 0), 408, 425, 429 and 5xx other than 501/505
+bool is_retryable_status(long status);
+
+// Exponential backoff with full jitter: uniform in [0, min(max, base * 2^(attempt-1))]
+std::chrono::milliseconds backoff_delay(const RetryPolicy& policy, int attempt);
+
+// Send a request until it gets a non-retryable status or attempts run out.
+// Each attempt gets a fresh HttpClient. `hedge` must only be set for
+// idempotent reads; the original request runs on the calling thread and a
+// hedge on a shared pool thread, both finished before this returns, so a
+// hedged `send` must be safe to call from two threads at once. Returns the
+// last response; rethrows the last transport error if no attempt produced
+// one.
+HttpResponse send_with_retries(const std::function<HttpResponse(HttpClient&)>& send, bool hedge);
+
+} // namespace slp::seaweed
@@ -0,0 +1,46 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include "slp/file_writer.h"
+
+// Streaming, restartable transfers of large objects between local files and
+// the filer. Unlike put_file/get_file the body never sits in memory.
+
+namespace slp::seaweed {
+
+struct DownloadStats {
+  uint64_t bytes_total = 0;    // object size as stored
+  uint64_t bytes_resumed = 0;  // taken from an earlier partial download
+  uint64_t bytes_fetched = 0;  // moved over the network by this call
+  int attempts = 0;
+  std::string writer;          // FileWriter::describe() of the write path
+};
+
+struct DownloadOptions {
+  int max_attempts = 5;  // connection failures tolerated within one call
+  FileWriterOptions writer;  // buffered, O_DIRECT and/or io_uring writes
+  // Called as bytes land on disk with (bytes on disk, object size)
+  std::function<void(uint64_t done, uint64_t total)> progress;
+};
+
+// Download `path` into `output_path`. Progress is kept in
+// <output_path>.part next to a checkpoint (<output_path>.part.ckpt) that
+// records the object's ETag/Last-Modified. A rerun after a dropped
+// connection or crash continues with a Range request; if the object has
+// changed since, it starts over. Connection failures are retried with
+// backoff per retry_policy(). Compressed objects are decoded once complete.
+DownloadStats download_file(const std::string& filer_base,
+                            const std::string& path,
+                            const std::string& output_path,
+                            const DownloadOptions& options = {});
+
+// PUT a local file without loading it; retried as a whole per
+// retry_policy(). For restartable uploads use chunked storage
+// (pipeline/chunk_store.h).
+bool upload_file(const std::string& filer_base,
+                 const std::string& path,
+                 const std::string& local_path);
+
+} // namespace slp::seaweed
@@ -5,10 +5,36 @@
 
 namespace slp {
 
+// Incremental SHA256 for data that does not fit in one buffer
+class Sha256 {
+public:
+  Sha256();
+
+  void update(const uint8_t* data, size_t len);
+  void update(const std::vector<uint8_t>& data) { update(data.data(), data.size()); }
+
+  // Finish and return the digest; the object must not be updated afterwards
+  std::vector<uint8_t> digest();
+  std::string hex_digest();
+
+private:
+  uint32_t state_[8];
+  uint8_t buffer_[64];
+  size_t buffer_len_ = 0;
+  uint64_t total_len_ = 0;
+};
+
 // Compute SHA256 hash of data and return as hex string
 std::string sha256_hex(const std::vector<uint8_t>& data);
+std::string sha256_hex(const uint8_t* data, size_t len);
+
+// Stream a file from disk through SHA256; throws if it cannot be read
+std::string sha256_file_hex(const std::string& path);
 
 // Compute SHA256 hash of data and return as raw bytes
 std::vector<uint8_t> sha256_raw(const std::vector<uint8_t>& data);
 
+// Lowercase hex encoding of raw bytes
+std::string to_hex(const std::vector<uint8_t>& bytes);
+
 } // namespace slp
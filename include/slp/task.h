@@ -0,0 +1,190 @@
+#pragma once
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <optional>
+#include <utility>
+#include <vector>
+
+// Minimal lazy coroutine task for the async I/O layer (see async_http.h).
+// A Task starts when it is co_awaited or handed to EventLoop::run, and
+// resumes its awaiter directly when it finishes.
+
+namespace slp {
+
+template <typename T = void>
+class Task;
+
+class EventLoop;
+
+namespace detail {
+
+struct PromiseBase {
+  std::coroutine_handle<> continuation;
+  std::exception_ptr error;
+
+  struct FinalAwaiter {
+    bool await_ready() const noexcept { return false; }
+    template <typename P>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<P> h) noexcept {
+      auto next = h.promise().continuation;
+      return next ? next : std::noop_coroutine();
+    }
+    void await_resume() const noexcept {}
+  };
+
+  std::suspend_always initial_suspend() const noexcept { return {}; }
+  FinalAwaiter final_suspend() const noexcept { return {}; }
+  void unhandled_exception() { error = std::current_exception(); }
+};
+
+template <typename T>
+struct Promise : PromiseBase {
+  std::optional<T> value;
+
+  Task<T> get_return_object();
+  void return_value(T v) { value.emplace(std::move(v)); }
+  T result() {
+    if (error) std::rethrow_exception(error);
+    return std::move(*value);
+  }
+};
+
+template <>
+struct Promise<void> : PromiseBase {
+  Task<void> get_return_object();
+  void return_void() const noexcept {}
+  void result() const {
+    if (error) std::rethrow_exception(error);
+  }
+};
+
+// Fire-and-forget coroutine used to wait on several tasks at once
+struct Detached {
+  struct promise_type {
+    Detached get_return_object() const noexcept { return {}; }
+    std::suspend_never initial_suspend() const noexcept { return {}; }
+    std::suspend_never final_suspend() const noexcept { return {}; }
+    void return_void() const noexcept {}
+    void unhandled_exception() const noexcept { std::terminate(); }
+  };
+};
+
+} // namespace detail
+
+template <typename T>
+class [[nodiscard]] Task {
+public:
+  using promise_type = detail::Promise<T>;
+  using handle_type = std::coroutine_handle<promise_type>;
+
+  Task() = default;
+  explicit Task(handle_type h) : handle_(h) {}
+  Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+  Task& operator=(Task&& other) noexcept {
+    if (this != &other) {
+      if (handle_) handle_.destroy();
+      handle_ = std::exchange(other.handle_, {});
+    }
+    return *this;
+  }
+  ~Task() {
+    if (handle_) handle_.destroy();
+  }
+
+  Task(const Task&) = delete;
+  Task& operator=(const Task&) = delete;
+
+  bool await_ready() const noexcept { return !handle_ || handle_.done(); }
+  std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept {
+    handle_.promise().continuation = awaiter;
+    return handle_;
+  }
+  T await_resume() { return handle_.promise().result(); }
+
+private:
+  friend class EventLoop;
+  template <typename U>
+  friend Task<std::vector<U>> when_all(std::vector<Task<U>> tasks);
+  friend Task<void> when_all(std::vector<Task<void>> tasks);
+
+  handle_type handle_;
+};
+
+template <typename T>
+Task<T> detail::Promise<T>::get_return_object() {
+  return Task<T>(std::coroutine_handle<Promise<T>>::from_promise(*this));
+}
+
+inline Task<void> detail::Promise<void>::get_return_object() {
+  return Task<void>(std::coroutine_handle<Promise<void>>::from_promise(*this));
+}
+
+namespace detail {
+
+struct JoinLatch {
+  size_t remaining = 0;
+  std::coroutine_handle<> waiter;
+};
+
+// Waits for a task to finish without taking its result
+template <typename P>
+struct Completion {
+  std::coroutine_handle<P> task;
+  bool await_ready() const noexcept { return task.done(); }
+  std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiter) noexcept {
+    task.promise().continuation = awaiter;
+    return task;
+  }
+  void await_resume() const noexcept {}
+};
+
+template <typename P>
+Detached join_one(std::coroutine_handle<P> task, JoinLatch& latch) {
+  co_await Completion<P>{task};
+  if (--latch.remaining == 0) latch.waiter.resume();
+}
+
+// Starts every task, then resumes the awaiter once all have finished.
+// `remaining` holds one extra count until all are started so a task that
+// completes synchronously cannot resume the awaiter mid-loop.
+template <typename P>
+struct JoinAll {
+  std::vector<std::coroutine_handle<P>> tasks;
+  JoinLatch latch;
+
+  bool await_ready() const noexcept { return tasks.empty(); }
+  bool await_suspend(std::coroutine_handle<> awaiter) {
+    latch.remaining = tasks.size() + 1;
+    latch.waiter = awaiter;
+    for (auto h : tasks) join_one(h, latch);
+    return --latch.remaining != 0;
+  }
+  void await_resume() const noexcept {}
+};
+
+} // namespace detail
+
+// Run all tasks concurrently; results are in input order. The first
+// exception thrown by a task is rethrown once all have finished.
+template <typename T>
+Task<std::vector<T>> when_all(std::vector<Task<T>> tasks) {
+  detail::JoinAll<detail::Promise<T>> join;
+  for (auto& t : tasks) join.tasks.push_back(t.handle_);
+  co_await join;
+
+  std::vector<T> results;
+  results.reserve(tasks.size());
+  for (auto& t : tasks) results.push_back(t.handle_.promise().result());
+  co_return results;
+}
+
+inline Task<void> when_all(std::vector<Task<void>> tasks) {
+  detail::JoinAll<detail::Promise<void>> join;
+  for (auto& t : tasks) join.tasks.push_back(t.handle_);
+  co_await join;
+
+  for (auto& t : tasks) t.handle_.promise().result();
+}
+
+} // namespace slp
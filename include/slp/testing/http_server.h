@@ -0,0 +1,157 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Loopback HTTP/1.1 server used by the mock filer and llama-server. It is
+// small and blocking (a thread per connection) on purpose: the mocks exist
+// to produce repeatable latencies, not to be fast.
+
+namespace slp::testing {
+
+// Response-time distribution, parsed from "none", "fixed:<ms>",
+// "uniform:<lo_ms>:<hi_ms>", "exp:<mean_ms>" or "lognormal:<median_ms>:<sigma>"
+struct Latency {
+  enum class Kind { none, fixed, uniform, exponential, lognormal };
+  Kind kind = Kind::none;
+  double a_ms = 0.0;
+  double b_ms = 0.0;
+
+  static Latency parse(const std::string& spec);
+  double sample_ms(std::mt19937_64& rng) const;
+  std::string describe() const;
+};
+
+// Applied to every request a mock serves
+struct FaultOptions {
+  Latency latency;                    // before the response starts
+  double bandwidth_bytes_per_sec = 0; // per response body; 0 = unlimited
+  double error_rate = 0.0;            // fraction answered with error_status
+  int error_status = 503;
+  double drop_rate = 0.0;             // fraction of bodies cut off halfway
+  uint64_t seed = 1;
+};
+
+struct ServerRequest {
+  std::string method;
+  std::string path;   // without the query string
+  std::string query;
+  std::vector<std::pair<std::string, std::string>> headers;
+  std::string body;
+
+  // Case-insensitive; empty when absent
+  std::string header(const std::string& name) const;
+  std::string query_param(const std::string& name) const;
+};
+
+class HttpServer;
+
+class ResponseWriter {
+public:
+  using Headers = std::vector<std::pair<std::string, std::string>>;
+
+  // Complete response with Content-Length; HEAD requests get headers only
+  void send(int status, std::string_view body, const Headers& headers = {});
+  // Send headers and the first `keep` body bytes, then close the connection
+  void send_truncated(int status, std::string_view body, size_t keep, const Headers& headers = {});
+
+  // Chunked response for streaming; write_chunk returns false once the
+  // client has gone away
+  void begin_stream(int status, const Headers& headers = {});
+  bool write_chunk(std::string_view data);
+  void end_stream();
+
+  // Cap the body rate of this response
+  void set_bandwidth(double bytes_per_sec) { bandwidth_ = bytes_per_sec; }
+  // Sleep, returning false early if the server is stopping
+  bool pause(std::chrono::microseconds delay);
+
+  bool closed() const { return closed_; }
+
+private:
+  friend class HttpServer;
+  ResponseWriter(HttpServer& server, int fd, bool head) : server_(server), fd_(fd), head_(head) {}
+
+  bool write_all(std::string_view data, bool throttled);
+
+  HttpServer& server_;
+  int fd_;
+  bool head_;
+  bool closed_ = false;
+  bool streaming_ = false;
+  double bandwidth_ = 0;
+  uint64_t body_sent_ = 0;
+  std::chrono::steady_clock::time_point body_start_{};
+};
+
+class HttpServer {
+public:
+  using Handler = std::function<void(const ServerRequest&, ResponseWriter&)>;
+
+  // Listens on 127.0.0.1:`port`; 0 picks a free port
+  explicit HttpServer(Handler handler, uint16_t port = 0);
+  ~HttpServer();
+
+  HttpServer(const HttpServer&) = delete;
+  HttpServer& operator=(const HttpServer&) = delete;
+
+  uint16_t port() const { return port_; }
+  std::string url() const { return "http://127.0.0.1:" + std::to_string(port_); }
+  uint64_t requests_served() const { return requests_; }
+
+  // Close the listener and every connection, then wait for handlers to return
+  void stop();
+
+private:
+  friend class ResponseWriter;
+
+  void accept_loop();
+  void serve_connection(int fd);
+  bool wait_stopping(std::chrono::microseconds delay);
+
+  Handler handler_;
+  int listen_fd_ = -1;
+  uint16_t port_ = 0;
+  std::thread accept_thread_;
+  std::atomic<uint64_t> requests_{0};
+
+  std::mutex mu_;
+  std::condition_variable cv_;
+  bool stopping_ = false;
+  std::vector<int> connections_;
+  size_t active_ = 0;
+};
+
+// Latency, error and drop injection shared by the mocks
+class FaultInjector {
+public:
+  explicit FaultInjector(FaultOptions opts) : opts_(opts), rng_(opts.seed) {}
+
+  const FaultOptions& options() const { return opts_; }
+
+  // Delay and maybe fail the request. Returns true if a response (an
+  // injected error) has already been sent.
+  bool before_response(ResponseWriter& w);
+  // Bytes of a body of `size` to send before dropping the connection, or
+  // `size` to send it whole
+  size_t body_cutoff(size_t size);
+  double sample_ms(const Latency& latency);
+
+private:
+  double uniform();
+
+  FaultOptions opts_;
+  std::mutex mu_;
+  std::mt19937_64 rng_;
+};
+
+} // namespace slp::testing
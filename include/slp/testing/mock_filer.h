@@ -0,0 +1,47 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "slp/testing/http_server.h"
+
+namespace slp::testing {
+
+// In-memory stand-in for the SeaweedFS filer HTTP API: PUT/POST store an
+// object (keeping Seaweed-* headers as metadata), GET/HEAD serve it with
+// Range and If-Range support, DELETE removes it, and GET on a directory
+// returns a JSON listing ({"Entries":[{"FullPath",...}]}, paged with
+// limit= and lastFileName=).
+class MockFiler {
+public:
+  explicit MockFiler(FaultOptions faults = {}, uint16_t port = 0);
+
+  std::string url() const { return server_.url(); }
+  uint16_t port() const { return server_.port(); }
+  uint64_t requests_served() const { return server_.requests_served(); }
+  size_t object_count() const;
+  void stop() { server_.stop(); }
+
+private:
+  struct Object {
+    std::string body;
+    std::vector<std::pair<std::string, std::string>> meta;
+    std::string etag;
+  };
+
+  void handle(const ServerRequest& req, ResponseWriter& w);
+  void serve_object(const ServerRequest& req, ResponseWriter& w, const Object& obj);
+  void serve_listing(const ServerRequest& req, ResponseWriter& w);
+
+  FaultInjector faults_;
+  mutable std::mutex mu_;
+  std::map<std::string, std::shared_ptr<const Object>> objects_;
+  uint64_t version_ = 0;
+  // Declared last so the handler never outlives the state it uses
+  HttpServer server_;
+};
+
+} // namespace slp::testing
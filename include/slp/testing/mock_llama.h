@@ -0,0 +1,50 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "slp/testing/http_server.h"
+
+namespace slp::testing {
+
+struct MockLlamaOptions {
+  FaultOptions faults;               // applied before a request is queued
+  Latency prefill;                   // per request, before the first token
+  double prefill_ms_per_token = 0.0; // plus this per prompt token
+  Latency token_interval = Latency{Latency::Kind::fixed, 10.0, 0.0};
+  int slots = 1;                     // requests decoded at once; others queue
+  int default_n_predict = 16;
+};
+
+// Stand-in for llama-server: POST /completion (plain or "stream": true
+// server-sent events) with llama-server's response fields and timings,
+// POST /tokenize and GET /health. Tokens are paced per the options, so
+// latency and throughput numbers are repeatable without a GPU.
+class MockLlama {
+public:
+  explicit MockLlama(MockLlamaOptions opts = {}, uint16_t port = 0);
+
+  std::string url() const { return server_.url(); }
+  uint16_t port() const { return server_.port(); }
+  uint64_t requests_served() const { return server_.requests_served(); }
+  void stop() { server_.stop(); }
+
+  // The mock's tokenizer: about one token per four characters of each word
+  static std::vector<int> tokenize(const std::string& text);
+
+private:
+  void handle(const ServerRequest& req, ResponseWriter& w);
+  void complete(const ServerRequest& req, ResponseWriter& w);
+
+  MockLlamaOptions opts_;
+  FaultInjector faults_;
+  std::mutex slot_mu_;
+  std::condition_variable slot_cv_;
+  int free_slots_;
+  // Declared last so the handler never outlives the state it uses
+  HttpServer server_;
+};
+
+} // namespace slp::testing
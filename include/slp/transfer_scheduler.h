@@ -0,0 +1,92 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+
+// Process-wide bandwidth scheduler for HTTP traffic. Every transfer belongs
+// to a priority class and a destination (host:port). Bytes are paid for out
+// of token buckets: one for the link, one per class and one per
+// destination. When transfers have to wait, they are served by weighted
+// fair queuing: each waiting flow gets a share of the link in proportion to
+// its class weight. Small interactive requests therefore go nearly straight
+// through while bulk transfers share what is left.
+//
+// With no limits set, which is the default, nothing waits and the
+// scheduler costs one atomic load per transfer.
+
+namespace slp {
+
+enum class TrafficClass { interactive = 0, normal = 1, bulk = 2 };
+inline constexpr size_t kTrafficClasses = 3;
+
+const char* traffic_class_name(TrafficClass c);
+
+// Requests up to this size are interactive unless a class is set explicitly
+inline constexpr uint64_t kInteractiveMaxBytes = 1 << 20;
+
+struct TransferPolicy {
+  uint64_t link_bytes_per_sec = 0;  // 0 = unlimited
+  std::array<uint64_t, kTrafficClasses> class_bytes_per_sec{};  // 0 = unlimited
+  uint64_t destination_bytes_per_sec = 0;                       // each destination; 0 = unlimited
+  std::map<std::string, uint64_t> destination_limits;           // host:port -> bytes/s
+  std::array<uint32_t, kTrafficClasses> weights{{16, 4, 1}};    // fair-queuing share
+  std::chrono::milliseconds burst{50};  // bucket depth, as time at the bucket's rate
+
+  bool limited() const;
+};
+
+// "link=100M,bulk=40M,dest=80M,dest:10.0.0.5:8888=20M,weights=16:4:1,burst_ms=50".
+// Rates are bytes/s with an optional K, M or G suffix (powers of 1024).
+// Throws std::invalid_argument on a malformed spec.
+TransferPolicy parse_transfer_policy(const std::string& spec);
+
+// The initial policy comes from $SLP_BANDWIDTH when set
+void set_transfer_policy(const TransferPolicy& policy);
+TransferPolicy transfer_policy();
+
+// Counted while limits are active
+struct TrafficStats {
+  uint64_t bytes = 0;
+  uint64_t waits = 0;       // times a transfer had to wait for bandwidth
+  double wait_ms = 0.0;     // total time spent waiting
+};
+
+std::array<TrafficStats, kTrafficClasses> transfer_stats();
+void reset_transfer_stats();
+
+// True when the policy sets any limit; transfers skip the scheduler otherwise
+bool transfer_limits_active();
+
+// "host:port" of a URL, the key for per-destination limits
+std::string transfer_destination(const std::string& url);
+
+// One transfer's place in the scheduler. Blocking transfers call acquire()
+// as bytes move; async ones wait out admit_delay() before starting and charge()
+// what they moved afterwards.
+class TransferFlow {
+public:
+  TransferFlow(TrafficClass cls, std::string destination);
+
+  TransferFlow(const TransferFlow&) = delete;
+  TransferFlow& operator=(const TransferFlow&) = delete;
+
+  TrafficClass traffic_class() const { return class_; }
+
+  // Wait for this flow's turn, then pay for `bytes`
+  void acquire(uint64_t bytes);
+  // Pay for `bytes` without waiting; later transfers wait off the debt
+  void charge(uint64_t bytes);
+  // How long until this flow's buckets allow it to send; zero when now
+  std::chrono::milliseconds admit_delay();
+
+private:
+  friend class TransferScheduler;
+
+  TrafficClass class_;
+  std::string destination_;
+  double finish_tag_ = 0.0;  // virtual finish time of its last grant
+};
+
+} // namespace slp
@@ -0,0 +1,96 @@
+#include "slp/alloc_count.h"
+
+#include <curl/curl.h>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+namespace {
+
+thread_local uint64_t g_allocations = 0;
+thread_local uint64_t g_curl_allocations = 0;
+
+void* counted_malloc(size_t size) {
+    ++g_curl_allocations;
+    return std::malloc(size);
+}
+
+void* counted_calloc(size_t count, size_t size) {
+    ++g_curl_allocations;
+    return std::calloc(count, size);
+}
+
+void* counted_realloc(void* ptr, size_t size) {
+    ++g_curl_allocations;
+    return std::realloc(ptr, size);
+}
+
+char* counted_strdup(const char* s) {
+    ++g_curl_allocations;
+    return strdup(s);
+}
+
+} // anonymous namespace
+
+namespace slp {
+
+uint64_t thread_allocations() {
+    return g_allocations;
+}
+
+uint64_t thread_curl_allocations() {
+    return g_curl_allocations;
+}
+
+void init_curl_counting_allocations() {
+    if (curl_global_init_mem(CURL_GLOBAL_DEFAULT, counted_malloc, std::free, counted_realloc,
+                             counted_strdup, counted_calloc) != CURLE_OK) {
+        throw std::runtime_error("curl_global_init_mem failed");
+    }
+}
+
+} // namespace slp
+
+// The replaceable allocation functions. The array and nothrow forms forward
+// to these in libstdc++ and libc++.
+
+void* operator new(size_t size) {
+    ++g_allocations;
+    if (size == 0) size = 1;
+    for (;;) {
+        if (void* p = std::malloc(size)) return p;
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) throw std::bad_alloc();
+        handler();
+    }
+}
+
+void* operator new(size_t size, std::align_val_t align) {
+    ++g_allocations;
+    auto a = static_cast<size_t>(align);
+    if (size == 0) size = 1;
+    size = (size + a - 1) & ~(a - 1);  // aligned_alloc wants a multiple of the alignment
+    for (;;) {
+        if (void* p = std::aligned_alloc(a, size)) return p;
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) throw std::bad_alloc();
+        handler();
+    }
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::align_val_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t, std::align_val_t) noexcept {
+    std::free(p);
+}
@@ -0,0 +1,85 @@
+#include "slp/artifact/chunker.h"
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+namespace slp::artifact {
+
+namespace {
+
+// Gear table from a fixed splitmix64 stream. It must never change: chunk
+// boundaries, and therefore every stored chunk hash, depend on it.
+constexpr std::array<uint64_t, 256> make_gear_table() {
+    std::array<uint64_t, 256> table{};
+    uint64_t x = 0x736c705f63646331ULL;  // "slp_cdc1"
+    for (auto& entry : table) {
+        x += 0x9e3779b97f4a7c15ULL;
+        uint64_t z = x;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        entry = z ^ (z >> 31);
+    }
+    return table;
+}
+
+constexpr std::array<uint64_t, 256> kGear = make_gear_table();
+
+unsigned log2_floor(size_t v) {
+    unsigned bits = 0;
+    while (v > 1) {
+        v >>= 1;
+        bits++;
+    }
+    return bits;
+}
+
+// Mask over the top `bits` bits of the rolling hash; those bits mix in the
+// last 64 input bytes, unlike the low bits.
+uint64_t top_mask(unsigned bits) {
+    return bits == 0 ? 0 : ~uint64_t{0} << (64 - bits);
+}
+
+} // anonymous namespace
+
+size_t next_chunk_length(const uint8_t* data, size_t len, const ChunkerParams& params) {
+    if (len <= params.min_size) return len;
+
+    size_t limit = std::min(len, params.max_size);
+    size_t normal = std::min(limit, params.avg_size);
+
+    // Normalized chunking: a stricter mask before the average size and a
+    // looser one after it pull chunk sizes towards avg_size.
+    unsigned bits = log2_floor(params.avg_size);
+    uint64_t mask_strict = top_mask(bits + 2);
+    uint64_t mask_loose = top_mask(bits > 2 ? bits - 2 : 1);
+
+    uint64_t hash = 0;
+    size_t i = params.min_size;
+    for (; i < normal; ++i) {
+        hash = (hash << 1) + kGear[data[i]];
+        if ((hash & mask_strict) == 0) return i + 1;
+    }
+    for (; i < limit; ++i) {
+        hash = (hash << 1) + kGear[data[i]];
+        if ((hash & mask_loose) == 0) return i + 1;
+    }
+    return limit;
+}
+
+std::vector<ChunkSpan> chunk_buffer(const uint8_t* data, size_t len, const ChunkerParams& params) {
+    if (params.min_size == 0 || params.min_size > params.avg_size || params.avg_size > params.max_size ||
+        (params.avg_size & (params.avg_size - 1)) != 0) {
+        throw std::invalid_argument("invalid chunker parameters");
+    }
+
+    std::vector<ChunkSpan> spans;
+    size_t offset = 0;
+    while (offset < len) {
+        size_t n = next_chunk_length(data + offset, len - offset, params);
+        spans.push_back({offset, n});
+        offset += n;
+    }
+    return spans;
+}
+
+} // namespace slp::artifact
@@ -0,0 +1,258 @@
+#include "slp/artifact/gguf.h"
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+namespace slp::artifact {
+
+namespace {
+
+constexpr uint32_t kGgufMagic = 0x46554747;  // "GGUF" little-endian
+
+// Sanity limits so a corrupt header cannot trigger huge allocations
+constexpr uint64_t kMaxStringLen = 1ULL << 30;
+constexpr uint64_t kMaxDims = 8;
+constexpr unsigned kMaxArrayDepth = 16;
+
+struct GgmlTypeTraits {
+  const char* name;
+  uint32_t block_size;  // elements per block
+  uint32_t type_size;   // bytes per block
+};
+
+// Indexed by ggml_type; entries with a null name are retired/unused ids
+constexpr GgmlTypeTraits kGgmlTypes[] = {
+    {"F32", 1, 4},        {"F16", 1, 2},        {"Q4_0", 32, 18},     {"Q4_1", 32, 20},
+    {nullptr, 0, 0},      {nullptr, 0, 0},      {"Q5_0", 32, 22},     {"Q5_1", 32, 24},
+    {"Q8_0", 32, 34},     {"Q8_1", 32, 36},     {"Q2_K", 256, 84},    {"Q3_K", 256, 110},
+    {"Q4_K", 256, 144},   {"Q5_K", 256, 176},   {"Q6_K", 256, 210},   {"Q8_K", 256, 292},
+    {"IQ2_XXS", 256, 66}, {"IQ2_XS", 256, 74},  {"IQ3_XXS", 256, 98}, {"IQ1_S", 256, 50},
+    {"IQ4_NL", 32, 18},   {"IQ3_S", 256, 110},  {"IQ2_S", 256, 82},   {"IQ4_XS", 256, 136},
+    {"I8", 1, 1},         {"I16", 1, 2},        {"I32", 1, 4},        {"I64", 1, 8},
+    {"F64", 1, 8},        {"IQ1_M", 256, 56},   {"BF16", 1, 2},       {nullptr, 0, 0},
+    {nullptr, 0, 0},      {nullptr, 0, 0},      {"TQ1_0", 256, 54},   {"TQ2_0", 256, 66},
+};
+
+const GgmlTypeTraits* type_traits(uint32_t type) {
+    if (type >= sizeof(kGgmlTypes) / sizeof(kGgmlTypes[0])) return nullptr;
+    return kGgmlTypes[type].name ? &kGgmlTypes[type] : nullptr;
+}
+
+class Reader {
+public:
+    Reader(const uint8_t* data, size_t len) : data_(data), len_(len) {}
+
+    uint64_t pos() const { return pos_; }
+
+    void need(uint64_t n) {
+        if (n > len_ - pos_) throw GgufTruncated(pos_ + n);
+    }
+
+    template <typename T>
+    T read() {
+        need(sizeof(T));
+        T v;
+        std::memcpy(&v, data_ + pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return v;
+    }
+
+    std::string read_string() {
+        uint64_t n = read<uint64_t>();
+        if (n > kMaxStringLen) throw std::runtime_error("GGUF string too long");
+        need(n);
+        std::string s(reinterpret_cast<const char*>(data_ + pos_), static_cast<size_t>(n));
+        pos_ += n;
+        return s;
+    }
+
+    void skip(uint64_t n) {
+        need(n);
+        pos_ += n;
+    }
+
+private:
+    const uint8_t* data_;
+    uint64_t len_;
+    uint64_t pos_ = 0;
+};
+
+uint64_t scalar_size(GgufValueType t) {
+    switch (t) {
+        case GgufValueType::uint8:
+        case GgufValueType::int8:
+        case GgufValueType::boolean: return 1;
+        case GgufValueType::uint16:
+        case GgufValueType::int16: return 2;
+        case GgufValueType::uint32:
+        case GgufValueType::int32:
+        case GgufValueType::float32: return 4;
+        case GgufValueType::uint64:
+        case GgufValueType::int64:
+        case GgufValueType::float64: return 8;
+        default: return 0;
+    }
+}
+
+std::string read_scalar(Reader& r, GgufValueType t) {
+    std::ostringstream oss;
+    switch (t) {
+        case GgufValueType::uint8: oss << static_cast<unsigned>(r.read<uint8_t>()); break;
+        case GgufValueType::int8: oss << static_cast<int>(r.read<int8_t>()); break;
+        case GgufValueType::uint16: oss << r.read<uint16_t>(); break;
+        case GgufValueType::int16: oss << r.read<int16_t>(); break;
+        case GgufValueType::uint32: oss << r.read<uint32_t>(); break;
+        case GgufValueType::int32: oss << r.read<int32_t>(); break;
+        case GgufValueType::float32: oss << r.read<float>(); break;
+        case GgufValueType::boolean: oss << (r.read<uint8_t>() ? "true" : "false"); break;
+        case GgufValueType::uint64: oss << r.read<uint64_t>(); break;
+        case GgufValueType::int64: oss << r.read<int64_t>(); break;
+        case GgufValueType::float64: oss << r.read<double>(); break;
+        case GgufValueType::string: return r.read_string();
+        default: throw std::runtime_error("bad GGUF value type");
+    }
+    return oss.str();
+}
+
+void skip_value(Reader& r, GgufValueType t, unsigned depth);
+
+// Skips `count` elements of type `t`; fixed-size elements in one step
+void skip_elements(Reader& r, GgufValueType t, uint64_t count, unsigned depth) {
+    uint64_t elem = scalar_size(t);
+    if (elem > 0) {
+        if (count > (UINT64_MAX - r.pos()) / elem) {
+            throw std::runtime_error("bad GGUF array length");
+        }
+        r.skip(count * elem);
+        return;
+    }
+    for (uint64_t j = 0; j < count; ++j) skip_value(r, t, depth);
+}
+
+void skip_value(Reader& r, GgufValueType t, unsigned depth) {
+    if (t == GgufValueType::string) {
+        uint64_t n = r.read<uint64_t>();
+        r.skip(n);
+        return;
+    }
+    if (t == GgufValueType::array) {
+        // Each level is read recursively; the bound keeps a crafted header
+        // from exhausting the stack
+        if (depth >= kMaxArrayDepth) throw std::runtime_error("GGUF arrays nested too deeply");
+        auto elem_type = static_cast<GgufValueType>(r.read<uint32_t>());
+        uint64_t count = r.read<uint64_t>();
+        skip_elements(r, elem_type, count, depth + 1);
+        return;
+    }
+    uint64_t size = scalar_size(t);
+    if (size == 0) throw std::runtime_error("bad GGUF array element type");
+    r.skip(size);
+}
+
+} // anonymous namespace
+
+const GgufKeyValue* GgufHeader::find(const std::string& key) const {
+    for (const auto& kv : metadata) {
+        if (kv.key == key) return &kv;
+    }
+    return nullptr;
+}
+
+std::string GgufHeader::get_string(const std::string& key, const std::string& def) const {
+    const auto* kv = find(key);
+    return kv && kv->type != GgufValueType::array ? kv->value : def;
+}
+
+bool is_gguf(const uint8_t* data, size_t len) {
+    uint32_t magic = 0;
+    if (len < sizeof(magic)) return false;
+    std::memcpy(&magic, data, sizeof(magic));
+    return magic == kGgufMagic;
+}
+
+GgufHeader parse_gguf_header(const uint8_t* data, size_t len) {
+    Reader r(data, len);
+    if (r.read<uint32_t>() != kGgufMagic) {
+        throw std::runtime_error("not a GGUF file");
+    }
+
+    GgufHeader h;
+    h.version = r.read<uint32_t>();
+    if (h.version < 2 || h.version > 3) {
+        throw std::runtime_error("unsupported GGUF version " + std::to_string(h.version));
+    }
+
+    uint64_t tensor_count = r.read<uint64_t>();
+    uint64_t kv_count = r.read<uint64_t>();
+
+    for (uint64_t i = 0; i < kv_count; ++i) {
+        GgufKeyValue kv;
+        kv.key = r.read_string();
+        kv.type = static_cast<GgufValueType>(r.read<uint32_t>());
+
+        if (kv.type == GgufValueType::array) {
+            kv.array_type = static_cast<GgufValueType>(r.read<uint32_t>());
+            kv.array_len = r.read<uint64_t>();
+            skip_elements(r, kv.array_type, kv.array_len, 1);
+        } else {
+            kv.value = read_scalar(r, kv.type);
+        }
+
+        if (kv.key == "general.alignment" && !kv.value.empty()) {
+            h.alignment = std::stoull(kv.value);
+            if (h.alignment == 0) throw std::runtime_error("bad GGUF alignment");
+        }
+        h.metadata.push_back(std::move(kv));
+    }
+
+    h.tensors.reserve(static_cast<size_t>(std::min<uint64_t>(tensor_count, 1 << 20)));
+    for (uint64_t i = 0; i < tensor_count; ++i) {
+        GgufTensorInfo t;
+        t.name = r.read_string();
+        uint32_t n_dims = r.read<uint32_t>();
+        if (n_dims > kMaxDims) throw std::runtime_error("bad GGUF tensor rank");
+        for (uint32_t d = 0; d < n_dims; ++d) {
+            t.shape.push_back(r.read<uint64_t>());
+        }
+        t.type = r.read<uint32_t>();
+        t.offset = r.read<uint64_t>();
+        t.size_bytes = ggml_tensor_bytes(t.type, t.shape);
+        h.tensors.push_back(std::move(t));
+    }
+
+    h.data_offset = (r.pos() + h.alignment - 1) / h.alignment * h.alignment;
+    return h;
+}
+
+std::string ggml_type_name(uint32_t type) {
+    const auto* traits = type_traits(type);
+    return traits ? traits->name : "type" + std::to_string(type);
+}
+
+uint64_t ggml_tensor_bytes(uint32_t type, const std::vector<uint64_t>& shape) {
+    const auto* traits = type_traits(type);
+    if (!traits) return 0;
+
+    uint64_t elements = 1;
+    for (uint64_t d : shape) elements *= d;
+    return elements / traits->block_size * traits->type_size;
+}
+
+void add_gguf_index(Manifest& manifest, const GgufHeader& header) {
+    manifest.gguf_version = header.version;
+    manifest.gguf_architecture = header.get_string("general.architecture");
+    manifest.gguf_header_bytes = header.data_offset;
+    manifest.tensors.clear();
+    manifest.tensors.reserve(header.tensors.size());
+    for (const auto& t : header.tensors) {
+        TensorRef ref;
+        ref.name = t.name;
+        ref.type = ggml_type_name(t.type);
+        ref.shape = t.shape;
+        ref.offset = header.data_offset + t.offset;
+        ref.size = t.size_bytes;
+        manifest.tensors.push_back(std::move(ref));
+    }
+}
+
+} // namespace slp::artifact
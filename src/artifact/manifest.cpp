@@ -1,6 +1,8 @@
 #include "slp/artifact/manifest.h"
+#include "slp/json.h"
 #include <sstream>
 #include <iomanip>
+#include <stdexcept>
 
 namespace slp::artifact {
 
@@ -10,9 +12,82 @@ std::string Manifest::to_json() const {
     oss << "  \"sha256\": \"" << sha256 << "\",\n";
     oss << "  \"size_bytes\": " << size_bytes << ",\n";
     oss << "  \"created_at\": \"" << created_at << "\",\n";
-    oss << "  \"original_name\": \"" << original_name << "\"\n";
-    oss << "}";
+    oss << "  \"original_name\": \"" << json::escape(original_name) << "\",\n";
+    oss << "  \"codec\": \"" << codec << "\"";
+    if (!chunks.empty()) {
+        oss << ",\n  \"chunks\": [\n";
+        for (size_t i = 0; i < chunks.size(); ++i) {
+            const auto& c = chunks[i];
+            oss << "    {\"sha256\": \"" << c.sha256 << "\", \"offset\": " << c.offset
+                << ", \"size\": " << c.size << "}" << (i + 1 < chunks.size() ? ",\n" : "\n");
+        }
+        oss << "  ]";
+    }
+    if (gguf_version != 0) {
+        oss << ",\n  \"gguf\": {\n";
+        oss << "    \"version\": " << gguf_version << ",\n";
+        oss << "    \"architecture\": \"" << json::escape(gguf_architecture) << "\",\n";
+        oss << "    \"header_bytes\": " << gguf_header_bytes << ",\n";
+        oss << "    \"tensors\": [";
+        for (size_t i = 0; i < tensors.size(); ++i) {
+            const auto& t = tensors[i];
+            oss << (i == 0 ? "\n" : ",\n");
+            oss << "      {\"name\": \"" << json::escape(t.name) << "\", \"type\": \"" << t.type
+                << "\", \"shape\": [";
+            for (size_t d = 0; d < t.shape.size(); ++d) {
+                oss << (d == 0 ? "" : ", ") << t.shape[d];
+            }
+            oss << "], \"offset\": " << t.offset << ", \"size\": " << t.size << "}";
+        }
+        oss << (tensors.empty() ? "]\n" : "\n    ]\n");
+        oss << "  }";
+    }
+    oss << "\n}";
     return oss.str();
 }
 
+Manifest Manifest::from_json(const std::string& text) {
+    auto doc = json::parse(text);
+    if (!doc.is_object()) {
+        throw std::runtime_error("manifest is not a JSON object");
+    }
+
+    Manifest m;
+    m.sha256 = doc.get_string("sha256");
+    m.size_bytes = static_cast<uint64_t>(doc.get_int("size_bytes"));
+    m.created_at = doc.get_string("created_at");
+    m.original_name = doc.get_string("original_name");
+    m.codec = doc.get_string("codec", "none");
+
+    if (const auto* chunks = doc.find("chunks"); chunks && chunks->is_array()) {
+        for (const auto& c : chunks->as_array()) {
+            ChunkRef ref;
+            ref.sha256 = c.get_string("sha256");
+            ref.offset = static_cast<uint64_t>(c.get_int("offset"));
+            ref.size = static_cast<uint64_t>(c.get_int("size"));
+            m.chunks.push_back(std::move(ref));
+        }
+    }
+
+    if (const auto* gguf = doc.find("gguf"); gguf && gguf->is_object()) {
+        m.gguf_version = static_cast<uint32_t>(gguf->get_int("version"));
+        m.gguf_architecture = gguf->get_string("architecture");
+        m.gguf_header_bytes = static_cast<uint64_t>(gguf->get_int("header_bytes"));
+        if (const auto* tensors = gguf->find("tensors"); tensors && tensors->is_array()) {
+            for (const auto& t : tensors->as_array()) {
+                TensorRef ref;
+                ref.name = t.get_string("name");
+                ref.type = t.get_string("type");
+                if (const auto* shape = t.find("shape"); shape && shape->is_array()) {
+                    for (const auto& d : shape->as_array()) ref.shape.push_back(d.as_uint());
+                }
+                ref.offset = static_cast<uint64_t>(t.get_int("offset"));
+                ref.size = static_cast<uint64_t>(t.get_int("size"));
+                m.tensors.push_back(std::move(ref));
+            }
+        }
+    }
+    return m;
+}
+
 } // namespace slp::artifact
@@ -0,0 +1,258 @@
+#include "slp/artifact/pack.h"
+#include "slp/artifact/paths.h"
+#include "slp/seaweed/filer.h"
+#include "slp/sha256.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace slp::artifact {
+
+namespace {
+
+constexpr char kMagic[8] = {'S', 'L', 'P', 'P', 'A', 'C', 'K', '1'};
+constexpr uint32_t kVersion = 1;
+
+// First guess at how much of the tail holds footer and index: about 1300
+// members, which covers typical packs in one request
+constexpr uint64_t kTailGuess = 64 * 1024;
+
+struct IndexEntry {
+    uint8_t hash[32];
+    uint64_t offset;
+    uint64_t size;
+};
+static_assert(sizeof(IndexEntry) == 48);
+
+struct Footer {
+    char magic[8];
+    uint32_t version;
+    uint32_t entry_size;
+    uint64_t count;
+    uint64_t index_offset;
+};
+static_assert(sizeof(Footer) == 32);
+
+int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+void hex_to_hash(const std::string& hex, uint8_t* out) {
+    if (hex.size() != 64) throw std::invalid_argument("invalid sha256: '" + hex + "'");
+    for (size_t i = 0; i < 32; ++i) {
+        int hi = hex_value(hex[2 * i]);
+        int lo = hex_value(hex[2 * i + 1]);
+        if (hi < 0 || lo < 0) throw std::invalid_argument("invalid sha256: '" + hex + "'");
+        out[i] = static_cast<uint8_t>(hi << 4 | lo);
+    }
+}
+
+std::string hash_to_hex(const uint8_t* hash) {
+    static const char* digits = "0123456789abcdef";
+    std::string out(64, '0');
+    for (size_t i = 0; i < 32; ++i) {
+        out[2 * i] = digits[hash[i] >> 4];
+        out[2 * i + 1] = digits[hash[i] & 0xf];
+    }
+    return out;
+}
+
+Footer read_footer(const std::vector<uint8_t>& tail) {
+    if (tail.size() < sizeof(Footer)) throw std::runtime_error("pack too short for a footer");
+    Footer f;
+    std::memcpy(&f, tail.data() + tail.size() - sizeof(Footer), sizeof(Footer));
+    if (std::memcmp(f.magic, kMagic, sizeof(kMagic)) != 0) throw std::runtime_error("not a pack (bad footer magic)");
+    if (f.version != kVersion) throw std::runtime_error("unsupported pack version " + std::to_string(f.version));
+    if (f.entry_size != sizeof(IndexEntry)) throw std::runtime_error("unexpected pack index entry size");
+    return f;
+}
+
+} // anonymous namespace
+
+std::string PackWriter::add(const std::vector<uint8_t>& data) {
+    return add(data.data(), data.size());
+}
+
+std::string PackWriter::add(const uint8_t* data, size_t len) {
+    std::string hash = sha256_hex(data, len);
+    if (!hashes_.insert(hash).second) return hash;
+    entries_.push_back({hash, data_.size(), len});
+    data_.insert(data_.end(), data, data + len);
+    return hash;
+}
+
+PackWriter::Finished PackWriter::finish() {
+    Finished out;
+    out.entries = std::move(entries_);
+    std::sort(out.entries.begin(), out.entries.end(),
+              [](const PackEntry& a, const PackEntry& b) { return a.sha256 < b.sha256; });
+
+    // Lay the data out in hash order too, so offsets, and with them the id,
+    // depend only on which members there are and not on the order added
+    std::vector<uint8_t> data;
+    data.reserve(data_.size());
+    for (auto& entry : out.entries) {
+        auto first = data_.begin() + static_cast<std::ptrdiff_t>(entry.offset);
+        entry.offset = data.size();
+        data.insert(data.end(), first, first + static_cast<std::ptrdiff_t>(entry.size));
+    }
+
+    std::vector<uint8_t> index(out.entries.size() * sizeof(IndexEntry));
+    for (size_t i = 0; i < out.entries.size(); ++i) {
+        IndexEntry e{};
+        hex_to_hash(out.entries[i].sha256, e.hash);
+        e.offset = out.entries[i].offset;
+        e.size = out.entries[i].size;
+        std::memcpy(index.data() + i * sizeof(IndexEntry), &e, sizeof(e));
+    }
+    out.pack_id = sha256_hex(index);
+
+    Footer f{};
+    std::memcpy(f.magic, kMagic, sizeof(kMagic));
+    f.version = kVersion;
+    f.entry_size = sizeof(IndexEntry);
+    f.count = out.entries.size();
+    f.index_offset = data.size();
+
+    out.bytes = std::move(data);
+    out.bytes.insert(out.bytes.end(), index.begin(), index.end());
+    const auto* fp = reinterpret_cast<const uint8_t*>(&f);
+    out.bytes.insert(out.bytes.end(), fp, fp + sizeof(f));
+
+    data_.clear();
+    entries_.clear();
+    hashes_.clear();
+    return out;
+}
+
+uint64_t PackIndex::tail_bytes_needed(const std::vector<uint8_t>& tail) {
+    Footer f = read_footer(tail);
+    return f.count * sizeof(IndexEntry) + sizeof(Footer);
+}
+
+PackIndex PackIndex::parse(const std::string& pack_id, const std::vector<uint8_t>& tail, uint64_t pack_size) {
+    Footer f = read_footer(tail);
+    uint64_t index_bytes = f.count * sizeof(IndexEntry);
+    if (f.count > pack_size / sizeof(IndexEntry) || f.index_offset > pack_size ||
+        f.index_offset + index_bytes + sizeof(Footer) != pack_size) {
+        throw std::runtime_error("pack " + pack_id + ": footer does not match the pack size");
+    }
+    if (tail.size() < index_bytes + sizeof(Footer)) {
+        throw std::runtime_error("pack " + pack_id + ": tail does not hold the whole index");
+    }
+
+    const uint8_t* index = tail.data() + tail.size() - sizeof(Footer) - index_bytes;
+    if (sha256_hex(index, static_cast<size_t>(index_bytes)) != pack_id) {
+        throw std::runtime_error("pack " + pack_id + ": index does not match the pack id");
+    }
+
+    PackIndex out;
+    out.pack_id_ = pack_id;
+    out.entries_.reserve(static_cast<size_t>(f.count));
+    for (uint64_t i = 0; i < f.count; ++i) {
+        IndexEntry e;
+        std::memcpy(&e, index + i * sizeof(IndexEntry), sizeof(e));
+        if (e.offset > f.index_offset || e.size > f.index_offset - e.offset) {
+            throw std::runtime_error("pack " + pack_id + ": member outside the data area");
+        }
+        out.entries_.push_back({hash_to_hex(e.hash), e.offset, e.size});
+    }
+    return out;
+}
+
+std::optional<PackEntry> PackIndex::find(const std::string& sha256) const {
+    auto it = std::lower_bound(entries_.begin(), entries_.end(), sha256,
+                               [](const PackEntry& e, const std::string& h) { return e.sha256 < h; });
+    if (it == entries_.end() || it->sha256 != sha256) return std::nullopt;
+    return *it;
+}
+
+void put_pack(const std::string& filer_base, const PackWriter::Finished& pack) {
+    if (!seaweed::put_file(filer_base, pack_path(pack.pack_id), pack.bytes)) {
+        throw std::runtime_error("failed to upload pack " + pack.pack_id);
+    }
+}
+
+PackIndex fetch_pack_index(const std::string& filer_base, const std::string& pack_id) {
+    std::string path = pack_path(pack_id);
+    uint64_t size = seaweed::file_size(filer_base, path);
+    if (size < sizeof(Footer)) throw std::runtime_error("pack " + pack_id + " is too short");
+
+    uint64_t want = std::min(size, kTailGuess);
+    auto tail = seaweed::get_file_range(filer_base, path, size - want, want);
+    uint64_t needed = PackIndex::tail_bytes_needed(tail);
+    if (needed > tail.size() && needed <= size) {
+        tail = seaweed::get_file_range(filer_base, path, size - needed, needed);
+    }
+    return PackIndex::parse(pack_id, tail, size);
+}
+
+std::vector<uint8_t> read_pack_member(const std::string& filer_base, const std::string& pack_id,
+                                      const PackEntry& entry) {
+    if (entry.size == 0) return {};
+    auto data = seaweed::get_file_range(filer_base, pack_path(pack_id), entry.offset, entry.size);
+    if (data.size() != entry.size || sha256_hex(data) != entry.sha256) {
+        throw std::runtime_error("pack " + pack_id + ": member " + entry.sha256 + " failed verification");
+    }
+    return data;
+}
+
+std::shared_ptr<const PackIndex> PackIndexCache::get(const std::string& filer_base, const std::string& pack_id) {
+    Key key = filer_base + " " + pack_id;
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        auto it = map_.find(key);
+        if (it != map_.end()) {
+            lru_.splice(lru_.begin(), lru_, it->second);
+            hits_++;
+            return it->second->second;
+        }
+        misses_++;
+    }
+
+    // Fetched without the lock; a concurrent miss on the same pack fetches
+    // it twice and keeps one copy
+    auto index = std::make_shared<const PackIndex>(fetch_pack_index(filer_base, pack_id));
+
+    std::lock_guard<std::mutex> lock(mu_);
+    auto it = map_.find(key);
+    if (it != map_.end()) {
+        lru_.splice(lru_.begin(), lru_, it->second);
+        return it->second->second;
+    }
+    lru_.emplace_front(key, index);
+    map_[key] = lru_.begin();
+    while (lru_.size() > std::max<size_t>(1, capacity_)) {
+        map_.erase(lru_.back().first);
+        lru_.pop_back();
+    }
+    return index;
+}
+
+std::vector<uint8_t> PackIndexCache::read(const std::string& filer_base, const std::string& pack_id,
+                                          const std::string& sha256) {
+    auto index = get(filer_base, pack_id);
+    auto entry = index->find(sha256);
+    if (!entry) throw std::runtime_error("pack " + pack_id + " has no member " + sha256);
+    return read_pack_member(filer_base, pack_id, *entry);
+}
+
+size_t PackIndexCache::size() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    return lru_.size();
+}
+
+uint64_t PackIndexCache::hits() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    return hits_;
+}
+
+uint64_t PackIndexCache::misses() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    return misses_;
+}
+
+} // namespace slp::artifact
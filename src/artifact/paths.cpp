@@ -1,11 +1,65 @@
-#include <string>
+#include "slp/artifact/paths.h"
 
-// Artifact path utilities placeholder
-// This would provide canonical path generation for storage layout
+#include <cstdio>
 
 namespace slp::artifact {
 
-// Placeholder for future implementation
-// This would generate paths like /models/<hash>.gguf, /prompts/<hash>.jsonl
+std::string model_path(const std::string& hash) {
+    return "/models/" + hash + ".gguf";
+}
+
+std::string model_manifest_path(const std::string& hash) {
+    return "/models/" + hash + ".manifest.json";
+}
+
+std::string prompts_path(const std::string& hash) {
+    return "/prompts/" + hash + ".jsonl";
+}
+
+std::string chunk_path(const std::string& hash) {
+    return "/chunks/" + hash;
+}
+
+std::string pack_path(const std::string& pack_id) {
+    return "/packs/" + pack_id + ".pack";
+}
+
+std::string run_results_path(const std::string& run_id) {
+    return "/runs/" + run_id + "/results.jsonl";
+}
+
+std::string run_metrics_path(const std::string& run_id) {
+    return "/runs/" + run_id + "/metrics.json";
+}
+
+namespace {
+
+std::string shard_name(uint32_t shard) {
+    char buf[16];
+    std::snprintf(buf, sizeof(buf), "%06u", shard);
+    return buf;
+}
+
+} // anonymous namespace
+
+std::string run_shard_plan_path(const std::string& run_id) {
+    return "/runs/" + run_id + "/shards.json";
+}
+
+std::string run_leases_dir(const std::string& run_id) {
+    return "/runs/" + run_id + "/leases/";
+}
+
+std::string run_lease_path(const std::string& run_id, uint32_t shard) {
+    return run_leases_dir(run_id) + shard_name(shard);
+}
+
+std::string run_shard_results_dir(const std::string& run_id) {
+    return "/runs/" + run_id + "/shards/";
+}
+
+std::string run_shard_results_path(const std::string& run_id, uint32_t shard) {
+    return run_shard_results_dir(run_id) + shard_name(shard) + ".jsonl";
+}
 
 } // namespace slp::artifact
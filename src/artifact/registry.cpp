@@ -1,11 +1,690 @@
-#include <string>
+#include "slp/artifact/registry.h"
+#include "slp/http_client.h"
+#include "slp/seaweed/filer.h"
+#include "slp/seaweed/retry.h"
 
-// Artifact registry placeholder
-// This would manage a content-addressed artifact database
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
 
 namespace slp::artifact {
 
-// Placeholder for future implementation
-// This would provide lookup/registration of artifacts by hash
+namespace {
+
+namespace fs = std::filesystem;
+
+// On-disk table layout (little-endian):
+//   FileHeader | Record[count] sorted by (name, tag) |
+//   uint32 hash_index[count] (record ids sorted by hash) | string pool
+// Version 2 added Record::flags for tombstones; version 1 tables (64-byte
+// records, no tombstones) are still read.
+constexpr char kMagic[8] = {'S', 'L', 'P', 'R', 'E', 'G', '0', '1'};
+constexpr uint32_t kVersion = 2;
+constexpr uint32_t kV1RecordSize = 64;
+constexpr uint32_t kDeleted = 1;
+constexpr const char* kRemotePath = "/registry/index.slpreg";
+
+// A push that loses the race for the remote index merges again and retries
+constexpr int kPushAttempts = 5;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    uint64_t count;
+    uint64_t records_off;
+    uint64_t hash_index_off;
+    uint64_t strings_off;
+    uint64_t strings_size;
+    uint64_t reserved;
+};
+static_assert(sizeof(FileHeader) == 64);
+
+struct Record {
+    uint32_t name_off;
+    uint32_t name_len;
+    uint32_t tag_off;
+    uint32_t tag_len;
+    uint8_t hash[32];
+    uint64_t size_bytes;
+    int64_t created_unix;  // removal time for a tombstone
+    uint32_t flags;
+    uint32_t reserved;
+};
+static_assert(sizeof(Record) == 72);
+
+int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+bool is_hex_hash(const std::string& s) {
+    return s.size() == 64 && std::all_of(s.begin(), s.end(), [](char c) { return hex_value(c) >= 0; });
+}
+
+bool is_hex_prefix(const std::string& s) {
+    return !s.empty() && s.size() <= 64 &&
+           std::all_of(s.begin(), s.end(), [](char c) { return hex_value(c) >= 0; });
+}
+
+std::string hash_to_hex(const uint8_t* hash) {
+    static const char* digits = "0123456789abcdef";
+    std::string out(64, '0');
+    for (size_t i = 0; i < 32; ++i) {
+        out[2 * i] = digits[hash[i] >> 4];
+        out[2 * i + 1] = digits[hash[i] & 0xf];
+    }
+    return out;
+}
+
+// Nibble-wise comparison of a binary hash against a hex prefix
+int compare_hash_prefix(const uint8_t* hash, const std::string& prefix) {
+    for (size_t i = 0; i < prefix.size(); ++i) {
+        int nib = (i % 2 == 0) ? (hash[i / 2] >> 4) : (hash[i / 2] & 0xf);
+        int want = hex_value(prefix[i]);
+        if (nib != want) return nib < want ? -1 : 1;
+    }
+    return 0;
+}
+
+// Names and tags end up in a tab-separated journal and in "name:tag" refs.
+// A tombstone needs no hash.
+void validate_entry(const RegistryEntry& e) {
+    auto bad = [](const std::string& s) {
+        return s.empty() || std::any_of(s.begin(), s.end(), [](char c) {
+                   return c == ':' || std::isspace(static_cast<unsigned char>(c));
+               });
+    };
+    if (bad(e.name)) throw std::invalid_argument("invalid artifact name: '" + e.name + "'");
+    if (bad(e.tag)) throw std::invalid_argument("invalid artifact tag: '" + e.tag + "'");
+    if (!is_hex_hash(e.sha256) && !(e.deleted && e.sha256.empty())) {
+        throw std::invalid_argument("invalid sha256: '" + e.sha256 + "'");
+    }
+}
+
+// Records sorted by (name, tag), the newer side winning a key both have
+// (`a` on a tie). Tombstones compete by removal time like any entry.
+std::vector<RegistryEntry> merge_newest(std::vector<RegistryEntry> a, std::vector<RegistryEntry> b) {
+    auto less = [](const RegistryEntry& x, const RegistryEntry& y) {
+        return x.name != y.name ? x.name < y.name : x.tag < y.tag;
+    };
+    std::vector<RegistryEntry> out;
+    out.reserve(a.size() + b.size());
+    size_t i = 0, j = 0;
+    while (i < a.size() || j < b.size()) {
+        if (j == b.size() || (i < a.size() && less(a[i], b[j]))) {
+            out.push_back(std::move(a[i++]));
+        } else if (i == a.size() || less(b[j], a[i])) {
+            out.push_back(std::move(b[j++]));
+        } else {
+            out.push_back(b[j].created_unix > a[i].created_unix ? std::move(b[j]) : std::move(a[i]));
+            i++;
+            j++;
+        }
+    }
+    return out;
+}
+
+// Exclusive flock on <dir>/registry.lock for its lifetime. Every process
+// that appends to the journal, rewrites the table or truncates the journal
+// holds it, so registrations from concurrent slp_put_model runs are not lost.
+class DirLock {
+public:
+    explicit DirLock(const std::string& dir) {
+        std::string path = dir + "/registry.lock";
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd_ < 0) throw std::runtime_error("cannot open " + path + ": " + std::strerror(errno));
+        while (::flock(fd_, LOCK_EX) != 0) {
+            if (errno == EINTR) continue;
+            int err = errno;
+            ::close(fd_);
+            throw std::runtime_error("cannot lock " + path + ": " + std::strerror(err));
+        }
+    }
+    ~DirLock() { ::close(fd_); }
+
+    DirLock(const DirLock&) = delete;
+    DirLock& operator=(const DirLock&) = delete;
+
+private:
+    int fd_ = -1;
+};
+
+} // anonymous namespace
+
+std::pair<std::string, std::string> split_ref(const std::string& ref) {
+    size_t colon = ref.rfind(':');
+    if (colon == std::string::npos) return {ref, "latest"};
+    return {ref.substr(0, colon), ref.substr(colon + 1)};
+}
+
+// Read-only view over an mmap'd table file
+class Registry::Table {
+public:
+    explicit Table(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("cannot open registry table: " + path);
+
+        struct stat st {};
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw std::runtime_error("cannot stat registry table: " + path);
+        }
+        size_ = static_cast<size_t>(st.st_size);
+        if (size_ < sizeof(FileHeader)) {
+            ::close(fd);
+            throw std::runtime_error("registry table too small: " + path);
+        }
+
+        void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) throw std::runtime_error("cannot mmap registry table: " + path);
+        base_ = static_cast<const uint8_t*>(p);
+
+        try {
+            validate();
+        } catch (...) {
+            ::munmap(const_cast<uint8_t*>(base_), size_);
+            throw;
+        }
+    }
+
+    ~Table() { ::munmap(const_cast<uint8_t*>(base_), size_); }
+
+    size_t count() const { return static_cast<size_t>(header().count); }
+
+    std::string_view name(size_t i) const {
+        const Record& r = record(i);
+        return {strings() + r.name_off, r.name_len};
+    }
+
+    std::string_view tag(size_t i) const {
+        const Record& r = record(i);
+        return {strings() + r.tag_off, r.tag_len};
+    }
+
+    const uint8_t* hash(size_t i) const { return record(i).hash; }
+
+    bool deleted(size_t i) const {
+        return header().record_size >= sizeof(Record) && (record(i).flags & kDeleted) != 0;
+    }
+
+    RegistryEntry entry(size_t i) const {
+        const Record& r = record(i);
+        RegistryEntry e;
+        e.name = std::string(name(i));
+        e.tag = std::string(tag(i));
+        e.deleted = deleted(i);
+        if (!e.deleted) e.sha256 = hash_to_hex(r.hash);
+        e.size_bytes = r.size_bytes;
+        e.created_unix = r.created_unix;
+        return e;
+    }
+
+    // First record with (name, tag) >= the key
+    size_t lower_bound(std::string_view n, std::string_view t) const {
+        size_t lo = 0, hi = count();
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            int c = name(mid).compare(n);
+            if (c == 0) c = tag(mid).compare(t);
+            if (c < 0) lo = mid + 1;
+            else hi = mid;
+        }
+        return lo;
+    }
+
+    // Position in the hash index of the first hash >= prefix
+    size_t hash_lower_bound(const std::string& prefix) const {
+        size_t lo = 0, hi = count();
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (compare_hash_prefix(hash(hash_index(mid)), prefix) < 0) lo = mid + 1;
+            else hi = mid;
+        }
+        return lo;
+    }
+
+    uint32_t hash_index(size_t pos) const {
+        uint32_t id;
+        std::memcpy(&id, base_ + header().hash_index_off + pos * sizeof(uint32_t), sizeof(id));
+        return id;
+    }
+
+private:
+    const FileHeader& header() const { return *reinterpret_cast<const FileHeader*>(base_); }
+
+    // Version 1 records are a prefix of the current layout; flags is only
+    // read when the stride includes it
+    const Record& record(size_t i) const {
+        return *reinterpret_cast<const Record*>(base_ + header().records_off + i * header().record_size);
+    }
+
+    const char* strings() const { return reinterpret_cast<const char*>(base_ + header().strings_off); }
+
+    void validate() const {
+        const FileHeader& h = header();
+        if (std::memcmp(h.magic, kMagic, sizeof(kMagic)) != 0 ||
+            !((h.version == 1 && h.record_size == kV1RecordSize) ||
+              (h.version == kVersion && h.record_size == sizeof(Record)))) {
+            throw std::runtime_error("not a registry table (bad magic or version)");
+        }
+        auto within = [this](uint64_t off, uint64_t len) { return off <= size_ && len <= size_ - off; };
+        if (h.count > UINT32_MAX || h.records_off % alignof(Record) != 0 ||
+            !within(h.records_off, h.count * h.record_size) ||
+            !within(h.hash_index_off, h.count * sizeof(uint32_t)) ||
+            !within(h.strings_off, h.strings_size)) {
+            throw std::runtime_error("corrupt registry table (bad section bounds)");
+        }
+        for (size_t i = 0; i < count(); ++i) {
+            const Record& r = record(i);
+            if (uint64_t{r.name_off} + r.name_len > h.strings_size ||
+                uint64_t{r.tag_off} + r.tag_len > h.strings_size || hash_index(i) >= h.count) {
+                throw std::runtime_error("corrupt registry table (bad record)");
+            }
+        }
+    }
+
+    const uint8_t* base_ = nullptr;
+    size_t size_ = 0;
+};
+
+Registry::Registry(std::string dir) : dir_(std::move(dir)) {
+    fs::create_directories(dir_);
+    DirLock lock(dir_);
+    reload();
+}
+
+Registry::~Registry() = default;
+
+void Registry::reopen_table() {
+    std::string path = dir_ + "/registry.idx";
+    table_.reset();
+    if (fs::exists(path)) {
+        table_ = std::make_unique<Table>(path);
+    }
+}
+
+void Registry::reload() {
+    reopen_table();
+    delta_.clear();
+    replay_journal();
+}
+
+size_t Registry::table_size() const {
+    return table_ ? table_->count() : 0;
+}
+
+void Registry::append_journal(const std::string& line) {
+    std::ofstream f(dir_ + "/registry.log", std::ios::app);
+    if (!f) throw std::runtime_error("cannot write registry journal in " + dir_);
+    f << line << "\n";
+    f.flush();
+    if (!f) throw std::runtime_error("registry journal write failed in " + dir_);
+}
+
+void Registry::replay_journal() {
+    std::ifstream f(dir_ + "/registry.log");
+    std::string line;
+    while (std::getline(f, line)) {
+        std::istringstream iss(line);
+        std::string op;
+        std::getline(iss, op, '\t');
+        if (op == "P") {
+            RegistryEntry e;
+            std::string size, created;
+            std::getline(iss, e.name, '\t');
+            std::getline(iss, e.tag, '\t');
+            std::getline(iss, e.sha256, '\t');
+            std::getline(iss, size, '\t');
+            std::getline(iss, created, '\t');
+            // A torn last line from a crash is skipped
+            if (!is_hex_hash(e.sha256) || size.empty() || created.empty()) continue;
+            e.size_bytes = std::stoull(size);
+            e.created_unix = std::stoll(created);
+            delta_[{e.name, e.tag}] = e;
+        } else if (op == "D") {
+            RegistryEntry e;
+            std::string removed;
+            std::getline(iss, e.name, '\t');
+            std::getline(iss, e.tag, '\t');
+            // Lines from before removal times were recorded lose to any entry
+            std::getline(iss, removed, '\t');
+            if (e.name.empty() || e.tag.empty()) continue;
+            e.deleted = true;
+            e.created_unix = removed.empty() ? 0 : std::stoll(removed);
+            delta_[{e.name, e.tag}] = e;
+        }
+    }
+}
+
+void Registry::put(const RegistryEntry& entry) {
+    if (entry.deleted) throw std::invalid_argument("put() of a tombstone; use remove()");
+    validate_entry(entry);
+    DirLock lock(dir_);
+    append_journal("P\t" + entry.name + "\t" + entry.tag + "\t" + entry.sha256 + "\t" +
+                   std::to_string(entry.size_bytes) + "\t" + std::to_string(entry.created_unix));
+    delta_[{entry.name, entry.tag}] = entry;
+
+    if (delta_.size() > kAutoCompactThreshold) {
+        compact_locked();
+    }
+}
+
+bool Registry::remove(const std::string& name, const std::string& tag) {
+    if (!find(name, tag)) return false;
+    RegistryEntry tombstone;
+    tombstone.name = name;
+    tombstone.tag = tag;
+    tombstone.deleted = true;
+    tombstone.created_unix = static_cast<int64_t>(std::time(nullptr));
+    DirLock lock(dir_);
+    append_journal("D\t" + name + "\t" + tag + "\t" + std::to_string(tombstone.created_unix));
+    delta_[{name, tag}] = tombstone;
+    return true;
+}
+
+std::optional<RegistryEntry> Registry::find(const std::string& name, const std::string& tag) const {
+    if (auto it = delta_.find({name, tag}); it != delta_.end()) {
+        if (it->second.deleted) return std::nullopt;
+        return it->second;
+    }
+    if (table_) {
+        size_t i = table_->lower_bound(name, tag);
+        if (i < table_->count() && table_->name(i) == name && table_->tag(i) == tag && !table_->deleted(i)) {
+            return table_->entry(i);
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<RegistryEntry> Registry::resolve(const std::string& ref) const {
+    auto [name, tag] = split_ref(ref);
+    if (auto e = find(name, tag)) return e;
+
+    if (ref.size() >= 4 && is_hex_prefix(ref)) {
+        // Several names may point at the same content, so only a second
+        // distinct hash makes the prefix ambiguous
+        std::optional<RegistryEntry> match;
+        std::string other;
+        visit_hash_prefix(ref, [&](const RegistryEntry& e) {
+            if (!match) {
+                match = e;
+            } else if (e.sha256 != match->sha256) {
+                other = e.sha256;
+                return false;
+            }
+            return true;
+        });
+        if (!other.empty()) {
+            throw std::runtime_error("ambiguous hash prefix " + ref + ": matches " + match->sha256 + " and " + other);
+        }
+        return match;
+    }
+    return std::nullopt;
+}
+
+std::vector<RegistryEntry> Registry::list(const std::string& name) const {
+    std::map<std::string, RegistryEntry> by_tag;
+    if (table_) {
+        for (size_t i = table_->lower_bound(name, ""); i < table_->count() && table_->name(i) == name; ++i) {
+            if (!table_->deleted(i)) by_tag.emplace(std::string(table_->tag(i)), table_->entry(i));
+        }
+    }
+    for (auto it = delta_.lower_bound({name, ""}); it != delta_.end() && it->first.first == name; ++it) {
+        if (!it->second.deleted) by_tag[it->first.second] = it->second;
+        else by_tag.erase(it->first.second);
+    }
+
+    std::vector<RegistryEntry> out;
+    for (auto& [tag, e] : by_tag) out.push_back(std::move(e));
+    return out;
+}
+
+std::vector<RegistryEntry> Registry::find_by_hash_prefix(const std::string& hex_prefix, size_t limit) const {
+    std::vector<RegistryEntry> out;
+    if (limit == 0) return out;
+    visit_hash_prefix(hex_prefix, [&](const RegistryEntry& e) {
+        out.push_back(e);
+        return out.size() < limit;
+    });
+    return out;
+}
+
+void Registry::visit_hash_prefix(const std::string& hex_prefix,
+                                 const std::function<bool(const RegistryEntry&)>& visit) const {
+    if (!is_hex_prefix(hex_prefix)) return;
+
+    std::string prefix = hex_prefix;
+    std::transform(prefix.begin(), prefix.end(), prefix.begin(),
+                   [](char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+
+    for (const auto& [key, e] : delta_) {
+        if (!e.deleted && e.sha256.compare(0, prefix.size(), prefix) == 0 && !visit(e)) return;
+    }
+
+    if (table_) {
+        for (size_t pos = table_->hash_lower_bound(prefix); pos < table_->count(); ++pos) {
+            uint32_t id = table_->hash_index(pos);
+            if (compare_hash_prefix(table_->hash(id), prefix) != 0) break;
+            if (table_->deleted(id)) continue;
+            // Entries changed or removed since the last compaction live in the delta
+            if (delta_.count({std::string(table_->name(id)), std::string(table_->tag(id))})) continue;
+            if (!visit(table_->entry(id))) return;
+        }
+    }
+}
+
+std::vector<RegistryEntry> Registry::all() const {
+    std::vector<RegistryEntry> out = records();
+    out.erase(std::remove_if(out.begin(), out.end(), [](const RegistryEntry& e) { return e.deleted; }), out.end());
+    return out;
+}
+
+std::vector<RegistryEntry> Registry::records() const {
+    std::vector<RegistryEntry> out;
+    out.reserve(table_size() + delta_.size());
+
+    // Merge two streams sorted by (name, tag); the delta wins on ties
+    size_t i = 0;
+    size_t n = table_size();
+    auto it = delta_.begin();
+    while (i < n || it != delta_.end()) {
+        int c;
+        if (i == n) {
+            c = 1;
+        } else if (it == delta_.end()) {
+            c = -1;
+        } else {
+            c = table_->name(i).compare(it->first.first);
+            if (c == 0) c = table_->tag(i).compare(it->first.second);
+        }
+
+        if (c < 0) {
+            out.push_back(table_->entry(i++));
+        } else {
+            out.push_back(it->second);
+            if (c == 0) i++;
+            ++it;
+        }
+    }
+    return out;
+}
+
+void Registry::write_table(const std::string& path, std::vector<RegistryEntry> entries) {
+    std::sort(entries.begin(), entries.end(), [](const RegistryEntry& a, const RegistryEntry& b) {
+        return a.name != b.name ? a.name < b.name : a.tag < b.tag;
+    });
+    if (entries.size() > UINT32_MAX) throw std::runtime_error("too many registry entries");
+
+    std::string pool;
+    std::vector<Record> records(entries.size());
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const auto& e = entries[i];
+        validate_entry(e);
+        Record& r = records[i];
+        std::memset(&r, 0, sizeof(r));
+        if (pool.size() + e.name.size() + e.tag.size() > UINT32_MAX) {
+            throw std::runtime_error("registry string pool too large");
+        }
+        r.name_off = static_cast<uint32_t>(pool.size());
+        r.name_len = static_cast<uint32_t>(e.name.size());
+        pool += e.name;
+        r.tag_off = static_cast<uint32_t>(pool.size());
+        r.tag_len = static_cast<uint32_t>(e.tag.size());
+        pool += e.tag;
+        for (size_t b = 0; b < 32 && !e.sha256.empty(); ++b) {
+            r.hash[b] = static_cast<uint8_t>(hex_value(e.sha256[2 * b]) << 4 | hex_value(e.sha256[2 * b + 1]));
+        }
+        r.size_bytes = e.size_bytes;
+        r.created_unix = e.created_unix;
+        r.flags = e.deleted ? kDeleted : 0;
+    }
+
+    std::vector<uint32_t> hash_index(records.size());
+    for (size_t i = 0; i < hash_index.size(); ++i) hash_index[i] = static_cast<uint32_t>(i);
+    std::sort(hash_index.begin(), hash_index.end(), [&](uint32_t a, uint32_t b) {
+        return std::memcmp(records[a].hash, records[b].hash, 32) < 0;
+    });
+
+    FileHeader h{};
+    std::memcpy(h.magic, kMagic, sizeof(kMagic));
+    h.version = kVersion;
+    h.record_size = sizeof(Record);
+    h.count = records.size();
+    h.records_off = sizeof(FileHeader);
+    h.hash_index_off = h.records_off + records.size() * sizeof(Record);
+    h.strings_off = h.hash_index_off + hash_index.size() * sizeof(uint32_t);
+    h.strings_size = pool.size();
+
+    std::string tmp = path + ".tmp." + std::to_string(::getpid());
+    {
+        std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+        if (!f) throw std::runtime_error("cannot create registry table: " + tmp);
+        f.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        f.write(reinterpret_cast<const char*>(records.data()),
+                static_cast<std::streamsize>(records.size() * sizeof(Record)));
+        f.write(reinterpret_cast<const char*>(hash_index.data()),
+                static_cast<std::streamsize>(hash_index.size() * sizeof(uint32_t)));
+        f.write(pool.data(), static_cast<std::streamsize>(pool.size()));
+        if (!f) {
+            std::error_code ec;
+            fs::remove(tmp, ec);
+            throw std::runtime_error("registry table write failed: " + tmp);
+        }
+    }
+    fs::rename(tmp, path);
+}
+
+void Registry::compact() {
+    DirLock lock(dir_);
+    compact_locked();
+}
+
+void Registry::compact_locked() {
+    // Other processes may have appended since this one last looked; the
+    // journal is the union of everyone's changes
+    reload();
+    // Tombstones stay, so a later pull or push still knows what was removed
+    write_table(dir_ + "/registry.idx", records());
+    reopen_table();
+    delta_.clear();
+    // Replaying a stale journal after a crash here is harmless: its
+    // operations are already part of the new table.
+    std::ofstream(dir_ + "/registry.log", std::ios::trunc);
+}
+
+void Registry::merge_table(const std::vector<uint8_t>& bytes) {
+    std::string tmp = dir_ + "/registry.idx.pull." + std::to_string(::getpid());
+    {
+        std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+        if (!f) throw std::runtime_error("cannot create " + tmp);
+        f.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        if (!f) throw std::runtime_error("write failed: " + tmp);
+    }
+
+    // Validated before anything local changes. The journal is folded in
+    // first, so a local change and a remote one to the same name:tag are
+    // decided by time, removals included.
+    std::vector<RegistryEntry> merged;
+    try {
+        Table remote(tmp);
+        reload();
+        std::vector<RegistryEntry> theirs;
+        theirs.reserve(remote.count());
+        for (size_t i = 0; i < remote.count(); ++i) theirs.push_back(remote.entry(i));
+        merged = merge_newest(records(), std::move(theirs));
+    } catch (...) {
+        std::error_code ec;
+        fs::remove(tmp, ec);
+        throw;
+    }
+    fs::remove(tmp);
+
+    write_table(dir_ + "/registry.idx", std::move(merged));
+    reopen_table();
+    delta_.clear();
+    std::ofstream(dir_ + "/registry.log", std::ios::trunc);
+}
+
+bool Registry::pull(const std::string& filer_base) {
+    if (!seaweed::file_exists(filer_base, kRemotePath)) return false;
+    auto bytes = seaweed::get_file(filer_base, kRemotePath);
+    DirLock lock(dir_);
+    merge_table(bytes);
+    return true;
+}
+
+void Registry::push(const std::string& filer_base) {
+    DirLock lock(dir_);
+    HttpClient client;
+    std::string url = filer_base + kRemotePath;
+
+    for (int attempt = 0; attempt < kPushAttempts; ++attempt) {
+        // Merge what other publishers pushed, then upload only if the remote
+        // copy is still the one merged (If-Match), or still absent
+        auto current = seaweed::send_with_retries([url](HttpClient& c) { return c.get(url); }, true);
+        std::string precondition;
+        if (current.status == 200) {
+            merge_table(current.body);
+            std::string etag = current.header("ETag");
+            if (!etag.empty()) precondition = "If-Match: " + etag;
+        } else if (current.status == 404) {
+            precondition = "If-None-Match: *";
+        } else {
+            throw std::runtime_error("registry download failed: HTTP " + std::to_string(current.status));
+        }
+        compact_locked();
+
+        std::string path = dir_ + "/registry.idx";
+        if (!fs::exists(path)) write_table(path, {});
+        std::ifstream f(path, std::ios::binary);
+        std::vector<uint8_t> bytes{std::istreambuf_iterator<char>(f), {}};
+        std::vector<std::string> headers;
+        if (!precondition.empty()) headers.push_back(precondition);
+        auto response = client.put(url, bytes, "application/octet-stream", headers);
+        if (response.status == 412) continue;  // someone pushed in between
+        if (response.status < 200 || response.status >= 300) {
+            throw std::runtime_error("registry upload failed: HTTP " + std::to_string(response.status));
+        }
+        return;
+    }
+    throw std::runtime_error("registry upload kept losing to concurrent pushes");
+}
 
 } // namespace slp::artifact
@@ -0,0 +1,329 @@
+#include "slp/async_http.h"
+#include "curl_common.h"
+
+#include <curl/curl.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+namespace slp {
+
+// Per-request libcurl state; lives in the frame of the coroutine that sends it
+struct EventLoop::Transfer {
+    EventLoop* loop = nullptr;
+    CURL* easy = nullptr;
+    curl_slist* headers = nullptr;
+    HttpResponse response;
+    CURLcode result = CURLE_OK;
+    std::coroutine_handle<> waiter;
+    bool in_multi = false;  // added to the multi handle and not yet finished
+
+    explicit Transfer(EventLoop& l) : loop(&l), easy(static_cast<CURL*>(l.acquire_handle())) {}
+    ~Transfer() {
+        // The coroutine was destroyed mid-request: take the handle back from
+        // curl_multi before it is reset and reused
+        if (in_multi) {
+            curl_multi_remove_handle(loop->multi_, easy);
+            loop->in_flight_--;
+        }
+        curl_slist_free_all(headers);
+        loop->release_handle(easy);
+    }
+
+    Transfer(const Transfer&) = delete;
+    Transfer& operator=(const Transfer&) = delete;
+};
+
+namespace {
+
+struct UploadSource {
+    const std::vector<uint8_t>* data;
+    size_t offset;
+};
+
+size_t upload_read_callback(char* buffer, size_t size, size_t nitems, void* userp) {
+    auto* src = static_cast<UploadSource*>(userp);
+    size_t n = std::min(size * nitems, src->data->size() - src->offset);
+    if (n > 0) {
+        std::memcpy(buffer, src->data->data() + src->offset, n);
+        src->offset += n;
+    }
+    return n;
+}
+
+// Same rules as HttpClient: HEADs and small bodies or ranges are
+// interactive, unbounded or large ranges and large bodies bulk
+TrafficClass default_class(const HttpRequest& request) {
+    if (request.traffic_class) return *request.traffic_class;
+    if (request.method == "HEAD") return TrafficClass::interactive;
+    if (request.method != "GET") {
+        return request.body.size() <= kInteractiveMaxBytes ? TrafficClass::interactive : TrafficClass::bulk;
+    }
+    if (request.range.empty()) return TrafficClass::normal;
+    size_t dash = request.range.find('-');
+    if (dash == std::string::npos || dash + 1 == request.range.size()) return TrafficClass::bulk;
+    uint64_t first = std::stoull(request.range.substr(0, dash));
+    uint64_t last = std::stoull(request.range.substr(dash + 1));
+    return last >= first && last - first < kInteractiveMaxBytes ? TrafficClass::interactive : TrafficClass::bulk;
+}
+
+} // anonymous namespace
+
+EventLoop::EventLoop(LoopOptions opts) {
+    epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0) throw std::runtime_error(std::string("epoll_create1 failed: ") + std::strerror(errno));
+
+    multi_ = curl_multi_init();
+    if (!multi_) {
+        ::close(epoll_fd_);
+        throw std::runtime_error("Failed to initialize CURL multi handle");
+    }
+    curl_multi_setopt(multi_, CURLMOPT_SOCKETFUNCTION, socket_callback);
+    curl_multi_setopt(multi_, CURLMOPT_SOCKETDATA, this);
+    curl_multi_setopt(multi_, CURLMOPT_TIMERFUNCTION, timer_callback);
+    curl_multi_setopt(multi_, CURLMOPT_TIMERDATA, this);
+    if (opts.max_connections > 0) curl_multi_setopt(multi_, CURLMOPT_MAX_TOTAL_CONNECTIONS, opts.max_connections);
+    if (opts.max_host_connections > 0) curl_multi_setopt(multi_, CURLMOPT_MAX_HOST_CONNECTIONS, opts.max_host_connections);
+}
+
+EventLoop::~EventLoop() {
+    for (void* easy : idle_handles_) curl_easy_cleanup(easy);
+    curl_multi_cleanup(multi_);
+    ::close(epoll_fd_);
+}
+
+void* EventLoop::acquire_handle() {
+    if (!idle_handles_.empty()) {
+        void* easy = idle_handles_.back();
+        idle_handles_.pop_back();
+        return easy;
+    }
+    CURL* easy = curl_easy_init();
+    if (!easy) throw std::runtime_error("Failed to initialize CURL");
+    return easy;
+}
+
+void EventLoop::release_handle(void* easy) {
+    curl_easy_reset(easy);
+    idle_handles_.push_back(easy);
+}
+
+int EventLoop::socket_callback(void*, int fd, int what, void* userp, void* socketp) {
+    auto* loop = static_cast<EventLoop*>(userp);
+    if (what == CURL_POLL_REMOVE) {
+        ::epoll_ctl(loop->epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+        curl_multi_assign(loop->multi_, fd, nullptr);
+        return 0;
+    }
+
+    epoll_event ev{};
+    ev.data.fd = fd;
+    if (what == CURL_POLL_IN || what == CURL_POLL_INOUT) ev.events |= EPOLLIN;
+    if (what == CURL_POLL_OUT || what == CURL_POLL_INOUT) ev.events |= EPOLLOUT;
+
+    // socketp marks sockets already registered with epoll
+    if (socketp) {
+        ::epoll_ctl(loop->epoll_fd_, EPOLL_CTL_MOD, fd, &ev);
+    } else {
+        ::epoll_ctl(loop->epoll_fd_, EPOLL_CTL_ADD, fd, &ev);
+        curl_multi_assign(loop->multi_, fd, loop);
+    }
+    return 0;
+}
+
+int EventLoop::timer_callback(void*, long timeout_ms, void* userp) {
+    auto* loop = static_cast<EventLoop*>(userp);
+    loop->curl_timer_armed_ = timeout_ms >= 0;
+    if (loop->curl_timer_armed_) {
+        loop->curl_deadline_ = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    }
+    return 0;
+}
+
+void EventLoop::TransferAwaiter::await_suspend(std::coroutine_handle<> h) {
+    transfer.waiter = h;
+    curl_easy_setopt(transfer.easy, CURLOPT_PRIVATE, &transfer);
+    CURLMcode rc = curl_multi_add_handle(loop.multi_, transfer.easy);
+    if (rc != CURLM_OK) {
+        throw std::runtime_error(std::string("curl_multi_add_handle failed: ") + curl_multi_strerror(rc));
+    }
+    transfer.in_multi = true;
+    loop.in_flight_++;
+}
+
+void EventLoop::poll() {
+    using clock = std::chrono::steady_clock;
+    auto now = clock::now();
+    int wait_ms = -1;
+    auto consider = [&](clock::time_point deadline) {
+        auto ms = std::chrono::ceil<std::chrono::milliseconds>(deadline - now).count();
+        int clamped = static_cast<int>(std::clamp<long long>(ms, 0, 60000));
+        wait_ms = wait_ms < 0 ? clamped : std::min(wait_ms, clamped);
+    };
+    if (curl_timer_armed_) consider(curl_deadline_);
+    if (!timers_.empty()) consider(timers_.begin()->first);
+    if (wait_ms < 0 && in_flight_ == 0) {
+        throw std::logic_error("EventLoop::run: the task is suspended on something other than this loop");
+    }
+
+    epoll_event events[64];
+    int n = ::epoll_wait(epoll_fd_, events, 64, wait_ms);
+    if (n < 0 && errno != EINTR) {
+        throw std::runtime_error(std::string("epoll_wait failed: ") + std::strerror(errno));
+    }
+
+    int running = 0;
+    for (int i = 0; i < n; ++i) {
+        int flags = 0;
+        if (events[i].events & EPOLLIN) flags |= CURL_CSELECT_IN;
+        if (events[i].events & EPOLLOUT) flags |= CURL_CSELECT_OUT;
+        if (events[i].events & (EPOLLERR | EPOLLHUP)) flags |= CURL_CSELECT_ERR;
+        curl_multi_socket_action(multi_, events[i].data.fd, flags, &running);
+    }
+    if (curl_timer_armed_ && clock::now() >= curl_deadline_) {
+        curl_timer_armed_ = false;
+        curl_multi_socket_action(multi_, CURL_SOCKET_TIMEOUT, 0, &running);
+    }
+
+    finish_transfers();
+    fire_timers();
+}
+
+void EventLoop::finish_transfers() {
+    // Collect first: resumed coroutines add and remove handles
+    std::vector<Transfer*> done;
+    int pending = 0;
+    while (CURLMsg* msg = curl_multi_info_read(multi_, &pending)) {
+        if (msg->msg != CURLMSG_DONE) continue;
+        char* priv = nullptr;
+        curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &priv);
+        auto* t = reinterpret_cast<Transfer*>(priv);
+        t->result = msg->data.result;
+        curl_multi_remove_handle(multi_, msg->easy_handle);
+        t->in_multi = false;
+        in_flight_--;
+        done.push_back(t);
+    }
+    for (Transfer* t : done) t->waiter.resume();
+}
+
+void EventLoop::fire_timers() {
+    auto now = std::chrono::steady_clock::now();
+    std::vector<std::coroutine_handle<>> due;
+    while (!timers_.empty() && timers_.begin()->first <= now) {
+        due.push_back(timers_.begin()->second);
+        timers_.erase(timers_.begin());
+    }
+    for (auto h : due) h.resume();
+}
+
+Task<HttpResponse> AsyncHttpClient::send(HttpRequest request) {
+    std::optional<TransferFlow> flow;
+    if (transfer_limits_active()) {
+        flow.emplace(default_class(request), transfer_destination(request.url));
+        for (auto wait = flow->admit_delay(); wait.count() > 0; wait = flow->admit_delay()) {
+            co_await loop_.sleep_for(wait);
+        }
+    }
+
+    EventLoop::Transfer t(loop_);
+    CURL* curl = t.easy;
+    UploadSource upload{&request.body, 0};
+
+    curl_easy_setopt(curl, CURLOPT_URL, request.url.c_str());
+    if (request.method == "HEAD") {
+        curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+    } else if (request.method == "PUT") {
+        curl_easy_setopt(curl, CURLOPT_UPLOAD, 1L);
+        curl_easy_setopt(curl, CURLOPT_READFUNCTION, upload_read_callback);
+        curl_easy_setopt(curl, CURLOPT_READDATA, &upload);
+        curl_easy_setopt(curl, CURLOPT_INFILESIZE_LARGE, static_cast<curl_off_t>(request.body.size()));
+    } else if (request.method == "POST") {
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDS, request.body.data());
+        curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(request.body.size()));
+    } else if (request.method != "GET") {
+        throw std::invalid_argument("unsupported HTTP method: " + request.method);
+    }
+    if (!request.range.empty()) {
+        curl_easy_setopt(curl, CURLOPT_RANGE, request.range.c_str());
+    }
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, detail::write_callback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &t.response.body);
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, detail::header_callback);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, &t.response.headers);
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    detail::set_stall_limits(curl);
+    if (request.timeout_ms > 0) {
+        curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, request.timeout_ms);
+    }
+    for (const auto& h : request.headers) {
+        t.headers = curl_slist_append(t.headers, h.c_str());
+    }
+    if (t.headers) curl_easy_setopt(curl, CURLOPT_HTTPHEADER, t.headers);
+
+    co_await EventLoop::TransferAwaiter{loop_, t};
+
+    if (t.result != CURLE_OK) {
+        throw std::runtime_error("CURL " + request.method + " failed: " + curl_easy_strerror(t.result));
+    }
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &t.response.status);
+    detail::record_first_byte(curl, t.response);
+    if (flow) flow->charge(request.body.size() + t.response.body.size());
+    co_return std::move(t.response);
+}
+
+Task<HttpResponse> AsyncHttpClient::get(std::string url, long timeout_ms) {
+    HttpRequest request;
+    request.url = std::move(url);
+    request.timeout_ms = timeout_ms;
+    return send(std::move(request));
+}
+
+Task<HttpResponse> AsyncHttpClient::get_range(std::string url, uint64_t offset, uint64_t length,
+                                              long timeout_ms) {
+    if (length == 0) {
+        throw std::invalid_argument("empty range");
+    }
+    HttpRequest request;
+    request.url = std::move(url);
+    request.range = std::to_string(offset) + "-" + std::to_string(offset + length - 1);
+    request.timeout_ms = timeout_ms;
+    return send(std::move(request));
+}
+
+Task<HttpResponse> AsyncHttpClient::head(std::string url, long timeout_ms) {
+    HttpRequest request;
+    request.method = "HEAD";
+    request.url = std::move(url);
+    request.timeout_ms = timeout_ms;
+    return send(std::move(request));
+}
+
+Task<HttpResponse> AsyncHttpClient::put(std::string url, std::vector<uint8_t> data, std::string content_type,
+                                        std::vector<std::string> extra_headers) {
+    HttpRequest request;
+    request.method = "PUT";
+    request.url = std::move(url);
+    request.body = std::move(data);
+    request.headers.push_back("Content-Type: " + content_type);
+    for (auto& h : extra_headers) request.headers.push_back(std::move(h));
+    return send(std::move(request));
+}
+
+Task<HttpResponse> AsyncHttpClient::post(std::string url, std::vector<uint8_t> data, std::string content_type,
+                                         std::vector<std::string> extra_headers, long timeout_ms) {
+    HttpRequest request;
+    request.method = "POST";
+    request.url = std::move(url);
+    request.body = std::move(data);
+    request.headers.push_back("Content-Type: " + content_type);
+    for (auto& h : extra_headers) request.headers.push_back(std::move(h));
+    request.timeout_ms = timeout_ms;
+    return send(std::move(request));
+}
+
+} // namespace slp
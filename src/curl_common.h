@@ -0,0 +1,20 @@
+#pragma once
+#include <curl/curl.h>
+#include <cstddef>
+
+#include "slp/http_client.h"
+
+// libcurl callbacks shared by the blocking and async clients
+
+namespace slp::detail {
+
+// Appends to the std::vector<uint8_t> passed as userp
+size_t write_callback(void* contents, size_t size, size_t nmemb, void* userp);
+// Collects "Name: value" lines into the header vector passed as userp
+size_t header_callback(char* buffer, size_t size, size_t nitems, void* userp);
+
+void record_first_byte(CURL* curl, HttpResponse& response);
+// Connect timeout plus low-speed abort instead of a total time limit
+void set_stall_limits(CURL* curl);
+
+} // namespace slp::detail
@@ -0,0 +1,139 @@
+#include "slp/file_hash.h"
+#include "slp/json.h"
+#include "slp/sha256.h"
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+namespace slp {
+
+namespace {
+
+// Filesystem timestamps advance in ticks (jiffies, or whole seconds on some
+// filesystems); a write within the same tick as the last one leaves them
+// unchanged, so files modified this recently are hashed but not recorded
+constexpr int64_t kRacyWindowNs = 2'000'000'000;
+
+int64_t to_ns(const struct timespec& ts) {
+    return static_cast<int64_t>(ts.tv_sec) * 1'000'000'000 + ts.tv_nsec;
+}
+
+int64_t wall_now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+bool is_hex_digest(const std::string& s) {
+    if (s.size() != 64) return false;
+    for (char c : s) {
+        if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f'))) return false;
+    }
+    return true;
+}
+
+std::string entry_json(const std::string& path, const FileFingerprint& fp, const std::string& sha256) {
+    return "{\"path\":\"" + json::escape(path) + "\",\"dev\":" + std::to_string(fp.dev) +
+           ",\"ino\":" + std::to_string(fp.ino) + ",\"size\":" + std::to_string(fp.size) +
+           ",\"mtime_ns\":" + std::to_string(fp.mtime_ns) + ",\"ctime_ns\":" + std::to_string(fp.ctime_ns) +
+           ",\"sha256\":\"" + sha256 + "\"}\n";
+}
+
+} // anonymous namespace
+
+FileFingerprint fingerprint_file(const std::string& path) {
+    struct stat st {};
+    if (::stat(path.c_str(), &st) != 0) throw std::runtime_error("cannot stat file: " + path);
+    FileFingerprint fp;
+    fp.dev = static_cast<uint64_t>(st.st_dev);
+    fp.ino = static_cast<uint64_t>(st.st_ino);
+    fp.size = static_cast<uint64_t>(st.st_size);
+    fp.mtime_ns = to_ns(st.st_mtim);
+    fp.ctime_ns = to_ns(st.st_ctim);
+    return fp;
+}
+
+HashCache::HashCache(std::string dir) : dir_(std::move(dir)) {}
+
+std::string HashCache::entry_path(const FileFingerprint& fp) const {
+    return dir_ + "/" + std::to_string(fp.dev) + "-" + std::to_string(fp.ino) + ".json";
+}
+
+std::optional<std::string> HashCache::lookup(const std::string& path) const {
+    FileFingerprint fp = fingerprint_file(path);
+    std::ifstream in(entry_path(fp), std::ios::binary);
+    if (!in) return std::nullopt;
+    std::string body((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    // A damaged entry is a miss, not an error: the file is simply hashed again
+    json::Value v;
+    try {
+        v = json::parse(body);
+    } catch (const std::exception&) {
+        return std::nullopt;
+    }
+    FileFingerprint stored;
+    stored.dev = static_cast<uint64_t>(v.get_int("dev"));
+    stored.ino = static_cast<uint64_t>(v.get_int("ino"));
+    stored.size = static_cast<uint64_t>(v.get_int("size"));
+    stored.mtime_ns = v.get_int("mtime_ns");
+    stored.ctime_ns = v.get_int("ctime_ns");
+    std::string hash = v.get_string("sha256");
+    if (stored != fp || !is_hex_digest(hash)) return std::nullopt;
+    return hash;
+}
+
+FileHash HashCache::sha256(const std::string& path, const std::function<std::string()>& compute) {
+    FileHash r;
+    if (auto hash = lookup(path)) {
+        r.sha256 = std::move(*hash);
+        r.reused = true;
+        return r;
+    }
+
+    int64_t started_ns = wall_now_ns();
+    FileFingerprint before = fingerprint_file(path);
+    r.sha256 = compute ? compute() : sha256_file_hex(path);
+    FileFingerprint after = fingerprint_file(path);
+
+    bool settled = std::max(after.mtime_ns, after.ctime_ns) < started_ns - kRacyWindowNs;
+    if (before != after || !settled) return r;
+
+    // Recording is best effort; a hash that cannot be stored is still correct
+    std::error_code ec;
+    fs::create_directories(dir_, ec);
+    std::string dest = entry_path(after);
+    std::string tmp = dest + ".tmp." + std::to_string(::getpid());
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out) return r;
+        out << entry_json(fs::absolute(path, ec).string(), after, r.sha256);
+        if (!out.flush()) {
+            fs::remove(tmp, ec);
+            return r;
+        }
+    }
+    fs::rename(tmp, dest, ec);
+    if (ec) {
+        fs::remove(tmp, ec);
+        return r;
+    }
+    r.stored = true;
+    return r;
+}
+
+void HashCache::forget(const std::string& path) {
+    std::error_code ec;
+    fs::remove(entry_path(fingerprint_file(path)), ec);
+}
+
+} // namespace slp
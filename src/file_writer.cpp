@@ -0,0 +1,500 @@
+#include "slp/file_writer.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifdef SLP_HAVE_IO_URING
+#include <linux/io_uring.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace slp {
+
+namespace {
+
+size_t round_up(size_t n, size_t align) {
+    return (n + align - 1) / align * align;
+}
+
+std::string errno_text(const std::string& what) {
+    return what + ": " + std::strerror(errno);
+}
+
+// Page-aligned buffer as O_DIRECT requires
+class AlignedBuffer {
+public:
+    explicit AlignedBuffer(size_t capacity) : capacity_(capacity) {
+        void* p = nullptr;
+        if (::posix_memalign(&p, kDirectAlignment, capacity) != 0) throw std::bad_alloc();
+        data_ = static_cast<uint8_t*>(p);
+    }
+    ~AlignedBuffer() { std::free(data_); }
+
+    AlignedBuffer(AlignedBuffer&& other) noexcept
+        : size(other.size), offset(other.offset), data_(other.data_), capacity_(other.capacity_) {
+        other.data_ = nullptr;
+    }
+    AlignedBuffer(const AlignedBuffer&) = delete;
+    AlignedBuffer& operator=(const AlignedBuffer&) = delete;
+    AlignedBuffer& operator=(AlignedBuffer&&) = delete;
+
+    uint8_t* data() const { return data_; }
+    size_t capacity() const { return capacity_; }
+
+    size_t size = 0;      // bytes filled
+    uint64_t offset = 0;  // file offset of data()[0]
+
+private:
+    uint8_t* data_;
+    size_t capacity_;
+};
+
+// Open for writing, falling back to buffered I/O where O_DIRECT is refused
+// (tmpfs, some network filesystems)
+int open_output(const std::string& path, bool& direct) {
+    if (direct) {
+        int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_DIRECT, 0644);
+        if (fd >= 0) return fd;
+        if (errno != EINVAL) throw std::runtime_error(errno_text("cannot create file " + path));
+        direct = false;
+    }
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT, 0644);
+    if (fd < 0) throw std::runtime_error(errno_text("cannot create file " + path));
+    return fd;
+}
+
+void pwrite_all(int fd, const uint8_t* data, size_t len, uint64_t offset) {
+    while (len > 0) {
+        ssize_t n = ::pwrite(fd, data, len, static_cast<off_t>(offset));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error(errno_text("write failed"));
+        }
+        data += n;
+        len -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+}
+
+std::string describe_mode(const char* engine, bool direct, unsigned qd, size_t buffer) {
+    std::ostringstream oss;
+    oss << engine << (direct ? "+O_DIRECT" : "");
+    if (qd > 0) oss << " qd=" << qd;
+    if (buffer > 0) oss << " buf=" << buffer / 1024 << "K";
+    return oss.str();
+}
+
+// Synchronous pwrite. Buffered mode hands every write to the page cache;
+// direct mode stages data in one aligned buffer.
+class PwriteWriter : public FileWriter {
+public:
+    PwriteWriter(int fd, uint64_t start, bool direct, size_t buffer_size)
+        : fd_(fd), offset_(start), direct_(direct) {
+        if (direct_) {
+            buffer_.emplace_back(buffer_size);
+            buffer_[0].offset = start;
+        }
+    }
+
+    ~PwriteWriter() override {
+        if (fd_ >= 0) ::close(fd_);
+    }
+
+    void write(const uint8_t* data, size_t len) override {
+        if (!direct_) {
+            pwrite_all(fd_, data, len, offset_);
+            offset_ += len;
+            return;
+        }
+
+        auto& buf = buffer_[0];
+        while (len > 0) {
+            size_t n = std::min(len, buf.capacity() - buf.size);
+            std::memcpy(buf.data() + buf.size, data, n);
+            buf.size += n;
+            data += n;
+            len -= n;
+            offset_ += n;
+            if (buf.size == buf.capacity()) {
+                pwrite_all(fd_, buf.data(), buf.size, buf.offset);
+                buf.offset += buf.size;
+                buf.size = 0;
+            }
+        }
+    }
+
+    void finish() override {
+        if (direct_ && buffer_[0].size > 0) {
+            // O_DIRECT writes whole blocks: pad, then cut back to size
+            auto& buf = buffer_[0];
+            size_t padded = round_up(buf.size, kDirectAlignment);
+            std::memset(buf.data() + buf.size, 0, padded - buf.size);
+            pwrite_all(fd_, buf.data(), padded, buf.offset);
+            buf.size = 0;
+        }
+        if (::ftruncate(fd_, static_cast<off_t>(offset_)) != 0) {
+            throw std::runtime_error(errno_text("truncate failed"));
+        }
+        int fd = fd_;
+        fd_ = -1;
+        if (::close(fd) != 0) throw std::runtime_error(errno_text("close failed"));
+    }
+
+    uint64_t offset() const override { return offset_; }
+
+    std::string describe() const override {
+        return describe_mode("pwrite", direct_, 0, direct_ ? buffer_[0].capacity() : 0);
+    }
+
+private:
+    int fd_;
+    uint64_t offset_;
+    bool direct_;
+    std::vector<AlignedBuffer> buffer_;
+};
+
+#ifdef SLP_HAVE_IO_URING
+
+int sys_io_uring_setup(unsigned entries, io_uring_params* p) {
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, p));
+}
+
+int sys_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+    return static_cast<int>(::syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+// Minimal io_uring ring over the raw syscalls (liburing is not required):
+// `queue_depth` aligned buffers rotate between being filled and being
+// written by the kernel.
+class UringWriter : public FileWriter {
+public:
+    UringWriter(int fd, uint64_t start, bool direct, size_t buffer_size, unsigned queue_depth)
+        : fd_(fd), offset_(start), direct_(direct) {
+        io_uring_params p{};
+        ring_fd_ = sys_io_uring_setup(queue_depth, &p);
+        if (ring_fd_ < 0) throw std::runtime_error(errno_text("io_uring_setup failed"));
+
+        // The destructor does not run for a constructor that throws, and
+        // buffer allocation can still fail after the rings are mapped. The
+        // file fd stays open: the caller falls back to another writer on it.
+        try {
+            map_rings(p);
+
+            // Never more buffers in flight than the SQ can hold
+            queue_depth_ = std::min(queue_depth, p.sq_entries);
+            for (unsigned i = 0; i < queue_depth_; ++i) {
+                buffers_.emplace_back(buffer_size);
+                free_.push_back(i);
+            }
+            pending_.resize(queue_depth_);
+            current_ = take_free();
+            buffers_[current_].offset = start;
+        } catch (...) {
+            unmap_rings();
+            throw;
+        }
+    }
+
+    ~UringWriter() override {
+        // The kernel may still be reading our buffers
+        try {
+            while (in_flight_ > 0) reap(1);
+        } catch (...) {
+        }
+        unmap_rings();
+        if (fd_ >= 0) ::close(fd_);
+    }
+
+    void write(const uint8_t* data, size_t len) override {
+        while (len > 0) {
+            auto& buf = buffers_[current_];
+            size_t n = std::min(len, buf.capacity() - buf.size);
+            std::memcpy(buf.data() + buf.size, data, n);
+            buf.size += n;
+            data += n;
+            len -= n;
+            offset_ += n;
+            if (buf.size == buf.capacity()) {
+                uint64_t next = buf.offset + buf.size;
+                submit(current_, buf.size);
+                current_ = take_free();
+                buffers_[current_].offset = next;
+            }
+        }
+    }
+
+    void finish() override {
+        auto& buf = buffers_[current_];
+        if (buf.size > 0) {
+            size_t len = buf.size;
+            if (direct_) {
+                len = round_up(buf.size, kDirectAlignment);
+                std::memset(buf.data() + buf.size, 0, len - buf.size);
+            }
+            submit(current_, len);
+        }
+        while (in_flight_ > 0) reap(1);
+
+        if (::ftruncate(fd_, static_cast<off_t>(offset_)) != 0) {
+            throw std::runtime_error(errno_text("truncate failed"));
+        }
+        int fd = fd_;
+        fd_ = -1;
+        if (::close(fd) != 0) throw std::runtime_error(errno_text("close failed"));
+    }
+
+    uint64_t offset() const override { return offset_; }
+
+    std::string describe() const override {
+        return describe_mode("io_uring", direct_, queue_depth_, buffers_[0].capacity());
+    }
+
+private:
+    struct Pending {
+        size_t done = 0;
+        size_t len = 0;
+    };
+
+    void map_rings(const io_uring_params& p) {
+        sq_map_size_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+        cq_map_size_ = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+        bool single = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single) sq_map_size_ = cq_map_size_ = std::max(sq_map_size_, cq_map_size_);
+
+        sq_map_ = ::mmap(nullptr, sq_map_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                         ring_fd_, IORING_OFF_SQ_RING);
+        if (sq_map_ == MAP_FAILED) {
+            sq_map_ = nullptr;
+            throw std::runtime_error(errno_text("io_uring SQ mmap failed"));
+        }
+        if (single) {
+            cq_map_ = sq_map_;
+        } else {
+            cq_map_ = ::mmap(nullptr, cq_map_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                             ring_fd_, IORING_OFF_CQ_RING);
+            if (cq_map_ == MAP_FAILED) {
+                cq_map_ = nullptr;
+                throw std::runtime_error(errno_text("io_uring CQ mmap failed"));
+            }
+        }
+        sqes_size_ = p.sq_entries * sizeof(io_uring_sqe);
+        void* sqes = ::mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                            ring_fd_, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED) throw std::runtime_error(errno_text("io_uring SQE mmap failed"));
+        sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+        auto* sq = static_cast<uint8_t*>(sq_map_);
+        sq_tail_ = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+        sq_mask_ = *reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+        sq_array_ = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+
+        auto* cq = static_cast<uint8_t*>(cq_map_);
+        cq_head_ = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+        cq_mask_ = *reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cq + p.cq_off.cqes);
+    }
+
+    void unmap_rings() {
+        if (sqes_) ::munmap(sqes_, sqes_size_);
+        if (cq_map_ && cq_map_ != sq_map_) ::munmap(cq_map_, cq_map_size_);
+        if (sq_map_) ::munmap(sq_map_, sq_map_size_);
+        sqes_ = nullptr;
+        cq_map_ = sq_map_ = nullptr;
+        if (ring_fd_ >= 0) ::close(ring_fd_);
+        ring_fd_ = -1;
+    }
+
+    unsigned take_free() {
+        while (free_.empty()) reap(1);
+        unsigned idx = free_.back();
+        free_.pop_back();
+        buffers_[idx].size = 0;
+        return idx;
+    }
+
+    void submit(unsigned idx, size_t len) {
+        pending_[idx] = {0, len};
+        push_sqe(idx);
+    }
+
+    void push_sqe(unsigned idx) {
+        const auto& buf = buffers_[idx];
+        const auto& pend = pending_[idx];
+
+        unsigned tail = *sq_tail_;
+        unsigned slot = tail & sq_mask_;
+        io_uring_sqe* sqe = &sqes_[slot];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = IORING_OP_WRITE;
+        sqe->fd = fd_;
+        sqe->addr = reinterpret_cast<uint64_t>(buf.data() + pend.done);
+        sqe->len = static_cast<uint32_t>(pend.len - pend.done);
+        sqe->off = buf.offset + pend.done;
+        sqe->user_data = idx;
+        sq_array_[slot] = slot;
+        __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+        in_flight_++;
+
+        while (sys_io_uring_enter(ring_fd_, 1, 0, 0) < 0) {
+            if (errno != EINTR && errno != EAGAIN) throw std::runtime_error(errno_text("io_uring_enter failed"));
+        }
+    }
+
+    // Wait for at least `min` completions and recycle their buffers
+    void reap(unsigned min) {
+        unsigned head = *cq_head_;
+        if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+            if (sys_io_uring_enter(ring_fd_, 0, min, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR) {
+                throw std::runtime_error(errno_text("io_uring_enter failed"));
+            }
+        }
+
+        std::vector<unsigned> resubmit;
+        int error = 0;
+        while (head != __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+            const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+            auto idx = static_cast<unsigned>(cqe.user_data);
+            int res = cqe.res;
+            head++;
+            in_flight_--;
+
+            if (res < 0) {
+                error = -res;
+                free_.push_back(idx);
+                continue;
+            }
+            auto& pend = pending_[idx];
+            pend.done += static_cast<size_t>(res);
+            if (res == 0 || pend.done >= pend.len) {
+                if (res == 0 && pend.done < pend.len) error = EIO;
+                free_.push_back(idx);
+            } else {
+                resubmit.push_back(idx);  // short write: send the rest
+            }
+        }
+        __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+
+        if (error != 0) {
+            errno = error;
+            throw std::runtime_error(errno_text("io_uring write failed"));
+        }
+        for (unsigned idx : resubmit) push_sqe(idx);
+    }
+
+    int fd_;
+    uint64_t offset_;
+    bool direct_;
+    unsigned queue_depth_ = 0;
+
+    int ring_fd_ = -1;
+    void* sq_map_ = nullptr;
+    void* cq_map_ = nullptr;
+    size_t sq_map_size_ = 0;
+    size_t cq_map_size_ = 0;
+    io_uring_sqe* sqes_ = nullptr;
+    size_t sqes_size_ = 0;
+    unsigned* sq_tail_ = nullptr;
+    unsigned sq_mask_ = 0;
+    unsigned* sq_array_ = nullptr;
+    unsigned* cq_head_ = nullptr;
+    unsigned* cq_tail_ = nullptr;
+    unsigned cq_mask_ = 0;
+    io_uring_cqe* cqes_ = nullptr;
+
+    std::vector<AlignedBuffer> buffers_;
+    std::vector<Pending> pending_;
+    std::vector<unsigned> free_;
+    unsigned current_ = 0;
+    unsigned in_flight_ = 0;
+};
+
+#endif // SLP_HAVE_IO_URING
+
+} // anonymous namespace
+
+bool io_uring_available() {
+#ifdef SLP_HAVE_IO_URING
+    // Seccomp profiles and kernel.io_uring_disabled can forbid it at runtime
+    static const bool available = [] {
+        io_uring_params p{};
+        int fd = sys_io_uring_setup(1, &p);
+        if (fd < 0) return false;
+        ::close(fd);
+        return true;
+    }();
+    return available;
+#else
+    return false;
+#endif
+}
+
+std::unique_ptr<FileWriter> open_file_writer(const std::string& path,
+                                             uint64_t start_offset,
+                                             const FileWriterOptions& options) {
+    bool direct = options.direct;
+    if (direct && start_offset % kDirectAlignment != 0) {
+        throw std::invalid_argument("O_DIRECT writer needs an aligned start offset");
+    }
+    size_t buffer_size = round_up(std::max<size_t>(options.buffer_size, 1), kDirectAlignment);
+
+    int fd = open_output(path, direct);
+    if (::ftruncate(fd, static_cast<off_t>(start_offset)) != 0) {
+        ::close(fd);
+        throw std::runtime_error(errno_text("cannot truncate " + path));
+    }
+
+#ifdef SLP_HAVE_IO_URING
+    if (options.io_uring && io_uring_available()) {
+        try {
+            return std::make_unique<UringWriter>(fd, start_offset, direct, buffer_size,
+                                                 std::max(options.queue_depth, 1u));
+        } catch (const std::exception&) {
+            // Ring setup failed (limits, seccomp); pwrite still works
+        }
+    }
+#endif
+    return std::make_unique<PwriteWriter>(fd, start_offset, direct, buffer_size);
+}
+
+FileWriterOptions parse_write_spec(const std::string& spec) {
+    FileWriterOptions opts;
+    std::istringstream iss(spec);
+    std::string part;
+    bool first = true;
+    while (std::getline(iss, part, ':')) {
+        if (first) {
+            first = false;
+            if (part == "buffered") {
+            } else if (part == "direct") {
+                opts.direct = true;
+            } else if (part == "uring") {
+                opts.io_uring = true;
+            } else if (part == "uring+direct" || part == "direct+uring") {
+                opts.io_uring = true;
+                opts.direct = true;
+            } else {
+                throw std::invalid_argument("unknown write mode: " + part);
+            }
+        } else if (part.rfind("qd=", 0) == 0) {
+            opts.queue_depth = static_cast<unsigned>(std::stoul(part.substr(3)));
+        } else if (part.rfind("buf=", 0) == 0) {
+            opts.buffer_size = std::stoul(part.substr(4)) * 1024;
+        } else {
+            throw std::invalid_argument("unknown write option: " + part);
+        }
+    }
+    return opts;
+}
+
+} // namespace slp
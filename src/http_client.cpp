@@ -1,11 +1,16 @@
 #include "slp/http_client.h"
+#include "curl_common.h"
 #include <curl/curl.h>
+#include <unistd.h>
 #include <stdexcept>
+#include <algorithm>
+#include <cctype>
 #include <cstring>
+#include <optional>
 
 namespace slp {
 
-namespace {
+namespace detail {
 
 // Callback for libcurl to write response data
 size_t write_callback(void* contents, size_t size, size_t nmemb, void* userp) {
@@ -16,26 +21,184 @@ size_t write_callback(void* contents, size_t size, size_t nmemb, void* userp) {
     return total_size;
 }
 
+// Callback for libcurl to collect "Name: value" response header lines
+size_t header_callback(char* buffer, size_t size, size_t nitems, void* userp) {
+    size_t total_size = size * nitems;
+    auto* headers = static_cast<std::vector<std::pair<std::string, std::string>>*>(userp);
+    std::string line(buffer, total_size);
+
+    // A new status line starts a new header block (redirects, 100-continue)
+    if (line.rfind("HTTP/", 0) == 0) {
+        headers->clear();
+        return total_size;
+    }
+
+    size_t colon = line.find(':');
+    if (colon == std::string::npos) return total_size;
+
+    std::string name = line.substr(0, colon);
+    size_t start = colon + 1;
+    while (start < line.size() && (line[start] == ' ' || line[start] == '\t')) start++;
+    size_t end = line.size();
+    while (end > start && (line[end - 1] == '\r' || line[end - 1] == '\n' || line[end - 1] == ' ')) end--;
+    headers->emplace_back(std::move(name), line.substr(start, end - start));
+    return total_size;
+}
+
+void record_first_byte(CURL* curl, HttpResponse& response) {
+    curl_off_t us = 0;
+    curl_easy_getinfo(curl, CURLINFO_STARTTRANSFER_TIME_T, &us);
+    response.first_byte_us = static_cast<int64_t>(us);
+}
+
+// Abort only when the transfer stalls, never because it is large
+void set_stall_limits(CURL* curl) {
+    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS, kConnectTimeoutMs);
+    curl_easy_setopt(curl, CURLOPT_LOW_SPEED_LIMIT, kLowSpeedBytesPerSec);
+    curl_easy_setopt(curl, CURLOPT_LOW_SPEED_TIME, kLowSpeedSeconds);
+}
+
+} // namespace detail
+
+namespace {
+
+using detail::header_callback;
+using detail::record_first_byte;
+using detail::set_stall_limits;
+using detail::write_callback;
+
+// Hedging control and bandwidth pacing of one request. Body bytes are paid
+// for as libcurl hands them over, at most one buffer (16 KiB) at a time;
+// while a callback waits, the socket is not read and TCP holds the sender
+// back.
+struct Pacing {
+    TransferControl* control;
+    std::optional<TransferFlow> flow;
+    std::vector<uint8_t>* body = nullptr;  // destination of paced_write_callback
+
+    Pacing(TransferControl* c, const std::string& url, TrafficClass cls) : control(c) {
+        if (transfer_limits_active()) flow.emplace(cls, transfer_destination(url));
+    }
+    void pay(size_t bytes) {
+        if (flow && bytes > 0) flow->acquire(bytes);
+    }
+};
+
+// write_callback, after waiting for bandwidth
+size_t paced_write_callback(void* contents, size_t size, size_t nmemb, void* userp) {
+    auto* pacing = static_cast<Pacing*>(userp);
+    pacing->pay(size * nmemb);
+    return write_callback(contents, size, nmemb, pacing->body);
+}
+
+// Progress callback: returning non-zero aborts with CURLE_ABORTED_BY_CALLBACK
+int control_callback(void* userp, curl_off_t, curl_off_t dlnow, curl_off_t, curl_off_t) {
+    auto* control = static_cast<TransferControl*>(userp);
+    if (dlnow > 0) control->responded.store(true, std::memory_order_relaxed);
+    return control->cancel.load(std::memory_order_relaxed) ? 1 : 0;
+}
+
+// Hook up hedging control, and route a buffered response `body` through
+// paced_write_callback when limits are active
+void apply_pacing(CURL* curl, Pacing& pacing, std::vector<uint8_t>* body) {
+    if (pacing.control) {
+        curl_easy_setopt(curl, CURLOPT_NOPROGRESS, 0L);
+        curl_easy_setopt(curl, CURLOPT_XFERINFOFUNCTION, control_callback);
+        curl_easy_setopt(curl, CURLOPT_XFERINFODATA, pacing.control);
+    }
+    if (pacing.flow && body) {
+        pacing.body = body;
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, paced_write_callback);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &pacing);
+    }
+}
+
+struct BufferSource {
+    const std::vector<uint8_t>* data;
+    size_t offset;
+    Pacing* pacing;
+};
+
 // Callback for libcurl to read request data
 size_t read_callback(char* buffer, size_t size, size_t nitems, void* userp) {
-    auto* ctx = static_cast<std::pair<const std::vector<uint8_t>*, size_t>*>(userp);
-    const auto& data = *ctx->first;
-    size_t& offset = ctx->second;
+    auto* src = static_cast<BufferSource*>(userp);
+    const auto& data = *src->data;
 
     size_t max_copy = size * nitems;
-    size_t remaining = data.size() - offset;
+    size_t remaining = data.size() - src->offset;
     size_t to_copy = std::min(max_copy, remaining);
 
     if (to_copy > 0) {
-        std::memcpy(buffer, data.data() + offset, to_copy);
-        offset += to_copy;
+        src->pacing->pay(to_copy);
+        std::memcpy(buffer, data.data() + src->offset, to_copy);
+        src->offset += to_copy;
     }
 
     return to_copy;
 }
 
+struct StreamSink {
+    CURL* curl;
+    const HttpClient::BodySink* sink;
+    long status = 0;
+    std::vector<uint8_t>* error_body;
+    Pacing* pacing;
+};
+
+// Hands 200/206 bodies to the caller's sink; anything else is kept as the
+// error body
+size_t stream_write_callback(void* contents, size_t size, size_t nmemb, void* userp) {
+    size_t total_size = size * nmemb;
+    auto* sink = static_cast<StreamSink*>(userp);
+    auto* data = static_cast<const uint8_t*>(contents);
+
+    if (sink->status == 0) {
+        curl_easy_getinfo(sink->curl, CURLINFO_RESPONSE_CODE, &sink->status);
+    }
+    if (sink->status != 200 && sink->status != 206) {
+        sink->error_body->insert(sink->error_body->end(), data, data + total_size);
+        return total_size;
+    }
+    sink->pacing->pay(total_size);
+    // Returning less than given aborts the transfer with CURLE_WRITE_ERROR
+    return (*sink->sink)(sink->status, data, total_size) ? total_size : 0;
+}
+
+struct FileSource {
+    int fd;
+    uint64_t offset;
+    uint64_t remaining;
+    Pacing* pacing;
+};
+
+size_t file_read_callback(char* buffer, size_t size, size_t nitems, void* userp) {
+    auto* src = static_cast<FileSource*>(userp);
+    size_t to_read = static_cast<size_t>(std::min<uint64_t>(size * nitems, src->remaining));
+    if (to_read == 0) return 0;
+    src->pacing->pay(to_read);
+
+    ssize_t n = ::pread(src->fd, buffer, to_read, static_cast<off_t>(src->offset));
+    if (n <= 0) return CURL_READFUNC_ABORT;
+    src->offset += static_cast<uint64_t>(n);
+    src->remaining -= static_cast<uint64_t>(n);
+    return static_cast<size_t>(n);
+}
+
 } // anonymous namespace
 
+std::string HttpResponse::header(const std::string& name) const {
+    for (const auto& [key, value] : headers) {
+        if (key.size() == name.size() &&
+            std::equal(key.begin(), key.end(), name.begin(), [](char a, char b) {
+                return std::tolower(static_cast<unsigned char>(a)) ==
+                       std::tolower(static_cast<unsigned char>(b));
+            })) {
+            return value;
+        }
+    }
+    return "";
+}
+
 HttpClient::HttpClient() {
     curl_ = curl_easy_init();
     if (!curl_) {
@@ -49,16 +212,63 @@ HttpClient::~HttpClient() {
     }
 }
 
-HttpResponse HttpClient::get(const std::string& url) const {
+HttpResponse HttpClient::get(const std::string& url, long timeout_ms,
+                             const std::vector<std::string>& extra_headers) const {
+    HttpResponse response;
+    CURL* curl = static_cast<CURL*>(curl_);
+
+    curl_easy_reset(curl);
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response.body);
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, header_callback);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, &response.headers);
+    Pacing pacing(control_, url, traffic_class(TrafficClass::normal));
+    apply_pacing(curl, pacing, &response.body);
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, timeout_ms);
+
+    struct curl_slist* headers = nullptr;
+    for (const auto& h : extra_headers) {
+        headers = curl_slist_append(headers, h.c_str());
+    }
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+
+    CURLcode res = curl_easy_perform(curl);
+
+    curl_slist_free_all(headers);
+
+    if (res != CURLE_OK) {
+        throw std::runtime_error(std::string("CURL GET failed: ") + curl_easy_strerror(res));
+    }
+
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response.status);
+    record_first_byte(curl, response);
+    return response;
+}
+
+HttpResponse HttpClient::get_range(const std::string& url, uint64_t offset, uint64_t length,
+                                   long timeout_ms) const {
+    if (length == 0) {
+        throw std::invalid_argument("empty range");
+    }
+
     HttpResponse response;
     CURL* curl = static_cast<CURL*>(curl_);
+    std::string range = std::to_string(offset) + "-" + std::to_string(offset + length - 1);
 
     curl_easy_reset(curl);
     curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_RANGE, range.c_str());
     curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
     curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response.body);
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, header_callback);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, &response.headers);
+    Pacing pacing(control_, url,
+                  traffic_class(length <= kInteractiveMaxBytes ? TrafficClass::interactive : TrafficClass::bulk));
+    apply_pacing(curl, pacing, &response.body);
     curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, timeout_ms);
 
     CURLcode res = curl_easy_perform(curl);
     if (res != CURLE_OK) {
@@ -66,33 +276,172 @@ HttpResponse HttpClient::get(const std::string& url) const {
     }
 
     curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response.status);
+    record_first_byte(curl, response);
     return response;
 }
 
+HttpResponse HttpClient::head(const std::string& url, long timeout_ms) const {
+    HttpResponse response;
+    CURL* curl = static_cast<CURL*>(curl_);
+
+    curl_easy_reset(curl);
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, header_callback);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, &response.headers);
+    Pacing pacing(control_, url, traffic_class(TrafficClass::interactive));
+    apply_pacing(curl, pacing, nullptr);
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, timeout_ms);
+
+    CURLcode res = curl_easy_perform(curl);
+    if (res != CURLE_OK) {
+        throw std::runtime_error(std::string("CURL HEAD failed: ") + curl_easy_strerror(res));
+    }
+
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response.status);
+    record_first_byte(curl, response);
+    return response;
+}
+
+HttpResponse HttpClient::get_stream(const std::string& url, uint64_t offset,
+                                    const std::string& if_range, const BodySink& body_sink) const {
+    HttpResponse response;
+    CURL* curl = static_cast<CURL*>(curl_);
+    Pacing pacing(control_, url, traffic_class(TrafficClass::bulk));
+    StreamSink sink{curl, &body_sink, 0, &response.body, &pacing};
+    std::string range = std::to_string(offset) + "-";
+
+    curl_easy_reset(curl);
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    if (offset > 0) {
+        curl_easy_setopt(curl, CURLOPT_RANGE, range.c_str());
+    }
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, stream_write_callback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &sink);
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, header_callback);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, &response.headers);
+    apply_pacing(curl, pacing, nullptr);
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    set_stall_limits(curl);
+
+    struct curl_slist* headers = nullptr;
+    std::string if_range_header = "If-Range: " + if_range;
+    if (offset > 0 && !if_range.empty()) {
+        headers = curl_slist_append(headers, if_range_header.c_str());
+        curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    }
+
+    CURLcode res = curl_easy_perform(curl);
+
+    curl_slist_free_all(headers);
+
+    if (res != CURLE_OK) {
+        throw std::runtime_error(std::string("CURL GET failed: ") + curl_easy_strerror(res));
+    }
+
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response.status);
+    record_first_byte(curl, response);
+    return response;
+}
+
+HttpResponse HttpClient::get_to_file(const std::string& url, int fd, uint64_t offset,
+                                     const std::string& if_range) const {
+    bool first = true;
+    return get_stream(url, offset, if_range, [&](long status, const uint8_t* data, size_t len) {
+        // A full response replaces whatever partial content we had
+        if (first && status == 200) {
+            offset = 0;
+            if (::ftruncate(fd, 0) != 0) return false;
+        }
+        first = false;
+        while (len > 0) {
+            ssize_t n = ::pwrite(fd, data, len, static_cast<off_t>(offset));
+            if (n <= 0) return false;
+            data += n;
+            len -= static_cast<size_t>(n);
+            offset += static_cast<uint64_t>(n);
+        }
+        return true;
+    });
+}
+
 HttpResponse HttpClient::put(const std::string& url,
                               const std::vector<uint8_t>& data,
-                              const std::string& content_type) {
+                              const std::string& content_type,
+                              const std::vector<std::string>& extra_headers) {
     HttpResponse response;
     CURL* curl = static_cast<CURL*>(curl_);
 
-    // Context for read callback
-    std::pair<const std::vector<uint8_t>*, size_t> read_ctx{&data, 0};
+    Pacing pacing(control_, url,
+                  traffic_class(data.size() <= kInteractiveMaxBytes ? TrafficClass::interactive : TrafficClass::bulk));
+    BufferSource source{&data, 0, &pacing};
 
     curl_easy_reset(curl);
     curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
     curl_easy_setopt(curl, CURLOPT_UPLOAD, 1L);
     curl_easy_setopt(curl, CURLOPT_READFUNCTION, read_callback);
-    curl_easy_setopt(curl, CURLOPT_READDATA, &read_ctx);
+    curl_easy_setopt(curl, CURLOPT_READDATA, &source);
     curl_easy_setopt(curl, CURLOPT_INFILESIZE_LARGE, static_cast<curl_off_t>(data.size()));
     curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
     curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response.body);
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, header_callback);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, &response.headers);
+    apply_pacing(curl, pacing, nullptr);
     curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 300L); // 5 min for large uploads
+    set_stall_limits(curl);
 
     // Set content type header
     struct curl_slist* headers = nullptr;
     std::string content_type_header = "Content-Type: " + content_type;
     headers = curl_slist_append(headers, content_type_header.c_str());
+    for (const auto& h : extra_headers) {
+        headers = curl_slist_append(headers, h.c_str());
+    }
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+
+    CURLcode res = curl_easy_perform(curl);
+
+    curl_slist_free_all(headers);
+
+    if (res != CURLE_OK) {
+        throw std::runtime_error(std::string("CURL PUT failed: ") + curl_easy_strerror(res));
+    }
+
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response.status);
+    record_first_byte(curl, response);
+    return response;
+}
+
+HttpResponse HttpClient::put_from_file(const std::string& url, int fd, uint64_t offset, uint64_t length,
+                                       const std::string& content_type,
+                                       const std::vector<std::string>& extra_headers) {
+    HttpResponse response;
+    CURL* curl = static_cast<CURL*>(curl_);
+    Pacing pacing(control_, url,
+                  traffic_class(length <= kInteractiveMaxBytes ? TrafficClass::interactive : TrafficClass::bulk));
+    FileSource source{fd, offset, length, &pacing};
+
+    curl_easy_reset(curl);
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(curl, CURLOPT_UPLOAD, 1L);
+    curl_easy_setopt(curl, CURLOPT_READFUNCTION, file_read_callback);
+    curl_easy_setopt(curl, CURLOPT_READDATA, &source);
+    curl_easy_setopt(curl, CURLOPT_INFILESIZE_LARGE, static_cast<curl_off_t>(length));
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response.body);
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, header_callback);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, &response.headers);
+    apply_pacing(curl, pacing, nullptr);
+    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
+    set_stall_limits(curl);
+
+    struct curl_slist* headers = nullptr;
+    std::string content_type_header = "Content-Type: " + content_type;
+    headers = curl_slist_append(headers, content_type_header.c_str());
+    for (const auto& h : extra_headers) {
+        headers = curl_slist_append(headers, h.c_str());
+    }
     curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
 
     CURLcode res = curl_easy_perform(curl);
@@ -104,6 +453,7 @@ HttpResponse HttpClient::put(const std::string& url,
     }
 
     curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response.status);
+    record_first_byte(curl, response);
     return response;
 }
 
@@ -0,0 +1,264 @@
+#include "slp/json.h"
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace slp::json {
+
+class Parser {
+public:
+    explicit Parser(const std::string& text) : s_(text) {}
+
+    Value parse_document() {
+        Value v = parse_value(0);
+        skip_ws();
+        if (pos_ != s_.size()) fail("trailing characters");
+        return v;
+    }
+
+private:
+    static constexpr int kMaxDepth = 128;
+
+    [[noreturn]] void fail(const std::string& what) const {
+        throw std::runtime_error("JSON parse error at offset " + std::to_string(pos_) + ": " + what);
+    }
+
+    void skip_ws() {
+        while (pos_ < s_.size() &&
+               (s_[pos_] == ' ' || s_[pos_] == '\t' || s_[pos_] == '\n' || s_[pos_] == '\r')) {
+            pos_++;
+        }
+    }
+
+    bool consume(const char* literal) {
+        size_t n = std::char_traits<char>::length(literal);
+        if (s_.compare(pos_, n, literal) == 0) {
+            pos_ += n;
+            return true;
+        }
+        return false;
+    }
+
+    Value parse_value(int depth) {
+        if (depth > kMaxDepth) fail("nesting too deep");
+        skip_ws();
+        if (pos_ >= s_.size()) fail("unexpected end of input");
+
+        Value v;
+        char c = s_[pos_];
+        if (c == '{') {
+            v.type_ = Value::Type::object;
+            pos_++;
+            skip_ws();
+            if (pos_ < s_.size() && s_[pos_] == '}') {
+                pos_++;
+                return v;
+            }
+            for (;;) {
+                skip_ws();
+                if (pos_ >= s_.size() || s_[pos_] != '"') fail("expected object key");
+                std::string key = parse_string();
+                skip_ws();
+                if (pos_ >= s_.size() || s_[pos_] != ':') fail("expected ':'");
+                pos_++;
+                v.object_.emplace_back(std::move(key), parse_value(depth + 1));
+                skip_ws();
+                if (pos_ < s_.size() && s_[pos_] == ',') { pos_++; continue; }
+                if (pos_ < s_.size() && s_[pos_] == '}') { pos_++; break; }
+                fail("expected ',' or '}'");
+            }
+        } else if (c == '[') {
+            v.type_ = Value::Type::array;
+            pos_++;
+            skip_ws();
+            if (pos_ < s_.size() && s_[pos_] == ']') {
+                pos_++;
+                return v;
+            }
+            for (;;) {
+                v.array_.push_back(parse_value(depth + 1));
+                skip_ws();
+                if (pos_ < s_.size() && s_[pos_] == ',') { pos_++; continue; }
+                if (pos_ < s_.size() && s_[pos_] == ']') { pos_++; break; }
+                fail("expected ',' or ']'");
+            }
+        } else if (c == '"') {
+            v.type_ = Value::Type::string;
+            v.string_ = parse_string();
+        } else if (consume("true")) {
+            v.type_ = Value::Type::boolean;
+            v.bool_ = true;
+        } else if (consume("false")) {
+            v.type_ = Value::Type::boolean;
+        } else if (consume("null")) {
+            v.type_ = Value::Type::null;
+        } else if (c == '-' || (c >= '0' && c <= '9')) {
+            parse_number(v);
+        } else {
+            fail(std::string("unexpected character '") + c + "'");
+        }
+        return v;
+    }
+
+    void parse_number(Value& v) {
+        size_t start = pos_;
+        bool integral = true;
+        if (s_[pos_] == '-') pos_++;
+        while (pos_ < s_.size()) {
+            char c = s_[pos_];
+            if (c >= '0' && c <= '9') {
+                pos_++;
+            } else if (c == '.' || c == 'e' || c == 'E' || c == '+' || c == '-') {
+                integral = false;
+                pos_++;
+            } else {
+                break;
+            }
+        }
+
+        std::string text = s_.substr(start, pos_ - start);
+        char* end = nullptr;
+        v.type_ = Value::Type::number;
+        v.number_ = std::strtod(text.c_str(), &end);
+        if (end != text.c_str() + text.size()) fail("bad number");
+        if (integral) {
+            v.integer_ = std::strtoll(text.c_str(), nullptr, 10);
+        } else {
+            v.integer_ = static_cast<int64_t>(std::llround(v.number_));
+        }
+    }
+
+    unsigned parse_hex4() {
+        if (pos_ + 4 > s_.size()) fail("truncated \\u escape");
+        unsigned cp = 0;
+        for (int i = 0; i < 4; ++i) {
+            char c = s_[pos_++];
+            cp <<= 4;
+            if (c >= '0' && c <= '9') cp |= static_cast<unsigned>(c - '0');
+            else if (c >= 'a' && c <= 'f') cp |= static_cast<unsigned>(c - 'a' + 10);
+            else if (c >= 'A' && c <= 'F') cp |= static_cast<unsigned>(c - 'A' + 10);
+            else fail("bad \\u escape");
+        }
+        return cp;
+    }
+
+    static void append_utf8(std::string& out, unsigned cp) {
+        if (cp < 0x80) {
+            out += static_cast<char>(cp);
+        } else if (cp < 0x800) {
+            out += static_cast<char>(0xc0 | (cp >> 6));
+            out += static_cast<char>(0x80 | (cp & 0x3f));
+        } else if (cp < 0x10000) {
+            out += static_cast<char>(0xe0 | (cp >> 12));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+            out += static_cast<char>(0x80 | (cp & 0x3f));
+        } else {
+            out += static_cast<char>(0xf0 | (cp >> 18));
+            out += static_cast<char>(0x80 | ((cp >> 12) & 0x3f));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3f));
+            out += static_cast<char>(0x80 | (cp & 0x3f));
+        }
+    }
+
+    std::string parse_string() {
+        pos_++;  // opening quote
+        std::string out;
+        for (;;) {
+            if (pos_ >= s_.size()) fail("unterminated string");
+            char c = s_[pos_++];
+            if (c == '"') break;
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (pos_ >= s_.size()) fail("unterminated escape");
+            char e = s_[pos_++];
+            switch (e) {
+                case '"': out += '"'; break;
+                case '\\': out += '\\'; break;
+                case '/': out += '/'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u': {
+                    unsigned cp = parse_hex4();
+                    // Combine UTF-16 surrogate pairs
+                    if (cp >= 0xd800 && cp <= 0xdbff && s_.compare(pos_, 2, "\\u") == 0) {
+                        pos_ += 2;
+                        unsigned lo = parse_hex4();
+                        cp = 0x10000 + ((cp - 0xd800) << 10) + (lo - 0xdc00);
+                    }
+                    append_utf8(out, cp);
+                    break;
+                }
+                default: fail("bad escape");
+            }
+        }
+        return out;
+    }
+
+    const std::string& s_;
+    size_t pos_ = 0;
+};
+
+const Value* Value::find(const std::string& key) const {
+    if (type_ != Type::object) return nullptr;
+    for (const auto& [k, v] : object_) {
+        if (k == key) return &v;
+    }
+    return nullptr;
+}
+
+std::string Value::get_string(const std::string& key, const std::string& def) const {
+    const Value* v = find(key);
+    return v && v->type_ == Type::string ? v->string_ : def;
+}
+
+double Value::get_number(const std::string& key, double def) const {
+    const Value* v = find(key);
+    return v && v->type_ == Type::number ? v->number_ : def;
+}
+
+int64_t Value::get_int(const std::string& key, int64_t def) const {
+    const Value* v = find(key);
+    return v && v->type_ == Type::number ? v->integer_ : def;
+}
+
+bool Value::get_bool(const std::string& key, bool def) const {
+    const Value* v = find(key);
+    return v && v->type_ == Type::boolean ? v->bool_ : def;
+}
+
+Value parse(const std::string& text) {
+    return Parser(text).parse_document();
+}
+
+std::string escape(const std::string& s) {
+    static const char* hex = "0123456789abcdef";
+    std::string out;
+    out.reserve(s.size() + 2);
+    for (char c : s) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 32) {
+                    out += "\\u00";
+                    out += hex[(c >> 4) & 0xf];
+                    out += hex[c & 0xf];
+                } else {
+                    out += c;
+                }
+        }
+    }
+    return out;
+}
+
+} // namespace slp::json
@@ -0,0 +1,172 @@
+#include "slp/llama/batch_journal.h"
+#include "slp/llama/batch_result.h"
+#include "slp/sha256.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+namespace slp::llama {
+
+namespace {
+
+constexpr char kMagic[8] = {'S', 'L', 'P', 'J', 'R', 'N', 'L', '1'};
+constexpr uint32_t kSucceeded = 1;
+
+struct Record {
+    uint64_t hash;
+    uint32_t line;
+    uint32_t flags;
+    uint64_t results_end;
+};
+static_assert(sizeof(Record) == 24);
+
+void write_all(int fd, const void* data, size_t len, const std::string& path) {
+    const auto* p = static_cast<const char*>(data);
+    while (len > 0) {
+        ssize_t n = ::write(fd, p, len);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) throw std::runtime_error("cannot write " + path + ": " + std::strerror(errno));
+        p += n;
+        len -= static_cast<size_t>(n);
+    }
+}
+
+uint64_t file_size_or_zero(const std::string& path) {
+    struct stat st {};
+    if (::stat(path.c_str(), &st) != 0) return 0;
+    return static_cast<uint64_t>(st.st_size);
+}
+
+} // anonymous namespace
+
+std::string PromptId::str() const {
+    char buf[40];
+    auto r = std::to_chars(buf, buf + 16, hash, 16);
+    // Zero-pad to 16 digits so ids sort and compare as text
+    size_t digits = static_cast<size_t>(r.ptr - buf);
+    std::string out(16 - digits, '0');
+    out.append(buf, digits);
+    out += '-';
+    out += std::to_string(line);
+    return out;
+}
+
+PromptId make_prompt_id(std::string_view line_text, uint32_t line) {
+    std::vector<uint8_t> digest = sha256_raw(std::vector<uint8_t>(line_text.begin(), line_text.end()));
+    PromptId id;
+    for (size_t i = 0; i < 8; ++i) id.hash = id.hash << 8 | digest[i];
+    id.line = line;
+    return id;
+}
+
+std::optional<PromptId> parse_prompt_id(std::string_view text) {
+    if (text.size() < 18 || text[16] != '-') return std::nullopt;
+    PromptId id;
+    auto h = std::from_chars(text.data(), text.data() + 16, id.hash, 16);
+    auto l = std::from_chars(text.data() + 17, text.data() + text.size(), id.line);
+    if (h.ptr != text.data() + 16 || h.ec != std::errc() || l.ptr != text.data() + text.size() ||
+        l.ec != std::errc()) {
+        return std::nullopt;
+    }
+    return id;
+}
+
+BatchJournal::BatchJournal(const std::string& results_path, bool resume) : path_(results_path + ".journal") {
+    bool have_journal = resume && ::access(path_.c_str(), F_OK) == 0;
+    if (!resume) {
+        std::ofstream results(results_path, std::ios::trunc);
+        if (!results) throw std::runtime_error("cannot create " + results_path);
+    }
+
+    if (have_journal) {
+        fd_ = ::open(path_.c_str(), O_RDWR | O_APPEND | O_CLOEXEC);
+        if (fd_ < 0) throw std::runtime_error("cannot open " + path_ + ": " + std::strerror(errno));
+        load(file_size_or_zero(results_path));
+    } else {
+        fd_ = ::open(path_.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND | O_CLOEXEC, 0644);
+        if (fd_ < 0) throw std::runtime_error("cannot create " + path_ + ": " + std::strerror(errno));
+        write_all(fd_, kMagic, sizeof(kMagic), path_);
+        if (resume) rebuild(results_path);
+    }
+
+    // Cut off lines the journal does not vouch for: a crash between writing
+    // a line and its record, or a line torn half way
+    if (resume && file_size_or_zero(results_path) != results_bytes_) {
+        if (::truncate(results_path.c_str(), static_cast<off_t>(results_bytes_)) != 0 && errno != ENOENT) {
+            throw std::runtime_error("cannot truncate " + results_path + ": " + std::strerror(errno));
+        }
+    }
+}
+
+BatchJournal::~BatchJournal() {
+    if (fd_ >= 0) ::close(fd_);
+}
+
+void BatchJournal::load(uint64_t results_size) {
+    struct stat st {};
+    if (::fstat(fd_, &st) != 0) throw std::runtime_error("cannot stat " + path_ + ": " + std::strerror(errno));
+    std::vector<char> data(static_cast<size_t>(st.st_size));
+    size_t got = 0;
+    while (got < data.size()) {
+        ssize_t n = ::pread(fd_, data.data() + got, data.size() - got, static_cast<off_t>(got));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) throw std::runtime_error("cannot read " + path_ + ": " + std::strerror(errno));
+        got += static_cast<size_t>(n);
+    }
+    if (data.size() < sizeof(kMagic) || std::memcmp(data.data(), kMagic, sizeof(kMagic)) != 0) {
+        throw std::runtime_error(path_ + " is not a batch journal");
+    }
+
+    // Records past a torn tail, or pointing past the end of the results
+    // file (lost with it), are dropped
+    size_t valid = sizeof(kMagic);
+    for (size_t off = valid; off + sizeof(Record) <= data.size(); off += sizeof(Record)) {
+        Record r;
+        std::memcpy(&r, data.data() + off, sizeof(r));
+        if (r.results_end < results_bytes_ || r.results_end > results_size) break;
+        if (r.flags & kSucceeded) succeeded_.insert({r.hash, r.line});
+        results_bytes_ = r.results_end;
+        valid = off + sizeof(Record);
+    }
+    if (valid != data.size() && ::ftruncate(fd_, static_cast<off_t>(valid)) != 0) {
+        throw std::runtime_error("cannot truncate " + path_ + ": " + std::strerror(errno));
+    }
+}
+
+void BatchJournal::rebuild(const std::string& results_path) {
+    std::ifstream in(results_path, std::ios::binary);
+    if (!in) return;
+    rebuilt_ = true;
+
+    std::vector<Record> records;
+    std::string line;
+    uint64_t end = 0;
+    while (std::getline(in, line)) {
+        if (in.eof()) break;  // no newline: torn by the crash
+        end += line.size() + 1;
+        results_bytes_ = end;
+        // Lines without an id (from before ids existed) get a blank record,
+        // so the journal still covers them
+        auto id = parse_prompt_id(find_json_field(line, "id")).value_or(PromptId{});
+        bool ok = id.line > 0 && find_json_field(line, "success") == "true";
+        records.push_back({id.hash, id.line, ok ? kSucceeded : 0, end});
+        if (ok) succeeded_.insert(id);
+    }
+    if (!records.empty()) write_all(fd_, records.data(), records.size() * sizeof(Record), path_);
+}
+
+void BatchJournal::record(const PromptId& id, bool success, uint64_t results_end) {
+    Record r{id.hash, id.line, success ? kSucceeded : 0, results_end};
+    write_all(fd_, &r, sizeof(r), path_);
+    results_bytes_ = results_end;
+}
+
+} // namespace slp::llama
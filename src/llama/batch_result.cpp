@@ -0,0 +1,135 @@
+#include "slp/llama/batch_result.h"
+
+#include <cctype>
+#include <charconv>
+
+namespace slp::llama {
+
+void append_json_escaped(std::string& out, std::string_view s) {
+    static const char hex[] = "0123456789abcdef";
+    size_t run = 0;  // start of the pending span that needs no escaping
+    for (size_t i = 0; i < s.size(); ++i) {
+        auto c = static_cast<unsigned char>(s[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+
+        out.append(s.data() + run, i - run);
+        run = i + 1;
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default: {
+                char u[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xf]};
+                out.append(u, sizeof(u));
+            }
+        }
+    }
+    out.append(s.data() + run, s.size() - run);
+}
+
+std::string escape_json_string(const std::string& s) {
+    std::string out;
+    out.reserve(s.size() + s.size() / 8);
+    append_json_escaped(out, s);
+    return out;
+}
+
+std::string_view find_json_field(std::string_view json, std::string_view field) {
+    // Look for "field": without building the pattern
+    size_t pos = 0;
+    for (;;) {
+        pos = json.find(field, pos);
+        if (pos == std::string_view::npos) return {};
+        size_t end = pos + field.size();
+        if (pos > 0 && json[pos - 1] == '"' && json.substr(end, 2) == "\":") {
+            pos = end + 2;
+            break;
+        }
+        pos++;
+    }
+
+    while (pos < json.length() && std::isspace(static_cast<unsigned char>(json[pos]))) pos++;
+
+    if (pos >= json.length()) return {};
+
+    if (json[pos] == '"') {
+        size_t start = pos + 1;
+        size_t end = start;
+        while (end < json.length() && json[end] != '"') {
+            if (json[end] == '\\' && end + 1 < json.length()) end += 2;
+            else end++;
+        }
+        return json.substr(start, end - start);
+    }
+
+    size_t start = pos;
+    while (pos < json.length() && (std::isalnum(static_cast<unsigned char>(json[pos])) || json[pos] == '.' || json[pos] == '-')) {
+        pos++;
+    }
+    return json.substr(start, pos - start);
+}
+
+std::string extract_json_field(const std::string& json, const std::string& field) {
+    return std::string(find_json_field(json, field));
+}
+
+void append_result_json(std::string& out, const InferenceResult& r) {
+    char num[32];
+    out += '{';
+    if (!r.id.empty()) {
+        out += "\"id\":\"";
+        out += r.id;
+        out += "\",";
+    }
+    out += "\"timestamp\":\"";
+    out += r.timestamp;
+    out += "\",\"prompt\":\"";
+    append_json_escaped(out, r.prompt);
+    out += "\",\"max_tokens\":";
+    out.append(num, static_cast<size_t>(std::to_chars(num, num + sizeof(num), r.max_tokens).ptr - num));
+    if (r.priority != 0) {
+        out += ",\"priority\":";
+        out.append(num, static_cast<size_t>(std::to_chars(num, num + sizeof(num), r.priority).ptr - num));
+    }
+    if (r.deadline_ms >= 0) {
+        out += ",\"deadline_ms\":";
+        out.append(num, static_cast<size_t>(std::to_chars(num, num + sizeof(num), r.deadline_ms).ptr - num));
+        out += r.deadline_missed ? ",\"deadline_missed\":true" : ",\"deadline_missed\":false";
+    }
+    out += r.success ? ",\"success\":true" : ",\"success\":false";
+    out += ",\"elapsed_ms\":";
+    auto ms = std::to_chars(num, num + sizeof(num), static_cast<double>(r.elapsed_us) / 1000.0,
+                            std::chars_format::fixed, 2);
+    out.append(num, static_cast<size_t>(ms.ptr - num));
+    if (r.ttfb_us > 0) {
+        out += ",\"ttfb_ms\":";
+        auto ttfb = std::to_chars(num, num + sizeof(num), static_cast<double>(r.ttfb_us) / 1000.0,
+                                  std::chars_format::fixed, 2);
+        out.append(num, static_cast<size_t>(ttfb.ptr - num));
+    }
+    if (r.timings.present) {
+        out += ',';
+        append_timings_json(out, r.timings);
+    }
+
+    if (r.success) {
+        out += ",\"response\":\"";
+        append_json_escaped(out, r.content);
+    } else {
+        out += ",\"error\":\"";
+        append_json_escaped(out, r.error);
+    }
+    out += "\"}";
+}
+
+std::string result_to_json(const InferenceResult& r) {
+    std::string out;
+    append_result_json(out, r);
+    return out;
+}
+
+} // namespace slp::llama
@@ -0,0 +1,64 @@
+#include "slp/llama/completion.h"
+#include "slp/json.h"
+
+#include <chrono>
+#include <exception>
+
+namespace slp::llama {
+
+std::string completion_request_body(const std::string& prompt, int n_predict) {
+    return "{\"prompt\":\"" + json::escape(prompt) + "\",\"n_predict\":" + std::to_string(n_predict) +
+           ",\"stream\":false}";
+}
+
+CompletionResult parse_completion_response(long status, const std::string& body) {
+    CompletionResult result;
+    result.status = status;
+    if (status != 200) {
+        result.error = "HTTP " + std::to_string(status) + ": " + body.substr(0, 200);
+        return result;
+    }
+
+    try {
+        auto doc = json::parse(body);
+        for (const char* field : {"content", "response", "completion", "text"}) {
+            result.content = doc.get_string(field);
+            if (!result.content.empty()) break;
+        }
+    } catch (const std::exception& e) {
+        result.error = std::string("bad response JSON: ") + e.what();
+        return result;
+    }
+
+    result.timings = parse_server_timings(body);
+    result.success = !result.content.empty();
+    if (!result.success) result.error = "Could not parse response";
+    return result;
+}
+
+Task<CompletionResult> complete_async(AsyncHttpClient& http,
+                                      std::string base_url,
+                                      std::string prompt,
+                                      int n_predict,
+                                      long timeout_ms) {
+    std::string body = completion_request_body(prompt, n_predict);
+    std::vector<uint8_t> data(body.begin(), body.end());
+
+    auto t0 = std::chrono::steady_clock::now();
+    CompletionResult result;
+    std::string error;
+    try {
+        auto response = co_await http.post(base_url + "/completion", std::move(data), "application/json",
+                                           {}, timeout_ms);
+        result = parse_completion_response(
+            response.status, std::string(response.body.begin(), response.body.end()));
+    } catch (const std::exception& e) {
+        error = e.what();
+    }
+    if (!error.empty()) result.error = error;
+    result.elapsed_us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - t0).count();
+    co_return result;
+}
+
+} // namespace slp::llama
@@ -0,0 +1,198 @@
+#include "slp/llama/endpoint_pool.h"
+#include "slp/http_client.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace slp::llama {
+
+namespace {
+
+double percentile_ms(const std::vector<int64_t>& sorted_us, double p) {
+    if (sorted_us.empty()) return 0.0;
+    size_t idx = static_cast<size_t>(p * static_cast<double>(sorted_us.size() - 1));
+    return static_cast<double>(sorted_us[idx]) / 1000.0;
+}
+
+} // anonymous namespace
+
+EndpointPool::EndpointPool(std::vector<std::string> urls, PoolOptions opts)
+    : opts_(opts) {
+    if (urls.empty()) {
+        throw std::invalid_argument("EndpointPool needs at least one endpoint");
+    }
+    backends_.resize(urls.size());
+    for (size_t i = 0; i < urls.size(); ++i) {
+        backends_[i].url = std::move(urls[i]);
+    }
+
+    if (opts_.health_interval.count() > 0) {
+        health_thread_ = std::thread([this] { health_loop(); });
+    }
+}
+
+EndpointPool::~EndpointPool() {
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    if (health_thread_.joinable()) {
+        health_thread_.join();
+    }
+}
+
+size_t EndpointPool::acquire() {
+    std::unique_lock<std::mutex> lock(mu_);
+    for (;;) {
+        auto now = std::chrono::steady_clock::now();
+        auto next_retry = std::chrono::steady_clock::time_point::max();
+        size_t best = backends_.size();
+
+        for (size_t i = 0; i < backends_.size(); ++i) {
+            const Backend& b = backends_[i];
+            // An ejected backend becomes eligible again once its ejection
+            // window has passed; the next request acts as the probe.
+            if (!b.healthy && now < b.ejected_until) {
+                next_retry = std::min(next_retry, b.ejected_until);
+                continue;
+            }
+            if (best == backends_.size() ||
+                b.in_flight < backends_[best].in_flight ||
+                (b.in_flight == backends_[best].in_flight &&
+                 b.requests < backends_[best].requests)) {
+                best = i;
+            }
+        }
+
+        if (best < backends_.size()) {
+            backends_[best].in_flight++;
+            backends_[best].requests++;
+            return best;
+        }
+
+        cv_.wait_until(lock, next_retry);
+    }
+}
+
+void EndpointPool::release(size_t idx, bool success, int64_t elapsed_us) {
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        Backend& b = backends_.at(idx);
+        if (b.in_flight > 0) b.in_flight--;
+
+        if (success) {
+            b.consecutive_failures = 0;
+            b.healthy = true;
+            b.latencies_us.push_back(elapsed_us);
+        } else {
+            b.failures++;
+            b.consecutive_failures++;
+            if (b.consecutive_failures >= opts_.max_consecutive_failures) {
+                eject_locked(b);
+            }
+        }
+    }
+    cv_.notify_all();
+}
+
+void EndpointPool::reserve(size_t requests_per_backend) {
+    std::lock_guard<std::mutex> lock(mu_);
+    for (auto& b : backends_) b.latencies_us.reserve(requests_per_backend);
+}
+
+void EndpointPool::eject_locked(Backend& b) {
+    if (b.healthy) b.ejections++;
+    b.healthy = false;
+    b.consecutive_failures = 0;
+    b.ejected_until = std::chrono::steady_clock::now() + opts_.eject_duration;
+}
+
+void EndpointPool::check_health() {
+    std::vector<std::string> urls;
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        for (const auto& b : backends_) urls.push_back(b.url);
+    }
+
+    std::vector<bool> ok(urls.size(), false);
+    for (size_t i = 0; i < urls.size(); ++i) {
+        try {
+            HttpClient client;
+            // llama-server answers 503 while the model is still loading
+            ok[i] = client.get(urls[i] + "/health", opts_.health_timeout_ms).status == 200;
+        } catch (const std::exception&) {
+            ok[i] = false;
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        for (size_t i = 0; i < backends_.size(); ++i) {
+            Backend& b = backends_[i];
+            if (ok[i]) {
+                b.healthy = true;
+                b.consecutive_failures = 0;
+            } else {
+                eject_locked(b);
+            }
+        }
+    }
+    cv_.notify_all();
+}
+
+void EndpointPool::health_loop() {
+    std::unique_lock<std::mutex> lock(mu_);
+    while (!stop_) {
+        if (cv_.wait_for(lock, opts_.health_interval, [this] { return stop_; })) {
+            break;
+        }
+        lock.unlock();
+        check_health();
+        lock.lock();
+    }
+}
+
+std::vector<EndpointStats> EndpointPool::stats() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    std::vector<EndpointStats> out;
+    out.reserve(backends_.size());
+
+    for (const auto& b : backends_) {
+        EndpointStats s;
+        s.url = b.url;
+        s.healthy = b.healthy;
+        s.in_flight = b.in_flight;
+        s.requests = b.requests;
+        s.failures = b.failures;
+        s.ejections = b.ejections;
+
+        if (!b.latencies_us.empty()) {
+            std::vector<int64_t> sorted = b.latencies_us;
+            std::sort(sorted.begin(), sorted.end());
+            int64_t total = 0;
+            for (auto lat : sorted) total += lat;
+            s.mean_ms = (static_cast<double>(total) / static_cast<double>(sorted.size())) / 1000.0;
+            s.p50_ms = percentile_ms(sorted, 0.50);
+            s.p95_ms = percentile_ms(sorted, 0.95);
+            s.p99_ms = percentile_ms(sorted, 0.99);
+        }
+        out.push_back(std::move(s));
+    }
+    return out;
+}
+
+std::vector<std::string> parse_endpoint_list(const std::string& list) {
+    std::vector<std::string> urls;
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t comma = list.find(',', start);
+        if (comma == std::string::npos) comma = list.size();
+        std::string url = list.substr(start, comma - start);
+        while (!url.empty() && url.back() == '/') url.pop_back();
+        if (!url.empty()) urls.push_back(url);
+        start = comma + 1;
+    }
+    return urls;
+}
+
+} // namespace slp::llama
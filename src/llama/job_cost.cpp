@@ -0,0 +1,177 @@
+#include "slp/llama/job_cost.h"
+#include "slp/json.h"
+#include "slp/sha256.h"
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+namespace slp::llama {
+
+namespace {
+
+bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+struct CountState {
+    const std::vector<std::string>& texts;
+    const std::string& base_url;
+    TokenCountCache& cache;
+    std::vector<int>& counts;
+    std::vector<size_t> todo;  // indexes of prompts the cache did not have
+    size_t next = 0;
+    size_t tokenized = 0;
+};
+
+Task<void> count_worker(AsyncHttpClient& http, CountState& state) {
+    while (state.next < state.todo.size()) {
+        size_t i = state.todo[state.next++];
+        int n = co_await count_tokens_async(http, state.base_url, state.texts[i]);
+        if (n < 0) continue;
+        state.counts[i] = n;
+        state.cache.put(TokenCountCache::key(state.base_url, state.texts[i]), n);
+        state.tokenized++;
+    }
+}
+
+} // anonymous namespace
+
+int estimate_prompt_tokens(std::string_view text) {
+    int tokens = 0;
+    size_t word = 0;
+    for (char c : text) {
+        if (!is_space(c)) {
+            word++;
+        } else if (word > 0) {
+            tokens += static_cast<int>((word + 3) / 4);
+            word = 0;
+        }
+    }
+    return tokens + static_cast<int>((word + 3) / 4);
+}
+
+double job_cost(int prompt_tokens, int n_predict, const CostModel& model) {
+    return model.prompt_token * std::max(0, prompt_tokens) + model.output_token * std::max(0, n_predict);
+}
+
+TokenCountCache::TokenCountCache(std::string path) : path_(std::move(path)) {
+    if (path_.empty()) return;
+    std::ifstream in(path_);
+    std::string line;
+    while (std::getline(in, line)) {
+        // A torn last line from an interrupted run is skipped, not an error
+        std::istringstream fields(line);
+        std::string key;
+        int tokens = -1;
+        if (fields >> key >> tokens && key.size() == 32 && tokens >= 0) counts_[key] = tokens;
+    }
+}
+
+std::string TokenCountCache::key(std::string_view tokenizer, std::string_view text) {
+    std::vector<uint8_t> data;
+    data.reserve(tokenizer.size() + 1 + text.size());
+    data.insert(data.end(), tokenizer.begin(), tokenizer.end());
+    data.push_back('\n');
+    data.insert(data.end(), text.begin(), text.end());
+    return sha256_hex(data).substr(0, 32);
+}
+
+std::optional<int> TokenCountCache::get(const std::string& key) const {
+    std::lock_guard<std::mutex> lock(mu_);
+    auto it = counts_.find(key);
+    if (it == counts_.end()) return std::nullopt;
+    return it->second;
+}
+
+void TokenCountCache::put(const std::string& key, int tokens) {
+    std::lock_guard<std::mutex> lock(mu_);
+    if (!counts_.emplace(key, tokens).second) return;
+    if (path_.empty()) return;
+
+    if (!out_.is_open()) {
+        std::error_code ec;
+        auto dir = std::filesystem::path(path_).parent_path();
+        if (!dir.empty()) std::filesystem::create_directories(dir, ec);
+        out_.open(path_, std::ios::app);
+    }
+    // Whole lines, so runs sharing the file append without interleaving
+    out_ << key << ' ' << tokens << '\n' << std::flush;
+}
+
+size_t TokenCountCache::size() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    return counts_.size();
+}
+
+Task<int> count_tokens_async(AsyncHttpClient& http, std::string base_url, std::string text, long timeout_ms) {
+    std::string body = "{\"content\":\"" + json::escape(text) + "\"}";
+    std::vector<uint8_t> data(body.begin(), body.end());
+
+    int count = -1;
+    try {
+        auto response = co_await http.post(base_url + "/tokenize", std::move(data), "application/json", {},
+                                           timeout_ms);
+        if (response.status == 200) {
+            auto doc = json::parse(std::string(response.body.begin(), response.body.end()));
+            const json::Value* tokens = doc.find("tokens");
+            if (tokens && tokens->is_array()) count = static_cast<int>(tokens->as_array().size());
+        }
+    } catch (const std::exception&) {
+        count = -1;
+    }
+    co_return count;
+}
+
+std::vector<int> count_prompt_tokens(const std::vector<std::string>& texts, const std::string& base_url,
+                                     TokenCountCache& cache, size_t concurrency, TokenCountReport* report) {
+    auto t0 = std::chrono::steady_clock::now();
+    std::vector<int> counts(texts.size(), -1);
+    CountState state{texts, base_url, cache, counts, {}};
+    TokenCountReport r;
+
+    for (size_t i = 0; i < texts.size(); ++i) {
+        if (auto n = cache.get(TokenCountCache::key(base_url, texts[i]))) {
+            counts[i] = *n;
+            r.cached++;
+        } else {
+            state.todo.push_back(i);
+        }
+    }
+
+    if (!base_url.empty() && !state.todo.empty()) {
+        EventLoop loop;
+        AsyncHttpClient http(loop);
+        // One request on its own first, so a server without /tokenize costs
+        // one round trip rather than one per prompt
+        state.next = 1;
+        size_t first = state.todo[0];
+        int n = loop.run(count_tokens_async(http, base_url, texts[first]));
+        if (n >= 0) {
+            counts[first] = n;
+            cache.put(TokenCountCache::key(base_url, texts[first]), n);
+            state.tokenized++;
+
+            std::vector<Task<void>> workers;
+            for (size_t w = 0; w < std::max<size_t>(1, std::min(concurrency, state.todo.size())); ++w) {
+                workers.push_back(count_worker(http, state));
+            }
+            loop.run(when_all(std::move(workers)));
+        }
+    }
+
+    for (size_t i : state.todo) {
+        if (counts[i] >= 0) continue;
+        counts[i] = estimate_prompt_tokens(texts[i]);
+        r.estimated++;
+    }
+    r.tokenized = state.tokenized;
+    r.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    if (report) *report = r;
+    return counts;
+}
+
+} // namespace slp::llama
@@ -0,0 +1,213 @@
+#include "slp/llama/loadgen.h"
+#include "slp/json.h"
+#include "slp/llama/completion.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+
+namespace slp::llama {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Sample {
+    bool success = false;
+    int64_t latency_us = 0;
+    int64_t service_us = 0;
+    int64_t lag_us = 0;
+    Clock::time_point done{};
+    std::string error;
+    ServerTimings timings;
+};
+
+int64_t micros(Clock::duration d) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+}
+
+double percentile_ms(const std::vector<int64_t>& sorted_us, double p) {
+    if (sorted_us.empty()) return 0.0;
+    size_t idx = static_cast<size_t>(p * static_cast<double>(sorted_us.size() - 1));
+    return static_cast<double>(sorted_us[idx]) / 1000.0;
+}
+
+std::string trim(const std::string& s) {
+    size_t b = s.find_first_not_of(" \t\r");
+    if (b == std::string::npos) return "";
+    return s.substr(b, s.find_last_not_of(" \t\r") - b + 1);
+}
+
+// `start` is read when the task first runs, i.e. once the whole schedule
+// has been handed to the loop
+Task<void> send_at(AsyncHttpClient& http, const Clock::time_point& start, double offset_s,
+                   const std::string& url, const LoadPrompt& prompt, long timeout_ms, Sample& s) {
+    auto scheduled = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(offset_s));
+    co_await http.loop().sleep_until(scheduled);
+    auto sent = Clock::now();
+    CompletionResult r = co_await complete_async(http, url, prompt.prompt, prompt.max_tokens, timeout_ms);
+    s.done = Clock::now();
+    s.success = r.success;
+    s.lag_us = micros(sent - scheduled);
+    s.service_us = micros(s.done - sent);
+    s.latency_us = micros(s.done - scheduled);
+    s.timings = r.timings;
+    if (!r.success) s.error = std::move(r.error);
+}
+
+} // anonymous namespace
+
+std::vector<LoadPrompt> load_prompts(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) throw std::runtime_error("cannot read prompts file " + path);
+    std::string body((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    auto prompts = parse_prompts(body, path);
+    if (prompts.empty()) throw std::runtime_error("no prompts in " + path);
+    return prompts;
+}
+
+std::vector<LoadPrompt> parse_prompts(const std::string& jsonl, const std::string& source) {
+    std::vector<LoadPrompt> prompts;
+    std::istringstream in(jsonl);
+    std::string line;
+    size_t line_no = 0;
+    while (std::getline(in, line)) {
+        line_no++;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line[0] == '#') continue;
+        json::Value v;
+        try {
+            v = json::parse(line);
+        } catch (const std::exception& e) {
+            throw std::runtime_error(source + ":" + std::to_string(line_no) + ": " + e.what());
+        }
+        LoadPrompt p;
+        p.prompt = v.get_string("prompt");
+        p.max_tokens = static_cast<int>(v.get_int("max_tokens", 50));
+        if (!p.prompt.empty()) prompts.push_back(std::move(p));
+    }
+    return prompts;
+}
+
+std::vector<double> poisson_arrivals(double rate, double duration_s, std::mt19937_64& rng) {
+    if (rate <= 0) throw std::invalid_argument("arrival rate must be positive");
+    std::exponential_distribution<double> gap(rate);
+    std::vector<double> arrivals;
+    arrivals.reserve(static_cast<size_t>(rate * duration_s * 1.1) + 16);
+    for (double t = gap(rng); t < duration_s; t += gap(rng)) arrivals.push_back(t);
+    return arrivals;
+}
+
+std::vector<double> read_trace(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) throw std::runtime_error("cannot read trace " + path);
+    std::vector<double> arrivals;
+    std::string line;
+    size_t line_no = 0;
+    while (std::getline(in, line)) {
+        line_no++;
+        line = trim(line);
+        if (line.empty() || line[0] == '#') continue;
+        size_t used = 0;
+        double t = -1;
+        try {
+            t = std::stod(line, &used);
+        } catch (const std::exception&) {
+        }
+        if (used != line.size() || t < 0 || (!arrivals.empty() && t < arrivals.back())) {
+            throw std::runtime_error(path + ":" + std::to_string(line_no) +
+                                     ": expected a non-decreasing send time in seconds");
+        }
+        arrivals.push_back(t);
+    }
+    return arrivals;
+}
+
+std::vector<double> scale_to_rate(const std::vector<double>& arrivals, double rate) {
+    if (rate <= 0) throw std::invalid_argument("arrival rate must be positive");
+    if (arrivals.empty() || arrivals.back() <= 0) return arrivals;
+    double factor = static_cast<double>(arrivals.size()) / rate / arrivals.back();
+    std::vector<double> scaled;
+    scaled.reserve(arrivals.size());
+    for (double t : arrivals) scaled.push_back(t * factor);
+    return scaled;
+}
+
+LatencySummary summarize_latencies(std::vector<int64_t>& us) {
+    LatencySummary s;
+    if (us.empty()) return s;
+    std::sort(us.begin(), us.end());
+    double total = 0;
+    for (int64_t v : us) total += static_cast<double>(v);
+    s.mean_ms = total / static_cast<double>(us.size()) / 1000.0;
+    s.p50_ms = percentile_ms(us, 0.50);
+    s.p90_ms = percentile_ms(us, 0.90);
+    s.p99_ms = percentile_ms(us, 0.99);
+    s.p999_ms = percentile_ms(us, 0.999);
+    s.max_ms = percentile_ms(us, 1.0);
+    return s;
+}
+
+Task<OpenLoopResult> run_open_loop(AsyncHttpClient& http,
+                                   const std::vector<double>& arrivals,
+                                   const std::vector<LoadPrompt>& prompts,
+                                   const OpenLoopOptions& opts) {
+    if (prompts.empty()) throw std::invalid_argument("run_open_loop needs prompts");
+    if (opts.urls.empty()) throw std::invalid_argument("run_open_loop needs a server URL");
+
+    std::vector<Sample> samples(arrivals.size());
+    std::vector<Task<void>> sends;
+    sends.reserve(arrivals.size());
+    Clock::time_point start{};
+    for (size_t i = 0; i < arrivals.size(); ++i) {
+        sends.push_back(send_at(http, start, arrivals[i], opts.urls[i % opts.urls.size()],
+                                prompts[i % prompts.size()], opts.timeout_ms, samples[i]));
+    }
+    start = Clock::now();
+    co_await when_all(std::move(sends));
+
+    OpenLoopResult r;
+    r.requests = samples.size();
+    std::vector<int64_t> latency;
+    std::vector<int64_t> service;
+    latency.reserve(samples.size());
+    service.reserve(samples.size());
+    Clock::time_point last = start;
+    double lag_total = 0;
+    double server_total = 0;
+    uint64_t timed = 0;
+    for (const auto& s : samples) {
+        last = std::max(last, s.done);
+        double lag_ms = static_cast<double>(s.lag_us) / 1000.0;
+        lag_total += lag_ms;
+        r.max_send_lag_ms = std::max(r.max_send_lag_ms, lag_ms);
+        if (!s.success) {
+            r.failures++;
+            if (r.first_error.empty()) r.first_error = s.error;
+            continue;
+        }
+        latency.push_back(s.latency_us);
+        service.push_back(s.service_us);
+        if (s.timings.present) {
+            timed++;
+            r.predicted_tokens += s.timings.predicted_n;
+            server_total += s.timings.server_ms();
+        }
+    }
+
+    r.duration_s = std::chrono::duration<double>(last - start).count();
+    if (!arrivals.empty() && arrivals.back() > 0) {
+        r.offered_rate = static_cast<double>(arrivals.size()) / arrivals.back();
+    }
+    if (r.duration_s > 0) r.achieved_rate = static_cast<double>(latency.size()) / r.duration_s;
+    if (r.requests > 0) r.mean_send_lag_ms = lag_total / static_cast<double>(r.requests);
+    if (timed > 0) r.mean_server_ms = server_total / static_cast<double>(timed);
+    r.latency = summarize_latencies(latency);
+    r.service = summarize_latencies(service);
+    co_return r;
+}
+
+} // namespace slp::llama
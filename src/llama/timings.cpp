@@ -0,0 +1,106 @@
+#include "slp/llama/timings.h"
+#include "slp/llama/batch_result.h"
+
+#include <algorithm>
+#include <charconv>
+
+namespace slp::llama {
+
+namespace {
+
+template <typename T>
+bool parse_number(std::string_view s, T& out) {
+    auto [end, ec] = std::from_chars(s.data(), s.data() + s.size(), out);
+    return ec == std::errc() && end != s.data();
+}
+
+template <typename T>
+void append_number(std::string& out, T value) {
+    char buf[32];
+    out.append(buf, static_cast<size_t>(std::to_chars(buf, buf + sizeof(buf), value).ptr - buf));
+}
+
+void append_ms(std::string& out, double ms) {
+    char buf[32];
+    out.append(buf, static_cast<size_t>(
+        std::to_chars(buf, buf + sizeof(buf), ms, std::chars_format::fixed, 3).ptr - buf));
+}
+
+double mean(double sum, uint64_t n) {
+    return n > 0 ? sum / static_cast<double>(n) : 0.0;
+}
+
+} // anonymous namespace
+
+ServerTimings parse_server_timings(std::string_view response) {
+    ServerTimings t;
+    parse_number(find_json_field(response, "tokens_predicted"), t.tokens_predicted);
+    parse_number(find_json_field(response, "tokens_evaluated"), t.tokens_evaluated);
+
+    // The timings object holds only numbers, so scanning inside it is safe
+    size_t at = response.find("\"timings\":");
+    if (at == std::string_view::npos) return t;
+    std::string_view timings = response.substr(at);
+    timings = timings.substr(0, timings.find('}'));
+    t.present = parse_number(find_json_field(timings, "prompt_n"), t.prompt_n) &&
+                parse_number(find_json_field(timings, "prompt_ms"), t.prompt_ms) &&
+                parse_number(find_json_field(timings, "predicted_n"), t.predicted_n) &&
+                parse_number(find_json_field(timings, "predicted_ms"), t.predicted_ms);
+    return t;
+}
+
+void append_timings_json(std::string& out, const ServerTimings& t) {
+    if (!t.present) return;
+    out += "\"tokens_predicted\":";
+    append_number(out, t.tokens_predicted);
+    out += ",\"tokens_evaluated\":";
+    append_number(out, t.tokens_evaluated);
+    out += ",\"timings\":{\"prompt_n\":";
+    append_number(out, t.prompt_n);
+    out += ",\"prompt_ms\":";
+    append_ms(out, t.prompt_ms);
+    out += ",\"predicted_n\":";
+    append_number(out, t.predicted_n);
+    out += ",\"predicted_ms\":";
+    append_ms(out, t.predicted_ms);
+    out += "}";
+}
+
+void ThroughputStats::add(const ServerTimings& t, int64_t wall_us, int64_t ttfb_us) {
+    requests_++;
+    if (!t.present) return;
+    timed_++;
+    prompt_tokens_ += t.prompt_n;
+    predicted_tokens_ += t.predicted_n;
+    prompt_ms_ += t.prompt_ms;
+    predicted_ms_ += t.predicted_ms;
+
+    double wall = static_cast<double>(wall_us) / 1000.0;
+    double ttfb = static_cast<double>(ttfb_us) / 1000.0;
+    // Clamp: the server's clock and ours round differently
+    double queue = std::max(0.0, ttfb - t.server_ms());
+    wall_ms_ += wall;
+    queue_ms_ += queue;
+    client_ms_ += std::max(0.0, wall - t.server_ms() - queue);
+}
+
+double ThroughputStats::prefill_tokens_per_sec() const {
+    return prompt_ms_ > 0 ? static_cast<double>(prompt_tokens_) * 1000.0 / prompt_ms_ : 0.0;
+}
+
+double ThroughputStats::decode_tokens_per_sec() const {
+    return predicted_ms_ > 0 ? static_cast<double>(predicted_tokens_) * 1000.0 / predicted_ms_ : 0.0;
+}
+
+double ThroughputStats::mean_wall_ms() const { return mean(wall_ms_, timed_); }
+double ThroughputStats::mean_server_ms() const { return mean(prompt_ms_ + predicted_ms_, timed_); }
+double ThroughputStats::mean_queue_ms() const { return mean(queue_ms_, timed_); }
+double ThroughputStats::mean_client_ms() const { return mean(client_ms_, timed_); }
+
+const char* ThroughputStats::bound() const {
+    double server = prompt_ms_ + predicted_ms_;
+    if (server >= queue_ms_ && server >= client_ms_) return "compute";
+    return queue_ms_ >= client_ms_ ? "queue" : "client";
+}
+
+} // namespace slp::llama
@@ -0,0 +1,41 @@
+#include "slp/mapped_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <stdexcept>
+
+namespace slp {
+
+MappedFile::MappedFile(const std::string& path) {
+    fd_ = ::open(path.c_str(), O_RDONLY);
+    if (fd_ < 0) throw std::runtime_error("cannot open file: " + path);
+
+    struct stat st {};
+    if (::fstat(fd_, &st) != 0) {
+        ::close(fd_);
+        throw std::runtime_error("cannot stat file: " + path);
+    }
+    size_ = static_cast<size_t>(st.st_size);
+
+    // mmap rejects zero-length mappings; an empty file has no data pointer
+    if (size_ > 0) {
+        void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+        if (p == MAP_FAILED) {
+            ::close(fd_);
+            throw std::runtime_error("cannot mmap file: " + path);
+        }
+        data_ = static_cast<const uint8_t*>(p);
+        // Hashing and chunking read front to back
+        ::madvise(p, size_, MADV_SEQUENTIAL);
+    }
+}
+
+MappedFile::~MappedFile() {
+    if (data_) ::munmap(const_cast<uint8_t*>(data_), size_);
+    if (fd_ >= 0) ::close(fd_);
+}
+
+} // namespace slp
@@ -0,0 +1,488 @@
+#include "slp/pipeline/aggregate.h"
+#include "slp/artifact/paths.h"
+#include "slp/async_http.h"
+#include "slp/llama/batch_result.h"
+#include "slp/llama/timings.h"
+#include "slp/seaweed/filer.h"
+#include "slp/seaweed/filer_async.h"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+// Cross-run results aggregation
+
+namespace slp::pipeline {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+std::string fmt(double v, int precision = 3) {
+    char buf[64];
+    std::snprintf(buf, sizeof(buf), "%.*f", precision, v);
+    return buf;
+}
+
+double parse_double(std::string_view s) {
+    double v = 0.0;
+    std::from_chars(s.data(), s.data() + s.size(), v);
+    return v;
+}
+
+double rate(double tokens, double ms) {
+    return ms > 0 ? tokens * 1000.0 / ms : 0.0;
+}
+
+// One run as it moves through fetch and parse
+struct RunJob {
+    RunAggregate agg;
+    bool pending = false;
+    bool cached = false;
+    std::string error;
+    uint64_t bytes = 0;
+};
+
+// Parses fetched bodies on worker threads while the event loop keeps
+// fetching. submit() blocks when the queue is full, which holds at most a
+// few bodies per thread in memory.
+class ParsePool {
+public:
+    ParsePool(size_t threads, std::vector<RunJob>& jobs) : jobs_(jobs), limit_(2 * threads) {
+        for (size_t i = 0; i < threads; ++i) threads_.emplace_back([this] { run(); });
+    }
+
+    ~ParsePool() { finish(); }
+
+    void submit(size_t job, std::vector<uint8_t> body) {
+        std::unique_lock<std::mutex> lock(mu_);
+        space_.wait(lock, [this] { return queue_.size() < limit_; });
+        queue_.emplace_back(job, std::move(body));
+        ready_.notify_one();
+    }
+
+    void finish() {
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            done_ = true;
+        }
+        ready_.notify_all();
+        for (auto& t : threads_) {
+            if (t.joinable()) t.join();
+        }
+    }
+
+private:
+    void run() {
+        for (;;) {
+            std::pair<size_t, std::vector<uint8_t>> item;
+            {
+                std::unique_lock<std::mutex> lock(mu_);
+                ready_.wait(lock, [this] { return done_ || !queue_.empty(); });
+                if (queue_.empty()) return;
+                item = std::move(queue_.front());
+                queue_.pop_front();
+            }
+            space_.notify_one();
+            const auto& body = item.second;
+            aggregate_results(std::string_view(reinterpret_cast<const char*>(body.data()), body.size()),
+                              jobs_[item.first].agg);
+        }
+    }
+
+    std::vector<RunJob>& jobs_;
+    size_t limit_;
+    std::mutex mu_;
+    std::condition_variable ready_;
+    std::condition_variable space_;
+    std::deque<std::pair<size_t, std::vector<uint8_t>>> queue_;
+    bool done_ = false;
+    std::vector<std::thread> threads_;
+};
+
+struct FetchState {
+    const AggregateOptions& opts;
+    std::vector<RunJob>& jobs;
+    const std::map<std::string, RunAggregate>& cache;
+    ParsePool& pool;
+    size_t next = 0;
+};
+
+// Model and prompt set of a run, from whatever metadata it stored
+Task<void> fetch_metadata(AsyncHttpClient& http, const std::string& filer, RunAggregate& agg) {
+    std::string metrics_url = filer + artifact::run_metrics_path(agg.run_id);
+    auto metrics = co_await http.get(metrics_url);
+    if (metrics.status == 200) {
+        try {
+            seaweed::CodecOptions codec;
+            codec.codec = seaweed::parse_codec(metrics.header(seaweed::kCodecHeader));
+            if (codec.codec != seaweed::Codec::none) metrics.body = seaweed::decompress(metrics.body, codec);
+            auto doc = json::parse(std::string(metrics.body.begin(), metrics.body.end()));
+            agg.model_hash = doc.get_string("model_hash", agg.model_hash);
+            agg.prompts_hash = doc.get_string("prompts_hash", agg.prompts_hash);
+        } catch (const std::exception&) {
+        }
+    }
+    if (agg.prompts_hash == "unknown") {
+        std::string plan_url = filer + artifact::run_shard_plan_path(agg.run_id);
+        auto plan = co_await http.get(plan_url);
+        if (plan.status == 200) {
+            try {
+                auto doc = json::parse(std::string(plan.body.begin(), plan.body.end()));
+                agg.prompts_hash = doc.get_string("prompts_hash", agg.prompts_hash);
+            } catch (const std::exception&) {
+            }
+        }
+    }
+}
+
+Task<void> fetch_worker(AsyncHttpClient& http, FetchState& st) {
+    const std::string& filer = st.opts.filer_base;
+    while (st.next < st.jobs.size()) {
+        RunJob& job = st.jobs[st.next++];
+        std::string path = artifact::run_results_path(job.agg.run_id);
+        std::string url = filer + path;
+        std::string error;
+        try {
+            auto head = co_await http.head(url);
+            if (head.status == 404) {
+                job.pending = true;
+                continue;
+            }
+            if (head.status != 200) throw std::runtime_error("HEAD: HTTP " + std::to_string(head.status));
+            // Without an ETag a change of size is all there is to go on
+            job.agg.validator = head.header("ETag") + "/" + head.header("Content-Length");
+
+            auto hit = st.cache.find(job.agg.run_id);
+            if (hit != st.cache.end() && !head.header("ETag").empty() && hit->second.validator == job.agg.validator) {
+                job.agg = hit->second;
+                job.cached = true;
+                // Cached before its metrics.json was readable; only the
+                // metadata is fetched again
+                if (job.agg.model_hash == "unknown") co_await fetch_metadata(http, filer, job.agg);
+                continue;
+            }
+
+            co_await fetch_metadata(http, filer, job.agg);
+            auto body = co_await seaweed::get_file_async(http, filer, path);
+            job.bytes = body.size();
+            st.pool.submit(static_cast<size_t>(&job - st.jobs.data()), std::move(body));
+        } catch (const std::exception& e) {
+            error = e.what();
+        }
+        if (!error.empty()) job.error = job.agg.run_id + ": " + error;
+    }
+}
+
+std::map<std::string, RunAggregate> load_cache(const std::string& path) {
+    std::map<std::string, RunAggregate> cache;
+    if (path.empty()) return cache;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        try {
+            RunAggregate run = RunAggregate::from_json(line);
+            cache[run.run_id] = std::move(run);
+        } catch (const std::exception&) {
+            // A torn or stale line only costs a re-read of that run
+        }
+    }
+    return cache;
+}
+
+void save_cache(const std::string& path, const std::vector<RunJob>& jobs) {
+    if (path.empty()) return;
+    std::filesystem::path p(path);
+    if (p.has_parent_path()) std::filesystem::create_directories(p.parent_path());
+    std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::trunc);
+        if (!out) throw std::runtime_error("cannot write aggregate cache " + tmp);
+        for (const auto& job : jobs) {
+            if (job.pending || !job.error.empty() || job.agg.validator.empty()) continue;
+            out << job.agg.to_json() << "\n";
+        }
+        if (!out) throw std::runtime_error("cannot write aggregate cache " + tmp);
+    }
+    std::filesystem::rename(tmp, path);
+}
+
+} // anonymous namespace
+
+void LatencyHistogram::add(double ms) {
+    double us = std::max(1.0, ms * 1000.0);
+    auto bucket = static_cast<size_t>(std::max(0.0, std::floor(4.0 * std::log2(us))));
+    buckets_[std::min(bucket, kBuckets - 1)]++;
+    count_++;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (size_t i = 0; i < kBuckets; ++i) buckets_[i] += other.buckets_[i];
+    count_ += other.count_;
+}
+
+double LatencyHistogram::bucket_upper_ms(size_t bucket) {
+    return std::exp2(static_cast<double>(bucket + 1) / 4.0) / 1000.0;
+}
+
+double LatencyHistogram::percentile_ms(double p) const {
+    if (count_ == 0) return 0.0;
+    auto rank = static_cast<uint64_t>(std::ceil(p * static_cast<double>(count_)));
+    rank = std::max<uint64_t>(rank, 1);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+        seen += buckets_[i];
+        if (seen >= rank) return bucket_upper_ms(i);
+    }
+    return bucket_upper_ms(kBuckets - 1);
+}
+
+std::string LatencyHistogram::to_json() const {
+    std::string out = "[";
+    for (size_t i = 0; i < kBuckets; ++i) {
+        if (buckets_[i] == 0) continue;
+        if (out.size() > 1) out += ',';
+        out += '[';
+        out += std::to_string(i);
+        out += ',';
+        out += std::to_string(buckets_[i]);
+        out += ']';
+    }
+    return out + "]";
+}
+
+LatencyHistogram LatencyHistogram::from_json(const json::Value& v) {
+    LatencyHistogram h;
+    if (!v.is_array()) return h;
+    for (const auto& pair : v.as_array()) {
+        if (!pair.is_array() || pair.as_array().size() != 2) throw std::runtime_error("bad histogram bucket");
+        auto bucket = static_cast<size_t>(pair.as_array()[0].as_uint());
+        if (bucket >= kBuckets) throw std::runtime_error("histogram bucket out of range");
+        h.buckets_[bucket] += pair.as_array()[1].as_uint();
+        h.count_ += pair.as_array()[1].as_uint();
+    }
+    return h;
+}
+
+std::string LatencyHistogram::to_report_json() const {
+    std::string out = "[";
+    for (size_t i = 0; i < kBuckets; ++i) {
+        if (buckets_[i] == 0) continue;
+        if (out.size() > 1) out += ',';
+        out += '[';
+        out += fmt(bucket_upper_ms(i));
+        out += ',';
+        out += std::to_string(buckets_[i]);
+        out += ']';
+    }
+    return out + "]";
+}
+
+bool GroupStats::add_line(std::string_view line) {
+    // Fields after the prompt, so text inside it cannot be mistaken for them
+    std::string_view rest = line;
+    std::string_view prompt = llama::find_json_field(line, "prompt");
+    if (!prompt.empty()) rest = line.substr(static_cast<size_t>(prompt.data() + prompt.size() - line.data()));
+
+    std::string_view success = llama::find_json_field(rest, "success");
+    if (success != "true" && success != "false") return false;
+
+    requests++;
+    if (success != "true") return true;
+    successes++;
+    double ms = parse_double(llama::find_json_field(rest, "elapsed_ms"));
+    latency_sum_ms += ms;
+    latency_max_ms = std::max(latency_max_ms, ms);
+    latency.add(ms);
+
+    llama::ServerTimings t = llama::parse_server_timings(rest);
+    if (t.present) {
+        timed++;
+        prompt_tokens += t.prompt_n;
+        prompt_ms += t.prompt_ms;
+        predicted_tokens += t.predicted_n;
+        predicted_ms += t.predicted_ms;
+    }
+    return true;
+}
+
+void GroupStats::merge(const GroupStats& other) {
+    runs += other.runs;
+    requests += other.requests;
+    successes += other.successes;
+    latency_sum_ms += other.latency_sum_ms;
+    latency_max_ms = std::max(latency_max_ms, other.latency_max_ms);
+    latency.merge(other.latency);
+    timed += other.timed;
+    prompt_tokens += other.prompt_tokens;
+    prompt_ms += other.prompt_ms;
+    predicted_tokens += other.predicted_tokens;
+    predicted_ms += other.predicted_ms;
+}
+
+std::string GroupStats::to_json() const {
+    return "{\"runs\":" + std::to_string(runs) + ",\"requests\":" + std::to_string(requests) +
+           ",\"successes\":" + std::to_string(successes) + ",\"latency_sum_ms\":" + fmt(latency_sum_ms) +
+           ",\"latency_max_ms\":" + fmt(latency_max_ms) + ",\"histogram\":" + latency.to_json() +
+           ",\"timed\":" + std::to_string(timed) + ",\"prompt_tokens\":" + std::to_string(prompt_tokens) +
+           ",\"prompt_ms\":" + fmt(prompt_ms) + ",\"predicted_tokens\":" + std::to_string(predicted_tokens) +
+           ",\"predicted_ms\":" + fmt(predicted_ms) + "}";
+}
+
+GroupStats GroupStats::from_json(const json::Value& v) {
+    GroupStats g;
+    g.runs = static_cast<uint64_t>(v.get_int("runs"));
+    g.requests = static_cast<uint64_t>(v.get_int("requests"));
+    g.successes = static_cast<uint64_t>(v.get_int("successes"));
+    g.latency_sum_ms = v.get_number("latency_sum_ms");
+    g.latency_max_ms = v.get_number("latency_max_ms");
+    if (const auto* h = v.find("histogram")) g.latency = LatencyHistogram::from_json(*h);
+    g.timed = static_cast<uint64_t>(v.get_int("timed"));
+    g.prompt_tokens = v.get_int("prompt_tokens");
+    g.prompt_ms = v.get_number("prompt_ms");
+    g.predicted_tokens = v.get_int("predicted_tokens");
+    g.predicted_ms = v.get_number("predicted_ms");
+    return g;
+}
+
+std::string RunAggregate::to_json() const {
+    std::string out = "{\"run_id\":\"" + json::escape(run_id) + "\",\"validator\":\"" + json::escape(validator) +
+                      "\",\"model_hash\":\"" + json::escape(model_hash) + "\",\"prompts_hash\":\"" +
+                      json::escape(prompts_hash) + "\",\"bad_lines\":" + std::to_string(bad_lines) + ",\"by_date\":{";
+    bool first = true;
+    for (const auto& [date, g] : by_date) {
+        out += (first ? "\"" : ",\"") + json::escape(date) + "\":" + g.to_json();
+        first = false;
+    }
+    return out + "}}";
+}
+
+RunAggregate RunAggregate::from_json(const std::string& line) {
+    json::Value doc = json::parse(line);
+    RunAggregate run;
+    run.run_id = doc.get_string("run_id");
+    run.validator = doc.get_string("validator");
+    run.model_hash = doc.get_string("model_hash", "unknown");
+    run.prompts_hash = doc.get_string("prompts_hash", "unknown");
+    run.bad_lines = static_cast<uint64_t>(doc.get_int("bad_lines"));
+    if (const auto* dates = doc.find("by_date"); dates && dates->is_object()) {
+        for (const auto& [date, g] : dates->as_object()) run.by_date[date] = GroupStats::from_json(g);
+    }
+    if (run.run_id.empty()) throw std::runtime_error("cached run without an id");
+    return run;
+}
+
+void aggregate_results(std::string_view jsonl, RunAggregate& run) {
+    size_t pos = 0;
+    while (pos < jsonl.size()) {
+        size_t nl = jsonl.find('\n', pos);
+        if (nl == std::string_view::npos) nl = jsonl.size();
+        std::string_view line = jsonl.substr(pos, nl - pos);
+        pos = nl + 1;
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        if (line.empty()) continue;
+
+        std::string_view ts = llama::find_json_field(line, "timestamp");
+        std::string date = ts.size() >= 10 ? std::string(ts.substr(0, 10)) : "unknown";
+        auto [it, inserted] = run.by_date.try_emplace(date);
+        if (!it->second.add_line(line)) {
+            run.bad_lines++;
+            if (inserted) run.by_date.erase(it);
+        }
+    }
+    for (auto& [date, g] : run.by_date) g.runs = 1;
+}
+
+std::string AggregateReport::to_json() const {
+    uint64_t requests = 0;
+    for (const auto& [key, g] : groups) requests += g.requests;
+    std::string out = "{\"runs\":" + std::to_string(runs) + ",\"requests\":" + std::to_string(requests) +
+                      ",\"groups\":[";
+    bool first = true;
+    for (const auto& [key, g] : groups) {
+        double success_rate = g.requests ? static_cast<double>(g.successes) / static_cast<double>(g.requests) : 0.0;
+        double mean = g.successes ? g.latency_sum_ms / static_cast<double>(g.successes) : 0.0;
+        out += first ? "{" : ",{";
+        first = false;
+        out += "\"model_hash\":\"" + json::escape(key.model_hash) + "\",\"prompts_hash\":\"" +
+               json::escape(key.prompts_hash) + "\",\"date\":\"" + json::escape(key.date) +
+               "\",\"runs\":" + std::to_string(g.runs) + ",\"requests\":" + std::to_string(g.requests) +
+               ",\"successes\":" + std::to_string(g.successes) + ",\"success_rate\":" + fmt(success_rate, 4) +
+               ",\"latency_ms\":{\"mean\":" + fmt(mean, 2) + ",\"p50\":" + fmt(g.latency.percentile_ms(0.50), 2) +
+               ",\"p90\":" + fmt(g.latency.percentile_ms(0.90), 2) +
+               ",\"p99\":" + fmt(g.latency.percentile_ms(0.99), 2) + ",\"max\":" + fmt(g.latency_max_ms, 2) +
+               ",\"histogram\":" + g.latency.to_report_json() + "}" +
+               ",\"prompt_tokens\":" + std::to_string(g.prompt_tokens) +
+               ",\"output_tokens\":" + std::to_string(g.predicted_tokens) +
+               ",\"prefill_tokens_per_sec\":" + fmt(rate(static_cast<double>(g.prompt_tokens), g.prompt_ms), 1) +
+               ",\"decode_tokens_per_sec\":" + fmt(rate(static_cast<double>(g.predicted_tokens), g.predicted_ms), 1) +
+               "}";
+    }
+    return out + "]}";
+}
+
+AggregateReport aggregate_runs(const AggregateOptions& opts) {
+    auto t0 = Clock::now();
+    AggregateReport report;
+
+    std::vector<RunJob> jobs;
+    for (const auto& e : seaweed::list_directory(opts.filer_base, "/runs/")) {
+        if (!e.is_dir) continue;
+        std::string id = e.path.substr(e.path.rfind('/') + 1);
+        if (id.compare(0, opts.run_prefix.size(), opts.run_prefix) != 0) continue;
+        RunJob job;
+        job.agg.run_id = id;
+        job.agg.model_hash = "unknown";
+        job.agg.prompts_hash = "unknown";
+        jobs.push_back(std::move(job));
+    }
+
+    auto cache = load_cache(opts.cache_path);
+    {
+        size_t threads = opts.parse_threads ? opts.parse_threads : std::max(1u, std::thread::hardware_concurrency());
+        ParsePool pool(threads, jobs);
+        FetchState state{opts, jobs, cache, pool};
+        EventLoop loop;
+        AsyncHttpClient http(loop);
+        std::vector<Task<void>> workers;
+        for (size_t i = 0; i < std::max<size_t>(1, std::min(opts.fetch_concurrency, jobs.size())); ++i) {
+            workers.push_back(fetch_worker(http, state));
+        }
+        loop.run(when_all(std::move(workers)));
+        pool.finish();
+    }
+
+    for (const auto& job : jobs) {
+        if (job.pending) {
+            report.runs_pending++;
+            continue;
+        }
+        if (!job.error.empty()) {
+            report.runs_failed++;
+            report.errors.push_back(job.error);
+            continue;
+        }
+        report.runs++;
+        if (job.cached) report.runs_cached++;
+        report.bytes_fetched += job.bytes;
+        report.bad_lines += job.agg.bad_lines;
+        for (const auto& [date, g] : job.agg.by_date) {
+            report.groups[{job.agg.model_hash, job.agg.prompts_hash, date}].merge(g);
+        }
+    }
+
+    save_cache(opts.cache_path, jobs);
+    report.seconds = std::chrono::duration<double>(Clock::now() - t0).count();
+    return report;
+}
+
+} // namespace slp::pipeline
@@ -0,0 +1,249 @@
+#include "slp/pipeline/chunk_store.h"
+#include "slp/artifact/paths.h"
+#include "slp/parallel.h"
+#include "slp/seaweed/filer.h"
+#include "slp/sha256.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+
+namespace slp::pipeline {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+std::vector<uint8_t> read_cached_chunk(const fs::path& path, uint64_t size) {
+    std::error_code ec;
+    if (fs::file_size(path, ec) != size || ec) return {};
+
+    std::ifstream f(path, std::ios::binary);
+    std::vector<uint8_t> data(size);
+    f.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(size));
+    if (!f) return {};
+    return data;
+}
+
+void write_cached_chunk(const fs::path& path, const std::vector<uint8_t>& data) {
+    // Write-then-rename so concurrent readers never see a partial chunk
+    fs::path tmp = path;
+    tmp += ".tmp." + std::to_string(::getpid());
+    {
+        std::ofstream f(tmp, std::ios::binary);
+        if (!f) return;  // the cache is best-effort
+        f.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        if (!f) {
+            std::error_code ec;
+            fs::remove(tmp, ec);
+            return;
+        }
+    }
+    std::error_code ec;
+    fs::rename(tmp, path, ec);
+}
+
+// Chunk hashes already confirmed by an earlier, interrupted upload
+std::set<std::string> read_checkpoint(const std::string& path) {
+    std::set<std::string> done;
+    if (path.empty()) return done;
+    std::ifstream f(path);
+    std::string line;
+    while (std::getline(f, line)) {
+        // A torn final line from a crash is ignored
+        if (line.size() == 64) done.insert(line);
+    }
+    return done;
+}
+
+void pwrite_all(int fd, const uint8_t* data, size_t len, uint64_t offset) {
+    while (len > 0) {
+        ssize_t n = ::pwrite(fd, data, len, static_cast<off_t>(offset));
+        if (n < 0) throw std::runtime_error("write failed while assembling chunks");
+        data += n;
+        len -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+}
+
+} // anonymous namespace
+
+double ChunkUploadStats::dedup_ratio() const {
+    if (bytes_total == 0) return 1.0;
+    if (bytes_uploaded == 0) return std::numeric_limits<double>::infinity();
+    return static_cast<double>(bytes_total) / static_cast<double>(bytes_uploaded);
+}
+
+ChunkUploadStats put_chunked(const std::string& filer_base,
+                             const std::vector<uint8_t>& data,
+                             artifact::Manifest& manifest,
+                             size_t parallelism,
+                             const artifact::ChunkerParams& params) {
+    return put_chunked(filer_base, data.data(), data.size(), manifest, "", parallelism, params);
+}
+
+ChunkUploadStats put_chunked(const std::string& filer_base,
+                             const uint8_t* data,
+                             size_t len,
+                             artifact::Manifest& manifest,
+                             const std::string& checkpoint_path,
+                             size_t parallelism,
+                             const artifact::ChunkerParams& params) {
+    ChunkUploadStats stats;
+    auto spans = artifact::chunk_buffer(data, len, params);
+
+    manifest.chunks.assign(spans.size(), {});
+    parallel_for(spans.size(), parallelism, [&](size_t i) {
+        auto& c = manifest.chunks[i];
+        c.offset = spans[i].offset;
+        c.size = spans[i].size;
+        c.sha256 = sha256_hex(data + c.offset, static_cast<size_t>(c.size));
+    });
+
+    std::set<std::string> done = read_checkpoint(checkpoint_path);
+    std::ofstream checkpoint;
+    std::mutex checkpoint_mu;
+    if (!checkpoint_path.empty()) {
+        checkpoint.open(checkpoint_path, std::ios::app);
+        if (!checkpoint) throw std::runtime_error("cannot write checkpoint: " + checkpoint_path);
+    }
+
+    // A chunk repeated inside the artifact is only checked and sent once
+    std::map<std::string, size_t> unique;
+    for (size_t i = 0; i < manifest.chunks.size(); ++i) {
+        unique.emplace(manifest.chunks[i].sha256, i);
+    }
+    std::vector<size_t> todo;
+    for (const auto& [hash, idx] : unique) todo.push_back(idx);
+
+    std::vector<uint8_t> uploaded(todo.size(), 0);
+    std::vector<uint8_t> resumed(todo.size(), 0);
+    parallel_for(todo.size(), parallelism, [&](size_t t) {
+        const auto& c = manifest.chunks[todo[t]];
+        if (done.count(c.sha256)) {
+            resumed[t] = 1;
+            return;
+        }
+
+        std::string path = artifact::chunk_path(c.sha256);
+        if (!seaweed::file_exists(filer_base, path)) {
+            // put_file retries transient failures itself
+            std::vector<uint8_t> bytes(data + c.offset, data + c.offset + c.size);
+            if (!seaweed::put_file(filer_base, path, bytes)) {
+                throw std::runtime_error("chunk upload failed: " + c.sha256);
+            }
+            uploaded[t] = 1;
+        }
+
+        if (checkpoint.is_open()) {
+            std::lock_guard<std::mutex> lock(checkpoint_mu);
+            checkpoint << c.sha256 << "\n" << std::flush;
+        }
+    });
+
+    stats.chunks_total = manifest.chunks.size();
+    stats.chunks_unique = todo.size();
+    stats.bytes_total = len;
+    for (size_t t = 0; t < todo.size(); ++t) {
+        if (uploaded[t]) {
+            stats.chunks_uploaded++;
+            stats.bytes_uploaded += manifest.chunks[todo[t]].size;
+        }
+        if (resumed[t]) stats.chunks_resumed++;
+    }
+
+    if (checkpoint.is_open()) {
+        checkpoint.close();
+        std::error_code ec;
+        fs::remove(checkpoint_path, ec);
+    }
+    return stats;
+}
+
+ChunkFetchStats get_chunked(const std::string& filer_base,
+                            const artifact::Manifest& manifest,
+                            const std::string& output_path,
+                            const std::string& cache_dir,
+                            size_t parallelism,
+                            const std::function<void(uint64_t done, uint64_t total)>& progress) {
+    ChunkFetchStats stats;
+    std::atomic<uint64_t> written{0};
+    stats.chunks_total = manifest.chunks.size();
+
+    std::error_code ec;
+    fs::create_directories(cache_dir, ec);
+    bool use_cache = !ec;
+
+    int fd = ::open(output_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) throw std::runtime_error("cannot create file: " + output_path);
+
+    // Group offsets by chunk hash so each distinct chunk is fetched once
+    std::map<std::string, std::vector<size_t>> by_hash;
+    for (size_t i = 0; i < manifest.chunks.size(); ++i) {
+        by_hash[manifest.chunks[i].sha256].push_back(i);
+    }
+    std::vector<const std::vector<size_t>*> groups;
+    for (const auto& [hash, idxs] : by_hash) groups.push_back(&idxs);
+
+    std::vector<uint8_t> from_cache(groups.size(), 0);
+    try {
+        if (::ftruncate(fd, static_cast<off_t>(manifest.size_bytes)) != 0) {
+            throw std::runtime_error("cannot size file: " + output_path);
+        }
+
+        parallel_for(groups.size(), parallelism, [&](size_t g) {
+            const auto& first = manifest.chunks[groups[g]->front()];
+            fs::path cached = fs::path(cache_dir) / first.sha256;
+
+            std::vector<uint8_t> bytes;
+            if (use_cache) {
+                bytes = read_cached_chunk(cached, first.size);
+                if (!bytes.empty() && sha256_hex(bytes) != first.sha256) bytes.clear();
+            }
+
+            if (!bytes.empty()) {
+                from_cache[g] = 1;
+            } else {
+                bytes = seaweed::get_file(filer_base, artifact::chunk_path(first.sha256));
+                if (bytes.size() != first.size || sha256_hex(bytes) != first.sha256) {
+                    throw std::runtime_error("chunk hash mismatch: " + first.sha256);
+                }
+                if (use_cache) write_cached_chunk(cached, bytes);
+            }
+
+            for (size_t idx : *groups[g]) {
+                pwrite_all(fd, bytes.data(), bytes.size(), manifest.chunks[idx].offset);
+            }
+            if (progress) {
+                progress(written += bytes.size() * groups[g]->size(), manifest.size_bytes);
+            }
+        });
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+
+    if (::close(fd) != 0) {
+        throw std::runtime_error("close failed: " + output_path);
+    }
+
+    for (size_t g = 0; g < groups.size(); ++g) {
+        if (from_cache[g]) {
+            stats.chunks_from_cache++;
+        } else {
+            stats.chunks_downloaded++;
+            stats.bytes_downloaded += manifest.chunks[groups[g]->front()].size;
+        }
+    }
+    return stats;
+}
+
+} // namespace slp::pipeline
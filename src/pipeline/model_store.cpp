@@ -1,11 +1,375 @@
-#include <string>
+#include "slp/pipeline/model_store.h"
+#include "slp/artifact/paths.h"
+#include "slp/http_client.h"
+#include "slp/parallel.h"
+#include "slp/seaweed/filer.h"
+#include "slp/seaweed/retry.h"
+#include "slp/sha256.h"
 
-// Model store placeholder
-// This would implement push/pull operations for GGUF models with caching
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <sys/file.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+// Model store: node-local caching and partial reads of GGUF models
 
 namespace slp::pipeline {
 
-// Placeholder for future implementation
-// This would handle model download, local caching, and cache invalidation
+namespace {
+
+namespace fs = std::filesystem;
+
+constexpr uint64_t kInitialHeaderProbe = 1 << 20;
+constexpr uint64_t kMaxHeaderBytes = 512ULL << 20;
+
+constexpr auto kLockPollInterval = std::chrono::milliseconds(200);
+
+// Layout of <hash>.progress, shared between processes through MAP_SHARED.
+// `magic` is stored last so readers never see a half-initialised record.
+constexpr uint64_t kProgressMagic = 0x3147525053504c53ULL;  // "SLPSPRG1"
+struct SharedProgress {
+    std::atomic<uint64_t> magic;
+    std::atomic<uint64_t> total;
+    std::atomic<uint64_t> done;
+    std::atomic<int32_t> pid;
+};
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<int32_t>::is_always_lock_free,
+              "progress record must be lock-free to live in shared memory");
+
+class ProgressFile {
+public:
+    // The downloader creates and resets the record; waiters only read it
+    ProgressFile(const std::string& path, bool owner) {
+        int fd = ::open(path.c_str(), owner ? O_RDWR | O_CREAT : O_RDONLY, 0644);
+        if (fd < 0) return;
+        if (owner && ::ftruncate(fd, sizeof(SharedProgress)) != 0) {
+            ::close(fd);
+            return;
+        }
+        if (!owner && ::lseek(fd, 0, SEEK_END) < static_cast<off_t>(sizeof(SharedProgress))) {
+            ::close(fd);
+            return;
+        }
+        void* p = ::mmap(nullptr, sizeof(SharedProgress), owner ? PROT_READ | PROT_WRITE : PROT_READ,
+                         MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) return;
+        rec_ = static_cast<SharedProgress*>(p);
+
+        if (owner) {
+            rec_->magic.store(0);
+            rec_->total.store(0);
+            rec_->done.store(0);
+            rec_->pid.store(static_cast<int32_t>(::getpid()));
+            rec_->magic.store(kProgressMagic, std::memory_order_release);
+        }
+    }
+
+    ~ProgressFile() {
+        if (rec_) ::munmap(rec_, sizeof(SharedProgress));
+    }
+
+    ProgressFile(const ProgressFile&) = delete;
+    ProgressFile& operator=(const ProgressFile&) = delete;
+
+    bool valid() const { return rec_ && rec_->magic.load(std::memory_order_acquire) == kProgressMagic; }
+    SharedProgress* record() const { return rec_; }
+
+private:
+    SharedProgress* rec_ = nullptr;
+};
+
+// flock is released by the kernel when the holder exits or crashes
+class FileLock {
+public:
+    explicit FileLock(const std::string& path) {
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd_ < 0) throw std::runtime_error("cannot open lock file: " + path);
+    }
+    ~FileLock() { ::close(fd_); }
+
+    FileLock(const FileLock&) = delete;
+    FileLock& operator=(const FileLock&) = delete;
+
+    bool try_lock() { return ::flock(fd_, LOCK_EX | LOCK_NB) == 0; }
+
+private:
+    int fd_;
+};
+
+// Empty only when no manifest is stored (404); any other failure throws so
+// a chunked model is never fetched as a single object
+artifact::Manifest try_fetch_manifest(const std::string& filer_base, const std::string& hash) {
+    std::string url = filer_base + artifact::model_manifest_path(hash);
+    auto response = seaweed::send_with_retries([url](HttpClient& client) { return client.get(url); }, true);
+    if (response.status == 404) return {};
+    if (response.status != 200) {
+        throw std::runtime_error("fetching manifest of " + hash + ": HTTP " + std::to_string(response.status));
+    }
+
+    seaweed::CodecOptions codec;
+    codec.codec = seaweed::parse_codec(response.header(seaweed::kCodecHeader));
+    if (codec.codec != seaweed::Codec::none) response.body = seaweed::decompress(response.body, codec);
+    auto m = artifact::Manifest::from_json(std::string(response.body.begin(), response.body.end()));
+    if (m.sha256.empty()) m.sha256 = hash;
+    return m;
+}
+
+void verify_hash(const std::string& path, const std::string& hash) {
+    auto computed = sha256_file_hex(path);
+    if (computed != hash) {
+        std::error_code ec;
+        fs::remove(path, ec);
+        throw std::runtime_error("hash mismatch: expected " + hash + ", got " + computed);
+    }
+}
+
+} // anonymous namespace
+
+std::string default_cache_dir() {
+    if (const char* dir = std::getenv("SLP_CACHE_DIR"); dir && *dir) {
+        return dir;
+    }
+    if (const char* xdg = std::getenv("XDG_CACHE_HOME"); xdg && *xdg) {
+        return std::string(xdg) + "/slp";
+    }
+    if (const char* home = std::getenv("HOME"); home && *home) {
+        return std::string(home) + "/.cache/slp";
+    }
+    return "/tmp/slp-cache";
+}
+
+CachedModel fetch_model_cached(const std::string& filer_base,
+                               const std::string& hash,
+                               const std::string& cache_dir,
+                               const FileWriterOptions& writer,
+                               const std::function<void(const FetchProgress&)>& progress) {
+    CachedModel result;
+    std::string dir = cache_dir + "/models";
+    fs::create_directories(dir);
+    result.path = dir + "/" + hash + ".gguf";
+    // Published by rename only once verified, so existence means complete
+    if (fs::exists(result.path)) return result;
+
+    FileLock lock(dir + "/" + hash + ".lock");
+    std::string progress_path = dir + "/" + hash + ".progress";
+
+    std::unique_ptr<ProgressFile> watched;
+    while (!lock.try_lock()) {
+        result.waited = true;
+        if (progress) {
+            if (!watched || !watched->valid()) watched = std::make_unique<ProgressFile>(progress_path, false);
+            FetchProgress p;
+            p.waiting = true;
+            if (watched->valid()) {
+                p.done = watched->record()->done.load();
+                p.total = watched->record()->total.load();
+                p.owner_pid = watched->record()->pid.load();
+            }
+            progress(p);
+        }
+        std::this_thread::sleep_for(kLockPollInterval);
+    }
+    watched.reset();
+
+    // The previous holder may have finished it; if it died instead, its
+    // partial file is resumed below
+    if (fs::exists(result.path)) return result;
+
+    ProgressFile shared(progress_path, true);
+    auto report = [&](uint64_t done, uint64_t total) {
+        if (SharedProgress* rec = shared.record()) {
+            rec->total.store(total, std::memory_order_relaxed);
+            rec->done.store(done, std::memory_order_relaxed);
+        }
+        if (progress) {
+            FetchProgress p;
+            p.done = done;
+            p.total = total;
+            p.owner_pid = static_cast<int>(::getpid());
+            progress(p);
+        }
+    };
+
+    std::string staging = result.path + ".dl";
+    auto manifest = try_fetch_manifest(filer_base, hash);
+    if (!manifest.chunks.empty()) {
+        result.chunked = true;
+        result.chunks = get_chunked(filer_base, manifest, staging, cache_dir + "/chunks", 8, report);
+    } else {
+        seaweed::DownloadOptions options;
+        options.writer = writer;
+        options.progress = report;
+        result.download = seaweed::download_file(filer_base, artifact::model_path(hash), staging, options);
+    }
+
+    verify_hash(staging, hash);
+    // Read-only once published: the hash check is not repeated on a hit
+    fs::permissions(staging, fs::perms::owner_read | fs::perms::group_read | fs::perms::others_read);
+    fs::rename(staging, result.path);
+    result.fetched = true;
+    return result;
+}
+
+bool copy_from_cache(const std::string& cached_path, const std::string& dest) {
+    int in = ::open(cached_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (in < 0) throw std::runtime_error("cannot open " + cached_path + ": " + std::strerror(errno));
+    struct stat st {};
+    if (::fstat(in, &st) != 0) {
+        ::close(in);
+        throw std::runtime_error("cannot stat " + cached_path + ": " + std::strerror(errno));
+    }
+
+    std::error_code ec;
+    fs::remove(dest, ec);
+    int out = ::open(dest.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (out < 0) {
+        ::close(in);
+        throw std::runtime_error("cannot create " + dest + ": " + std::strerror(errno));
+    }
+
+    bool reflinked = ::ioctl(out, FICLONE, in) == 0;
+    std::string error;
+    if (!reflinked) {
+        auto remaining = static_cast<uint64_t>(st.st_size);
+        bool use_read = false;
+        std::vector<char> buf;
+        while (remaining > 0 && error.empty()) {
+            ssize_t n;
+            if (!use_read) {
+                n = ::copy_file_range(in, nullptr, out, nullptr, remaining, 0);
+                // Not supported between these files: copy through user space
+                if (n < 0 && (errno == EXDEV || errno == ENOSYS || errno == EOPNOTSUPP || errno == EINVAL)) {
+                    use_read = true;
+                    buf.resize(1 << 20);
+                    continue;
+                }
+            } else {
+                n = ::read(in, buf.data(), std::min<uint64_t>(buf.size(), remaining));
+                for (ssize_t off = 0; n > 0 && off < n;) {
+                    ssize_t w = ::write(out, buf.data() + off, static_cast<size_t>(n - off));
+                    if (w < 0 && errno == EINTR) continue;
+                    if (w <= 0) {
+                        n = -1;
+                        break;
+                    }
+                    off += w;
+                }
+            }
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0) {
+                error = std::strerror(errno);
+            } else if (n == 0) {
+                error = "source shrank while copying";
+            } else {
+                remaining -= static_cast<uint64_t>(n);
+            }
+        }
+    }
+    ::close(in);
+    if (::close(out) != 0 && error.empty()) error = std::strerror(errno);
+    if (!error.empty()) {
+        fs::remove(dest, ec);
+        throw std::runtime_error("cannot copy " + cached_path + " to " + dest + ": " + error);
+    }
+    return reflinked;
+}
+
+artifact::Manifest fetch_manifest(const std::string& filer_base, const std::string& hash) {
+    auto bytes = seaweed::get_file(filer_base, artifact::model_manifest_path(hash));
+    auto m = artifact::Manifest::from_json(std::string(bytes.begin(), bytes.end()));
+    if (m.sha256.empty()) m.sha256 = hash;
+    return m;
+}
+
+std::vector<uint8_t> read_model_range(const std::string& filer_base,
+                                      const artifact::Manifest& manifest,
+                                      uint64_t offset,
+                                      uint64_t length) {
+    if (manifest.size_bytes > 0) {
+        if (offset >= manifest.size_bytes) return {};
+        length = std::min(length, manifest.size_bytes - offset);
+    }
+    if (length == 0) return {};
+
+    if (manifest.chunks.empty()) {
+        return seaweed::get_file_range(filer_base, artifact::model_path(manifest.sha256), offset, length);
+    }
+
+    // Chunks are sorted by offset; find the first one overlapping the range
+    const auto& chunks = manifest.chunks;
+    auto it = std::upper_bound(chunks.begin(), chunks.end(), offset,
+                               [](uint64_t off, const artifact::ChunkRef& c) { return off < c.offset; });
+    size_t first = static_cast<size_t>(std::distance(chunks.begin(), it));
+    if (first > 0) first--;
+
+    size_t last = first;
+    while (last < chunks.size() && chunks[last].offset < offset + length) last++;
+
+    std::vector<uint8_t> out(length);
+    parallel_for(last - first, 8, [&](size_t k) {
+        const auto& c = chunks[first + k];
+        uint64_t begin = std::max(offset, c.offset);
+        uint64_t end = std::min(offset + length, c.offset + c.size);
+        auto part = seaweed::get_file_range(filer_base, artifact::chunk_path(c.sha256),
+                                            begin - c.offset, end - begin);
+        if (part.size() != end - begin) {
+            throw std::runtime_error("short read from chunk " + c.sha256);
+        }
+        std::memcpy(out.data() + (begin - offset), part.data(), part.size());
+    });
+    return out;
+}
+
+artifact::GgufHeader fetch_gguf_header(const std::string& filer_base,
+                                       const artifact::Manifest& manifest) {
+    uint64_t probe = manifest.gguf_header_bytes > 0 ? manifest.gguf_header_bytes : kInitialHeaderProbe;
+
+    for (;;) {
+        auto prefix = read_model_range(filer_base, manifest, 0, probe);
+        try {
+            return artifact::parse_gguf_header(prefix.data(), prefix.size());
+        } catch (const artifact::GgufTruncated& e) {
+            if (prefix.size() < probe) {
+                throw std::runtime_error("model ends inside its GGUF header");
+            }
+            probe = std::max(e.needed, probe * 4);
+            if (probe > kMaxHeaderBytes) {
+                throw std::runtime_error("GGUF header larger than " + std::to_string(kMaxHeaderBytes) + " bytes");
+            }
+        }
+    }
+}
+
+std::vector<uint8_t> fetch_tensor(const std::string& filer_base,
+                                  const artifact::Manifest& manifest,
+                                  const std::string& tensor_name) {
+    for (const auto& t : manifest.tensors) {
+        if (t.name != tensor_name) continue;
+        if (t.size == 0) {
+            throw std::runtime_error("unknown size for tensor " + tensor_name + " (type " + t.type + ")");
+        }
+        auto bytes = read_model_range(filer_base, manifest, t.offset, t.size);
+        if (bytes.size() != t.size) {
+            throw std::runtime_error("short read for tensor " + tensor_name);
+        }
+        return bytes;
+    }
+    throw std::runtime_error("no tensor named " + tensor_name);
+}
 
 } // namespace slp::pipeline
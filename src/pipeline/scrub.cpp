@@ -0,0 +1,300 @@
+#include "slp/pipeline/scrub.h"
+#include "slp/artifact/paths.h"
+#include "slp/http_client.h"
+#include "slp/json.h"
+#include "slp/seaweed/codec.h"
+#include "slp/seaweed/filer.h"
+#include "slp/seaweed/retry.h"
+#include "slp/sha256.h"
+
+#include <algorithm>
+#include <exception>
+#include <set>
+#include <stdexcept>
+#include <thread>
+
+// Store scrubbing: streaming verification of content-addressed objects
+
+namespace slp::pipeline {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+bool is_hash(const std::string& s) {
+    return s.size() == 64 && std::all_of(s.begin(), s.end(), [](char c) {
+        return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f');
+    });
+}
+
+// <hash> from <dir><hash><suffix>, or "" if `path` does not have that shape
+std::string hash_between(const std::string& path, const std::string& dir, const std::string& suffix) {
+    if (path.size() != dir.size() + 64 + suffix.size()) return "";
+    if (path.compare(0, dir.size(), dir) != 0) return "";
+    if (path.compare(path.size() - suffix.size(), suffix.size(), suffix) != 0) return "";
+    std::string hash = path.substr(dir.size(), 64);
+    return is_hash(hash) ? hash : "";
+}
+
+int64_t elapsed_us(Clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+}
+
+} // anonymous namespace
+
+std::string scrub_status_name(ScrubStatus status) {
+    switch (status) {
+        case ScrubStatus::ok: return "ok";
+        case ScrubStatus::readable: return "readable";
+        case ScrubStatus::corrupt: return "corrupt";
+        case ScrubStatus::missing: return "missing";
+        case ScrubStatus::error: return "error";
+    }
+    return "error";
+}
+
+ScrubStatus parse_scrub_status(const std::string& name) {
+    if (name == "ok") return ScrubStatus::ok;
+    if (name == "readable") return ScrubStatus::readable;
+    if (name == "corrupt") return ScrubStatus::corrupt;
+    if (name == "missing") return ScrubStatus::missing;
+    if (name == "error") return ScrubStatus::error;
+    throw std::invalid_argument("unknown scrub status: '" + name + "'");
+}
+
+std::string ScrubResult::to_json() const {
+    std::string out = "{\"path\":\"" + json::escape(path) + "\",\"status\":\"" + scrub_status_name(status) +
+                      "\",\"bytes\":" + std::to_string(bytes);
+    if (!expected.empty()) out += ",\"expected\":\"" + json::escape(expected) + "\"";
+    if (!actual.empty()) out += ",\"actual\":\"" + json::escape(actual) + "\"";
+    if (!detail.empty()) out += ",\"detail\":\"" + json::escape(detail) + "\"";
+    out += ",\"elapsed_us\":" + std::to_string(elapsed_us) + "}";
+    return out;
+}
+
+ScrubResult ScrubResult::from_json(const std::string& line) {
+    json::Value v = json::parse(line);
+    ScrubResult r;
+    r.path = v.get_string("path");
+    r.status = parse_scrub_status(v.get_string("status"));
+    r.bytes = static_cast<uint64_t>(v.get_int("bytes"));
+    r.expected = v.get_string("expected");
+    r.actual = v.get_string("actual");
+    r.detail = v.get_string("detail");
+    r.elapsed_us = v.get_int("elapsed_us");
+    return r;
+}
+
+std::string expected_content_hash(const std::string& path) {
+    std::string hash = hash_between(path, "/chunks/", "");
+    if (hash.empty()) hash = hash_between(path, "/models/", ".gguf");
+    if (hash.empty()) hash = hash_between(path, "/prompts/", ".jsonl");
+    return hash;
+}
+
+std::string manifest_model_hash(const std::string& path) {
+    return hash_between(path, "/models/", ".manifest.json");
+}
+
+ByteThrottle::ByteThrottle(double bytes_per_sec) : bytes_per_sec_(bytes_per_sec) {}
+
+void ByteThrottle::acquire(size_t bytes) {
+    if (bytes_per_sec_ <= 0) return;
+    auto cost = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(static_cast<double>(bytes) / bytes_per_sec_));
+    Clock::time_point start;
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        // Idle time is not banked: a scrub that was waiting on the filer
+        // does not get to burst afterwards
+        next_ = std::max(next_, Clock::now());
+        start = next_;
+        next_ += cost;
+    }
+    std::this_thread::sleep_until(start);
+}
+
+bool StoreListing::covers(const std::string& path) const {
+    return std::any_of(roots.begin(), roots.end(), [&](const std::string& root) {
+        return path.compare(0, root.size(), root) == 0;
+    });
+}
+
+ScrubResult scrub_object(const std::string& filer_base,
+                         const std::string& path,
+                         const ScrubOptions& opts,
+                         std::optional<uint64_t> expected_size) {
+    auto start = Clock::now();
+    ScrubResult r;
+    r.path = path;
+    r.expected = expected_content_hash(path);
+    std::string url = filer_base + path;
+
+    try {
+        // Chunks are always stored raw; anything else may carry a codec,
+        // which only the response headers tell
+        seaweed::CodecOptions codec;
+        codec.dictionary = opts.dictionary;
+        if (path.rfind("/chunks/", 0) != 0) {
+            auto head = seaweed::send_with_retries([url](HttpClient& client) { return client.head(url); }, false);
+            if (head.status == 404) {
+                r.status = ScrubStatus::missing;
+                r.detail = "not found";
+                r.elapsed_us = elapsed_us(start);
+                return r;
+            }
+            if (head.status != 200) throw std::runtime_error("HEAD: HTTP " + std::to_string(head.status));
+            codec.codec = seaweed::parse_codec(head.header(seaweed::kCodecHeader));
+        }
+
+        Sha256 hasher;
+        uint64_t content_bytes = 0;
+        std::unique_ptr<seaweed::Decompressor> decoder;
+        std::vector<uint8_t> decoded;
+        std::exception_ptr sink_error;
+
+        HttpResponse response;
+        try {
+            response = seaweed::send_with_retries([&](HttpClient& client) {
+                // A retry starts the object over
+                sink_error = nullptr;
+                hasher = Sha256();
+                content_bytes = 0;
+                r.bytes = 0;
+                if (codec.codec != seaweed::Codec::none) decoder = seaweed::make_decompressor(codec);
+                return client.get_stream(url, 0, "", [&](long, const uint8_t* data, size_t len) {
+                    // Exceptions must not unwind through libcurl
+                    try {
+                        if (opts.throttle) opts.throttle->acquire(len);
+                        r.bytes += len;
+                        if (decoder) {
+                            decoded.clear();
+                            decoder->update(data, len, decoded);
+                            hasher.update(decoded);
+                            content_bytes += decoded.size();
+                        } else {
+                            hasher.update(data, len);
+                            content_bytes += len;
+                        }
+                        return true;
+                    } catch (...) {
+                        sink_error = std::current_exception();
+                        return false;
+                    }
+                });
+            }, false);
+        } catch (const std::exception&) {
+            // An aborted sink surfaces as a transport error; report the cause
+            if (sink_error) std::rethrow_exception(sink_error);
+            throw;
+        }
+        if (response.status == 404) {
+            r.status = ScrubStatus::missing;
+            r.detail = "not found";
+            r.elapsed_us = elapsed_us(start);
+            return r;
+        }
+        if (response.status != 200) throw std::runtime_error("GET: HTTP " + std::to_string(response.status));
+        if (decoder) {
+            decoded.clear();
+            decoder->finish(decoded);
+            hasher.update(decoded);
+            content_bytes += decoded.size();
+        }
+
+        // Recorded even without a promised hash, so a later scrub can tell
+        // whether the object changed
+        r.actual = hasher.hex_digest();
+        std::vector<std::string> problems;
+        if (!r.expected.empty() && r.actual != r.expected) problems.push_back("content hash mismatch");
+        if (expected_size && content_bytes != *expected_size) {
+            problems.push_back("content is " + std::to_string(content_bytes) + " bytes, manifest says " +
+                               std::to_string(*expected_size));
+        }
+        if (!problems.empty()) {
+            r.status = ScrubStatus::corrupt;
+            for (size_t i = 0; i < problems.size(); ++i) r.detail += (i ? "; " : "") + problems[i];
+        } else {
+            r.status = r.expected.empty() ? ScrubStatus::readable : ScrubStatus::ok;
+        }
+    } catch (const std::exception& e) {
+        r.status = ScrubStatus::error;
+        r.detail = e.what();
+    }
+    r.elapsed_us = elapsed_us(start);
+    return r;
+}
+
+std::vector<ScrubResult> scrub_manifest(const std::string& filer_base,
+                                        const std::string& path,
+                                        const StoreListing& listing,
+                                        const ScrubOptions& opts,
+                                        std::optional<artifact::Manifest>& manifest) {
+    auto start = Clock::now();
+    ScrubResult r;
+    std::vector<ScrubResult> results;
+    r.path = path;
+    r.expected = manifest_model_hash(path);
+    manifest.reset();
+
+    auto missing = [&](const std::string& ref, const std::string& what) {
+        ScrubResult m;
+        m.path = ref;
+        m.status = ScrubStatus::missing;
+        m.expected = expected_content_hash(ref);
+        m.detail = what + " of " + path + " is not in the store";
+        results.push_back(std::move(m));
+    };
+
+    try {
+        auto bytes = seaweed::get_file(filer_base, path);
+        if (opts.throttle) opts.throttle->acquire(bytes.size());
+        r.bytes = bytes.size();
+        manifest = artifact::Manifest::from_json(std::string(bytes.begin(), bytes.end()));
+        const artifact::Manifest& m = *manifest;
+        r.actual = m.sha256;
+
+        std::vector<std::string> problems;
+        if (m.sha256 != r.expected) problems.push_back("sha256 field does not match the path");
+
+        if (m.chunks.empty()) {
+            std::string model = artifact::model_path(m.sha256);
+            if (listing.covers(model) && !listing.objects.count(model)) missing(model, "model body");
+        } else {
+            uint64_t offset = 0;
+            std::set<std::string> reported;
+            for (const auto& c : m.chunks) {
+                if (c.offset != offset) {
+                    problems.push_back("chunk list is not contiguous at offset " + std::to_string(offset));
+                    break;
+                }
+                offset += c.size;
+
+                std::string chunk = artifact::chunk_path(c.sha256);
+                if (!listing.covers(chunk)) continue;
+                auto it = listing.objects.find(chunk);
+                if (it == listing.objects.end()) {
+                    if (reported.insert(chunk).second) missing(chunk, "chunk");
+                } else if (it->second != c.size) {
+                    problems.push_back("chunk " + c.sha256 + " is " + std::to_string(it->second) +
+                                       " bytes, manifest says " + std::to_string(c.size));
+                }
+            }
+            if (problems.empty() && offset != m.size_bytes) {
+                problems.push_back("chunks cover " + std::to_string(offset) + " bytes, manifest says " +
+                                   std::to_string(m.size_bytes));
+            }
+        }
+
+        r.status = problems.empty() ? ScrubStatus::ok : ScrubStatus::corrupt;
+        for (size_t i = 0; i < problems.size(); ++i) r.detail += (i ? "; " : "") + problems[i];
+    } catch (const std::exception& e) {
+        r.status = ScrubStatus::error;
+        r.detail = e.what();
+    }
+    r.elapsed_us = elapsed_us(start);
+    results.insert(results.begin(), std::move(r));
+    return results;
+}
+
+} // namespace slp::pipeline
@@ -0,0 +1,284 @@
+#include "slp/pipeline/shards.h"
+#include "slp/artifact/paths.h"
+#include "slp/http_client.h"
+#include "slp/json.h"
+#include "slp/seaweed/filer.h"
+#include "slp/seaweed/retry.h"
+#include "slp/sha256.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
+
+// Sharded batch runs: shard planning and filer-backed leases
+
+namespace slp::pipeline {
+
+namespace {
+
+std::vector<uint8_t> to_bytes(const std::string& s) {
+    return std::vector<uint8_t>(s.begin(), s.end());
+}
+
+void put_or_throw(const std::string& filer_base, const std::string& path, const std::string& body,
+                  const seaweed::CodecOptions& codec = {}) {
+    if (!seaweed::put_file(filer_base, path, to_bytes(body), codec)) {
+        throw std::runtime_error("failed to write " + path);
+    }
+}
+
+// Results are JSONL and compress well; plans and leases stay plain so they
+// can be read and conditionally rewritten as they are
+seaweed::CodecOptions results_codec() {
+    seaweed::CodecOptions codec;
+    codec.codec = seaweed::default_text_codec();
+    return codec;
+}
+
+} // anonymous namespace
+
+std::string ShardPlan::to_json() const {
+    std::string out = "{\"prompts_hash\":\"" + json::escape(prompts_hash) +
+                      "\",\"prompts_per_shard\":" + std::to_string(prompts_per_shard) +
+                      ",\"total_prompts\":" + std::to_string(total_prompts) + ",\"shards\":[";
+    for (size_t i = 0; i < shards.size(); ++i) {
+        const Shard& s = shards[i];
+        out += (i ? ",{\"id\":" : "{\"id\":") + std::to_string(s.id) + ",\"offset\":" + std::to_string(s.offset) +
+               ",\"length\":" + std::to_string(s.length) + ",\"prompts\":" + std::to_string(s.prompts) + "}";
+    }
+    out += "]}";
+    return out;
+}
+
+ShardPlan ShardPlan::from_json(const std::string& text) {
+    json::Value doc = json::parse(text);
+    ShardPlan plan;
+    plan.prompts_hash = doc.get_string("prompts_hash");
+    plan.prompts_per_shard = static_cast<uint32_t>(doc.get_int("prompts_per_shard"));
+    plan.total_prompts = static_cast<uint64_t>(doc.get_int("total_prompts"));
+    if (const auto* shards = doc.find("shards"); shards && shards->is_array()) {
+        for (const auto& s : shards->as_array()) {
+            Shard shard;
+            shard.id = static_cast<uint32_t>(s.get_int("id"));
+            shard.offset = static_cast<uint64_t>(s.get_int("offset"));
+            shard.length = static_cast<uint64_t>(s.get_int("length"));
+            shard.prompts = static_cast<uint32_t>(s.get_int("prompts"));
+            plan.shards.push_back(shard);
+        }
+    }
+    for (size_t i = 0; i < plan.shards.size(); ++i) {
+        if (plan.shards[i].id != i) throw std::runtime_error("shard plan: shards out of order");
+    }
+    return plan;
+}
+
+ShardPlan plan_shards(const std::vector<uint8_t>& prompts,
+                      const std::string& prompts_hash,
+                      uint32_t prompts_per_shard) {
+    if (prompts_per_shard == 0) throw std::invalid_argument("prompts_per_shard must be positive");
+    ShardPlan plan;
+    plan.prompts_hash = prompts_hash;
+    plan.prompts_per_shard = prompts_per_shard;
+
+    Shard current;
+    size_t pos = 0;
+    while (pos < prompts.size()) {
+        auto nl = std::find(prompts.begin() + static_cast<std::ptrdiff_t>(pos), prompts.end(), '\n');
+        size_t end = static_cast<size_t>(nl - prompts.begin());
+        size_t next = nl == prompts.end() ? end : end + 1;
+        bool blank = end == pos || (end == pos + 1 && prompts[pos] == '\r');
+        if (!blank && prompts[pos] != '#') current.prompts++;
+        current.length += next - pos;
+        pos = next;
+
+        if (current.prompts == prompts_per_shard) {
+            plan.total_prompts += current.prompts;
+            plan.shards.push_back(current);
+            current = Shard{};
+            current.id = static_cast<uint32_t>(plan.shards.size());
+            current.offset = pos;
+        }
+    }
+    // Trailing blank or comment lines join the last shard
+    if (current.prompts > 0 || (current.length > 0 && plan.shards.empty())) {
+        plan.total_prompts += current.prompts;
+        plan.shards.push_back(current);
+    } else if (current.length > 0) {
+        plan.shards.back().length += current.length;
+    }
+    return plan;
+}
+
+ShardPlan load_or_create_plan(const std::string& filer_base,
+                              const std::string& run_id,
+                              const std::string& prompts_hash,
+                              uint32_t prompts_per_shard) {
+    std::string path = artifact::run_shard_plan_path(run_id);
+    if (!seaweed::file_exists(filer_base, path)) {
+        auto prompts = seaweed::get_file(filer_base, artifact::prompts_path(prompts_hash));
+        std::string actual = sha256_hex(prompts);
+        if (actual != prompts_hash) {
+            throw std::runtime_error("prompt set " + prompts_hash + " hashes to " + actual);
+        }
+        put_or_throw(filer_base, path, plan_shards(prompts, prompts_hash, prompts_per_shard).to_json());
+    }
+
+    auto stored = seaweed::get_file(filer_base, path);
+    ShardPlan plan = ShardPlan::from_json(std::string(stored.begin(), stored.end()));
+    if (plan.prompts_hash != prompts_hash) {
+        throw std::runtime_error("run " + run_id + " is for prompt set " + plan.prompts_hash);
+    }
+    return plan;
+}
+
+std::string Lease::to_json() const {
+    return "{\"shard\":" + std::to_string(shard) + ",\"owner\":\"" + json::escape(owner) +
+           "\",\"generation\":" + std::to_string(generation) +
+           ",\"expires_unix_ms\":" + std::to_string(expires_unix_ms) + "}";
+}
+
+Lease Lease::from_json(const std::string& text) {
+    json::Value doc = json::parse(text);
+    Lease lease;
+    lease.shard = static_cast<uint32_t>(doc.get_int("shard"));
+    lease.owner = doc.get_string("owner");
+    lease.generation = static_cast<uint64_t>(doc.get_int("generation"));
+    lease.expires_unix_ms = doc.get_int("expires_unix_ms");
+    return lease;
+}
+
+int64_t unix_now_ms() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+ShardLeases::ShardLeases(std::string filer_base, std::string run_id, std::string owner, LeaseOptions opts)
+    : filer_(std::move(filer_base)), run_id_(std::move(run_id)), owner_(std::move(owner)), opts_(opts) {}
+
+std::set<uint32_t> ShardLeases::list_ids(const std::string& dir, const std::string& suffix) const {
+    std::set<uint32_t> ids;
+    for (const auto& e : seaweed::list_directory(filer_, dir)) {
+        if (e.is_dir) continue;
+        std::string name = e.path.substr(e.path.rfind('/') + 1);
+        if (name.size() <= suffix.size() || name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0) {
+            continue;
+        }
+        name.resize(name.size() - suffix.size());
+        if (!std::all_of(name.begin(), name.end(), [](char c) { return c >= '0' && c <= '9'; })) continue;
+        ids.insert(static_cast<uint32_t>(std::stoul(name)));
+    }
+    return ids;
+}
+
+std::set<uint32_t> ShardLeases::finished() const {
+    return list_ids(artifact::run_shard_results_dir(run_id_), ".jsonl");
+}
+
+std::set<uint32_t> ShardLeases::leased() const {
+    return list_ids(artifact::run_leases_dir(run_id_), "");
+}
+
+std::optional<Lease> ShardLeases::read(uint32_t shard) const {
+    std::string url = filer_ + artifact::run_lease_path(run_id_, shard);
+    auto response = seaweed::send_with_retries([url](HttpClient& client) { return client.get(url); }, false);
+    if (response.status == 404) return std::nullopt;
+    if (response.status != 200) {
+        throw std::runtime_error("reading lease " + std::to_string(shard) + ": HTTP " + std::to_string(response.status));
+    }
+    try {
+        return Lease::from_json(std::string(response.body.begin(), response.body.end()));
+    } catch (const std::exception&) {
+        // Unreadable: treat as long expired so it can be taken over
+        Lease lease;
+        lease.shard = shard;
+        return lease;
+    }
+}
+
+void ShardLeases::write(const Lease& lease) {
+    put_or_throw(filer_, artifact::run_lease_path(run_id_, lease.shard), lease.to_json());
+}
+
+std::optional<Lease> ShardLeases::claim(uint32_t shard, const std::optional<Lease>& seen) {
+    // Someone may have got there between our listing and now
+    uint64_t seen_generation = seen ? seen->generation : 0;
+    auto current = read(shard);
+    if ((current ? current->generation : 0) != seen_generation) return std::nullopt;
+
+    Lease mine;
+    mine.shard = shard;
+    mine.owner = owner_;
+    mine.generation = seen_generation + 1;
+    mine.expires_unix_ms = unix_now_ms() + opts_.ttl.count();
+    write(mine);
+
+    // Of several workers claiming at once, the last write wins; give the
+    // others' writes time to land before checking which one that was
+    std::this_thread::sleep_for(opts_.settle);
+    auto back = read(shard);
+    if (!back || back->owner != owner_ || back->generation != mine.generation) return std::nullopt;
+    return mine;
+}
+
+bool ShardLeases::renew(Lease& lease) {
+    auto current = read(lease.shard);
+    if (!current || current->owner != owner_ || current->generation != lease.generation) return false;
+    lease.expires_unix_ms = unix_now_ms() + opts_.ttl.count();
+    write(lease);
+    return true;
+}
+
+ShardLeases::Next ShardLeases::next(const ShardPlan& plan, uint32_t start) {
+    Next result;
+    auto done = finished();
+    size_t n = plan.shards.size();
+    if (std::all_of(plan.shards.begin(), plan.shards.end(), [&](const Shard& s) { return done.count(s.id) != 0; })) {
+        result.outcome = Outcome::finished;
+        return result;
+    }
+    auto held = leased();
+
+    for (size_t k = 0; k < n; ++k) {
+        uint32_t id = static_cast<uint32_t>((start + k) % n);
+        if (done.count(id) || held.count(id)) continue;
+        if (auto lease = claim(id, std::nullopt)) {
+            result.outcome = Outcome::claimed;
+            result.lease = *lease;
+            return result;
+        }
+    }
+
+    // Every unfinished shard has a lease; take over one that has lapsed
+    for (size_t k = 0; k < n; ++k) {
+        uint32_t id = static_cast<uint32_t>((start + k) % n);
+        if (done.count(id) || !held.count(id)) continue;
+        auto seen = read(id);
+        if (seen && !seen->expired(unix_now_ms())) continue;
+        // The previous owner may have finished just as its lease ran out
+        if (seaweed::file_exists(filer_, artifact::run_shard_results_path(run_id_, id))) continue;
+        if (auto lease = claim(id, seen)) {
+            result.outcome = Outcome::claimed;
+            result.lease = *lease;
+            result.stolen = true;
+            return result;
+        }
+    }
+    return result;
+}
+
+void ShardLeases::complete(uint32_t shard, const std::string& results) {
+    put_or_throw(filer_, artifact::run_shard_results_path(run_id_, shard), results, results_codec());
+}
+
+void merge_shard_results(const std::string& filer_base, const std::string& run_id, const ShardPlan& plan) {
+    std::vector<uint8_t> merged;
+    for (const auto& s : plan.shards) {
+        auto part = seaweed::get_file(filer_base, artifact::run_shard_results_path(run_id, s.id));
+        merged.insert(merged.end(), part.begin(), part.end());
+    }
+    if (!seaweed::put_file(filer_base, artifact::run_results_path(run_id), merged, results_codec())) {
+        throw std::runtime_error("failed to write " + artifact::run_results_path(run_id));
+    }
+}
+
+} // namespace slp::pipeline
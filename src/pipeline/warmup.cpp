@@ -0,0 +1,179 @@
+#include "slp/pipeline/warmup.h"
+#include "slp/parallel.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+namespace slp::pipeline {
+
+namespace {
+
+uint64_t page_size() {
+    static const uint64_t size = static_cast<uint64_t>(::sysconf(_SC_PAGESIZE));
+    return size;
+}
+
+// Resident bytes of [offset, offset + len) of the mapping
+uint64_t resident_in(const MappedFile& file, uint64_t offset, uint64_t len) {
+    if (len == 0) return 0;
+    uint64_t page = page_size();
+    size_t pages = static_cast<size_t>((len + page - 1) / page);
+    std::vector<unsigned char> vec(pages);
+    void* addr = const_cast<uint8_t*>(file.data() + offset);
+    if (::mincore(addr, static_cast<size_t>(len), vec.data()) != 0) {
+        throw std::runtime_error(std::string("mincore failed: ") + std::strerror(errno));
+    }
+    uint64_t resident = 0;
+    for (size_t i = 0; i < pages; ++i) {
+        if (vec[i] & 1) resident += std::min(page, len - i * page);
+    }
+    return resident;
+}
+
+// Read the range so that every page of it is in the page cache; pages the
+// advisory pass already requested just wait for their I/O
+void read_range(int fd, uint64_t offset, uint64_t len) {
+    thread_local std::vector<char> buf(1 << 20);
+    while (len > 0) {
+        size_t want = static_cast<size_t>(std::min<uint64_t>(len, buf.size()));
+        ssize_t n = ::pread(fd, buf.data(), want, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) throw std::runtime_error(std::string("read failed while warming: ") + std::strerror(errno));
+        offset += static_cast<uint64_t>(n);
+        len -= static_cast<uint64_t>(n);
+    }
+}
+
+} // anonymous namespace
+
+WarmMethod parse_warm_method(const std::string& name) {
+    if (name == "readahead") return WarmMethod::readahead;
+    if (name == "fadvise") return WarmMethod::fadvise;
+    if (name == "touch") return WarmMethod::touch;
+    throw std::invalid_argument("unknown warm-up method: " + name + " (readahead, fadvise or touch)");
+}
+
+const char* warm_method_name(WarmMethod m) {
+    switch (m) {
+    case WarmMethod::readahead: return "readahead";
+    case WarmMethod::fadvise: return "fadvise";
+    case WarmMethod::touch: return "touch";
+    }
+    return "unknown";
+}
+
+uint64_t available_memory_bytes() {
+    std::ifstream in("/proc/meminfo");
+    std::string key;
+    uint64_t kib = 0;
+    std::string unit;
+    while (in >> key >> kib >> unit) {
+        if (key == "MemAvailable:") return kib * 1024;
+    }
+    return 0;
+}
+
+uint64_t resident_bytes(const MappedFile& file) {
+    return resident_in(file, 0, file.size());
+}
+
+WarmupReport warm_page_cache(const std::string& path, const WarmupOptions& opts) {
+    auto t0 = std::chrono::steady_clock::now();
+    auto file = std::make_shared<MappedFile>(path);
+    WarmupReport report;
+    report.file_bytes = file->size();
+    report.resident_before = resident_bytes(*file);
+
+    // Pages already cached cost no extra memory, so the bound applies to
+    // what has to be read in; a lock pins cached pages too, so then it
+    // applies to the whole warmed prefix
+    uint64_t limit = opts.memory_limit;
+    if (limit == 0) limit = available_memory_bytes() / 10 * 8;
+    if (limit == 0) limit = UINT64_MAX;
+    if (opts.lock) {
+        struct rlimit rl {};
+        if (::getrlimit(RLIMIT_MEMLOCK, &rl) == 0 && rl.rlim_cur != RLIM_INFINITY && ::geteuid() != 0) {
+            limit = std::min<uint64_t>(limit, rl.rlim_cur);
+        }
+    }
+
+    uint64_t range = std::max(page_size(), opts.range_bytes / page_size() * page_size());
+    size_t ranges = static_cast<size_t>((report.file_bytes + range - 1) / range);
+    std::vector<uint64_t> missing(ranges);
+    std::vector<uint64_t> cost(ranges);
+    for (size_t i = 0; i < ranges; ++i) {
+        uint64_t off = i * range;
+        uint64_t len = std::min(range, report.file_bytes - off);
+        missing[i] = len - resident_in(*file, off, len);
+        cost[i] = opts.lock ? len : missing[i];
+    }
+
+    // Warm a prefix whose cost fits the bound
+    size_t warm = 0;
+    uint64_t budget = limit;
+    for (; warm < ranges; ++warm) {
+        if (cost[warm] > budget) {
+            report.limited_by_memory = true;
+            break;
+        }
+        budget -= cost[warm];
+    }
+    report.target_bytes = std::min(report.file_bytes, warm * range);
+
+    int fd = file->fd();
+    // The mapping was opened for sequential hashing; warming reads ranges
+    // out of order
+    if (report.target_bytes > 0) {
+        ::madvise(const_cast<uint8_t*>(file->data()), static_cast<size_t>(report.target_bytes), MADV_NORMAL);
+    }
+
+    // Issue every advisory request first so the device sees them all at
+    // once, then wait for the ranges by reading them
+    if (opts.method != WarmMethod::touch) {
+        parallel_for(warm, opts.threads, [&](size_t i) {
+            if (missing[i] == 0) return;
+            uint64_t off = i * range;
+            uint64_t len = std::min(range, report.file_bytes - off);
+            if (opts.method == WarmMethod::readahead) {
+                ::readahead(fd, static_cast<off64_t>(off), static_cast<size_t>(len));
+            } else {
+                ::posix_fadvise(fd, static_cast<off_t>(off), static_cast<off_t>(len), POSIX_FADV_WILLNEED);
+            }
+        });
+    }
+    std::atomic<uint64_t> read{0};
+    parallel_for(warm, opts.threads, [&](size_t i) {
+        if (missing[i] == 0) return;
+        uint64_t off = i * range;
+        uint64_t len = std::min(range, report.file_bytes - off);
+        if (resident_in(*file, off, len) < len) read_range(fd, off, len);
+        read += missing[i];
+    });
+    report.bytes_read = read.load();
+
+    if (opts.lock && report.target_bytes > 0) {
+        if (::mlock(file->data(), static_cast<size_t>(report.target_bytes)) == 0) {
+            report.locked_bytes = report.target_bytes;
+            report.pinned = file;
+        } else {
+            report.lock_error = std::string("mlock failed: ") + std::strerror(errno);
+        }
+    }
+
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    report.resident_after = resident_bytes(*file);
+    return report;
+}
+
+} // namespace slp::pipeline
@@ -0,0 +1,350 @@
+#include "slp/seaweed/codec.h"
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+
+#ifdef SLP_HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef SLP_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace slp::seaweed {
+
+namespace {
+
+constexpr size_t kStreamChunk = 64 * 1024;
+
+#ifdef SLP_HAVE_ZLIB
+
+// zlib takes 32-bit lengths; larger inputs are fed in slices
+constexpr size_t kZlibMaxIn = std::numeric_limits<uInt>::max();
+
+class GzipCompressor : public Compressor {
+public:
+    explicit GzipCompressor(int level) {
+        // windowBits 15 + 16 selects the gzip wrapper
+        if (deflateInit2(&zs_, level == 0 ? Z_DEFAULT_COMPRESSION : level,
+                         Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            throw std::runtime_error("deflateInit2 failed");
+        }
+    }
+    ~GzipCompressor() override { deflateEnd(&zs_); }
+
+    void update(const uint8_t* data, size_t len, std::vector<uint8_t>& out) override {
+        while (len > 0) {
+            size_t slice = std::min(len, kZlibMaxIn);
+            zs_.next_in = const_cast<Bytef*>(data);
+            zs_.avail_in = static_cast<uInt>(slice);
+            pump(Z_NO_FLUSH, out);
+            data += slice;
+            len -= slice;
+        }
+    }
+
+    void finish(std::vector<uint8_t>& out) override {
+        zs_.next_in = nullptr;
+        zs_.avail_in = 0;
+        pump(Z_FINISH, out);
+    }
+
+private:
+    void pump(int flush, std::vector<uint8_t>& out) {
+        int ret;
+        do {
+            size_t old_size = out.size();
+            out.resize(old_size + kStreamChunk);
+            zs_.next_out = out.data() + old_size;
+            zs_.avail_out = static_cast<uInt>(kStreamChunk);
+            ret = deflate(&zs_, flush);
+            if (ret == Z_STREAM_ERROR) {
+                throw std::runtime_error("gzip compression failed");
+            }
+            out.resize(old_size + kStreamChunk - zs_.avail_out);
+        } while (zs_.avail_out == 0 || (flush == Z_FINISH && ret != Z_STREAM_END));
+    }
+
+    z_stream zs_{};
+};
+
+class GzipDecompressor : public Decompressor {
+public:
+    GzipDecompressor() {
+        // windowBits 15 + 32 auto-detects gzip or zlib headers
+        if (inflateInit2(&zs_, 15 + 32) != Z_OK) {
+            throw std::runtime_error("inflateInit2 failed");
+        }
+    }
+    ~GzipDecompressor() override { inflateEnd(&zs_); }
+
+    void update(const uint8_t* data, size_t len, std::vector<uint8_t>& out) override {
+        while (len > 0 && !done_) {
+            size_t slice = std::min(len, kZlibMaxIn);
+            zs_.next_in = const_cast<Bytef*>(data);
+            zs_.avail_in = static_cast<uInt>(slice);
+            do {
+                size_t old_size = out.size();
+                out.resize(old_size + kStreamChunk);
+                zs_.next_out = out.data() + old_size;
+                zs_.avail_out = static_cast<uInt>(kStreamChunk);
+                int ret = inflate(&zs_, Z_NO_FLUSH);
+                out.resize(old_size + kStreamChunk - zs_.avail_out);
+                if (ret == Z_STREAM_END) {
+                    done_ = true;
+                    break;
+                }
+                if (ret != Z_OK && ret != Z_BUF_ERROR) {
+                    throw std::runtime_error("gzip decompression failed");
+                }
+            } while (zs_.avail_out == 0 || zs_.avail_in > 0);
+            data += slice;
+            len -= slice;
+        }
+    }
+
+    void finish(std::vector<uint8_t>&) override {
+        if (!done_) {
+            throw std::runtime_error("gzip stream truncated");
+        }
+    }
+
+private:
+    z_stream zs_{};
+    bool done_ = false;
+};
+
+#endif // SLP_HAVE_ZLIB
+
+#ifdef SLP_HAVE_ZSTD
+
+void check_zstd(size_t ret, const char* what) {
+    if (ZSTD_isError(ret)) {
+        throw std::runtime_error(std::string(what) + ": " + ZSTD_getErrorName(ret));
+    }
+}
+
+class ZstdCompressor : public Compressor {
+public:
+    ZstdCompressor(int level, const std::vector<uint8_t>& dict) : cctx_(ZSTD_createCCtx()) {
+        if (!cctx_) throw std::runtime_error("ZSTD_createCCtx failed");
+        check_zstd(ZSTD_CCtx_setParameter(cctx_, ZSTD_c_compressionLevel,
+                                          level == 0 ? ZSTD_CLEVEL_DEFAULT : level),
+                   "zstd level");
+        check_zstd(ZSTD_CCtx_setParameter(cctx_, ZSTD_c_checksumFlag, 1), "zstd checksum");
+        if (!dict.empty()) {
+            check_zstd(ZSTD_CCtx_loadDictionary(cctx_, dict.data(), dict.size()), "zstd dictionary");
+        }
+    }
+    ~ZstdCompressor() override { ZSTD_freeCCtx(cctx_); }
+
+    void update(const uint8_t* data, size_t len, std::vector<uint8_t>& out) override {
+        ZSTD_inBuffer in{data, len, 0};
+        while (in.pos < in.size) {
+            pump(in, ZSTD_e_continue, out);
+        }
+    }
+
+    void finish(std::vector<uint8_t>& out) override {
+        ZSTD_inBuffer in{nullptr, 0, 0};
+        while (pump(in, ZSTD_e_end, out) != 0) {
+        }
+    }
+
+private:
+    size_t pump(ZSTD_inBuffer& in, ZSTD_EndDirective mode, std::vector<uint8_t>& out) {
+        size_t old_size = out.size();
+        out.resize(old_size + ZSTD_CStreamOutSize());
+        ZSTD_outBuffer ob{out.data() + old_size, ZSTD_CStreamOutSize(), 0};
+        size_t remaining = ZSTD_compressStream2(cctx_, &ob, &in, mode);
+        check_zstd(remaining, "zstd compression");
+        out.resize(old_size + ob.pos);
+        return remaining;
+    }
+
+    ZSTD_CCtx* cctx_;
+};
+
+class ZstdDecompressor : public Decompressor {
+public:
+    explicit ZstdDecompressor(const std::vector<uint8_t>& dict) : dctx_(ZSTD_createDCtx()) {
+        if (!dctx_) throw std::runtime_error("ZSTD_createDCtx failed");
+        if (!dict.empty()) {
+            check_zstd(ZSTD_DCtx_loadDictionary(dctx_, dict.data(), dict.size()), "zstd dictionary");
+        }
+    }
+    ~ZstdDecompressor() override { ZSTD_freeDCtx(dctx_); }
+
+    void update(const uint8_t* data, size_t len, std::vector<uint8_t>& out) override {
+        ZSTD_inBuffer in{data, len, 0};
+        // A full output buffer may leave decoded bytes inside the decoder
+        // even after all input is consumed, so keep going until it is not
+        do {
+            full_ = pump(in, out);
+        } while (in.pos < in.size || full_);
+    }
+
+    void finish(std::vector<uint8_t>& out) override {
+        ZSTD_inBuffer in{nullptr, 0, 0};
+        while (full_) {
+            full_ = pump(in, out);
+        }
+        // A non-zero hint means the decoder still expects frame bytes
+        if (last_ != 0) {
+            throw std::runtime_error("zstd stream truncated");
+        }
+    }
+
+private:
+    // One decompressStream call; true if it filled the output buffer short
+    // of the frame's end, so decoded bytes may still be waiting
+    bool pump(ZSTD_inBuffer& in, std::vector<uint8_t>& out) {
+        size_t old_size = out.size();
+        out.resize(old_size + ZSTD_DStreamOutSize());
+        ZSTD_outBuffer ob{out.data() + old_size, ZSTD_DStreamOutSize(), 0};
+        last_ = ZSTD_decompressStream(dctx_, &ob, &in);
+        check_zstd(last_, "zstd decompression");
+        out.resize(old_size + ob.pos);
+        return ob.pos == ob.size && last_ != 0;
+    }
+
+    ZSTD_DCtx* dctx_;
+    size_t last_ = 1;
+    bool full_ = false;
+};
+
+#endif // SLP_HAVE_ZSTD
+
+class PassthroughCodec : public Compressor, public Decompressor {
+public:
+    void update(const uint8_t* data, size_t len, std::vector<uint8_t>& out) override {
+        out.insert(out.end(), data, data + len);
+    }
+    void finish(std::vector<uint8_t>&) override {}
+};
+
+[[noreturn]] void throw_unavailable(Codec codec) {
+    throw std::runtime_error("codec not compiled into this build: " + codec_name(codec));
+}
+
+template <typename Stream>
+std::vector<uint8_t> run_stream(Stream& stream, const std::vector<uint8_t>& data) {
+    std::vector<uint8_t> out;
+    for (size_t pos = 0; pos < data.size(); pos += kStreamChunk) {
+        stream.update(data.data() + pos, std::min(kStreamChunk, data.size() - pos), out);
+    }
+    stream.finish(out);
+    return out;
+}
+
+} // anonymous namespace
+
+std::string codec_name(Codec codec) {
+    switch (codec) {
+        case Codec::none: return "none";
+        case Codec::gzip: return "gzip";
+        case Codec::zstd: return "zstd";
+    }
+    return "none";
+}
+
+Codec parse_codec(const std::string& name) {
+    if (name.empty() || name == "none" || name == "identity") return Codec::none;
+    if (name == "gzip") return Codec::gzip;
+    if (name == "zstd") return Codec::zstd;
+    throw std::invalid_argument("unknown codec: " + name);
+}
+
+CodecOptions parse_codec_spec(const std::string& spec) {
+    CodecOptions opts;
+    size_t first = spec.find(':');
+    opts.codec = parse_codec(spec.substr(0, first));
+    if (first == std::string::npos) return opts;
+
+    size_t second = spec.find(':', first + 1);
+    std::string level = spec.substr(first + 1, second == std::string::npos ? std::string::npos : second - first - 1);
+    if (!level.empty()) opts.level = std::stoi(level);
+
+    if (second != std::string::npos) {
+        std::string dict_path = spec.substr(second + 1);
+        std::ifstream f(dict_path, std::ios::binary);
+        if (!f) throw std::runtime_error("cannot open dictionary: " + dict_path);
+        opts.dictionary.assign(std::istreambuf_iterator<char>(f), {});
+    }
+    return opts;
+}
+
+bool codec_available(Codec codec) {
+    switch (codec) {
+        case Codec::none: return true;
+#ifdef SLP_HAVE_ZLIB
+        case Codec::gzip: return true;
+#endif
+#ifdef SLP_HAVE_ZSTD
+        case Codec::zstd: return true;
+#endif
+        default: return false;
+    }
+}
+
+Codec default_text_codec() {
+    if (codec_available(Codec::zstd)) return Codec::zstd;
+    if (codec_available(Codec::gzip)) return Codec::gzip;
+    return Codec::none;
+}
+
+std::unique_ptr<Compressor> make_compressor(const CodecOptions& opts) {
+    switch (opts.codec) {
+        case Codec::none:
+            return std::make_unique<PassthroughCodec>();
+        case Codec::gzip:
+#ifdef SLP_HAVE_ZLIB
+            return std::make_unique<GzipCompressor>(opts.level);
+#else
+            throw_unavailable(opts.codec);
+#endif
+        case Codec::zstd:
+#ifdef SLP_HAVE_ZSTD
+            return std::make_unique<ZstdCompressor>(opts.level, opts.dictionary);
+#else
+            throw_unavailable(opts.codec);
+#endif
+    }
+    throw_unavailable(opts.codec);
+}
+
+std::unique_ptr<Decompressor> make_decompressor(const CodecOptions& opts) {
+    switch (opts.codec) {
+        case Codec::none:
+            return std::make_unique<PassthroughCodec>();
+        case Codec::gzip:
+#ifdef SLP_HAVE_ZLIB
+            return std::make_unique<GzipDecompressor>();
+#else
+            throw_unavailable(opts.codec);
+#endif
+        case Codec::zstd:
+#ifdef SLP_HAVE_ZSTD
+            return std::make_unique<ZstdDecompressor>(opts.dictionary);
+#else
+            throw_unavailable(opts.codec);
+#endif
+    }
+    throw_unavailable(opts.codec);
+}
+
+std::vector<uint8_t> compress(const std::vector<uint8_t>& data, const CodecOptions& opts) {
+    if (opts.codec == Codec::none) return data;
+    auto c = make_compressor(opts);
+    return run_stream(*c, data);
+}
+
+std::vector<uint8_t> decompress(const std::vector<uint8_t>& data, const CodecOptions& opts) {
+    if (opts.codec == Codec::none) return data;
+    auto d = make_decompressor(opts);
+    return run_stream(*d, data);
+}
+
+} // namespace slp::seaweed
@@ -1,16 +1,63 @@
 #include "slp/seaweed/filer.h"
 #include "slp/http_client.h"
+#include "slp/json.h"
+#include "slp/seaweed/retry.h"
+#include <algorithm>
+#include <cctype>
 #include <stdexcept>
 
 namespace slp::seaweed {
 
+namespace {
+
+// Go's os.ModeDir, which the filer reports in an entry's Mode
+constexpr uint64_t kModeDir = 1ULL << 31;
+
+std::string url_encode(const std::string& s) {
+    static const char hex[] = "0123456789ABCDEF";
+    std::string out;
+    for (char c : s) {
+        auto u = static_cast<unsigned char>(c);
+        if (std::isalnum(u) || c == '-' || c == '_' || c == '.' || c == '~') {
+            out += c;
+        } else {
+            out += '%';
+            out += hex[u >> 4];
+            out += hex[u & 0xf];
+        }
+    }
+    return out;
+}
+
+} // anonymous namespace
+
 bool put_file(const std::string& filer_base,
               const std::string& path,
               const std::vector<uint8_t>& data) {
+    return put_file(filer_base, path, data, CodecOptions{});
+}
+
+bool put_file(const std::string& filer_base,
+              const std::string& path,
+              const std::vector<uint8_t>& data,
+              const CodecOptions& codec) {
     try {
-        HttpClient client;
         std::string url = filer_base + path;
-        auto response = client.put(url, data, "application/octet-stream");
+
+        // Uncompressed objects carry no codec metadata
+        const std::vector<uint8_t>* body = &data;
+        std::vector<uint8_t> encoded;
+        std::vector<std::string> headers;
+        if (codec.codec != Codec::none) {
+            encoded = compress(data, codec);
+            body = &encoded;
+            headers.push_back(std::string(kCodecHeader) + ": " + codec_name(codec.codec));
+            headers.push_back(std::string(kRawSizeHeader) + ": " + std::to_string(data.size()));
+        }
+
+        auto response = send_with_retries([&](HttpClient& client) {
+            return client.put(url, *body, "application/octet-stream", headers);
+        }, false);
 
         // SeaweedFS returns 201 (Created) or 200 (OK) on success
         return response.status == 201 || response.status == 200;
@@ -21,15 +68,118 @@ bool put_file(const std::string& filer_base,
 
 std::vector<uint8_t> get_file(const std::string& filer_base,
                               const std::string& path) {
-    HttpClient client;
+    return get_file(filer_base, path, {});
+}
+
+std::vector<uint8_t> get_file(const std::string& filer_base,
+                              const std::string& path,
+                              const std::vector<uint8_t>& dictionary) {
     std::string url = filer_base + path;
-    auto response = client.get(url);
+    auto response = send_with_retries([url](HttpClient& client) { return client.get(url); }, true);
 
     if (response.status != 200) {
         throw std::runtime_error("Failed to get file: HTTP " + std::to_string(response.status));
     }
 
-    return response.body;
+    CodecOptions codec;
+    codec.codec = parse_codec(response.header(kCodecHeader));
+    if (codec.codec == Codec::none) {
+        return std::move(response.body);
+    }
+    codec.dictionary = dictionary;
+    return decompress(response.body, codec);
+}
+
+std::vector<uint8_t> get_file_range(const std::string& filer_base,
+                                    const std::string& path,
+                                    uint64_t offset,
+                                    uint64_t length) {
+    std::string url = filer_base + path;
+    auto response = send_with_retries(
+        [url, offset, length](HttpClient& client) { return client.get_range(url, offset, length); }, true);
+
+    // 416: the range starts at or past the end of the object
+    if (response.status == 416) return {};
+    if (response.status != 206 && response.status != 200) {
+        throw std::runtime_error("Failed to get file range: HTTP " + std::to_string(response.status));
+    }
+    if (parse_codec(response.header(kCodecHeader)) != Codec::none) {
+        throw std::runtime_error("range reads need an uncompressed object: " + path);
+    }
+
+    if (response.status == 206) {
+        return std::move(response.body);
+    }
+
+    // Server ignored the Range header and sent the whole object
+    auto& body = response.body;
+    if (offset >= body.size()) return {};
+    uint64_t end = std::min<uint64_t>(body.size(), offset + length);
+    return std::vector<uint8_t>(body.begin() + static_cast<std::ptrdiff_t>(offset),
+                                body.begin() + static_cast<std::ptrdiff_t>(end));
+}
+
+bool file_exists(const std::string& filer_base,
+                 const std::string& path) {
+    std::string url = filer_base + path;
+    auto response = send_with_retries([url](HttpClient& client) { return client.head(url); }, false);
+
+    if (response.status == 200) return true;
+    if (response.status == 404) return false;
+    throw std::runtime_error("Failed to stat file: HTTP " + std::to_string(response.status));
+}
+
+uint64_t file_size(const std::string& filer_base,
+                   const std::string& path) {
+    std::string url = filer_base + path;
+    auto response = send_with_retries([url](HttpClient& client) { return client.head(url); }, false);
+
+    if (response.status != 200) {
+        throw std::runtime_error("Failed to stat file " + path + ": HTTP " + std::to_string(response.status));
+    }
+    std::string length = response.header("Content-Length");
+    if (length.empty()) throw std::runtime_error("no Content-Length for " + path);
+    return std::stoull(length);
+}
+
+std::vector<FilerEntry> list_directory(const std::string& filer_base,
+                                       const std::string& dir,
+                                       size_t page_size) {
+    std::string base = filer_base + dir;
+    if (base.empty() || base.back() != '/') base += '/';
+
+    std::vector<FilerEntry> entries;
+    std::string last_name;
+    for (;;) {
+        std::string url = base + "?limit=" + std::to_string(page_size) + "&lastFileName=" + url_encode(last_name);
+        // Without the Accept header the filer answers with its HTML browser
+        auto response = send_with_retries([url](HttpClient& client) {
+            return client.get(url, 30000, {"Accept: application/json"});
+        }, true);
+
+        if (response.status == 404) return entries;
+        if (response.status != 200) {
+            throw std::runtime_error("Failed to list " + dir + ": HTTP " + std::to_string(response.status));
+        }
+
+        json::Value doc = json::parse(std::string(response.body.begin(), response.body.end()));
+        const json::Value* list = doc.find("Entries");
+        size_t before = entries.size();
+        if (list && list->is_array()) {
+            for (const auto& e : list->as_array()) {
+                FilerEntry entry;
+                entry.path = e.get_string("FullPath");
+                entry.is_dir = (static_cast<uint64_t>(e.get_int("Mode")) & kModeDir) != 0;
+                entry.size = entry.is_dir ? 0 : static_cast<uint64_t>(e.get_int("FileSize"));
+                entries.push_back(std::move(entry));
+            }
+        }
+
+        // An empty page ends the listing even if the filer claims more
+        if (!doc.get_bool("ShouldDisplayLoadMore") || entries.size() == before) return entries;
+        last_name = doc.get_string("LastFileName");
+        if (last_name.empty()) last_name = entries.back().path.substr(entries.back().path.rfind('/') + 1);
+    }
 }
 
 } // namespace slp::seaweed
@@ -0,0 +1,157 @@
+#include "slp/seaweed/filer_async.h"
+#include "slp/seaweed/filer.h"
+#include "slp/seaweed/retry.h"
+
+#include <algorithm>
+#include <exception>
+#include <optional>
+#include <stdexcept>
+
+namespace slp::seaweed {
+
+namespace {
+
+// Async counterpart of send_with_retries (without hedging). The request is
+// copied for each attempt but the last.
+Task<HttpResponse> send_with_retries_async(AsyncHttpClient& http, HttpRequest request) {
+    RetryPolicy retry = retry_policy();
+    RequestStats counts;
+    counts.requests = 1;
+
+    for (int attempt = 1;; ++attempt) {
+        bool last = attempt >= retry.max_attempts;
+        std::optional<HttpResponse> response;
+        std::exception_ptr error;
+        counts.attempts++;
+        HttpRequest attempt_request = last ? std::move(request) : request;
+        try {
+            response = co_await http.send(std::move(attempt_request));
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        long status = response ? response->status : 0;
+        if (response && !is_retryable_status(status)) {
+            add_request_stats(counts);
+            co_return std::move(*response);
+        }
+
+        if (last) {
+            counts.failures++;
+            add_request_stats(counts);
+            if (response) co_return std::move(*response);
+            std::rethrow_exception(error);
+        }
+
+        counts.retries++;
+        co_await http.loop().sleep_for(backoff_delay(retry, attempt));
+    }
+}
+
+} // anonymous namespace
+
+Task<bool> put_file_async(AsyncHttpClient& http,
+                          std::string filer_base,
+                          std::string path,
+                          std::vector<uint8_t> data,
+                          CodecOptions codec) {
+    HttpRequest request;
+    request.method = "PUT";
+    request.url = filer_base + path;
+    request.headers.push_back("Content-Type: application/octet-stream");
+
+    try {
+        // Uncompressed objects carry no codec metadata
+        if (codec.codec != Codec::none) {
+            request.headers.push_back(std::string(kCodecHeader) + ": " + codec_name(codec.codec));
+            request.headers.push_back(std::string(kRawSizeHeader) + ": " + std::to_string(data.size()));
+            request.body = compress(data, codec);
+        } else {
+            request.body = std::move(data);
+        }
+    } catch (const std::exception&) {
+        co_return false;
+    }
+
+    std::optional<HttpResponse> response;
+    try {
+        response = co_await send_with_retries_async(http, std::move(request));
+    } catch (const std::exception&) {
+        co_return false;
+    }
+    // SeaweedFS returns 201 (Created) or 200 (OK) on success
+    co_return response->status == 201 || response->status == 200;
+}
+
+Task<std::vector<uint8_t>> get_file_async(AsyncHttpClient& http,
+                                          std::string filer_base,
+                                          std::string path,
+                                          std::vector<uint8_t> dictionary) {
+    HttpRequest request;
+    request.url = filer_base + path;
+    request.timeout_ms = 30000;
+    auto response = co_await send_with_retries_async(http, std::move(request));
+
+    if (response.status != 200) {
+        throw std::runtime_error("Failed to get file: HTTP " + std::to_string(response.status));
+    }
+
+    CodecOptions codec;
+    codec.codec = parse_codec(response.header(kCodecHeader));
+    if (codec.codec == Codec::none) {
+        co_return std::move(response.body);
+    }
+    codec.dictionary = std::move(dictionary);
+    co_return decompress(response.body, codec);
+}
+
+Task<std::vector<uint8_t>> get_file_range_async(AsyncHttpClient& http,
+                                                std::string filer_base,
+                                                std::string path,
+                                                uint64_t offset,
+                                                uint64_t length) {
+    if (length == 0) {
+        throw std::invalid_argument("empty range");
+    }
+    HttpRequest request;
+    request.url = filer_base + path;
+    request.range = std::to_string(offset) + "-" + std::to_string(offset + length - 1);
+    request.timeout_ms = 30000;
+    auto response = co_await send_with_retries_async(http, std::move(request));
+
+    // 416: the range starts at or past the end of the object
+    if (response.status == 416) co_return std::vector<uint8_t>{};
+    if (response.status != 206 && response.status != 200) {
+        throw std::runtime_error("Failed to get file range: HTTP " + std::to_string(response.status));
+    }
+    if (parse_codec(response.header(kCodecHeader)) != Codec::none) {
+        throw std::runtime_error("range reads need an uncompressed object: " + path);
+    }
+
+    if (response.status == 206) {
+        co_return std::move(response.body);
+    }
+
+    // Server ignored the Range header and sent the whole object
+    auto& body = response.body;
+    if (offset >= body.size()) co_return std::vector<uint8_t>{};
+    uint64_t end = std::min<uint64_t>(body.size(), offset + length);
+    co_return std::vector<uint8_t>(body.begin() + static_cast<std::ptrdiff_t>(offset),
+                                   body.begin() + static_cast<std::ptrdiff_t>(end));
+}
+
+Task<bool> file_exists_async(AsyncHttpClient& http,
+                             std::string filer_base,
+                             std::string path) {
+    HttpRequest request;
+    request.method = "HEAD";
+    request.url = filer_base + path;
+    request.timeout_ms = 30000;
+    auto response = co_await send_with_retries_async(http, std::move(request));
+
+    if (response.status == 200) co_return true;
+    if (response.status == 404) co_return false;
+    throw std::runtime_error("Failed to stat file: HTTP " + std::to_string(response.status));
+}
+
+} // namespace slp::seaweed
@@ -0,0 +1,345 @@
+#include "slp/seaweed/retry.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace slp::seaweed {
+
+namespace {
+
+std::mutex g_policy_mu;
+RetryPolicy g_retry;
+HedgePolicy g_hedge;
+
+struct Counters {
+    std::atomic<uint64_t> requests{0};
+    std::atomic<uint64_t> attempts{0};
+    std::atomic<uint64_t> retries{0};
+    std::atomic<uint64_t> hedges_sent{0};
+    std::atomic<uint64_t> hedges_won{0};
+    std::atomic<uint64_t> failures{0};
+};
+Counters g_counters;
+
+// Recent time-to-first-byte samples of successful GETs
+class FirstByteWindow {
+public:
+    void record(int64_t us) {
+        std::lock_guard<std::mutex> lock(mu_);
+        if (samples_.size() < kCapacity) {
+            samples_.push_back(us);
+        } else {
+            samples_[next_] = us;
+            next_ = (next_ + 1) % kCapacity;
+        }
+    }
+
+    std::optional<int64_t> quantile(double q, size_t min_samples) const {
+        std::vector<int64_t> copy;
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            if (samples_.size() < std::max<size_t>(min_samples, 1)) return std::nullopt;
+            copy = samples_;
+        }
+        auto idx = static_cast<size_t>(q * static_cast<double>(copy.size() - 1));
+        std::nth_element(copy.begin(), copy.begin() + static_cast<std::ptrdiff_t>(idx), copy.end());
+        return copy[idx];
+    }
+
+private:
+    static constexpr size_t kCapacity = 1024;
+    mutable std::mutex mu_;
+    std::vector<int64_t> samples_;
+    size_t next_ = 0;
+};
+FirstByteWindow g_first_byte;
+
+// State shared between the caller, which runs the original request, and
+// the hedge worker that may run a duplicate. The caller does not return
+// until the hedge has finished or been withdrawn, so `send` may capture by
+// reference.
+struct Race {
+    explicit Race(const std::function<HttpResponse(HttpClient&)>& s) : send(s) {}
+
+    const std::function<HttpResponse(HttpClient&)>& send;
+    std::mutex mu;
+    std::condition_variable cv;
+    TransferControl control[2];
+    std::optional<HttpResponse> response[2];
+    std::exception_ptr error[2];
+    bool finished[2] = {false, false};
+    int winner = -1;
+};
+
+void run_leg(Race& race, int leg) {
+    g_counters.attempts++;
+    std::optional<HttpResponse> response;
+    std::exception_ptr error;
+    try {
+        // Lost before it started: do not bother the server
+        if (race.control[leg].cancel) throw std::runtime_error("hedge cancelled");
+        HttpClient client;
+        client.set_control(&race.control[leg]);
+        response = race.send(client);
+    } catch (...) {
+        error = std::current_exception();
+    }
+
+    std::lock_guard<std::mutex> lock(race.mu);
+    race.finished[leg] = true;
+    race.response[leg] = std::move(response);
+    race.error[leg] = error;
+    // A retryable error only counts if the other leg fails too
+    if (race.winner < 0 && race.response[leg] && !is_retryable_status(race.response[leg]->status)) {
+        race.winner = leg;
+        race.control[1 - leg].cancel = true;
+    }
+    race.cv.notify_all();
+}
+
+// Joinable threads that send hedges. A hedge is queued with the time it
+// becomes due and withdrawn if the original answers first, so most never
+// leave the queue. Threads are added while every one is busy, up to
+// kMaxThreads; past that, hedges wait for a free thread.
+class HedgePool {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    ~HedgePool() {
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (auto& t : threads_) t.join();
+    }
+
+    void schedule(Race* race, Clock::time_point due) {
+        std::lock_guard<std::mutex> lock(mu_);
+        queue_.emplace(due, race);
+        if (idle_ == 0 && threads_.size() < kMaxThreads) {
+            threads_.emplace_back([this] { work(); });
+        }
+        cv_.notify_one();
+    }
+
+    // True if the hedge was still queued; otherwise a thread has taken it
+    // and will mark it finished
+    bool withdraw(Race* race) {
+        std::lock_guard<std::mutex> lock(mu_);
+        for (auto it = queue_.begin(); it != queue_.end(); ++it) {
+            if (it->second == race) {
+                queue_.erase(it);
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    static constexpr size_t kMaxThreads = 16;
+
+    void work() {
+        std::unique_lock<std::mutex> lock(mu_);
+        for (;;) {
+            ++idle_;
+            while (!stop_ && (queue_.empty() || queue_.begin()->first > Clock::now())) {
+                if (queue_.empty()) {
+                    cv_.wait(lock);
+                } else {
+                    cv_.wait_until(lock, queue_.begin()->first);
+                }
+            }
+            --idle_;
+            if (stop_) return;
+            Race* race = queue_.begin()->second;
+            queue_.erase(queue_.begin());
+            lock.unlock();
+            run_hedge(*race);
+            lock.lock();
+        }
+    }
+
+    static void run_hedge(Race& race) {
+        {
+            std::lock_guard<std::mutex> lock(race.mu);
+            // The original answered while the hedge waited for a thread
+            if (race.finished[0] || race.control[0].responded.load()) {
+                race.finished[1] = true;
+                race.cv.notify_all();
+                return;
+            }
+        }
+        g_counters.hedges_sent++;
+        run_leg(race, 1);
+    }
+
+    std::mutex mu_;
+    std::condition_variable cv_;
+    std::multimap<Clock::time_point, Race*> queue_;
+    std::vector<std::thread> threads_;
+    size_t idle_ = 0;
+    bool stop_ = false;
+};
+
+HedgePool& hedge_pool() {
+    static HedgePool pool;
+    return pool;
+}
+
+HttpResponse hedged_attempt(const std::function<HttpResponse(HttpClient&)>& send, const HedgePolicy& policy) {
+    Race race(send);
+
+    auto delay = std::chrono::duration_cast<std::chrono::microseconds>(policy.initial_delay);
+    if (auto q = g_first_byte.quantile(policy.quantile, policy.min_samples)) {
+        delay = std::max(std::chrono::microseconds(*q),
+                         std::chrono::duration_cast<std::chrono::microseconds>(policy.min_delay));
+    }
+
+    // If the original is slow to answer, a pool thread races a duplicate
+    // against it while this thread keeps running the original
+    HedgePool& pool = hedge_pool();
+    pool.schedule(&race, HedgePool::Clock::now() + delay);
+    run_leg(race, 0);
+
+    std::unique_lock<std::mutex> lock(race.mu);
+    if (!race.finished[1]) {
+        lock.unlock();
+        bool withdrawn = pool.withdraw(&race);
+        lock.lock();
+        if (withdrawn) {
+            race.finished[1] = true;
+        } else {
+            race.cv.wait(lock, [&] { return race.finished[1]; });
+        }
+    }
+
+    if (race.winner < 0) {
+        for (int leg = 0; leg < 2; ++leg) {
+            if (race.response[leg]) return *race.response[leg];
+        }
+        // Every leg failed at the transport level; a hedge that never ran
+        // has no error of its own
+        std::rethrow_exception(race.error[0] ? race.error[0] : race.error[1]);
+    }
+
+    if (race.winner == 1) g_counters.hedges_won++;
+    return *race.response[race.winner];
+}
+
+std::mt19937_64& rng() {
+    thread_local std::mt19937_64 gen{std::random_device{}()};
+    return gen;
+}
+
+} // anonymous namespace
+
+void set_retry_policy(const RetryPolicy& policy) {
+    std::lock_guard<std::mutex> lock(g_policy_mu);
+    g_retry = policy;
+}
+
+RetryPolicy retry_policy() {
+    std::lock_guard<std::mutex> lock(g_policy_mu);
+    return g_retry;
+}
+
+void set_hedge_policy(const HedgePolicy& policy) {
+    std::lock_guard<std::mutex> lock(g_policy_mu);
+    g_hedge = policy;
+}
+
+HedgePolicy hedge_policy() {
+    std::lock_guard<std::mutex> lock(g_policy_mu);
+    return g_hedge;
+}
+
+RequestStats request_stats() {
+    RequestStats s;
+    s.requests = g_counters.requests;
+    s.attempts = g_counters.attempts;
+    s.retries = g_counters.retries;
+    s.hedges_sent = g_counters.hedges_sent;
+    s.hedges_won = g_counters.hedges_won;
+    s.failures = g_counters.failures;
+    return s;
+}
+
+void reset_request_stats() {
+    g_counters.requests = 0;
+    g_counters.attempts = 0;
+    g_counters.retries = 0;
+    g_counters.hedges_sent = 0;
+    g_counters.hedges_won = 0;
+    g_counters.failures = 0;
+}
+
+void add_request_stats(const RequestStats& delta) {
+    g_counters.requests += delta.requests;
+    g_counters.attempts += delta.attempts;
+    g_counters.retries += delta.retries;
+    g_counters.hedges_sent += delta.hedges_sent;
+    g_counters.hedges_won += delta.hedges_won;
+    g_counters.failures += delta.failures;
+}
+
+bool is_retryable_status(long status) {
+    if (status == 0) return true;
+    if (status == 408 || status == 425 || status == 429) return true;
+    return status >= 500 && status != 501 && status != 505;
+}
+
+std::chrono::milliseconds backoff_delay(const RetryPolicy& policy, int attempt) {
+    int shift = std::clamp(attempt - 1, 0, 20);
+    long long cap = std::min<long long>(policy.max_delay.count(), policy.base_delay.count() * (1LL << shift));
+    std::uniform_int_distribution<long long> dist(0, std::max<long long>(cap, 0));
+    return std::chrono::milliseconds(dist(rng()));
+}
+
+HttpResponse send_with_retries(const std::function<HttpResponse(HttpClient&)>& send, bool hedge) {
+    RetryPolicy retry = retry_policy();
+    HedgePolicy hedging = hedge_policy();
+    hedge = hedge && hedging.enabled;
+    g_counters.requests++;
+
+    for (int attempt = 1;; ++attempt) {
+        std::optional<HttpResponse> response;
+        std::exception_ptr error;
+        try {
+            if (hedge) {
+                response = hedged_attempt(send, hedging);
+            } else {
+                g_counters.attempts++;
+                HttpClient client;
+                response = send(client);
+            }
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        long status = response ? response->status : 0;
+        if (response && !is_retryable_status(status)) {
+            if (hedge && status >= 200 && status < 300) g_first_byte.record(response->first_byte_us);
+            return std::move(*response);
+        }
+
+        if (attempt >= retry.max_attempts) {
+            g_counters.failures++;
+            if (response) return std::move(*response);
+            std::rethrow_exception(error);
+        }
+
+        g_counters.retries++;
+        std::this_thread::sleep_for(backoff_delay(retry, attempt));
+    }
+}
+
+} // namespace slp::seaweed
@@ -0,0 +1,197 @@
+#include "slp/seaweed/transfer.h"
+#include "slp/file_writer.h"
+#include "slp/http_client.h"
+#include "slp/seaweed/codec.h"
+#include "slp/seaweed/filer.h"
+#include "slp/seaweed/retry.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace slp::seaweed {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+constexpr const char* kCheckpointMagic = "slp-download-v1";
+
+struct Checkpoint {
+    std::string url;
+    std::string validator;
+};
+
+Checkpoint read_checkpoint(const std::string& path) {
+    Checkpoint c;
+    std::ifstream f(path);
+    std::string magic;
+    if (!std::getline(f, magic) || magic != kCheckpointMagic) return {};
+    std::getline(f, c.url);
+    std::getline(f, c.validator);
+    return c;
+}
+
+void write_checkpoint(const std::string& path, const Checkpoint& c) {
+    std::string tmp = path + ".tmp";
+    {
+        std::ofstream f(tmp, std::ios::trunc);
+        f << kCheckpointMagic << "\n" << c.url << "\n" << c.validator << "\n";
+        if (!f) throw std::runtime_error("cannot write checkpoint: " + path);
+    }
+    fs::rename(tmp, path);
+}
+
+uint64_t file_size(int fd) {
+    struct stat st {};
+    if (::fstat(fd, &st) != 0) throw std::runtime_error("fstat failed");
+    return static_cast<uint64_t>(st.st_size);
+}
+
+void backoff(int attempt) {
+    std::this_thread::sleep_for(backoff_delay(retry_policy(), attempt));
+}
+
+// Objects written with a codec are stored compressed; decode in one pass
+void decode_in_place(const std::string& part_path, Codec codec) {
+    std::ifstream in(part_path, std::ios::binary);
+    std::vector<uint8_t> stored{std::istreambuf_iterator<char>(in), {}};
+    CodecOptions opts;
+    opts.codec = codec;
+    auto raw = decompress(stored, opts);
+
+    std::ofstream out(part_path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char*>(raw.data()), static_cast<std::streamsize>(raw.size()));
+    if (!out) throw std::runtime_error("write failed: " + part_path);
+}
+
+} // anonymous namespace
+
+DownloadStats download_file(const std::string& filer_base,
+                            const std::string& path,
+                            const std::string& output_path,
+                            const DownloadOptions& options) {
+    DownloadStats stats;
+    const FileWriterOptions& writer_options = options.writer;
+    const int max_attempts = options.max_attempts;
+    HttpClient client;
+    std::string url = filer_base + path;
+    std::string part_path = output_path + ".part";
+    std::string ckpt_path = part_path + ".ckpt";
+
+    auto head = send_with_retries([url](HttpClient& c) { return c.head(url); }, false);
+    if (head.status != 200) {
+        throw std::runtime_error("Failed to stat file: HTTP " + std::to_string(head.status));
+    }
+    std::string length = head.header("Content-Length");
+    if (length.empty()) throw std::runtime_error("filer did not report the object size");
+    stats.bytes_total = std::stoull(length);
+    Codec codec = parse_codec(head.header(kCodecHeader));
+
+    Checkpoint current{url, head.header("ETag")};
+    if (current.validator.empty()) current.validator = head.header("Last-Modified");
+
+    // Partial data is only trusted for the same, unchanged object
+    Checkpoint saved = read_checkpoint(ckpt_path);
+    std::error_code ec;
+    uint64_t have = fs::file_size(part_path, ec);
+    if (ec || saved.url != current.url || saved.validator != current.validator ||
+        current.validator.empty() || have > stats.bytes_total) {
+        have = 0;
+    }
+    // Direct writers restart on a block boundary; the tail is fetched again
+    if (writer_options.direct) have -= have % kDirectAlignment;
+    write_checkpoint(ckpt_path, current);
+    stats.bytes_resumed = have;
+    if (options.progress) options.progress(have, stats.bytes_total);
+
+    while (have < stats.bytes_total) {
+        if (stats.attempts == max_attempts) {
+            throw std::runtime_error("download incomplete after " + std::to_string(max_attempts) +
+                                     " attempts (" + std::to_string(have) + "/" +
+                                     std::to_string(stats.bytes_total) + " bytes kept in " +
+                                     part_path + ")");
+        }
+        stats.attempts++;
+
+        uint64_t before = have;
+        auto writer = open_file_writer(part_path, have, writer_options);
+        stats.writer = writer->describe();
+
+        HttpResponse response;
+        std::exception_ptr write_error;
+        try {
+            response = client.get_stream(url, have, current.validator,
+                                         [&](long status, const uint8_t* data, size_t len) {
+                // Exceptions must not unwind through libcurl
+                try {
+                    // The object changed: rewrite it from zero
+                    if (status == 200 && writer->offset() == before && before != 0) {
+                        writer = open_file_writer(part_path, 0, writer_options);
+                        before = 0;
+                    }
+                    writer->write(data, len);
+                    if (options.progress) options.progress(writer->offset(), stats.bytes_total);
+                    return true;
+                } catch (...) {
+                    write_error = std::current_exception();
+                    return false;
+                }
+            });
+        } catch (const std::exception&) {
+            // Dropped or stalled connection: keep what arrived and go on
+            // from there
+            response.status = 0;
+        }
+        if (write_error) std::rethrow_exception(write_error);
+        // Flushes what arrived even when the transfer broke off
+        writer->finish();
+        have = writer->offset();
+        if (have > before) stats.bytes_fetched += have - before;
+        if (writer_options.direct && have < stats.bytes_total) have -= have % kDirectAlignment;
+
+        // A dropped connection or a transient status (5xx, 429) resumes
+        // after a backoff; error bodies never reach the writer
+        if (is_retryable_status(response.status)) {
+            backoff(stats.attempts);
+        } else if (response.status != 200 && response.status != 206) {
+            throw std::runtime_error("Failed to get file: HTTP " + std::to_string(response.status));
+        }
+    }
+
+    if (codec != Codec::none) decode_in_place(part_path, codec);
+    fs::rename(part_path, output_path);
+    fs::remove(ckpt_path);
+    return stats;
+}
+
+bool upload_file(const std::string& filer_base,
+                 const std::string& path,
+                 const std::string& local_path) {
+    int fd = ::open(local_path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    bool ok = false;
+    try {
+        std::string url = filer_base + path;
+        uint64_t size = file_size(fd);
+        auto response = send_with_retries([&](HttpClient& client) {
+            return client.put_from_file(url, fd, 0, size, "application/octet-stream");
+        }, false);
+        // SeaweedFS returns 201 (Created) or 200 (OK) on success
+        ok = response.status == 201 || response.status == 200;
+    } catch (const std::exception&) {
+        ok = false;
+    }
+    ::close(fd);
+    return ok;
+}
+
+} // namespace slp::seaweed
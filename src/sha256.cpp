@@ -1,7 +1,10 @@
 #include "slp/sha256.h"
 #include <iomanip>
 #include <sstream>
+#include <algorithm>
 #include <cstring>
+#include <fstream>
+#include <stdexcept>
 
 namespace slp {
 
@@ -100,49 +103,107 @@ void sha256_transform(uint32_t state[8], const uint8_t block[64]) {
 
 } // anonymous namespace
 
-std::vector<uint8_t> sha256_raw(const std::vector<uint8_t>& data) {
-    // Initialize hash values
-    uint32_t state[8] = {
-        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
-        0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
-    };
+Sha256::Sha256()
+    : state_{0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+             0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19},
+      buffer_{} {}
+
+void Sha256::update(const uint8_t* data, size_t len) {
+    total_len_ += len;
+
+    // Top up a partially filled block first
+    if (buffer_len_ > 0) {
+        size_t take = std::min(len, sizeof(buffer_) - buffer_len_);
+        std::memcpy(buffer_ + buffer_len_, data, take);
+        buffer_len_ += take;
+        data += take;
+        len -= take;
+        if (buffer_len_ < sizeof(buffer_)) return;
+        sha256_transform(state_, buffer_);
+        buffer_len_ = 0;
+    }
+
+    // Hash whole blocks straight from the input
+    while (len >= 64) {
+        sha256_transform(state_, data);
+        data += 64;
+        len -= 64;
+    }
+
+    std::memcpy(buffer_, data, len);
+    buffer_len_ = len;
+}
 
-    uint64_t bit_len = static_cast<uint64_t>(data.size()) * 8;
-    std::vector<uint8_t> padded = data;
+std::vector<uint8_t> Sha256::digest() {
+    uint64_t bit_len = total_len_ * 8;
 
     // Padding
-    padded.push_back(0x80);
-    while ((padded.size() % 64) != 56) {
-        padded.push_back(0x00);
+    buffer_[buffer_len_++] = 0x80;
+    if (buffer_len_ > 56) {
+        std::memset(buffer_ + buffer_len_, 0, sizeof(buffer_) - buffer_len_);
+        sha256_transform(state_, buffer_);
+        buffer_len_ = 0;
     }
+    std::memset(buffer_ + buffer_len_, 0, 56 - buffer_len_);
 
     // Append length
     for (int i = 7; i >= 0; --i) {
-        padded.push_back(static_cast<uint8_t>((bit_len >> (i * 8)) & 0xff));
-    }
-
-    // Process blocks
-    for (size_t i = 0; i < padded.size(); i += 64) {
-        sha256_transform(state, &padded[i]);
+        buffer_[56 + (7 - i)] = static_cast<uint8_t>((bit_len >> (i * 8)) & 0xff);
     }
+    sha256_transform(state_, buffer_);
+    buffer_len_ = 0;
 
     // Produce final hash
     std::vector<uint8_t> hash(32);
     for (int i = 0; i < 8; ++i) {
-        hash[i * 4] = static_cast<uint8_t>((state[i] >> 24) & 0xff);
-        hash[i * 4 + 1] = static_cast<uint8_t>((state[i] >> 16) & 0xff);
-        hash[i * 4 + 2] = static_cast<uint8_t>((state[i] >> 8) & 0xff);
-        hash[i * 4 + 3] = static_cast<uint8_t>(state[i] & 0xff);
+        hash[i * 4] = static_cast<uint8_t>((state_[i] >> 24) & 0xff);
+        hash[i * 4 + 1] = static_cast<uint8_t>((state_[i] >> 16) & 0xff);
+        hash[i * 4 + 2] = static_cast<uint8_t>((state_[i] >> 8) & 0xff);
+        hash[i * 4 + 3] = static_cast<uint8_t>(state_[i] & 0xff);
     }
 
     return hash;
 }
 
+std::string Sha256::hex_digest() {
+    return to_hex(digest());
+}
+
+std::vector<uint8_t> sha256_raw(const std::vector<uint8_t>& data) {
+    Sha256 ctx;
+    ctx.update(data);
+    return ctx.digest();
+}
+
 std::string sha256_hex(const std::vector<uint8_t>& data) {
-    auto raw = sha256_raw(data);
+    return to_hex(sha256_raw(data));
+}
+
+std::string sha256_hex(const uint8_t* data, size_t len) {
+    Sha256 ctx;
+    ctx.update(data, len);
+    return ctx.hex_digest();
+}
+
+std::string sha256_file_hex(const std::string& path) {
+    std::ifstream f(path, std::ios::binary);
+    if (!f) throw std::runtime_error("cannot open file: " + path);
+
+    Sha256 ctx;
+    std::vector<char> buf(1 << 20);
+    while (f) {
+        f.read(buf.data(), static_cast<std::streamsize>(buf.size()));
+        auto n = f.gcount();
+        if (n > 0) ctx.update(reinterpret_cast<const uint8_t*>(buf.data()), static_cast<size_t>(n));
+    }
+    if (f.bad()) throw std::runtime_error("read failed: " + path);
+    return ctx.hex_digest();
+}
+
+std::string to_hex(const std::vector<uint8_t>& bytes) {
     std::ostringstream oss;
     oss << std::hex << std::setfill('0');
-    for (uint8_t byte : raw) {
+    for (uint8_t byte : bytes) {
         oss << std::setw(2) << static_cast<int>(byte);
     }
     return oss.str();
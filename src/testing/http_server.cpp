@@ -0,0 +1,444 @@
+#include "slp/testing/http_server.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+
+namespace slp::testing {
+
+namespace {
+
+bool iequals(const std::string& a, const std::string& b) {
+    return a.size() == b.size() &&
+           std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+               return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+           });
+}
+
+std::string trim(const std::string& s) {
+    size_t start = s.find_first_not_of(" \t\r\n");
+    if (start == std::string::npos) return "";
+    size_t end = s.find_last_not_of(" \t\r\n");
+    return s.substr(start, end - start + 1);
+}
+
+const char* reason_phrase(int status) {
+    switch (status) {
+        case 100: return "Continue";
+        case 200: return "OK";
+        case 201: return "Created";
+        case 204: return "No Content";
+        case 206: return "Partial Content";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 416: return "Range Not Satisfiable";
+        case 429: return "Too Many Requests";
+        case 500: return "Internal Server Error";
+        case 503: return "Service Unavailable";
+        default: return "Status";
+    }
+}
+
+std::string status_and_headers(int status, const ResponseWriter::Headers& headers) {
+    std::string out = "HTTP/1.1 " + std::to_string(status) + " " + reason_phrase(status) + "\r\n";
+    for (const auto& [name, value] : headers) out += name + ": " + value + "\r\n";
+    return out;
+}
+
+// Buffered reads from a connection
+class Reader {
+public:
+    explicit Reader(int fd) : fd_(fd) {}
+
+    // Request line and headers, without the blank line; false on EOF
+    bool read_head(std::string& head) {
+        for (;;) {
+            size_t end = buf_.find("\r\n\r\n");
+            if (end != std::string::npos) {
+                head = buf_.substr(0, end);
+                buf_.erase(0, end + 4);
+                return true;
+            }
+            if (buf_.size() > (1 << 20) || !fill()) return false;
+        }
+    }
+
+    bool read_exact(size_t n, std::string& out) {
+        while (buf_.size() < n) {
+            if (!fill()) return false;
+        }
+        out.append(buf_, 0, n);
+        buf_.erase(0, n);
+        return true;
+    }
+
+    bool read_line(std::string& line) {
+        for (;;) {
+            size_t end = buf_.find("\r\n");
+            if (end != std::string::npos) {
+                line = buf_.substr(0, end);
+                buf_.erase(0, end + 2);
+                return true;
+            }
+            if (!fill()) return false;
+        }
+    }
+
+private:
+    bool fill() {
+        char tmp[65536];
+        ssize_t n = ::recv(fd_, tmp, sizeof(tmp), 0);
+        if (n <= 0) return false;
+        buf_.append(tmp, static_cast<size_t>(n));
+        return true;
+    }
+
+    int fd_;
+    std::string buf_;
+};
+
+// Content-Length or chunk size digits; nullopt unless the whole of `text`
+// (chunk extensions aside) is a number
+std::optional<size_t> parse_length(const std::string& text, int base) {
+    std::string digits = trim(text.substr(0, text.find(';')));
+    size_t value = 0;
+    auto r = std::from_chars(digits.data(), digits.data() + digits.size(), value, base);
+    if (digits.empty() || r.ec != std::errc() || r.ptr != digits.data() + digits.size()) return std::nullopt;
+    return value;
+}
+
+enum class BodyRead { ok, closed, malformed };
+
+BodyRead read_chunked_body(Reader& reader, std::string& body) {
+    for (;;) {
+        std::string line;
+        if (!reader.read_line(line)) return BodyRead::closed;
+        auto size = parse_length(line, 16);
+        if (!size) return BodyRead::malformed;
+        if (*size == 0) {
+            // Trailers end with an empty line
+            while (reader.read_line(line) && !line.empty()) {}
+            return BodyRead::ok;
+        }
+        if (!reader.read_exact(*size, body) || !reader.read_line(line)) return BodyRead::closed;
+    }
+}
+
+} // anonymous namespace
+
+// ---- Latency ----
+
+Latency Latency::parse(const std::string& spec) {
+    Latency l;
+    std::vector<std::string> parts;
+    std::stringstream ss(spec);
+    for (std::string p; std::getline(ss, p, ':');) parts.push_back(p);
+    if (parts.empty() || parts[0] == "none") return l;
+
+    auto arg = [&](size_t i) {
+        if (i >= parts.size()) throw std::invalid_argument("latency spec needs more arguments: " + spec);
+        return std::stod(parts[i]);
+    };
+    if (parts[0] == "fixed") {
+        l.kind = Kind::fixed;
+        l.a_ms = arg(1);
+    } else if (parts[0] == "uniform") {
+        l.kind = Kind::uniform;
+        l.a_ms = arg(1);
+        l.b_ms = arg(2);
+    } else if (parts[0] == "exp") {
+        l.kind = Kind::exponential;
+        l.a_ms = arg(1);
+    } else if (parts[0] == "lognormal") {
+        l.kind = Kind::lognormal;
+        l.a_ms = arg(1);
+        l.b_ms = arg(2);
+    } else {
+        throw std::invalid_argument("unknown latency spec: " + spec);
+    }
+    return l;
+}
+
+double Latency::sample_ms(std::mt19937_64& rng) const {
+    switch (kind) {
+        case Kind::none: return 0.0;
+        case Kind::fixed: return a_ms;
+        case Kind::uniform: return std::uniform_real_distribution<double>(a_ms, b_ms)(rng);
+        case Kind::exponential: return std::exponential_distribution<double>(1.0 / std::max(a_ms, 1e-9))(rng);
+        case Kind::lognormal: return std::lognormal_distribution<double>(std::log(std::max(a_ms, 1e-9)), b_ms)(rng);
+    }
+    return 0.0;
+}
+
+std::string Latency::describe() const {
+    std::ostringstream oss;
+    switch (kind) {
+        case Kind::none: return "none";
+        case Kind::fixed: oss << "fixed " << a_ms << " ms"; break;
+        case Kind::uniform: oss << "uniform " << a_ms << "-" << b_ms << " ms"; break;
+        case Kind::exponential: oss << "exponential, mean " << a_ms << " ms"; break;
+        case Kind::lognormal: oss << "lognormal, median " << a_ms << " ms, sigma " << b_ms; break;
+    }
+    return oss.str();
+}
+
+// ---- ServerRequest ----
+
+std::string ServerRequest::header(const std::string& name) const {
+    for (const auto& [key, value] : headers) {
+        if (iequals(key, name)) return value;
+    }
+    return "";
+}
+
+std::string ServerRequest::query_param(const std::string& name) const {
+    std::stringstream ss(query);
+    for (std::string kv; std::getline(ss, kv, '&');) {
+        size_t eq = kv.find('=');
+        if (kv.substr(0, eq) == name) return eq == std::string::npos ? "" : kv.substr(eq + 1);
+    }
+    return "";
+}
+
+// ---- ResponseWriter ----
+
+bool ResponseWriter::write_all(std::string_view data, bool throttled) {
+    while (!data.empty() && !closed_) {
+        size_t slice = data.size();
+        if (throttled && bandwidth_ > 0) {
+            // ~100 slices per second keeps the rate smooth
+            slice = std::min(slice, std::max<size_t>(1024, static_cast<size_t>(bandwidth_ / 100)));
+            auto due = body_start_ + std::chrono::microseconds(
+                static_cast<int64_t>(static_cast<double>(body_sent_) / bandwidth_ * 1e6));
+            auto wait = std::chrono::duration_cast<std::chrono::microseconds>(due - std::chrono::steady_clock::now());
+            if (wait.count() > 0 && !pause(wait)) {
+                closed_ = true;
+                return false;
+            }
+        }
+        ssize_t n = ::send(fd_, data.data(), slice, MSG_NOSIGNAL);
+        if (n <= 0) {
+            closed_ = true;
+            return false;
+        }
+        data.remove_prefix(static_cast<size_t>(n));
+        if (throttled) body_sent_ += static_cast<uint64_t>(n);
+    }
+    return !closed_;
+}
+
+void ResponseWriter::send(int status, std::string_view body, const Headers& headers) {
+    send_truncated(status, body, body.size(), headers);
+}
+
+void ResponseWriter::send_truncated(int status, std::string_view body, size_t keep, const Headers& headers) {
+    std::string head = status_and_headers(status, headers);
+    head += "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n";
+    if (!write_all(head, false) || head_) return;
+
+    body_start_ = std::chrono::steady_clock::now();
+    write_all(body.substr(0, std::min(keep, body.size())), true);
+    if (keep < body.size()) {
+        ::shutdown(fd_, SHUT_RDWR);
+        closed_ = true;
+    }
+}
+
+void ResponseWriter::begin_stream(int status, const Headers& headers) {
+    std::string head = status_and_headers(status, headers);
+    head += "Transfer-Encoding: chunked\r\n\r\n";
+    streaming_ = true;
+    body_start_ = std::chrono::steady_clock::now();
+    write_all(head, false);
+}
+
+bool ResponseWriter::write_chunk(std::string_view data) {
+    if (data.empty()) return !closed_;
+    std::ostringstream size;
+    size << std::hex << data.size() << "\r\n";
+    return write_all(size.str(), false) && write_all(data, true) && write_all("\r\n", false);
+}
+
+void ResponseWriter::end_stream() {
+    if (streaming_) write_all("0\r\n\r\n", false);
+    streaming_ = false;
+}
+
+bool ResponseWriter::pause(std::chrono::microseconds delay) {
+    return server_.wait_stopping(delay);
+}
+
+// ---- HttpServer ----
+
+HttpServer::HttpServer(Handler handler, uint16_t port) : handler_(std::move(handler)) {
+    listen_fd_ = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) throw std::runtime_error(std::string("socket failed: ") + std::strerror(errno));
+    int one = 1;
+    ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::listen(listen_fd_, 4096) != 0) {
+        std::string err = std::strerror(errno);
+        ::close(listen_fd_);
+        throw std::runtime_error("cannot listen on 127.0.0.1:" + std::to_string(port) + ": " + err);
+    }
+    socklen_t len = sizeof(addr);
+    ::getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&addr), &len);
+    port_ = ntohs(addr.sin_port);
+
+    accept_thread_ = std::thread([this] { accept_loop(); });
+}
+
+HttpServer::~HttpServer() {
+    stop();
+}
+
+void HttpServer::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        if (stopping_) return;
+        stopping_ = true;
+        for (int fd : connections_) ::shutdown(fd, SHUT_RDWR);
+    }
+    cv_.notify_all();
+    ::shutdown(listen_fd_, SHUT_RDWR);
+    if (accept_thread_.joinable()) accept_thread_.join();
+    ::close(listen_fd_);
+
+    std::unique_lock<std::mutex> lock(mu_);
+    cv_.wait(lock, [this] { return active_ == 0; });
+}
+
+bool HttpServer::wait_stopping(std::chrono::microseconds delay) {
+    std::unique_lock<std::mutex> lock(mu_);
+    return !cv_.wait_for(lock, delay, [this] { return stopping_; });
+}
+
+void HttpServer::accept_loop() {
+    for (;;) {
+        int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            return;
+        }
+        // Small responses go out at once instead of waiting on delayed ACKs
+        int one = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        std::lock_guard<std::mutex> lock(mu_);
+        if (stopping_) {
+            ::close(fd);
+            return;
+        }
+        connections_.push_back(fd);
+        active_++;
+        std::thread([this, fd] { serve_connection(fd); }).detach();
+    }
+}
+
+void HttpServer::serve_connection(int fd) {
+    Reader reader(fd);
+    std::string head;
+    while (reader.read_head(head)) {
+        ServerRequest req;
+        std::istringstream lines(head);
+        std::string line;
+        std::getline(lines, line);
+        std::istringstream request_line(line);
+        std::string target;
+        request_line >> req.method >> target;
+        size_t q = target.find('?');
+        req.path = target.substr(0, q);
+        if (q != std::string::npos) req.query = target.substr(q + 1);
+        while (std::getline(lines, line)) {
+            size_t colon = line.find(':');
+            if (colon == std::string::npos) continue;
+            req.headers.emplace_back(trim(line.substr(0, colon)), trim(line.substr(colon + 1)));
+        }
+
+        // curl waits for this before sending large uploads
+        if (iequals(req.header("Expect"), "100-continue")) {
+            const char cont[] = "HTTP/1.1 100 Continue\r\n\r\n";
+            if (::send(fd, cont, sizeof(cont) - 1, MSG_NOSIGNAL) <= 0) break;
+        }
+        BodyRead body = BodyRead::ok;
+        if (iequals(req.header("Transfer-Encoding"), "chunked")) {
+            body = read_chunked_body(reader, req.body);
+        } else if (std::string length = req.header("Content-Length"); !length.empty()) {
+            auto n = parse_length(length, 10);
+            body = !n ? BodyRead::malformed : reader.read_exact(*n, req.body) ? BodyRead::ok : BodyRead::closed;
+        }
+        if (body == BodyRead::malformed) {
+            // The rest of the stream cannot be framed, so the connection ends
+            ResponseWriter(*this, fd, false).send(400, "bad body length", {{"Connection", "close"}});
+            break;
+        }
+        if (body == BodyRead::closed) break;
+
+        ResponseWriter writer(*this, fd, req.method == "HEAD");
+        requests_++;
+        try {
+            handler_(req, writer);
+        } catch (const std::exception& e) {
+            if (!writer.closed()) writer.send(500, e.what());
+        }
+        if (writer.closed() || iequals(req.header("Connection"), "close")) break;
+    }
+
+    // Closed under the lock so stop() never shuts down a reused descriptor
+    std::lock_guard<std::mutex> lock(mu_);
+    connections_.erase(std::find(connections_.begin(), connections_.end(), fd));
+    ::close(fd);
+    active_--;
+    cv_.notify_all();
+}
+
+// ---- FaultInjector ----
+
+double FaultInjector::uniform() {
+    std::lock_guard<std::mutex> lock(mu_);
+    return std::uniform_real_distribution<double>(0.0, 1.0)(rng_);
+}
+
+double FaultInjector::sample_ms(const Latency& latency) {
+    std::lock_guard<std::mutex> lock(mu_);
+    return latency.sample_ms(rng_);
+}
+
+bool FaultInjector::before_response(ResponseWriter& w) {
+    double ms = sample_ms(opts_.latency);
+    if (ms > 0 && !w.pause(std::chrono::microseconds(static_cast<int64_t>(ms * 1000)))) {
+        w.send(503, "stopping");
+        return true;
+    }
+    if (opts_.error_rate > 0 && uniform() < opts_.error_rate) {
+        w.send(opts_.error_status, "injected error");
+        return true;
+    }
+    w.set_bandwidth(opts_.bandwidth_bytes_per_sec);
+    return false;
+}
+
+size_t FaultInjector::body_cutoff(size_t size) {
+    if (opts_.drop_rate > 0 && size > 1 && uniform() < opts_.drop_rate) return size / 2;
+    return size;
+}
+
+} // namespace slp::testing
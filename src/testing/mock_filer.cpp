@@ -0,0 +1,193 @@
+#include "slp/testing/mock_filer.h"
+#include "slp/json.h"
+
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+
+namespace slp::testing {
+
+namespace {
+
+bool has_prefix_ci(const std::string& s, const std::string& prefix) {
+    if (s.size() < prefix.size()) return false;
+    for (size_t i = 0; i < prefix.size(); ++i) {
+        if (std::tolower(static_cast<unsigned char>(s[i])) != std::tolower(static_cast<unsigned char>(prefix[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// "bytes=a-b", "bytes=a-" or "bytes=-n" against an object of `size` bytes;
+// false if unsatisfiable
+bool parse_range(const std::string& header, size_t size, size_t& first, size_t& last) {
+    if (header.rfind("bytes=", 0) != 0) return false;
+    std::string spec = header.substr(6);
+    size_t dash = spec.find('-');
+    if (dash == std::string::npos) return false;
+    std::string a = spec.substr(0, dash);
+    std::string b = spec.substr(dash + 1);
+    if (a.empty()) {
+        size_t n = std::stoul(b);
+        if (n == 0 || size == 0) return false;
+        first = size - std::min(n, size);
+        last = size - 1;
+        return true;
+    }
+    first = std::stoul(a);
+    if (first >= size) return false;
+    last = b.empty() ? size - 1 : std::min<size_t>(std::stoul(b), size - 1);
+    return last >= first;
+}
+
+} // anonymous namespace
+
+MockFiler::MockFiler(FaultOptions faults, uint16_t port)
+    : faults_(faults),
+      server_([this](const ServerRequest& req, ResponseWriter& w) { handle(req, w); }, port) {}
+
+size_t MockFiler::object_count() const {
+    std::lock_guard<std::mutex> lock(mu_);
+    return objects_.size();
+}
+
+void MockFiler::handle(const ServerRequest& req, ResponseWriter& w) {
+    if (faults_.before_response(w)) return;
+
+    if (req.method == "PUT" || req.method == "POST") {
+        auto obj = std::make_shared<Object>();
+        obj->body = req.body;
+        for (const auto& [name, value] : req.headers) {
+            if (has_prefix_ci(name, "Seaweed-")) obj->meta.emplace_back(name, value);
+        }
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            // Conditional writes, for clients that merge before they publish
+            auto it = objects_.find(req.path);
+            std::string if_match = req.header("If-Match");
+            std::string if_none_match = req.header("If-None-Match");
+            if ((!if_match.empty() && (it == objects_.end() || it->second->etag != if_match)) ||
+                (if_none_match == "*" && it != objects_.end())) {
+                w.send(412, "");
+                return;
+            }
+            obj->etag = '"';
+            obj->etag += std::to_string(++version_);
+            obj->etag += '"';
+            objects_[req.path] = obj;
+        }
+        std::string name = req.path.substr(req.path.rfind('/') + 1);
+        w.send(201, "{\"name\":\"" + json::escape(name) + "\",\"size\":" + std::to_string(req.body.size()) + "}",
+               {{"Content-Type", "application/json"}});
+        return;
+    }
+
+    if (req.method == "DELETE") {
+        std::lock_guard<std::mutex> lock(mu_);
+        objects_.erase(req.path);
+        w.send(204, "");
+        return;
+    }
+
+    if (req.method != "GET" && req.method != "HEAD") {
+        w.send(405, "");
+        return;
+    }
+
+    std::shared_ptr<const Object> obj;
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        auto it = objects_.find(req.path);
+        if (it != objects_.end()) obj = it->second;
+    }
+    if (obj) {
+        serve_object(req, w, *obj);
+    } else {
+        serve_listing(req, w);
+    }
+}
+
+void MockFiler::serve_object(const ServerRequest& req, ResponseWriter& w, const Object& obj) {
+    ResponseWriter::Headers headers = obj.meta;
+    headers.emplace_back("ETag", obj.etag);
+    headers.emplace_back("Accept-Ranges", "bytes");
+    headers.emplace_back("Content-Type", "application/octet-stream");
+
+    std::string_view body = obj.body;
+    int status = 200;
+    std::string range = req.header("Range");
+    std::string if_range = req.header("If-Range");
+    // A stale If-Range validator means "send the whole current object"
+    if (!range.empty() && (if_range.empty() || if_range == obj.etag)) {
+        size_t first = 0;
+        size_t last = 0;
+        if (!parse_range(range, obj.body.size(), first, last)) {
+            w.send(416, "", {{"Content-Range", "bytes */" + std::to_string(obj.body.size())}});
+            return;
+        }
+        status = 206;
+        body = body.substr(first, last - first + 1);
+        headers.emplace_back("Content-Range", "bytes " + std::to_string(first) + "-" + std::to_string(last) + "/" +
+                                                  std::to_string(obj.body.size()));
+    }
+
+    size_t keep = req.method == "GET" ? faults_.body_cutoff(body.size()) : body.size();
+    w.send_truncated(status, body, keep, headers);
+}
+
+void MockFiler::serve_listing(const ServerRequest& req, ResponseWriter& w) {
+    std::string dir = req.path;
+    if (dir.empty() || dir.back() != '/') dir += '/';
+    std::string last_name = req.query_param("lastFileName");
+    std::string limit_param = req.query_param("limit");
+    size_t limit = limit_param.empty() ? 100 : std::stoul(limit_param);
+
+    struct Child {
+        std::string name;
+        bool is_dir;
+        size_t size;
+    };
+    std::vector<Child> children;
+    bool more = false;
+    bool found = false;
+    {
+        std::lock_guard<std::mutex> lock(mu_);
+        // Keys sort by full path, so a directory's entries are contiguous and
+        // each subdirectory shows up as a run of keys sharing its name
+        for (auto it = objects_.lower_bound(dir + last_name); it != objects_.end(); ++it) {
+            const std::string& key = it->first;
+            if (key.compare(0, dir.size(), dir) != 0) break;
+            found = true;
+            std::string rest = key.substr(dir.size());
+            size_t slash = rest.find('/');
+            std::string name = rest.substr(0, slash);
+            if (name <= last_name && !last_name.empty()) continue;
+            if (!children.empty() && children.back().name == name) continue;
+            if (children.size() == limit) {
+                more = true;
+                break;
+            }
+            children.push_back({name, slash != std::string::npos, it->second->body.size()});
+        }
+    }
+    if (!found && req.path != "/") {
+        w.send(404, "");
+        return;
+    }
+
+    std::ostringstream out;
+    out << "{\"Path\":\"" << json::escape(req.path) << "\",\"Entries\":[";
+    for (size_t i = 0; i < children.size(); ++i) {
+        const auto& c = children[i];
+        // SeaweedFS reports directories with the os.ModeDir bit set
+        out << (i ? "," : "") << "{\"FullPath\":\"" << json::escape(dir + c.name) << "\",\"FileSize\":"
+            << (c.is_dir ? 0 : c.size) << ",\"Mode\":" << (c.is_dir ? 2147484141ULL : 420ULL) << "}";
+    }
+    out << "],\"Limit\":" << limit << ",\"LastFileName\":\""
+        << json::escape(children.empty() ? "" : children.back().name) << "\",\"ShouldDisplayLoadMore\":"
+        << (more ? "true" : "false") << "}";
+    w.send(200, out.str(), {{"Content-Type", "application/json"}});
+}
+
+} // namespace slp::testing
@@ -0,0 +1,140 @@
+#include "slp/testing/mock_llama.h"
+#include "slp/json.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+
+namespace slp::testing {
+
+namespace {
+
+const char* const kWords[] = {" the", " model", " weights", " are", " stored", " in", " content", "-addressed",
+                              " chunks", " and", " fetched", " on", " demand", "."};
+constexpr size_t kWordCount = sizeof(kWords) / sizeof(kWords[0]);
+
+std::string timings_json(int prompt_n, double prompt_ms, int predicted_n, double predicted_ms) {
+    auto per_second = [](int n, double ms) { return ms > 0 ? 1000.0 * n / ms : 0.0; };
+    auto per_token = [](int n, double ms) { return n > 0 ? ms / n : 0.0; };
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3) << "{\"prompt_n\":" << prompt_n << ",\"prompt_ms\":" << prompt_ms
+        << ",\"prompt_per_token_ms\":" << per_token(prompt_n, prompt_ms)
+        << ",\"prompt_per_second\":" << per_second(prompt_n, prompt_ms) << ",\"predicted_n\":" << predicted_n
+        << ",\"predicted_ms\":" << predicted_ms << ",\"predicted_per_token_ms\":" << per_token(predicted_n, predicted_ms)
+        << ",\"predicted_per_second\":" << per_second(predicted_n, predicted_ms) << "}";
+    return out.str();
+}
+
+double ms_since(std::chrono::steady_clock::time_point t) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t).count();
+}
+
+} // anonymous namespace
+
+MockLlama::MockLlama(MockLlamaOptions opts, uint16_t port)
+    : opts_(opts),
+      faults_(opts.faults),
+      free_slots_(std::max(1, opts.slots)),
+      server_([this](const ServerRequest& req, ResponseWriter& w) { handle(req, w); }, port) {}
+
+std::vector<int> MockLlama::tokenize(const std::string& text) {
+    std::vector<int> tokens;
+    std::istringstream words(text);
+    for (std::string word; words >> word;) {
+        size_t pieces = (word.size() + 3) / 4;
+        for (size_t i = 0; i < pieces; ++i) {
+            tokens.push_back(static_cast<int>(std::hash<std::string>{}(word.substr(i * 4, 4)) % 32000));
+        }
+    }
+    return tokens;
+}
+
+void MockLlama::handle(const ServerRequest& req, ResponseWriter& w) {
+    if (req.path == "/health") {
+        w.send(200, "{\"status\":\"ok\"}", {{"Content-Type", "application/json"}});
+        return;
+    }
+    if (faults_.before_response(w)) return;
+
+    if (req.method == "POST" && req.path == "/tokenize") {
+        auto tokens = tokenize(json::parse(req.body).get_string("content"));
+        std::string out = "{\"tokens\":[";
+        for (size_t i = 0; i < tokens.size(); ++i) {
+            if (i) out += ',';
+            out += std::to_string(tokens[i]);
+        }
+        w.send(200, out + "]}", {{"Content-Type", "application/json"}});
+        return;
+    }
+    if (req.method == "POST" && req.path == "/completion") {
+        complete(req, w);
+        return;
+    }
+    w.send(404, "");
+}
+
+void MockLlama::complete(const ServerRequest& req, ResponseWriter& w) {
+    json::Value body;
+    try {
+        body = json::parse(req.body);
+    } catch (const std::exception& e) {
+        w.send(400, std::string("{\"error\":\"") + json::escape(e.what()) + "\"}");
+        return;
+    }
+    std::string prompt = body.get_string("prompt");
+    auto n_predict = static_cast<int>(body.get_int("n_predict", opts_.default_n_predict));
+    if (n_predict < 0) n_predict = opts_.default_n_predict;
+    bool stream = body.get_bool("stream");
+    int prompt_n = static_cast<int>(tokenize(prompt).size());
+
+    // Wait for a decode slot, as llama-server queues requests beyond -np
+    {
+        std::unique_lock<std::mutex> lock(slot_mu_);
+        slot_cv_.wait(lock, [this] { return free_slots_ > 0; });
+        free_slots_--;
+    }
+    struct SlotGuard {
+        MockLlama* self;
+        ~SlotGuard() {
+            {
+                std::lock_guard<std::mutex> lock(self->slot_mu_);
+                self->free_slots_++;
+            }
+            self->slot_cv_.notify_one();
+        }
+    } slot{this};
+
+    auto t0 = std::chrono::steady_clock::now();
+    double prefill_ms = faults_.sample_ms(opts_.prefill) + opts_.prefill_ms_per_token * prompt_n;
+    if (!w.pause(std::chrono::microseconds(static_cast<int64_t>(prefill_ms * 1000)))) return;
+    double prompt_ms = ms_since(t0);
+
+    if (stream) w.begin_stream(200, {{"Content-Type", "text/event-stream"}});
+    auto t1 = std::chrono::steady_clock::now();
+    std::string content;
+    for (int i = 0; i < n_predict; ++i) {
+        if (i > 0) {
+            double gap = faults_.sample_ms(opts_.token_interval);
+            if (!w.pause(std::chrono::microseconds(static_cast<int64_t>(gap * 1000)))) return;
+        }
+        std::string token = kWords[static_cast<size_t>(i) % kWordCount];
+        content += token;
+        if (stream && !w.write_chunk("data: {\"content\":\"" + json::escape(token) + "\",\"stop\":false}\n\n")) return;
+    }
+    double predicted_ms = ms_since(t1);
+
+    std::ostringstream tail;
+    tail << "\"tokens_predicted\":" << n_predict << ",\"tokens_evaluated\":" << prompt_n
+         << ",\"stop\":true,\"stopped_limit\":true,\"model\":\"mock\",\"timings\":"
+         << timings_json(prompt_n, prompt_ms, n_predict, predicted_ms);
+    if (stream) {
+        w.write_chunk("data: {\"content\":\"\"," + tail.str() + "}\n\n");
+        w.end_stream();
+    } else {
+        w.send(200, "{\"content\":\"" + json::escape(content) + "\"," + tail.str() + "}",
+               {{"Content-Type", "application/json"}});
+    }
+}
+
+} // namespace slp::testing
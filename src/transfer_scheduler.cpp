@@ -0,0 +1,367 @@
+#include "slp/transfer_scheduler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cmath>
+#include <condition_variable>
+#include <cstdlib>
+#include <list>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace slp {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Smallest bucket depth, so one libcurl buffer never exceeds a full bucket
+constexpr double kMinDepthBytes = 64 * 1024;
+
+uint64_t parse_rate(const std::string& text) {
+    size_t used = 0;
+    double value = -1;
+    try {
+        value = std::stod(text, &used);
+    } catch (const std::exception&) {
+    }
+    double scale = 1;
+    if (used + 1 == text.size()) {
+        switch (std::toupper(static_cast<unsigned char>(text[used]))) {
+        case 'K': scale = 1024.0; break;
+        case 'M': scale = 1024.0 * 1024.0; break;
+        case 'G': scale = 1024.0 * 1024.0 * 1024.0; break;
+        default: used = 0;
+        }
+        if (used) used++;
+    }
+    if (used != text.size() || value < 0) throw std::invalid_argument("bad rate: " + text);
+    return static_cast<uint64_t>(value * scale);
+}
+
+struct Bucket {
+    double rate = 0;    // bytes/s; 0 = unlimited
+    double depth = 0;
+    double tokens = 0;  // negative while in debt
+    Clock::time_point last{};
+
+    void configure(uint64_t bytes_per_sec, std::chrono::milliseconds burst) {
+        rate = static_cast<double>(bytes_per_sec);
+        depth = std::max(kMinDepthBytes, rate * std::chrono::duration<double>(burst).count());
+        tokens = depth;
+        last = Clock::now();
+    }
+    bool unlimited() const { return rate <= 0; }
+    void refill(Clock::time_point now) {
+        if (unlimited()) return;
+        tokens = std::min(depth, tokens + rate * std::chrono::duration<double>(now - last).count());
+        last = now;
+    }
+    bool ready() const { return unlimited() || tokens >= 0; }
+    void consume(uint64_t bytes) {
+        if (!unlimited()) tokens -= static_cast<double>(bytes);
+    }
+    // Time until the debt is paid off
+    Clock::duration until_ready() const {
+        if (ready()) return Clock::duration::zero();
+        return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(-tokens / rate));
+    }
+};
+
+} // anonymous namespace
+
+class TransferScheduler {
+public:
+    static TransferScheduler& instance() {
+        static TransferScheduler scheduler;
+        return scheduler;
+    }
+
+    bool limited() const { return limited_.load(std::memory_order_relaxed); }
+
+    void set_policy(const TransferPolicy& policy) {
+        std::lock_guard<std::mutex> lock(mu_);
+        policy_ = policy;
+        link_.configure(policy.link_bytes_per_sec, policy.burst);
+        for (size_t c = 0; c < kTrafficClasses; ++c) {
+            classes_[c].configure(policy.class_bytes_per_sec[c], policy.burst);
+        }
+        destinations_.clear();
+        limited_.store(policy.limited(), std::memory_order_relaxed);
+        cv_.notify_all();
+    }
+
+    TransferPolicy policy() {
+        std::lock_guard<std::mutex> lock(mu_);
+        return policy_;
+    }
+
+    void acquire(TransferFlow& flow, uint64_t bytes) {
+        counters_[index(flow)].bytes.fetch_add(bytes, std::memory_order_relaxed);
+        if (!limited()) return;
+
+        std::unique_lock<std::mutex> lock(mu_);
+        Waiter me{&flow, std::max(virtual_time_, flow.finish_tag_)};
+        auto it = waiting_.insert(waiting_.end(), me);
+        auto started = Clock::now();
+        bool waited = false;
+
+        for (;;) {
+            auto now = Clock::now();
+            refill(now);
+            const Waiter* next = pick();
+            if (next == &*it) break;
+
+            // Sleep until the bucket holding this flow back has refilled;
+            // grants to other flows wake everyone to re-check
+            waited = true;
+            Clock::duration wait = std::max(link_.until_ready(), own_delay(flow));
+            wait = std::clamp<Clock::duration>(wait, std::chrono::microseconds(50), std::chrono::milliseconds(50));
+            cv_.wait_for(lock, wait);
+        }
+
+        waiting_.erase(it);
+        pay(flow, bytes);
+        virtual_time_ = me.start_tag;
+        flow.finish_tag_ = me.start_tag + static_cast<double>(bytes) / weight(flow);
+        if (waited) {
+            auto& s = stats_[index(flow)];
+            s.waits++;
+            s.wait_ms += std::chrono::duration<double, std::milli>(Clock::now() - started).count();
+        }
+        cv_.notify_all();
+    }
+
+    void charge(TransferFlow& flow, uint64_t bytes) {
+        counters_[index(flow)].bytes.fetch_add(bytes, std::memory_order_relaxed);
+        if (!limited()) return;
+        std::lock_guard<std::mutex> lock(mu_);
+        refill(Clock::now());
+        pay(flow, bytes);
+        double start = std::max(virtual_time_, flow.finish_tag_);
+        flow.finish_tag_ = start + static_cast<double>(bytes) / weight(flow);
+    }
+
+    std::chrono::milliseconds admit_delay(TransferFlow& flow) {
+        if (!limited()) return std::chrono::milliseconds::zero();
+        std::lock_guard<std::mutex> lock(mu_);
+        refill(Clock::now());
+        auto wait = std::max(link_.until_ready(), own_delay(flow));
+        if (wait > Clock::duration::zero()) {
+            auto& s = stats_[index(flow)];
+            s.waits++;
+            s.wait_ms += std::chrono::duration<double, std::milli>(wait).count();
+        }
+        return std::chrono::ceil<std::chrono::milliseconds>(wait);
+    }
+
+    std::array<TrafficStats, kTrafficClasses> stats() {
+        std::lock_guard<std::mutex> lock(mu_);
+        auto out = stats_;
+        for (size_t c = 0; c < kTrafficClasses; ++c) out[c].bytes = counters_[c].bytes.load();
+        return out;
+    }
+
+    void reset_stats() {
+        std::lock_guard<std::mutex> lock(mu_);
+        stats_ = {};
+        for (auto& c : counters_) c.bytes = 0;
+    }
+
+private:
+    struct Waiter {
+        TransferFlow* flow;
+        double start_tag;
+    };
+    struct Counters {
+        std::atomic<uint64_t> bytes{0};
+    };
+
+    TransferScheduler() {
+        TransferPolicy policy;
+        if (const char* spec = std::getenv("SLP_BANDWIDTH"); spec && *spec) {
+            try {
+                policy = parse_transfer_policy(spec);
+            } catch (const std::exception& e) {
+                throw std::invalid_argument(std::string("SLP_BANDWIDTH: ") + e.what());
+            }
+        }
+        set_policy(policy);
+    }
+
+    static size_t index(const TransferFlow& flow) { return static_cast<size_t>(flow.class_); }
+
+    double weight(const TransferFlow& flow) const {
+        return std::max<double>(1.0, policy_.weights[index(flow)]);
+    }
+
+    Bucket& destination(const std::string& dest) {
+        auto [it, inserted] = destinations_.try_emplace(dest);
+        if (inserted) {
+            auto limit = policy_.destination_limits.find(dest);
+            it->second.configure(limit != policy_.destination_limits.end() ? limit->second
+                                                                           : policy_.destination_bytes_per_sec,
+                                 policy_.burst);
+        }
+        return it->second;
+    }
+
+    void refill(Clock::time_point now) {
+        link_.refill(now);
+        for (auto& b : classes_) b.refill(now);
+        for (auto& [dest, b] : destinations_) b.refill(now);
+    }
+
+    Clock::duration own_delay(TransferFlow& flow) {
+        return std::max(classes_[index(flow)].until_ready(), destination(flow.destination_).until_ready());
+    }
+
+    // The waiter to serve next: the smallest start tag among those whose
+    // class and destination buckets allow them to go. Waiters held back by
+    // their own limits are skipped rather than blocking everyone else.
+    const Waiter* pick() {
+        if (!link_.ready()) return nullptr;
+        const Waiter* best = nullptr;
+        for (const Waiter& w : waiting_) {
+            if (!classes_[index(*w.flow)].ready() || !destination(w.flow->destination_).ready()) continue;
+            if (!best || w.start_tag < best->start_tag) best = &w;
+        }
+        return best;
+    }
+
+    void pay(TransferFlow& flow, uint64_t bytes) {
+        link_.consume(bytes);
+        classes_[index(flow)].consume(bytes);
+        destination(flow.destination_).consume(bytes);
+    }
+
+    std::atomic<bool> limited_{false};
+    std::array<Counters, kTrafficClasses> counters_;
+
+    std::mutex mu_;
+    std::condition_variable cv_;
+    TransferPolicy policy_;
+    Bucket link_;
+    std::array<Bucket, kTrafficClasses> classes_;
+    std::map<std::string, Bucket> destinations_;
+    std::list<Waiter> waiting_;
+    double virtual_time_ = 0.0;
+    std::array<TrafficStats, kTrafficClasses> stats_{};
+};
+
+const char* traffic_class_name(TrafficClass c) {
+    switch (c) {
+    case TrafficClass::interactive: return "interactive";
+    case TrafficClass::normal: return "normal";
+    case TrafficClass::bulk: return "bulk";
+    }
+    return "unknown";
+}
+
+bool TransferPolicy::limited() const {
+    if (link_bytes_per_sec > 0 || destination_bytes_per_sec > 0 || !destination_limits.empty()) return true;
+    return std::any_of(class_bytes_per_sec.begin(), class_bytes_per_sec.end(), [](uint64_t r) { return r > 0; });
+}
+
+TransferPolicy parse_transfer_policy(const std::string& spec) {
+    TransferPolicy policy;
+    size_t pos = 0;
+    while (pos <= spec.size()) {
+        size_t comma = spec.find(',', pos);
+        std::string item = spec.substr(pos, comma == std::string::npos ? std::string::npos : comma - pos);
+        pos = comma == std::string::npos ? spec.size() + 1 : comma + 1;
+        if (item.empty()) continue;
+
+        size_t eq = item.rfind('=');
+        if (eq == std::string::npos) throw std::invalid_argument("expected key=value: " + item);
+        std::string key = item.substr(0, eq);
+        std::string value = item.substr(eq + 1);
+
+        if (key == "link") {
+            policy.link_bytes_per_sec = parse_rate(value);
+        } else if (key == "interactive" || key == "normal" || key == "bulk") {
+            size_t c = key == "interactive" ? 0 : key == "normal" ? 1 : 2;
+            policy.class_bytes_per_sec[c] = parse_rate(value);
+        } else if (key == "dest") {
+            policy.destination_bytes_per_sec = parse_rate(value);
+        } else if (key.rfind("dest:", 0) == 0 && key.size() > 5) {
+            policy.destination_limits[key.substr(5)] = parse_rate(value);
+        } else if (key == "weights") {
+            std::vector<std::string> parts;
+            for (size_t at = 0;;) {
+                size_t colon = value.find(':', at);
+                parts.push_back(value.substr(at, colon == std::string::npos ? std::string::npos : colon - at));
+                if (colon == std::string::npos) break;
+                at = colon + 1;
+            }
+            if (parts.size() != kTrafficClasses) {
+                throw std::invalid_argument("weights needs three values, e.g. 16:4:1");
+            }
+            for (size_t c = 0; c < kTrafficClasses; ++c) {
+                policy.weights[c] = static_cast<uint32_t>(std::max<uint64_t>(1, parse_rate(parts[c])));
+            }
+        } else if (key == "burst_ms") {
+            policy.burst = std::chrono::milliseconds(parse_rate(value));
+        } else {
+            throw std::invalid_argument("unknown bandwidth setting: " + key);
+        }
+    }
+    return policy;
+}
+
+void set_transfer_policy(const TransferPolicy& policy) {
+    TransferScheduler::instance().set_policy(policy);
+}
+
+TransferPolicy transfer_policy() {
+    return TransferScheduler::instance().policy();
+}
+
+std::array<TrafficStats, kTrafficClasses> transfer_stats() {
+    return TransferScheduler::instance().stats();
+}
+
+void reset_transfer_stats() {
+    TransferScheduler::instance().reset_stats();
+}
+
+bool transfer_limits_active() {
+    return TransferScheduler::instance().limited();
+}
+
+std::string transfer_destination(const std::string& url) {
+    size_t scheme_end = url.find("://");
+    std::string scheme = scheme_end == std::string::npos ? "http" : url.substr(0, scheme_end);
+    size_t start = scheme_end == std::string::npos ? 0 : scheme_end + 3;
+    size_t end = url.find_first_of("/?#", start);
+    std::string authority = url.substr(start, end == std::string::npos ? std::string::npos : end - start);
+    if (size_t at = authority.rfind('@'); at != std::string::npos) authority.erase(0, at + 1);
+    for (char& c : authority) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+
+    // A port after the host, not a colon inside a bracketed IPv6 address
+    size_t colon = authority.rfind(':');
+    size_t bracket = authority.rfind(']');
+    if (colon == std::string::npos || (bracket != std::string::npos && colon < bracket)) {
+        authority += scheme == "https" ? ":443" : ":80";
+    }
+    return authority;
+}
+
+TransferFlow::TransferFlow(TrafficClass cls, std::string destination)
+    : class_(cls), destination_(std::move(destination)) {}
+
+void TransferFlow::acquire(uint64_t bytes) {
+    TransferScheduler::instance().acquire(*this, bytes);
+}
+
+void TransferFlow::charge(uint64_t bytes) {
+    TransferScheduler::instance().charge(*this, bytes);
+}
+
+std::chrono::milliseconds TransferFlow::admit_delay() {
+    return TransferScheduler::instance().admit_delay(*this);
+}
+
+} // namespace slp
@@ -0,0 +1,111 @@
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+#include "slp/artifact/registry.h"
+#include "slp/testing/mock_filer.h"
+
+// Two registry directories syncing through an in-process mock filer: a
+// removal pushed from one node must survive the other node's pull and push.
+
+namespace {
+
+int failures = 0;
+
+void check(bool ok, const std::string& what) {
+    if (!ok) {
+        std::cerr << "FAIL: " << what << "\n";
+        failures++;
+    }
+}
+
+slp::artifact::RegistryEntry entry(const std::string& name, const std::string& tag, char digit, int64_t created) {
+    slp::artifact::RegistryEntry e;
+    e.name = name;
+    e.tag = tag;
+    e.sha256 = std::string(64, digit);
+    e.size_bytes = 1;
+    e.created_unix = created;
+    return e;
+}
+
+} // anonymous namespace
+
+int main() {
+    namespace fs = std::filesystem;
+    char tmpl[] = "/tmp/slp_registry_sync_XXXXXX";
+    if (!::mkdtemp(tmpl)) {
+        std::cerr << "cannot create a temporary directory\n";
+        return 1;
+    }
+    fs::path root = tmpl;
+    auto now = static_cast<int64_t>(std::time(nullptr));
+
+    try {
+        slp::testing::MockFiler filer;
+        std::string url = filer.url();
+        std::string dir_a = (root / "a").string();
+        std::string dir_b = (root / "b").string();
+
+        {
+            slp::artifact::Registry a(dir_a);
+            a.put(entry("model", "q4", 'a', now - 100));
+            a.put(entry("other", "latest", 'b', now - 100));
+            a.push(url);
+        }
+        {
+            slp::artifact::Registry b(dir_b);
+            check(b.pull(url), "B pulls the first push");
+            check(b.find("model", "q4").has_value(), "B sees model:q4 after its pull");
+        }
+
+        // A removes the tag and pushes; B still holds it in its table
+        {
+            slp::artifact::Registry a(dir_a);
+            check(a.remove("model", "q4"), "A removes model:q4");
+            a.push(url);
+        }
+        {
+            slp::artifact::Registry b(dir_b);
+            check(b.pull(url), "B pulls the removal");
+            check(!b.find("model", "q4").has_value(), "model:q4 stays gone on B after pull");
+            check(b.find("other", "latest").has_value(), "other:latest survives on B");
+            b.push(url);
+        }
+        {
+            slp::artifact::Registry a(dir_a);
+            check(a.pull(url), "A pulls after B's push");
+            check(!a.find("model", "q4").has_value(), "model:q4 stays gone on A after B's push");
+        }
+        {
+            slp::artifact::Registry c((root / "c").string());
+            check(c.pull(url), "a fresh node pulls");
+            check(!c.find("model", "q4").has_value(), "model:q4 is gone on a fresh node");
+            check(!c.resolve(std::string(8, 'a')).has_value(), "the removed hash no longer resolves");
+            check(c.all().size() == 1, "a fresh node lists only other:latest");
+        }
+
+        // Tagging it again after the removal wins over the tombstone
+        {
+            slp::artifact::Registry b(dir_b);
+            b.put(entry("model", "q4", 'c', now + 100));
+            b.push(url);
+        }
+        {
+            slp::artifact::Registry a(dir_a);
+            check(a.pull(url), "A pulls the re-tag");
+            auto e = a.find("model", "q4");
+            check(e && e->sha256 == std::string(64, 'c'), "a newer put wins over the tombstone");
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "FAIL: " << e.what() << "\n";
+        failures++;
+    }
+
+    std::error_code ec;
+    fs::remove_all(root, ec);
+    if (failures == 0) std::cout << "registry sync: ok\n";
+    return failures == 0 ? 0 : 1;
+}